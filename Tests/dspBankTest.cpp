@@ -13,6 +13,7 @@
 
 #include <cmath>
 
+#define DO_TIME_TESTS 0
 
 using namespace ml;
 using namespace testUtils;
@@ -25,7 +26,7 @@ TEST_CASE("madronalib/bank/tickgen_bank", "[bank]")
   using inputType = GenBank<TickGen, 8>::inputType;
   using outputType = GenBank<TickGen, 8>::outputType;
 
-  // 8 voices with frequencies that divide evenly into 64 samples:
+  // 8 voices with frequencies that divide evenly into 256 samples:
   // voices 0-3: tick every 8, 16, 32, 64 samples
   // voices 4-7: tick every 8, 16, 32, 64 samples (same pattern, second group)
   inputType freqInput;
@@ -35,51 +36,54 @@ TEST_CASE("madronalib/bank/tickgen_bank", "[bank]")
     freqInput.rowPtr(1)[t] = float4(1.f/8, 1.f/16, 1.f/32, 1.f/64);
   }
   
-  // run two blocks to get past any startup transient
+  // run one block to get past any startup transient
   bank(freqInput);
-  outputType output = bank(freqInput);
   
-  // convert to horizontal for easy per-voice inspection
-  auto hOutput = verticalToHorizontal<2>(output);
-  
-  // count ticks per voice (tick = 1.0)
-  auto countTicks = [&](int voice) {
-    int count = 0;
-    const float* row = hOutput.rowPtr(voice);
-    for (size_t t = 0; t < kFramesPerBlock; ++t)
+  // count ticks per voice (tick = 1.0) over 256 samples, and verify
+  // matching outputs between the two groups (same frequency → same tick
+  // pattern)
+  constexpr size_t kSamples = 256;
+  std::array<int, 8> counts{};
+  for (size_t b = 0; b < kSamples / kFramesPerBlock; ++b)
+  {
+    outputType output = bank(freqInput);
+    
+    // convert to horizontal for easy per-voice inspection
+    auto hOutput = verticalToHorizontal<2>(output);
+    for (int v = 0; v < 8; ++v)
     {
-      if (row[t] > 0.5f) count++;
+      const float* row = hOutput.rowPtr(v);
+      for (size_t t = 0; t < kFramesPerBlock; ++t)
+      {
+        if (row[t] > 0.5f) counts[v]++;
+      }
     }
-    return count;
-  };
-  
-  // voices 0 and 4: freq=1/8, expect 8 ticks per block
-  REQUIRE(countTicks(0) == 8);
-  REQUIRE(countTicks(4) == 8);
+    for (int v = 0; v < 4; ++v)
+    {
+      const float* rowA = hOutput.rowPtr(v);
+      const float* rowB = hOutput.rowPtr(v + 4);
+      for (size_t t = 0; t < kFramesPerBlock; ++t)
+      {
+        REQUIRE(rowA[t] == rowB[t]);
+      }
+    }
+  }
   
-  // voices 1 and 5: freq=1/16, expect 4 ticks
-  REQUIRE(countTicks(1) == 4);
-  REQUIRE(countTicks(5) == 4);
+  // voices 0 and 4: freq=1/8, expect 32 ticks
+  REQUIRE(counts[0] == 32);
+  REQUIRE(counts[4] == 32);
   
-  // voices 2 and 6: freq=1/32, expect 2 ticks
-  REQUIRE(countTicks(2) == 2);
-  REQUIRE(countTicks(6) == 2);
+  // voices 1 and 5: freq=1/16, expect 16 ticks
+  REQUIRE(counts[1] == 16);
+  REQUIRE(counts[5] == 16);
   
-  // voices 3 and 7: freq=1/64, expect 1 tick
-  REQUIRE(countTicks(3) == 1);
-  REQUIRE(countTicks(7) == 1);
+  // voices 2 and 6: freq=1/32, expect 8 ticks
+  REQUIRE(counts[2] == 8);
+  REQUIRE(counts[6] == 8);
   
-  // verify matching outputs between the two groups
-  // (same frequency → same tick pattern)
-  for (int v = 0; v < 4; ++v)
-  {
-    const float* rowA = hOutput.rowPtr(v);
-    const float* rowB = hOutput.rowPtr(v + 4);
-    for (size_t t = 0; t < kFramesPerBlock; ++t)
-    {
-      REQUIRE(rowA[t] == rowB[t]);
-    }
-  }
+  // voices 3 and 7: freq=1/64, expect 4 ticks
+  REQUIRE(counts[3] == 4);
+  REQUIRE(counts[7] == 4);
 }
 
 
@@ -141,4 +145,336 @@ TEST_CASE("madronalib/bank/lopass_bank", "[bank]")
   }
 }
 
+TEST_CASE("madronalib/bank/voices", "[bank]")
+{
+  // six voices, so the second float4 processor has two unused lanes
+  constexpr int kVoices = 6;
+  using Sines = GenBank<SineGen, kVoices>;
+  using Lopasses = FilterBank<Lopass, kVoices>;
+  Sines sineBank;
+  Lopasses lopassBank;
+  std::array<SineGen<float>, kVoices> sines;
+  std::array<Lopass<float>, kVoices> lopasses;
+  
+  auto freq = [](int v, int block) { return 0.01f + 0.002f * v + (block > 1 ? 0.001f : 0.f); };
+  auto omega = [](int v) { return 0.02f + 0.01f * v; };
+  
+  SECTION("voice params")
+  {
+    lopassBank.setVoiceParams(5, {0.1f, 0.7f});
+    REQUIRE(lopassBank.getVoiceParams(5) == Lopasses::VoiceParams{0.1f, 0.7f});
+    REQUIRE(lopassBank.getVoiceParams(4) == Lopasses::VoiceParams{0.f, 0.f});
+  }
+  
+  SECTION("stored params match scalar processors")
+  {
+    for (int block = 0; block < 4; ++block)
+    {
+      for (int v = 0; v < kVoices; ++v)
+      {
+        sineBank.setVoiceParams(v, {freq(v, block)});
+        lopassBank.setVoiceParams(v, {omega(v), 0.5f});
+      }
+      auto y = lopassBank.processVoices(sineBank.processVoices());
+      for (int v = 0; v < kVoices; ++v)
+      {
+        SignalBlock yv = lopasses[v](sines[v](freq(v, block)), omega(v), 0.5f);
+        for (size_t t = 0; t < kFramesPerBlock; ++t)
+          REQUIRE(y.rowPtr(v)[t] == Approx(yv[t]).margin(1e-4f));
+      }
+    }
+  }
+  
+  SECTION("signal-rate params match scalar processors")
+  {
+    Sines::voiceInputType freqs;
+    Lopasses::voiceParamType filterParams;
+    for (int v = 0; v < kVoices; ++v)
+    {
+      freqs.row(v) = SignalBlock(freq(v, 0));
+      filterParams.row(v) = SignalBlock(columnIndex()) * 0.001f + omega(v);
+      filterParams.row(kVoices + v) = SignalBlock(0.5f);
+    }
+    for (int block = 0; block < 2; ++block)
+    {
+      auto y = lopassBank.processVoices(sineBank.processVoices(freqs), filterParams);
+      for (int v = 0; v < kVoices; ++v)
+      {
+        SignalBlockArray<1> freqRow = freqs.getRow(v);
+        SignalBlock yv = lopasses[v](sines[v](freqRow),
+                                     concatRows(filterParams.getRow(v), filterParams.getRow(kVoices + v)));
+        for (size_t t = 0; t < kFramesPerBlock; ++t)
+          REQUIRE(y.rowPtr(v)[t] == Approx(yv[t]).margin(1e-4f));
+      }
+    }
+  }
+}
 
+TEST_CASE("madronalib/bank/activity", "[bank]")
+{
+  constexpr int kVoices = 8;
+  using Sines = GenBank<SineGen, kVoices>;
+  using Lopasses = FilterBank<Lopass, kVoices>;
+  Sines sineBank;
+  Lopasses lopassBank;
+  std::array<SineGen<float>, kVoices> sines;
+  std::array<Lopass<float>, kVoices> lopasses;
+  for (int v = 0; v < kVoices; ++v)
+  {
+    sineBank.setVoiceParams(v, {0.01f + 0.002f * v});
+    lopassBank.setVoiceParams(v, {0.05f, 0.5f});
+  }
+  
+  // run both banks and the scalar processors for the voices in check
+  auto run = [&](std::bitset<kVoices> check) {
+    auto y = lopassBank.processVoices(sineBank.processVoices());
+    for (int v = 0; v < kVoices; ++v)
+    {
+      if (!check[v]) continue;
+      SignalBlock yv = lopasses[v](sines[v](0.01f + 0.002f * v), 0.05f, 0.5f);
+      for (size_t t = 0; t < kFramesPerBlock; ++t)
+        REQUIRE(y.rowPtr(v)[t] == Approx(yv[t]).margin(1e-4f));
+    }
+    return y;
+  };
+  
+  run(0xFF);
+  REQUIRE(lopassBank.getRunningVoices().all());
+  
+  // an inactive generator voice is silent right away
+  sineBank.setVoiceActive(6, false);
+  run(0x0F);
+  REQUIRE(sineBank.getRunningVoices() == std::bitset<kVoices>(0xBF));
+  
+  // once the second float4 group is inactive and its filter tails have
+  // decayed, it is skipped and outputs zero
+  for (int v = 4; v < kVoices; ++v)
+  {
+    sineBank.setVoiceActive(v, false);
+    lopassBank.setVoiceActive(v, false);
+  }
+  int blocks = 0;
+  while (lopassBank.getRunningVoices() != std::bitset<kVoices>(0x0F))
+  {
+    run(0x0F);
+    REQUIRE(++blocks < 100);
+  }
+  auto y = run(0x0F);
+  for (int v = 4; v < kVoices; ++v)
+    for (size_t t = 0; t < kFramesPerBlock; ++t)
+      REQUIRE(y.rowPtr(v)[t] == 0.f);
+  
+  // woken voices start again from cleared state
+  for (int v = 4; v < kVoices; ++v)
+  {
+    sineBank.setVoiceActive(v, true);
+    lopassBank.setVoiceActive(v, true);
+    sines[v].clear();
+    lopasses[v].clear();
+  }
+  for (int block = 0; block < 4; ++block)
+    run(0xFF);
+  REQUIRE(lopassBank.getRunningVoices().all());
+  
+  // a voice woken while the rest of its group kept running starts from
+  // cleared state as well
+  sineBank.setVoiceActive(1, false);
+  lopassBank.setVoiceActive(1, false);
+  blocks = 0;
+  while (lopassBank.getRunningVoices() != std::bitset<kVoices>(0xFD))
+  {
+    run(0xFD);
+    REQUIRE(++blocks < 100);
+  }
+  for (int block = 0; block < 3; ++block)
+    run(0xFD);
+  sineBank.setVoiceActive(1, true);
+  lopassBank.setVoiceActive(1, true);
+  sines[1].clear();
+  lopasses[1].clear();
+  for (int block = 0; block < 4; ++block)
+    run(0xFF);
+}
+
+TEST_CASE("madronalib/bank/envelopes", "[bank]")
+{
+  // six voices with different envelopes and notes, one a retrigger with a
+  // one-frame gap and one a velocity change while held, against ADSRs.
+  constexpr int kVoices = 6;
+  constexpr float kSr = 48000.f;
+  struct Note
+  {
+    size_t start, end;
+    float velocity;
+  };
+  const std::array<std::vector<Note>, kVoices> notes{{
+      {{10, 3000, 1.f}},
+      {{0, 500, 0.5f}, {501, 2000, 0.8f}},
+      {{100, 4000, 0.3f}, {4000, 6000, 0.9f}},
+      {{64, 128, 1.f}, {1000, 1100, 0.6f}},
+      {{333, 9000, 0.7f}},
+      {},
+  }};
+  const std::array<ADSR::Coeffs, kVoices> coeffs{
+      ADSR::calcCoeffs(0.001f, 0.01f, 0.5f, 0.02f, kSr), ADSR::calcCoeffs(0.005f, 0.02f, 0.8f, 0.01f, kSr),
+      ADSR::calcCoeffs(0.f, 0.005f, 0.f, 0.05f, kSr),    ADSR::calcCoeffs(0.002f, 0.002f, 1.f, 0.002f, kSr),
+      ADSR::calcCoeffs(0.02f, 0.1f, 0.3f, 0.1f, kSr),    ADSR::calcCoeffs(0.01f, 0.01f, 0.5f, 0.01f, kSr)};
+
+  auto gate = [&](int v, size_t n) {
+    for (const auto& note : notes[v])
+      if (n >= note.start && n < note.end) return note.velocity;
+    return 0.f;
+  };
+
+  EnvelopeBank<kVoices> bank, ptrBank;
+  std::array<ADSR, kVoices> adsrs;
+  for (int v = 0; v < kVoices; ++v)
+  {
+    bank.setVoiceCoeffs(v, coeffs[v]);
+    ptrBank.setVoiceCoeffs(v, coeffs[v]);
+    adsrs[v].coeffs = coeffs[v];
+  }
+
+  bool sawAttack{false}, sawSustain{false}, sawRelease{false};
+  for (size_t b = 0; b < 12800 / kFramesPerBlock; ++b)
+  {
+    SignalBlockArray<kVoices> gates;
+    EnvelopeBank<kVoices>::voiceRowPtrs gatePtrs;
+    for (int v = 0; v < kVoices; ++v)
+    {
+      for (size_t t = 0; t < kFramesPerBlock; ++t) gates.rowPtr(v)[t] = gate(v, b * kFramesPerBlock + t);
+      gatePtrs[v] = gates.rowPtr(v);
+    }
+
+    auto y = bank.processVoices(gates);
+    auto yPtrs = ptrBank.processVoices(gatePtrs);
+    for (int v = 0; v < kVoices; ++v)
+    {
+      SignalBlock expected = adsrs[v](gates.getRow(v));
+      for (size_t t = 0; t < kFramesPerBlock; ++t)
+      {
+        REQUIRE(y.rowPtr(v)[t] == Approx(expected[t]).margin(1e-5f));
+        REQUIRE(yPtrs.rowPtr(v)[t] == y.rowPtr(v)[t]);
+      }
+      REQUIRE(bank.isVoiceIdle(v) == (adsrs[v].segment == ADSR::off));
+      sawAttack |= (adsrs[v].segment == ADSR::A);
+      sawSustain |= (adsrs[v].segment == ADSR::S);
+      sawRelease |= (adsrs[v].segment == ADSR::R);
+    }
+  }
+  REQUIRE((sawAttack && sawSustain && sawRelease));
+  // all but voice 2, which like an ADSR with zero sustain never leaves its
+  // release, have finished.
+  for (int v : {0, 1, 3, 4, 5}) REQUIRE(bank.isVoiceIdle(v));
+
+  // the float4 interface makes the same envelopes as the per-voice one.
+  EnvelopeBank<8> bank4, bankVoices;
+  bank4.setCoeffs(coeffs[0]);
+  bankVoices.setCoeffs(coeffs[0]);
+  for (size_t b = 0; b < 6400 / kFramesPerBlock; ++b)
+  {
+    SignalBlockArray<8> gates;
+    for (int v = 0; v < 8; ++v)
+      for (size_t t = 0; t < kFramesPerBlock; ++t) gates.rowPtr(v)[t] = gate(v % 5, b * kFramesPerBlock + t);
+    auto y = verticalToHorizontal<2>(bank4(horizontalToVertical<2>(gates)));
+    auto yv = bankVoices.processVoices(gates);
+    for (int v = 0; v < 8; ++v)
+      for (size_t t = 0; t < kFramesPerBlock; ++t) REQUIRE(y.rowPtr(v)[t] == yv.rowPtr(v)[t]);
+  }
+}
+
+#if DO_TIME_TESTS
+TEST_CASE("madronalib/bank/time", "[bank][time]")
+{
+  // a 16-voice sine into lopass patch, with per-block params
+  constexpr int kVoices = 16;
+  using Sines = GenBank<SineGen, kVoices>;
+  using Lopasses = FilterBank<Lopass, kVoices>;
+  Sines sineBank;
+  Lopasses lopassBank;
+  Sines::inputType sineFreqs{float4(0.01f)};
+  std::array<Lopasses::Params, Lopasses::kNumFloat4Procs> loParams;
+  loParams.fill(Lopasses::Params{float4(0.05f), float4(0.5f)});
+
+  std::function<Lopasses::outputType(void)> patchFn = [&]() { return lopassBank(sineBank(sineFreqs), loParams); };
+  auto patchTime = timeIterations<Lopasses::outputType>(patchFn);
+
+  std::cout << "sine -> lopass bank, ns per voice per block: " << patchTime.ns / kVoices << "\n";
+  
+  // the same patch with the per-voice interface, and with scalar processors
+  for (int v = 0; v < kVoices; ++v)
+  {
+    sineBank.setVoiceParams(v, {0.01f});
+    lopassBank.setVoiceParams(v, {0.05f, 0.5f});
+  }
+  std::function<SignalBlockArray<kVoices>(void)> voicesFn = [&]() {
+    return lopassBank.processVoices(sineBank.processVoices());
+  };
+  auto voicesTime = timeIterations<SignalBlockArray<kVoices>>(voicesFn);
+  
+  std::array<SineGen<float>, kVoices> sines;
+  std::array<Lopass<float>, kVoices> lopasses;
+  std::function<SignalBlockArray<kVoices>(void)> scalarFn = [&]() {
+    SignalBlockArray<kVoices> y(uninitialized);
+    for (int v = 0; v < kVoices; ++v)
+      y.row(v) = lopasses[v](sines[v](0.01f), 0.05f, 0.5f);
+    return y;
+  };
+  auto scalarTime = timeIterations<SignalBlockArray<kVoices>>(scalarFn);
+  
+  std::cout << "per-voice interface, ns per voice per block: " << voicesTime.ns / kVoices
+            << ", scalar processors: " << scalarTime.ns / kVoices << "\n";
+  
+  // with only the first four voices active, three of the four processors rest
+  for (int v = 4; v < kVoices; ++v)
+  {
+    sineBank.setVoiceActive(v, false);
+    lopassBank.setVoiceActive(v, false);
+  }
+  for (int i = 0; i < 100; ++i) voicesFn();
+  auto restingTime = timeIterations<SignalBlockArray<kVoices>>(voicesFn);
+  std::cout << "per-voice interface, 4 of " << kVoices << " voices active, ns per block: " << restingTime.ns
+            << ", all active: " << voicesTime.ns << "\n";
+}
+
+TEST_CASE("madronalib/bank/envelopes/time", "[bank][time]")
+{
+  // 64 envelopes retriggered every 64 blocks, against ADSRs. Half of the
+  // time the envelopes are sustaining or idle.
+  constexpr int kVoices = 64;
+  EnvelopeBank<kVoices> bank;
+  std::array<ADSR, kVoices> adsrs;
+  auto c = ADSR::calcCoeffs(0.002f, 0.01f, 0.5f, 0.02f, 48000.f);
+  bank.setCoeffs(c);
+  for (auto& a : adsrs) a.coeffs = c;
+
+  int n = 0, step = 1;
+  SignalBlockArray<kVoices> gates;
+  auto nextGates = [&]() {
+    ++n;
+    for (int v = 0; v < kVoices; ++v) gates.row(v) = SignalBlock(((n + v / step) & 63) < 32 ? 0.8f : 0.f);
+  };
+  std::function<SignalBlockArray<kVoices>(void)> bankFn = [&]() {
+    nextGates();
+    return bank.processVoices(gates);
+  };
+  std::function<SignalBlockArray<kVoices>(void)> scalarFn = [&]() {
+    nextGates();
+    SignalBlockArray<kVoices> y(uninitialized);
+    for (int v = 0; v < kVoices; ++v) y.row(v) = adsrs[v](gates.getRow(v));
+    return y;
+  };
+  auto bankTime = timeIterations<SignalBlockArray<kVoices>>(bankFn);
+  auto scalarTime = timeIterations<SignalBlockArray<kVoices>>(scalarFn);
+  std::cout << kVoices << " envelopes, ns per block: EnvelopeBank " << bankTime.ns << ", ADSR " << scalarTime.ns
+            << "\n";
+
+  // the same with the voices of each group in step, as in chords, so that
+  // the groups skip the blocks where they are all sustaining or idle.
+  step = 4;
+  bankTime = timeIterations<SignalBlockArray<kVoices>>(bankFn);
+  scalarTime = timeIterations<SignalBlockArray<kVoices>>(scalarFn);
+  std::cout << kVoices << " envelopes in step, ns per block: EnvelopeBank " << bankTime.ns << ", ADSR "
+            << scalarTime.ns << "\n";
+}
+#endif
@@ -0,0 +1,173 @@
+// madronalib: a C++ framework for DSP applications.
+// Copyright (c) 2026 Madrona Labs LLC. http://www.madronalabs.com
+// Distributed under the MIT license: http://madrona-labs.mit-license.org/
+
+// a unit test made using the Catch framework in catch.hpp / tests.cpp.
+
+#include "catch.hpp"
+#include "MLTestUtils.h"
+#include "MLDSPConvolution.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#define DO_TIME_TESTS 0
+
+using namespace ml;
+using namespace testUtils;
+
+namespace
+{
+
+std::vector<float> decayingNoise(size_t n, float decay)
+{
+  RandomScalarSource rand;
+  std::vector<float> x(n);
+  for (size_t i = 0; i < n; ++i) x[i] = rand.getFloat() * std::exp(-decay * i);
+  return x;
+}
+
+// direct convolution of x with h, for the first n outputs
+std::vector<float> convolveDirect(const std::vector<float>& x, const std::vector<float>& h, size_t n)
+{
+  std::vector<float> y(n, 0.f);
+  for (size_t t = 0; t < n; ++t)
+  {
+    double sum = 0;
+    for (size_t k = 0; k < h.size() && k <= t; ++k) sum += double(h[k]) * x[t - k];
+    y[t] = float(sum);
+  }
+  return y;
+}
+
+std::vector<float> runConvolver(Convolver& c, const std::vector<float>& x)
+{
+  std::vector<float> y(x.size());
+  for (size_t b = 0; b < x.size() / kFramesPerBlock; ++b)
+  {
+    SignalBlock vx(x.data() + b * kFramesPerBlock);
+    SignalBlock vy = c(vx);
+    std::copy(vy.begin(), vy.end(), y.data() + b * kFramesPerBlock);
+  }
+  return y;
+}
+
+}  // namespace
+
+TEST_CASE("madronalib/convolution/partitioned", "[convolution]")
+{
+  SECTION("layers")
+  {
+    // partitions growing by four times from kFramesPerBlock until the
+    // largest size is reached (64, 256, 1024 and 4096 at 64 frames), each
+    // layer starting in time to be ready.
+    constexpr size_t kMaxSize = 4096;
+    auto h = decayingNoise(20000, 0.f);
+    ConvolutionIR ir(h.data(), h.size(), kMaxSize);
+    auto& layers = ir.getLayers();
+    size_t expectedLayers = 1;
+    for (size_t size = kFramesPerBlock; size < kMaxSize; size *= 4) expectedLayers++;
+    REQUIRE(layers.size() == expectedLayers);
+    size_t offset = 0;
+    for (size_t i = 0; i < layers.size(); ++i)
+    {
+      REQUIRE(layers[i].blockSize == std::min(kFramesPerBlock << (2 * i), kMaxSize));
+      REQUIRE(layers[i].offset == offset);
+      REQUIRE(layers[i].offset + kFramesPerBlock >= layers[i].blockSize);
+      offset += layers[i].partitions * layers[i].blockSize;
+    }
+    REQUIRE(offset >= h.size());
+  }
+
+  SECTION("matches direct convolution with no latency")
+  {
+    auto x = decayingNoise(16384, 0.f);
+    for (size_t irLength : {1, 100, 1000, 5000, 9000})
+    {
+      auto h = decayingNoise(irLength, 4.f / irLength);
+      auto expected = convolveDirect(x, h, x.size());
+      for (size_t maxSize : {64, 256, 4096})
+      {
+        Convolver c(std::make_shared<ConvolutionIR>(h.data(), h.size(), maxSize));
+        auto y = runConvolver(c, x);
+        float maxDiff = 0.f;
+        for (size_t t = 0; t < x.size(); ++t) maxDiff = std::max(maxDiff, std::fabs(y[t] - expected[t]));
+        REQUIRE(maxDiff < 1e-4f);
+      }
+    }
+  }
+
+  SECTION("impulse response from a Sample, shared across channels")
+  {
+    // a two-channel sample: an impulse at 10, and an impulse at 3000
+    Sample s;
+    resize(s, 4000, 2);
+    s.sampleData[10 * 2] = 1.f;
+    s.sampleData[3000 * 2 + 1] = 0.5f;
+    auto left = std::make_shared<const ConvolutionIR>(s, 0);
+    auto right = std::make_shared<const ConvolutionIR>(s, 1);
+    REQUIRE(left->getLength() == 4000);
+
+    constexpr int kRows = 3;
+    ConvolverBank<kRows> bank;
+    bank.setImpulseResponse(left);
+    bank.setImpulseResponse(2, right);
+
+    SignalBlockArray<kRows> x(0.f);
+    for (int j = 0; j < kRows; ++j) x.rowPtr(j)[0] = float(j + 1);
+    std::vector<SignalBlockArray<kRows>> y;
+    for (size_t b = 0; b < 3000 / kFramesPerBlock + 1; ++b)
+    {
+      y.push_back(bank(x));
+      x = SignalBlockArray<kRows>(0.f);
+    }
+    REQUIRE(y[0].rowPtr(0)[10] == Approx(1.f));
+    REQUIRE(y[0].rowPtr(1)[10] == Approx(2.f));
+    REQUIRE(y[3000 / kFramesPerBlock].rowPtr(2)[3000 % kFramesPerBlock] == Approx(1.5f));
+    REQUIRE(y[0].rowPtr(2)[10] == Approx(0.f).margin(1e-6f));
+
+    // a channel past the last uses the last
+    ConvolutionIR past(s, 5);
+    for (size_t i = 0; i < past.getLayers().size(); ++i)
+    {
+      const auto& a = past.getLayers()[i];
+      const auto& b = right->getLayers()[i];
+      REQUIRE(std::equal(a.getSpectrum(0), a.getSpectrum(a.partitions), b.getSpectrum(0)));
+    }
+  }
+
+  SECTION("clear")
+  {
+    auto h = decayingNoise(3000, 0.001f);
+    auto x = decayingNoise(4096, 0.f);
+    Convolver c(std::make_shared<ConvolutionIR>(h.data(), h.size()));
+    auto y1 = runConvolver(c, x);
+    c.clear();
+    auto y2 = runConvolver(c, x);
+    REQUIRE(y1 == y2);
+  }
+}
+
+#if DO_TIME_TESTS
+TEST_CASE("madronalib/convolution/time", "[convolution][time]")
+{
+  // channels of convolution that one core can run in real time at 48 kHz,
+  // for each IR length and maximum partition size
+  constexpr float kSampleRate = 48000.f;
+  const double blockNs = 1e9 * kFramesPerBlock / kSampleRate;
+  for (float seconds : {2.f, 10.f})
+  {
+    auto h = decayingNoise(size_t(seconds * kSampleRate), 0.f);
+    for (size_t maxSize : {64, 1024, 4096, 16384})
+    {
+      Convolver c(std::make_shared<ConvolutionIR>(h.data(), h.size(), maxSize));
+      SignalBlock x(0.5f);
+      std::function<SignalBlock(void)> fn = [&]() { return c(x); };
+      auto t = timeIterations<SignalBlock>(fn);
+      std::cout << seconds << " s IR, max partition " << maxSize << ": " << t.ns << " ns per block, "
+                << blockNs / t.ns << " channels per core\n";
+    }
+  }
+}
+#endif
@@ -0,0 +1,564 @@
+// madronalib: a C++ framework for DSP applications.
+// Copyright (c) 2026 Madrona Labs LLC. http://www.madronalabs.com
+// Distributed under the MIT license: http://madrona-labs.mit-license.org/
+
+// a unit test made using the Catch framework in catch.hpp / tests.cpp.
+
+#include "catch.hpp"
+#include "MLTestUtils.h"
+#include "MLDSPDelays.h"
+
+#include <cmath>
+#include <vector>
+
+#define DO_TIME_TESTS 0
+
+using namespace ml;
+using namespace testUtils;
+
+namespace
+{
+
+std::vector<float> noise(size_t n)
+{
+  RandomScalarSource rand;
+  std::vector<float> x(n);
+  for (auto& v : x) v = rand.getFloat();
+  return x;
+}
+
+// sample t - d of x, or 0 before the start
+float delayed(const std::vector<float>& x, size_t t, size_t d) { return (t >= d) ? x[t - d] : 0.f; }
+
+// peak error in dB of a sine with frequency omega through a ModulatedDelay
+// with the constant delay d.
+template<TapInterpolation INTERP>
+float interpolationError(float omega, float d)
+{
+  ModulatedDelay<INTERP> delay(100.f);
+  float maxError = 0.f;
+  for (int b = 0; b < 32; ++b)
+  {
+    SignalBlock x;
+    for (int i = 0; i < kFramesPerBlock; ++i) x[i] = float(std::sin(kTwoPi * double(omega) * (b * kFramesPerBlock + i)));
+    SignalBlock y = delay(x, SignalBlock(d));
+    if (b < 4) continue;
+    for (int i = 0; i < kFramesPerBlock; ++i)
+    {
+      double expected = std::sin(kTwoPi * double(omega) * (b * kFramesPerBlock + i - double(d)));
+      maxError = std::max(maxError, float(std::fabs(y[i] - expected)));
+    }
+  }
+  return 20.f * std::log10(maxError);
+}
+
+}  // namespace
+
+TEST_CASE("madronalib/delays/integer", "[delays]")
+{
+  constexpr size_t kBlocks = 64;
+  auto x = noise(kBlocks * kFramesPerBlock);
+
+  SECTION("constant delays, across the end of the buffer")
+  {
+    for (int d : {0, 1, 63, 64, 65, 100, 1000, 1500})
+    {
+      IntegerDelay delay;
+      delay.setMaxDelayInSamples(1500.f);
+      delay.setDelayInSamples(d);
+      for (size_t b = 0; b < kBlocks; ++b)
+      {
+        SignalBlock y = delay(SignalBlock(x.data() + b * kFramesPerBlock));
+        for (int i = 0; i < kFramesPerBlock; ++i)
+          REQUIRE(y[i] == delayed(x, b * kFramesPerBlock + i, d));
+      }
+    }
+  }
+
+  SECTION("blocks after single samples")
+  {
+    // single samples move the write position off the block boundaries.
+    IntegerDelay delay(300);
+    size_t t = 0;
+    for (; t < 5; ++t) REQUIRE(delay.processSample(x[t]) == delayed(x, t, 300));
+    for (; t + kFramesPerBlock <= x.size(); t += kFramesPerBlock)
+    {
+      SignalBlock y = delay(SignalBlock(x.data() + t));
+      for (int i = 0; i < kFramesPerBlock; ++i) REQUIRE(y[i] == delayed(x, t + i, 300));
+    }
+  }
+
+  SECTION("varying delay")
+  {
+    IntegerDelay delay;
+    delay.setMaxDelayInSamples(700.f);
+    RandomScalarSource rand;
+    for (size_t b = 0; b < kBlocks; ++b)
+    {
+      SignalBlock d;
+      for (int i = 0; i < kFramesPerBlock; ++i) d[i] = std::floor(350.f + 350.f * rand.getFloat());
+      SignalBlock y = delay(SignalBlock(x.data() + b * kFramesPerBlock), d);
+      for (int i = 0; i < kFramesPerBlock; ++i)
+        REQUIRE(y[i] == delayed(x, b * kFramesPerBlock + i, size_t(d[i])));
+    }
+  }
+}
+
+TEST_CASE("madronalib/delays/fractional", "[delays]")
+{
+  // a low sine comes out delayed by the fractional time
+  const float omega = 0.005f;
+  auto sine = [&](float t) { return std::sin(kTwoPi * omega * t); };
+  const float d = 100.3f;
+
+  FractionalDelay constant(200.f);
+  constant.setDelayInSamples(d);
+  FractionalDelay varying(200.f);
+  PitchbendableDelay bendable;
+  bendable.setMaxDelayInSamples(200.f);
+
+  // skip the first 2 * d samples, while the delay fills and the
+  // interpolation settles.
+  for (size_t b = 0; b < 1024 / kFramesPerBlock; ++b)
+  {
+    SignalBlock x;
+    for (int i = 0; i < kFramesPerBlock; ++i) x[i] = sine(float(b * kFramesPerBlock + i));
+    SignalBlock y1 = constant(x);
+    SignalBlock y2 = varying(x, SignalBlock(d));
+    SignalBlock y3 = bendable(x, SignalBlock(d));
+    for (int i = 0; i < kFramesPerBlock; ++i)
+    {
+      if (b * kFramesPerBlock + i < 2 * d) continue;
+      float expected = sine(b * kFramesPerBlock + i - d);
+      REQUIRE(y1[i] == Approx(expected).margin(1e-3f));
+      REQUIRE(y2[i] == Approx(y1[i]).margin(1e-6f));
+      REQUIRE(y3[i] == Approx(expected).margin(1e-3f));
+    }
+  }
+}
+
+TEST_CASE("madronalib/delays/allpass", "[delays]")
+{
+  // the impulse response has unit energy
+  Allpass<IntegerDelay> ap;
+  ap.setMaxDelayInSamples(500.f);
+  ap.setDelayInSamples(437.f);
+  ap.mGain = 0.7f;
+  double energy = 0.;
+  SignalBlock impulse;
+  impulse[0] = 1.f;
+  for (int b = 0; b < 400; ++b)
+  {
+    SignalBlock y = ap((b == 0) ? impulse : SignalBlock(0.f));
+    for (int i = 0; i < kFramesPerBlock; ++i) energy += y[i] * y[i];
+  }
+  REQUIRE(energy == Approx(1.).margin(1e-4));
+}
+
+TEST_CASE("madronalib/delays/multitap", "[delays]")
+{
+  constexpr size_t kTaps = 8;
+  constexpr size_t kBlocks = 32;
+  auto x = noise(kBlocks * kFramesPerBlock);
+
+  // a different moving delay time for each tap
+  auto tapDelays = [&](size_t b) {
+    SignalBlockArray<kTaps> d;
+    for (size_t j = 0; j < kTaps; ++j)
+      for (int i = 0; i < kFramesPerBlock; ++i)
+        d.rowPtr(j)[i] = 20.f + 100.f * j + 10.f * std::sin(0.001f * (j + 1) * (b * kFramesPerBlock + i));
+    return d;
+  };
+
+  SECTION("linear interpolation")
+  {
+    MultiTapDelay<kTaps> taps(1000.f);
+    for (size_t b = 0; b < kBlocks; ++b)
+    {
+      auto d = tapDelays(b);
+      auto y = taps(SignalBlock(x.data() + b * kFramesPerBlock), d);
+      for (size_t j = 0; j < kTaps; ++j)
+      {
+        for (int i = 0; i < kFramesPerBlock; ++i)
+        {
+          size_t t = b * kFramesPerBlock + i;
+          float dj = d.rowPtr(j)[i];
+          size_t dInt = size_t(dj);
+          float frac = dj - dInt;
+          float expected = delayed(x, t, dInt) + frac * (delayed(x, t, dInt + 1) - delayed(x, t, dInt));
+          REQUIRE(y.rowPtr(j)[i] == Approx(expected).margin(1e-6f));
+        }
+      }
+    }
+  }
+
+  SECTION("allpass interpolation matches FractionalDelay")
+  {
+    MultiTapDelay<kTaps, TapInterpolation::kAllpass> taps(1000.f);
+    std::array<FractionalDelay, kTaps> singles;
+    for (auto& f : singles) f.setMaxDelayInSamples(1000.f);
+    for (size_t b = 0; b < kBlocks; ++b)
+    {
+      SignalBlock vx(x.data() + b * kFramesPerBlock);
+      auto d = tapDelays(b);
+      auto y = taps(vx, d);
+      for (size_t j = 0; j < kTaps; ++j)
+      {
+        SignalBlock yj = singles[j](vx, d.getRow(j));
+        for (int i = 0; i < kFramesPerBlock; ++i) REQUIRE(y.rowPtr(j)[i] == Approx(yj[i]).margin(1e-5f));
+      }
+    }
+  }
+
+  SECTION("mix")
+  {
+    MultiTapDelay<kTaps> taps(1000.f), mixed(1000.f);
+    SignalBlockArray<kTaps> gains;
+    for (size_t j = 0; j < kTaps; ++j) gains.setRow(j, SignalBlock(1.f / (j + 1)));
+    for (size_t b = 0; b < kBlocks; ++b)
+    {
+      SignalBlock vx(x.data() + b * kFramesPerBlock);
+      auto d = tapDelays(b);
+      auto y = taps(vx, d);
+      SignalBlock mix = mixed(vx, d, gains);
+      for (int i = 0; i < kFramesPerBlock; ++i)
+      {
+        float expected = 0.f;
+        for (size_t j = 0; j < kTaps; ++j) expected += y.rowPtr(j)[i] / (j + 1);
+        REQUIRE(mix[i] == Approx(expected).margin(1e-5f));
+      }
+    }
+  }
+}
+
+TEST_CASE("madronalib/delays/fdn", "[delays]")
+{
+  // frames of noise through a mixer keep their energy, and the symmetric
+  // mixers are their own inverses.
+  auto checkMixer = [](auto mixer, bool involution) {
+    constexpr int kSize = 16;
+    auto x = noise(kSize * kFramesPerBlock);
+    SignalBlockArray<kSize> v(x.data());
+    SignalBlockArray<kSize> y = v;
+    mixer(y);
+    for (int i = 0; i < kFramesPerBlock; ++i)
+    {
+      float inEnergy = 0.f, outEnergy = 0.f;
+      for (int j = 0; j < kSize; ++j)
+      {
+        inEnergy += v.rowPtr(j)[i] * v.rowPtr(j)[i];
+        outEnergy += y.rowPtr(j)[i] * y.rowPtr(j)[i];
+      }
+      REQUIRE(outEnergy == Approx(inEnergy).epsilon(1e-5f));
+    }
+    if (involution)
+    {
+      mixer(y);
+      for (int j = 0; j < kSize; ++j)
+        for (int i = 0; i < kFramesPerBlock; ++i) REQUIRE(y.rowPtr(j)[i] == Approx(v.rowPtr(j)[i]).margin(1e-5f));
+    }
+  };
+
+  SECTION("mixers")
+  {
+    checkMixer(HouseholderMixer<16>(), true);
+    checkMixer(HadamardMixer<16>(), true);
+    checkMixer(OrthogonalMixer<16>(), false);
+  }
+
+  SECTION("impulse with no feedback")
+  {
+    // each line's delay time lands in its output row, odd lines on the left.
+    // Delay times are at least one block.
+    constexpr int kSize = 8;
+    FDN<kSize> fdn;
+    fdn.setMaxDelayInSamples(2000);
+    std::array<float, kSize> times;
+    for (int j = 0; j < kSize; ++j) times[j] = float(kFramesPerBlock) + 97.f * j;
+    fdn.setDelaysInSamples(times);
+
+    std::vector<float> left, right;
+    SignalBlock impulse;
+    impulse[0] = 1.f;
+    for (size_t b = 0; b < 2048 / kFramesPerBlock; ++b)
+    {
+      auto y = fdn((b == 0) ? impulse : SignalBlock(0.f));
+      left.insert(left.end(), y.rowPtr(0), y.rowPtr(0) + kFramesPerBlock);
+      right.insert(right.end(), y.rowPtr(1), y.rowPtr(1) + kFramesPerBlock);
+    }
+    for (size_t t = 0; t < left.size(); ++t)
+    {
+      float expectedLeft = 0.f, expectedRight = 0.f;
+      for (int j = 0; j < kSize; ++j)
+      {
+        if (t == size_t(times[j])) ((j & 1) ? expectedLeft : expectedRight) = 1.f;
+      }
+      REQUIRE(left[t] == Approx(expectedLeft).margin(1e-6f));
+      REQUIRE(right[t] == Approx(expectedRight).margin(1e-6f));
+    }
+  }
+
+  SECTION("every line reaches an output")
+  {
+    // with six lines and four outputs, line n goes to output (n + 1) % 4, so
+    // lines 4 and 5 join lines 0 and 1 in outputs 1 and 2.
+    constexpr int kSize = 6, kOuts = 4;
+    FDN<kSize, HouseholderMixer, 1, kOuts> fdn;
+    fdn.setMaxDelayInSamples(1000);
+    std::array<float, kSize> times;
+    for (int j = 0; j < kSize; ++j) times[j] = float(kFramesPerBlock + 10 * j);
+    fdn.setDelaysInSamples(times);
+    SignalBlock impulse;
+    impulse[0] = 1.f;
+    std::array<float, kOuts> sums{};
+    for (size_t b = 0; b < 1024 / kFramesPerBlock; ++b)
+    {
+      auto y = fdn((b == 0) ? impulse : SignalBlock(0.f));
+      for (int o = 0; o < kOuts; ++o)
+        for (int i = 0; i < kFramesPerBlock; ++i) sums[o] += y.rowPtr(o)[i];
+    }
+    REQUIRE(sums[0] == Approx(1.f));
+    REQUIRE(sums[1] == Approx(2.f));
+    REQUIRE(sums[2] == Approx(2.f));
+    REQUIRE(sums[3] == Approx(1.f));
+  }
+
+  SECTION("modulated, with feedback")
+  {
+    // a modulated 16-line network with damping rings and then decays.
+    constexpr int kSize = 16;
+    FDN<kSize, HadamardMixer, 2, 2> fdn;
+    fdn.setMaxDelayInSamples(2000);
+    std::array<float, kSize> times, cutoffs;
+    for (int j = 0; j < kSize; ++j)
+    {
+      times[j] = 300.f + 89.3f * j;
+      cutoffs[j] = 0.2f;
+    }
+    fdn.setDelaysInSamples(times);
+    fdn.setFilterCutoffs(cutoffs);
+    fdn.setModulation(8.f, 0.5f / 48000.f);
+    fdn.mFeedbackGains.fill(0.9f);
+
+    auto energy = [](const SignalBlockArray<2>& y) {
+      float sum = 0.f;
+      for (int j = 0; j < 2; ++j)
+        for (int i = 0; i < kFramesPerBlock; ++i) sum += y.rowPtr(j)[i] * y.rowPtr(j)[i];
+      return sum;
+    };
+    SignalBlockArray<2> impulse;
+    impulse.rowPtr(0)[0] = impulse.rowPtr(1)[0] = 1.f;
+    float early = 0.f, late = 0.f;
+    for (int b = 0; b < 2000; ++b)
+    {
+      auto y = fdn((b == 0) ? impulse : SignalBlockArray<2>(0.f));
+      float e = energy(y);
+      REQUIRE(std::isfinite(e));
+      if (b >= 100 && b < 200) early += e;
+      if (b >= 1900) late += e;
+    }
+    REQUIRE(early > 0.f);
+    REQUIRE(late < early * 1e-3f);
+  }
+}
+
+TEST_CASE("madronalib/delays/modulated", "[delays]")
+{
+  SECTION("accuracy")
+  {
+    // worst case fractional delays; error bounds in dB, a few dB above the
+    // table in MLDSPDelays.h.
+    const float d = 20.5f;
+    REQUIRE(interpolationError<TapInterpolation::kLinear>(0.02f, d) < -50.f);
+    REQUIRE(interpolationError<TapInterpolation::kHermite>(0.02f, d) < -95.f);
+    REQUIRE(interpolationError<TapInterpolation::kLagrange>(0.02f, d) < -95.f);
+    REQUIRE(interpolationError<TapInterpolation::kSinc>(0.02f, d) < -65.f);
+    REQUIRE(interpolationError<TapInterpolation::kSinc>(0.25f, d) < -63.f);
+
+    // integer delays are exact, down to the shortest.
+    REQUIRE(interpolationError<TapInterpolation::kHermite>(0.1f, 1.f) < -120.f);
+    REQUIRE(interpolationError<TapInterpolation::kSinc>(0.1f, 3.f) < -120.f);
+  }
+
+  SECTION("varying, linear")
+  {
+    constexpr size_t kBlocks = 32;
+    auto x = noise(kBlocks * kFramesPerBlock);
+    ModulatedDelay<TapInterpolation::kLinear> delay(200.f);
+    for (size_t b = 0; b < kBlocks; ++b)
+    {
+      SignalBlock d;
+      for (int i = 0; i < kFramesPerBlock; ++i) d[i] = 100.f + 99.f * std::sin(0.003f * (b * kFramesPerBlock + i));
+      SignalBlock y = delay(SignalBlock(x.data() + b * kFramesPerBlock), d);
+      for (int i = 0; i < kFramesPerBlock; ++i)
+      {
+        size_t t = b * kFramesPerBlock + i;
+        size_t dInt = size_t(d[i]);
+        float frac = d[i] - dInt;
+        float expected = delayed(x, t, dInt) + frac * (delayed(x, t, dInt + 1) - delayed(x, t, dInt));
+        REQUIRE(y[i] == Approx(expected).margin(1e-6f));
+      }
+    }
+  }
+
+  SECTION("multitap matches")
+  {
+    // each tap of a MultiTapDelay reads like a ModulatedDelay, including the
+    // clamping of the first tap's times below the minimum.
+    constexpr size_t kTaps = 4;
+    constexpr size_t kBlocks = 16;
+    auto x = noise(kBlocks * kFramesPerBlock);
+    MultiTapDelay<kTaps, TapInterpolation::kSinc> taps(500.f);
+    std::array<ModulatedDelay<TapInterpolation::kSinc>, kTaps> singles;
+    for (auto& m : singles) m.setMaxDelayInSamples(500.f);
+    for (size_t b = 0; b < kBlocks; ++b)
+    {
+      SignalBlock vx(x.data() + b * kFramesPerBlock);
+      SignalBlockArray<kTaps> d;
+      for (size_t j = 0; j < kTaps; ++j)
+        for (int i = 0; i < kFramesPerBlock; ++i)
+          d.rowPtr(j)[i] = (j ? 100.f * j : 2.f) + (j ? 20.f : 2.f) * std::sin(0.002f * (j + 1) * (b * kFramesPerBlock + i));
+      auto y = taps(vx, d);
+      for (size_t j = 0; j < kTaps; ++j)
+      {
+        SignalBlock yj = singles[j](vx, d.getRow(j));
+        for (int i = 0; i < kFramesPerBlock; ++i) REQUIRE(y.rowPtr(j)[i] == Approx(yj[i]).margin(1e-6f));
+      }
+    }
+  }
+}
+
+#if DO_TIME_TESTS
+namespace
+{
+
+// time for one block of each of lines delays with lengths near 1000 samples
+template<typename DELAY, typename FN>
+double timeDelays(size_t lines, FN process)
+{
+  std::vector<DELAY> delays(lines);
+  for (size_t j = 0; j < lines; ++j)
+  {
+    delays[j].setMaxDelayInSamples(2000.f);
+    if constexpr (!std::is_same_v<DELAY, PitchbendableDelay>) delays[j].setDelayInSamples(1000.f + 37.3f * j);
+  }
+  SignalBlock x(0.5f);
+  std::function<float(void)> fn = [&]() {
+    float sum = 0.f;
+    for (auto& d : delays) sum += process(d, x)[0];
+    return sum;
+  };
+  return timeIterations<float>(fn).ns;
+}
+
+}  // namespace
+
+TEST_CASE("madronalib/delays/time", "[delays][time]")
+{
+  SignalBlock varying(1000.f);
+  for (size_t lines : {1, 64})
+  {
+    std::cout << lines << " lines, ns per block:\n";
+    std::cout << "  IntegerDelay "
+              << timeDelays<IntegerDelay>(lines, [](IntegerDelay& d, const SignalBlock& x) { return d(x); })
+              << ", varying "
+              << timeDelays<IntegerDelay>(lines, [&](IntegerDelay& d, const SignalBlock& x) { return d(x, varying); })
+              << "\n";
+    std::cout << "  FractionalDelay "
+              << timeDelays<FractionalDelay>(lines, [](FractionalDelay& d, const SignalBlock& x) { return d(x); })
+              << ", varying "
+              << timeDelays<FractionalDelay>(lines,
+                                             [&](FractionalDelay& d, const SignalBlock& x) { return d(x, varying); })
+              << "\n";
+    std::cout << "  PitchbendableDelay "
+              << timeDelays<PitchbendableDelay>(
+                     lines, [&](PitchbendableDelay& d, const SignalBlock& x) { return d(x, varying); })
+              << "\n";
+    std::cout << "  Allpass<IntegerDelay> "
+              << timeDelays<Allpass<IntegerDelay>>(lines,
+                                                   [](Allpass<IntegerDelay>& d, const SignalBlock& x) { return d(x); })
+              << "\n";
+  }
+
+  // sixteen modulated taps from one MultiTapDelay, against sixteen
+  // FractionalDelays
+  constexpr size_t kTaps = 16;
+  SignalBlock x(0.5f);
+  SignalBlockArray<kTaps> delays, gains(1.f);
+  for (size_t j = 0; j < kTaps; ++j)
+    for (int i = 0; i < kFramesPerBlock; ++i) delays.rowPtr(j)[i] = 500.f + 30.f * j + 0.1f * i;
+  MultiTapDelay<kTaps> linear(2000.f);
+  MultiTapDelay<kTaps, TapInterpolation::kAllpass> allpass(2000.f);
+  std::array<FractionalDelay, kTaps> singles;
+  for (auto& f : singles) f.setMaxDelayInSamples(2000.f);
+  std::function<float(void)> linearFn = [&]() { return linear(x, delays, gains)[0]; };
+  std::function<float(void)> allpassFn = [&]() { return allpass(x, delays, gains)[0]; };
+  std::function<float(void)> singlesFn = [&]() {
+    SignalBlock sum(0.f);
+    for (size_t j = 0; j < kTaps; ++j) sum += singles[j](x, delays.getRow(j));
+    return sum[0];
+  };
+  std::cout << "16 modulated taps, ns per block: MultiTapDelay linear " << timeIterations<float>(linearFn).ns
+            << ", allpass " << timeIterations<float>(allpassFn).ns << "; 16 FractionalDelays "
+            << timeIterations<float>(singlesFn).ns << "\n";
+
+  // FDNs of each size and mixer, as a fraction of a 48 kHz block
+  const double blockNs = 1e9 * kFramesPerBlock / 48000.;
+  auto timeFDN = [&](auto& fdn, const char* name) {
+    constexpr int kSize = std::tuple_size<decltype(fdn.mFeedbackGains)>::value;
+    std::array<float, kSize> times;
+    for (int j = 0; j < kSize; ++j) times[j] = 500.f + 61.7f * j;
+    fdn.setMaxDelayInSamples(4000);
+    fdn.setDelaysInSamples(times);
+    fdn.setModulation(4.f, 1.f / 48000.f);
+    std::function<float(void)> fn = [&]() { return fdn(x).rowPtr(0)[0]; };
+    double ns = timeIterations<float>(fn).ns;
+    std::cout << "FDN<" << kSize << ", " << name << ">: " << ns << " ns per block, " << 100. * ns / blockNs
+              << "% of one core\n";
+  };
+  FDN<8> h8;
+  FDN<16> h16;
+  FDN<32> h32;
+  FDN<8, HadamardMixer> w8;
+  FDN<16, HadamardMixer> w16;
+  FDN<32, HadamardMixer> w32;
+  FDN<8, OrthogonalMixer> o8;
+  FDN<16, OrthogonalMixer> o16;
+  FDN<32, OrthogonalMixer> o32;
+  timeFDN(h8, "Householder");
+  timeFDN(h16, "Householder");
+  timeFDN(h32, "Householder");
+  timeFDN(w8, "Hadamard");
+  timeFDN(w16, "Hadamard");
+  timeFDN(w32, "Hadamard");
+  timeFDN(o8, "Orthogonal");
+  timeFDN(o16, "Orthogonal");
+  timeFDN(o32, "Orthogonal");
+
+  // the interpolation table in MLDSPDelays.h: the larger error in dB at
+  // delays of n + 0.25 and n + 0.5, and ns per block of a ModulatedDelay with
+  // a moving delay.
+  auto interpolationRow = [&](auto delay, const char* name) {
+    constexpr auto kInterp = decltype(delay)::kInterpolation;
+    auto error = [](float omega) {
+      return std::max(interpolationError<kInterp>(omega, 20.25f), interpolationError<kInterp>(omega, 20.5f));
+    };
+    SignalBlock moving;
+    for (int i = 0; i < kFramesPerBlock; ++i) moving[i] = 1000.f + 0.37f * i;
+    delay.setMaxDelayInSamples(2000.f);
+    std::function<float(void)> fn = [&]() { return delay(x, moving)[0]; };
+    std::cout << "  " << name << ": " << error(0.02f) << " dB, " << error(0.1f) << " dB, " << error(0.25f) << " dB, "
+              << timeIterations<float>(fn).ns << " ns\n";
+  };
+  std::cout << "interpolation, error at omega 0.02, 0.1, 0.25, time per block:\n";
+  interpolationRow(ModulatedDelay<TapInterpolation::kLinear>(), "linear");
+  interpolationRow(ModulatedDelay<TapInterpolation::kHermite>(), "Hermite");
+  interpolationRow(ModulatedDelay<TapInterpolation::kLagrange>(), "Lagrange");
+  interpolationRow(ModulatedDelay<TapInterpolation::kSinc>(), "sinc");
+  std::cout << "  FractionalDelay (allpass), varying: "
+            << timeDelays<FractionalDelay>(1, [](FractionalDelay& d, const SignalBlock& x) {
+                 return d(x, SignalBlock(1000.5f));
+               })
+            << " ns\n";
+}
+#endif
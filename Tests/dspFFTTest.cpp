@@ -0,0 +1,188 @@
+// madronalib: a C++ framework for DSP applications.
+// Copyright (c) 2026 Madrona Labs LLC. http://www.madronalabs.com
+// Distributed under the MIT license: http://madrona-labs.mit-license.org/
+
+// a unit test made using the Catch framework in catch.hpp / tests.cpp.
+
+#include "catch.hpp"
+#include "MLTestUtils.h"
+#include "MLDSPFFT.h"
+
+#include "ffft/FFTReal.h"
+#include "ffft/FFTRealFixLen.h"
+
+#include <cmath>
+#include <vector>
+
+#define DO_TIME_TESTS 0
+
+using namespace ml;
+using namespace testUtils;
+
+namespace
+{
+
+// a reproducible test signal with energy in every bin
+void makeSignal(float* x, size_t n)
+{
+  RandomScalarSource rand;
+  for (size_t i = 0; i < n; ++i)
+    x[i] = rand.getFloat() + 0.25f * std::sin(0.37f * i);
+}
+
+// largest absolute value of x
+float peak(const float* x, size_t n)
+{
+  float p = 0.f;
+  for (size_t i = 0; i < n; ++i) p = std::max(p, std::fabs(x[i]));
+  return p;
+}
+
+}  // namespace
+
+TEST_CASE("madronalib/fft/real", "[fft]")
+{
+  SECTION("matches a direct DFT")
+  {
+    for (size_t n : {64, 128, 256, 512})
+    {
+      fft::FloatBuffer x(n), f(n);
+      makeSignal(x.data(), n);
+      RealFFT fft(n);
+      fft.forward(x.data(), f.data());
+
+      float tolerance = 1e-5f * n;
+      for (size_t k = 0; k <= n / 2; ++k)
+      {
+        double re = 0, im = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+          double theta = 6.283185307179586 * double(i * k % n) / double(n);
+          re += x.data()[i] * std::cos(theta);
+          im -= x.data()[i] * std::sin(theta);
+        }
+        REQUIRE(f.data()[k] == Approx(re).margin(tolerance));
+        if ((k > 0) && (k < n / 2)) REQUIRE(f.data()[n / 2 + k] == Approx(-im).margin(tolerance));
+      }
+    }
+  }
+
+  SECTION("matches ffft::FFTReal")
+  {
+    // above 8192 points, FFTReal's recursive twiddles are the larger error.
+    for (size_t n = kMinFFTSize; n <= 8192; n *= 2)
+    {
+      fft::FloatBuffer x(n), f(n), g(n);
+      makeSignal(x.data(), n);
+      RealFFT fft(n);
+      ffft::FFTReal<float> reference{long(n)};
+      fft.forward(x.data(), f.data());
+      reference.do_fft(g.data(), x.data());
+
+      float maxDiff = 0.f;
+      for (size_t i = 0; i < n; ++i) maxDiff = std::max(maxDiff, std::fabs(f.data()[i] - g.data()[i]));
+      REQUIRE(maxDiff < 1e-6f * peak(g.data(), n));
+    }
+  }
+
+  SECTION("inverse of forward is scaled input")
+  {
+    for (size_t n = kMinFFTSize; n <= kMaxFFTSize; n *= 2)
+    {
+      fft::FloatBuffer x(n), f(n), y(n);
+      makeSignal(x.data(), n);
+      RealFFT fft(n);
+      fft.forward(x.data(), f.data());
+      fft.inverse(f.data(), y.data());
+
+      float maxDiff = 0.f;
+      for (size_t i = 0; i < n; ++i)
+        maxDiff = std::max(maxDiff, std::fabs(y.data()[i] / n - x.data()[i]));
+      REQUIRE(maxDiff < 1e-5f);
+    }
+  }
+
+  SECTION("signal block arrays")
+  {
+    // one 1024-point frame in as many rows as it takes
+    constexpr size_t kRows = 1024 / kFramesPerBlock;
+    SignalBlockArray<kRows> x, f, y;
+    makeSignal(x.data(), 1024);
+    RealFFT fft(1024);
+    fft.forward(x, f);
+
+    // a single cosine at bin 8 puts all its energy there
+    SignalBlockArray<kRows> c;
+    for (size_t i = 0; i < 1024; ++i) c.data()[i] = std::cos(6.283185307179586 * 8 * i / 1024);
+    fft.forward(c, f);
+    REQUIRE(f.data()[8] == Approx(512.f).margin(1e-3f));
+    REQUIRE(peak(f.data(), 8) < 1e-3f);
+    fft.inverse(f, y);
+    for (size_t i = 0; i < 1024; ++i) REQUIRE(y.data()[i] / 1024 == Approx(c.data()[i]).margin(1e-5f));
+  }
+
+  SECTION("shared tables")
+  {
+    RealFFT a(2048), b(2048);
+    REQUIRE(a.getSize() == 2048);
+    REQUIRE(fft::Tables::get(2048) == fft::Tables::get(2048));
+    REQUIRE(fft::Tables::get(2048) != fft::Tables::get(4096));
+    REQUIRE(isValidFFTSize(65536));
+    REQUIRE(!isValidFFTSize(32));
+    REQUIRE(!isValidFFTSize(96));
+  }
+}
+
+#if DO_TIME_TESTS
+
+namespace
+{
+
+template<int ORDER>
+void timeAgainstFixLen()
+{
+  constexpr size_t n = size_t(1) << ORDER;
+  fft::FloatBuffer x(n), f(n), y(n);
+  makeSignal(x.data(), n);
+  RealFFT fft(n);
+  ffft::FFTRealFixLen<ORDER> reference;
+
+  std::function<float(void)> forwardFn = [&]() {
+    fft.forward(x.data(), f.data());
+    return f.data()[1];
+  };
+  std::function<float(void)> referenceFn = [&]() {
+    reference.do_fft(f.data(), x.data());
+    return f.data()[1];
+  };
+  std::function<float(void)> roundTripFn = [&]() {
+    fft.forward(x.data(), f.data());
+    fft.inverse(f.data(), y.data());
+    return y.data()[1];
+  };
+  std::function<float(void)> referenceRoundTripFn = [&]() {
+    reference.do_fft(f.data(), x.data());
+    reference.do_ifft(f.data(), y.data());
+    return y.data()[1];
+  };
+  auto forwardTime = timeIterations<float>(forwardFn);
+  auto referenceTime = timeIterations<float>(referenceFn);
+  auto roundTripTime = timeIterations<float>(roundTripFn);
+  auto referenceRoundTripTime = timeIterations<float>(referenceRoundTripFn);
+  std::cout << "size " << n << " forward ns: RealFFT " << forwardTime.ns << ", FFTRealFixLen "
+            << referenceTime.ns << "; round trip ns: RealFFT " << roundTripTime.ns << ", FFTRealFixLen "
+            << referenceRoundTripTime.ns << "\n";
+}
+
+}  // namespace
+
+TEST_CASE("madronalib/fft/time", "[fft][time]")
+{
+  timeAgainstFixLen<6>();
+  timeAgainstFixLen<8>();
+  timeAgainstFixLen<10>();
+  timeAgainstFixLen<12>();
+  timeAgainstFixLen<14>();
+  timeAgainstFixLen<16>();
+}
+#endif
@@ -9,11 +9,15 @@
 #include "MLDSPSample.h"
 #include "MLDSPGens.h"
 #include "MLDSPFilters.h"
+#include "MLDSPBank.h"
 #include "MLDSPMath.h"
 
 #include "ffft/FFTRealFixLen.h"
 
+#define DO_TIME_TESTS 0
+
 using namespace ml;
+using namespace testUtils;
 
 
 namespace {
@@ -88,19 +92,11 @@ TEST_CASE("madronalib/filters/template", "[filters]")
     SignalBlock sineParams{0.125f};
     SignalBlock input = g1(sineParams);
     
-    // signal-rate params
-    lp1.clear();
-    // TODO SignalBlockArray ctor or construction fn
-    //SignalBlockArray<2> signalParams{kFreq, kDamp};
-    SignalBlock freq{kFreq};
-    SignalBlock damp{kDamp};
-    SignalBlockArray<2> signalParams = concatRows(freq, damp);
-    SignalBlock ref = lp1(input, signalParams);
-
-    // single Params
-    lp1.clear();
+    // single Params. The first call sets the coefficients to interpolate from.
     Lopass<float>::Params lopassParams{kFreq, kDamp};
-    REQUIRE(lp1(input, lopassParams) == ref);
+    lp1(input, lopassParams);
+    lp1.clear();
+    SignalBlock ref = lp1(input, lopassParams);
     
     // single Params from std::array
     lp1.clear();
@@ -114,6 +110,20 @@ TEST_CASE("madronalib/filters/template", "[filters]")
     // no params
     lp1.clear();
     REQUIRE(lp1(input) == ref);
+
+    // signal-rate params. The coefficients are computed with block operations,
+    // so they can differ from the scalar ones in the last bits.
+    lp1.clear();
+    // TODO SignalBlockArray ctor or construction fn
+    //SignalBlockArray<2> signalParams{kFreq, kDamp};
+    SignalBlock freq{kFreq};
+    SignalBlock damp{kDamp};
+    SignalBlockArray<2> signalParams = concatRows(freq, damp);
+    SignalBlock signalRateOut = lp1(input, signalParams);
+    for (size_t i = 0; i < kFramesPerBlock; ++i)
+    {
+      REQUIRE(signalRateOut[i] == Approx(ref[i]).margin(1e-6f));
+    }
   }
 }
 
@@ -123,16 +133,32 @@ TEST_CASE("madronalib/filters/template", "[filters]")
 
 namespace {
 
-constexpr int kFFTOrder = 6; // 2^6 = 64 = kFramesPerBlock
-constexpr int N = kFramesPerBlock;
+// 64 points at any block size, so that the bins below stay where they are.
+constexpr int kFFTOrder = 6;
+constexpr int N = 1 << kFFTOrder;
 
+// the first N samples of the filter's response to an impulse of the given
+// size, over as many blocks as that takes.
 template<typename FilterT>
-std::array<float, N / 2> getMagnitudes(FilterT& filter)
+std::array<float, N> getImpulseResponse(FilterT& filter, float size = 1.0f)
 {
+  std::array<float, N> response{};
   SignalBlock impulse{0.f};
-  impulse[0] = 1.0f;
-  
-  SignalBlock output = filter(impulse);
+  impulse[0] = size;
+  for (size_t start = 0; start < N; start += kFramesPerBlock)
+  {
+    SignalBlock output = filter(impulse);
+    impulse[0] = 0.f;
+    for (size_t t = 0; t < std::min(kFramesPerBlock, N - start); ++t)
+      response[start + t] = output[t];
+  }
+  return response;
+}
+
+template<typename FilterT>
+std::array<float, N / 2> getMagnitudes(FilterT& filter, float size = 1.0f)
+{
+  std::array<float, N> output = getImpulseResponse(filter, size);
   
   ffft::FFTRealFixLen<kFFTOrder> fft;
   std::array<float, N> fftOut{};
@@ -454,7 +480,7 @@ TEST_CASE("madronalib/filters/dcblocker", "[filters]")
     // feed constant DC and verify output decays toward zero
     SignalBlock dcInput(1.0f);
     SignalBlock output;
-    for (int i = 0; i < 200; ++i)
+    for (size_t i = 0; i < 12800 / kFramesPerBlock; ++i)
     {
       output = dc(dcInput);
     }
@@ -573,18 +599,14 @@ TEST_CASE("madronalib/filters/pink_filter_constructor", "[filters]")
 
 TEST_CASE("madronalib/filters/pink_filter_rolloff", "[filters]")
 {
-  constexpr int kFFTOrder = 6;
   ffft::FFTRealFixLen<kFFTOrder> fft;
-  constexpr int N = kFramesPerBlock;
   
   auto measureRolloff = [&](float sr) {
     PinkFilter<float> pf;
     pf.init(sr);
     
     // impulse response
-    SignalBlock impulse{0.f};
-    impulse[0] = 1.0f;
-    SignalBlock output = pf(impulse);
+    std::array<float, N> output = getImpulseResponse(pf);
     
     // FFT
     std::array<float, N> fftOut{};
@@ -713,6 +735,431 @@ TEST_CASE("madronalib/filters/constructors", "[filters]")
   }
 }
 
+// ================================================================
+// signal-rate coefficient tests
+// ================================================================
+
+namespace {
+
+// Run a filter with signal-rate params, and a copy of it that makes scalar
+// coefficients for each frame. Return the largest difference in the outputs.
+template<typename F, typename... Tags>
+float maxSignalRateError(const SignalBlockArray<F::nParams>& params, const SignalBlock& input, Tags... tags)
+{
+  F f, ref;
+  float maxError{0.f};
+  for (int b = 0; b < 4; ++b)
+  {
+    SignalBlock y = f(input, params, tags...);
+    for (size_t t = 0; t < kFramesPerBlock; ++t)
+    {
+      typename F::Params p;
+      for (size_t i = 0; i < F::nParams; ++i) p[i] = params.rowPtr(i)[t];
+      float yRef = ref.nextFrame(input[t], F::makeCoeffs(p));
+      maxError = std::max(maxError, std::fabs(y[t] - yRef));
+    }
+  }
+  return maxError;
+}
+
+}  // namespace
+
+TEST_CASE("madronalib/filters/signal_rate_coeffs", "[filters]")
+{
+  float phase{0.f};
+  SignalBlock input = makeSine(0.05f, phase);
+  SignalBlock sweep = SignalBlock(columnIndex()) * (0.4f / kFramesPerBlock) + 0.01f;
+  SignalBlock k(0.5f), A(2.0f);
+  auto svfParams = concatRows(sweep, k);
+  auto shelfParams = concatRows(sweep, k, A);
+  SignalBlockArray<1> onePoleParams = sweep;
+  SignalBlockArray<1> allpassParams = sweep * 2.0f + 0.5f;
+
+  float preciseErrors[] = {maxSignalRateError<Lopass<float>>(svfParams, input),
+    maxSignalRateError<Hipass<float>>(svfParams, input),
+    maxSignalRateError<Bandpass<float>>(svfParams, input),
+    maxSignalRateError<LoShelf<float>>(shelfParams, input),
+    maxSignalRateError<HiShelf<float>>(shelfParams, input),
+    maxSignalRateError<Bell<float>>(shelfParams, input),
+    maxSignalRateError<OnePole<float>>(onePoleParams, input),
+    maxSignalRateError<DCBlocker<float>>(onePoleParams, input),
+    maxSignalRateError<Allpass1<float>>(allpassParams, input),
+    maxSignalRateError<LadderFilter<float>>(svfParams, input)};
+  for (float e : preciseErrors) REQUIRE(e < 1e-5f);
+
+  float approxErrors[] = {maxSignalRateError<Lopass<float>>(svfParams, input, approxCoeffs),
+    maxSignalRateError<Hipass<float>>(svfParams, input, approxCoeffs),
+    maxSignalRateError<Bandpass<float>>(svfParams, input, approxCoeffs),
+    maxSignalRateError<LoShelf<float>>(shelfParams, input, approxCoeffs),
+    maxSignalRateError<HiShelf<float>>(shelfParams, input, approxCoeffs),
+    maxSignalRateError<Bell<float>>(shelfParams, input, approxCoeffs),
+    maxSignalRateError<OnePole<float>>(onePoleParams, input, approxCoeffs),
+    maxSignalRateError<DCBlocker<float>>(onePoleParams, input, approxCoeffs),
+    maxSignalRateError<Allpass1<float>>(allpassParams, input, approxCoeffs),
+    maxSignalRateError<LadderFilter<float>>(svfParams, input, approxCoeffs)};
+  // the shelves boost by A^2, which scales their coefficient errors
+  for (float e : approxErrors) REQUIRE(e < 5e-3f);
+
+  // float4 filters for banks take the same path
+  Lopass<float4> lp4;
+  SignalBlock4Array<2> svfParams4;
+  for (size_t t = 0; t < kFramesPerBlock; ++t)
+  {
+    svfParams4.rowPtr(0)[t] = float4(sweep[t]);
+    svfParams4.rowPtr(1)[t] = float4(0.5f);
+  }
+  SignalBlock4 input4;
+  for (size_t t = 0; t < kFramesPerBlock; ++t) input4[t] = float4(input[t]);
+  Lopass<float> lp1;
+  SignalBlock y1 = lp1(input, svfParams);
+  SignalBlock4 y4 = lp4(input4, svfParams4);
+  for (size_t t = 0; t < kFramesPerBlock; ++t)
+  {
+    REQUIRE(getFloat4Lane(y4[t], 3) == Approx(y1[t]).margin(1e-5f));
+  }
+}
+
+TEST_CASE("madronalib/filters/coeff_cache", "[filters]")
+{
+  float phase{0.f};
+  Lopass<float> lp1, lp2;
+  Lopass<float>::Params p{0.05f, 0.5f};
+  
+  // after the first block, the same params run the constant path
+  SignalBlock input = makeSine(0.01f, phase);
+  REQUIRE(lp1(input, p) == lp2(input, p));
+  for (int i = 0; i < 3; ++i)
+  {
+    input = makeSine(0.01f, phase);
+    REQUIRE(lp1(input, 0.05f, 0.5f) == lp2(input));
+  }
+  REQUIRE(lp1.getCoeffCacheStats().hits == 3);
+  REQUIRE(lp1.getCoeffCacheStats().misses == 1);
+  
+  // new params, or coefficients set some other way, interpolate again
+  lp1(input, 0.06f, 0.5f);
+  REQUIRE(lp1.getCoeffCacheStats().misses == 2);
+  lp1.coeffs = Lopass<float>::makeCoeffs(p);
+  lp1(input, 0.06f, 0.5f);
+  REQUIRE(lp1.getCoeffCacheStats().misses == 3);
+  lp1(input, concatRows(SignalBlock(0.07f), SignalBlock(0.5f)));
+  lp1(input, 0.06f, 0.5f);
+  REQUIRE(lp1.getCoeffCacheStats().misses == 4);
+  REQUIRE(lp1.getCoeffCacheStats().hits == 3);
+  
+  // float4 filters compare all lanes
+  Lopass<float4> lp4;
+  Lopass<float4>::Params p4{float4(0.05f, 0.05f, 0.05f, 0.06f), float4(0.5f)};
+  lp4(Block<float4>(0.f), p4);
+  lp4(Block<float4>(0.f), p4);
+  p4[0] = float4(0.05f);
+  lp4(Block<float4>(0.f), p4);
+  REQUIRE(lp4.getCoeffCacheStats().hits == 1);
+  REQUIRE(lp4.getCoeffCacheStats().misses == 2);
+  
+  // filters with cheap coefficients keep no cache, but still run the
+  // constant path while the coefficients they make are unchanged
+  LadderFilter<float> ladder1(0.1f, 0.5f), ladder2(0.1f, 0.5f);
+  for (int i = 0; i < 2; ++i)
+  {
+    input = makeSine(0.01f, phase);
+    REQUIRE(ladder1(input, 0.1f, 0.5f) == ladder2(input));
+  }
+  ladder1(input, 0.2f, 0.5f);
+  REQUIRE(ladder1.getCoeffCacheStats().hits == 2);
+  REQUIRE(ladder1.getCoeffCacheStats().misses == 1);
+}
+
+TEST_CASE("madronalib/filters/block_size", "[filters]")
+{
+  // Filters with blocks of twice the default size make the same output as the
+  // default ones over two blocks.
+  constexpr size_t kLong{kFramesPerBlock * 2};
+  float phase{0.f};
+  SignalBlock input0 = makeSine(0.03f, phase);
+  SignalBlock input1 = makeSine(0.03f, phase) + 0.5f;
+  SignalBlockOf<kLong> input(uninitialized);
+  std::copy(input0.begin(), input0.end(), input.data());
+  std::copy(input1.begin(), input1.end(), input.data() + kFramesPerBlock);
+  
+  auto requireSame = [&](const SignalBlockOf<kLong>& yLong, const SignalBlock& y0,
+                         const SignalBlock& y1) {
+    for (size_t t = 0; t < kFramesPerBlock; ++t)
+    {
+      REQUIRE(yLong[t] == Approx(y0[t]).margin(1e-6f));
+      REQUIRE(yLong[kFramesPerBlock + t] == Approx(y1[t]).margin(1e-6f));
+    }
+  };
+  
+  SECTION("constant coefficients")
+  {
+    Lopass<float> lp(0.05f, 0.5f);
+    Lopass<float, kLong> lpLong(0.05f, 0.5f);
+    SignalBlock y0 = lp(input0);
+    requireSame(lpLong(input), y0, lp(input1));
+    
+    StateSpaceFilter<Bell<float>> bell({0.1f, 0.7f, 2.f});
+    StateSpaceFilter<Bell<float, kLong>> bellLong({0.1f, 0.7f, 2.f});
+    y0 = bell(input0);
+    requireSame(bellLong(input), y0, bell(input1));
+    
+    BiquadCascade<3> bq;
+    BiquadCascade<3, kLong> bqLong;
+    for (size_t i = 0; i < 3; ++i)
+    {
+      BiquadCoeffs c = biquadFromParams<Bell<float>>({0.02f * float(i + 1), 1.f, 1.5f});
+      bq.setSection(i, c);
+      bqLong.setSection(i, c);
+    }
+    y0 = bq(input0);
+    requireSame(bqLong(input), y0, bq(input1));
+  }
+  
+  SECTION("signal-rate params")
+  {
+    SignalBlockArrayOf<2, kLong> params(uninitialized);
+    for (size_t t = 0; t < kLong; ++t)
+    {
+      params.rowPtr(0)[t] = 0.01f + 0.2f * float(t) / kLong;
+      params.rowPtr(1)[t] = 0.5f;
+    }
+    SignalBlockArray<2> params0(uninitialized), params1(uninitialized);
+    for (size_t i = 0; i < 2; ++i)
+    {
+      std::copy(params.rowPtr(i), params.rowPtr(i) + kFramesPerBlock, params0.rowPtr(i));
+      std::copy(params.rowPtr(i) + kFramesPerBlock, params.rowPtr(i) + kLong, params1.rowPtr(i));
+    }
+    Hipass<float> hp;
+    Hipass<float, kLong> hpLong;
+    SignalBlock y0 = hp(input0, params0);
+    requireSame(hpLong(input, params), y0, hp(input1, params1));
+    y0 = hp(input0, params0, approxCoeffs);
+    requireSame(hpLong(input, params, approxCoeffs), y0, hp(input1, params1, approxCoeffs));
+  }
+  
+  SECTION("banks")
+  {
+    FilterBank<Lopass, 4> bank;
+    FilterBank<Lopass, 4, kLong> bankLong;
+    bank[0].coeffs = bankLong[0].coeffs = Lopass<float4>::makeCoeffs({float4(0.05f), float4(0.5f)});
+    FilterBank<Lopass, 4>::inputType bankInput0, bankInput1;
+    FilterBank<Lopass, 4, kLong>::inputType bankInput;
+    for (size_t t = 0; t < kFramesPerBlock; ++t)
+    {
+      bankInput0[t] = float4(input0[t]);
+      bankInput1[t] = float4(input1[t]);
+      bankInput[t] = bankInput0[t];
+      bankInput[kFramesPerBlock + t] = bankInput1[t];
+    }
+    auto y0 = bank(bankInput0);
+    auto y1 = bank(bankInput1);
+    auto yLong = bankLong(bankInput);
+    for (size_t t = 0; t < kFramesPerBlock; ++t)
+    {
+      REQUIRE(getFloat4Lane(yLong[t], 1) == Approx(getFloat4Lane(y0[t], 1)).margin(1e-6f));
+      REQUIRE(getFloat4Lane(yLong[kFramesPerBlock + t], 1) ==
+              Approx(getFloat4Lane(y1[t], 1)).margin(1e-6f));
+    }
+  }
+}
+
+// ================================================================
+// state-space tests
+// ================================================================
+
+namespace {
+
+// Run a filter and a StateSpaceFilter with the same params over a few blocks
+// of a sine with a step in it. Return the largest difference in the outputs.
+template<typename F>
+float maxStateSpaceError(const typename F::Params& params)
+{
+  F f;
+  f.coeffs = F::makeCoeffs(params);
+  StateSpaceFilter<F> ss(params);
+  float phase{0.f};
+  float maxError{0.f};
+  for (int b = 0; b < 4; ++b)
+  {
+    SignalBlock input = makeSine(0.03f, phase) + (b > 0 ? 0.5f : 0.f);
+    SignalBlock y = f(input);
+    SignalBlock ySS = ss(input);
+    for (size_t t = 0; t < kFramesPerBlock; ++t)
+    {
+      maxError = std::max(maxError, std::fabs(y[t] - ySS[t]));
+    }
+  }
+  return maxError;
+}
+
+}  // namespace
+
+TEST_CASE("madronalib/filters/state_space", "[filters]")
+{
+  REQUIRE(maxStateSpaceError<Lopass<float>>({0.05f, 0.2f}) < 1e-5f);
+  REQUIRE(maxStateSpaceError<Hipass<float>>({0.05f, 0.2f}) < 1e-5f);
+  REQUIRE(maxStateSpaceError<Bandpass<float>>({0.05f, 0.2f}) < 1e-5f);
+  REQUIRE(maxStateSpaceError<LoShelf<float>>({0.1f, 0.7f, 2.f}) < 1e-5f);
+  REQUIRE(maxStateSpaceError<HiShelf<float>>({0.1f, 0.7f, 2.f}) < 1e-5f);
+  REQUIRE(maxStateSpaceError<Bell<float>>({0.1f, 0.7f, 2.f}) < 1e-5f);
+  REQUIRE(maxStateSpaceError<OnePole<float>>({0.01f}) < 1e-5f);
+  REQUIRE(maxStateSpaceError<DCBlocker<float>>({0.045f}) < 1e-5f);
+  REQUIRE(maxStateSpaceError<Allpass1<float>>({1.2f}) < 1e-5f);
+
+  // changing params between blocks keeps the state
+  Lopass<float> lp;
+  StateSpaceFilter<Lopass<float>> lpSS;
+  float phase{0.f};
+  for (int b = 0; b < 4; ++b)
+  {
+    Lopass<float>::Params p{0.02f + 0.05f * b, 0.5f};
+    lp.coeffs = Lopass<float>::makeCoeffs(p);
+    lpSS.setParams(p);
+    SignalBlock input = makeSine(0.01f, phase);
+    REQUIRE(nearlyEqual(lp(input), lpSS(input), 1e-5f));
+  }
+  lpSS.clear();
+  REQUIRE(nearlyEqual(lpSS(SignalBlock(0.f)), SignalBlock(0.f), 1e-12f));
+}
+
+#if DO_TIME_TESTS
+TEST_CASE("madronalib/filters/state_space_time", "[filters][time]")
+{
+  float phase{0.f};
+  SignalBlock input = makeSine(0.03f, phase);
+  Lopass<float>::Params p{0.05f, 0.2f};
+  Lopass<float> lp(p[0], p[1]);
+  StateSpaceFilter<Lopass<float>> lpSS(p);
+
+  std::function<SignalBlock(void)> serialFn = [&]() { return lp(input); };
+  std::function<SignalBlock(void)> stateSpaceFn = [&]() { return lpSS(input); };
+  std::function<SignalBlock(void)> setParamsFn = [&]() { lpSS.setParams(p); return lpSS(input); };
+  auto serialTime = timeIterations<SignalBlock>(serialFn);
+  auto stateSpaceTime = timeIterations<SignalBlock>(stateSpaceFn);
+  auto setParamsTime = timeIterations<SignalBlock>(setParamsFn);
+
+  std::cout << "lopass ns per block: serial " << serialTime.ns << ", state space "
+            << stateSpaceTime.ns << ", state space with new params " << setParamsTime.ns << "\n";
+}
+#endif
+
+// ================================================================
+// biquad tests
+// ================================================================
+
+template<typename T, size_t FRAMES> using TenBandEQ = BiquadCascadeFilter<T, 10, FRAMES>;
+
+TEST_CASE("madronalib/filters/biquad", "[filters]")
+{
+  // a one-section cascade matches the filter it was made from
+  auto maxError = [](auto filter, const BiquadCoeffs& c) {
+    BiquadCascade<1> bq;
+    bq.setSection(0, c);
+    float phase{0.f};
+    float e{0.f};
+    for (int b = 0; b < 4; ++b)
+    {
+      SignalBlock input = makeSine(0.03f, phase) + (b > 0 ? 0.5f : 0.f);
+      SignalBlock y = filter(input);
+      SignalBlock yBQ = bq(input);
+      for (size_t t = 0; t < kFramesPerBlock; ++t) e = std::max(e, std::fabs(y[t] - yBQ[t]));
+    }
+    return e;
+  };
+  REQUIRE(maxError(Lopass<float>(0.05f, 0.2f), biquadFromParams<Lopass<float>>({0.05f, 0.2f})) < 1e-4f);
+  REQUIRE(maxError(Hipass<float>(0.05f, 0.2f), biquadFromParams<Hipass<float>>({0.05f, 0.2f})) < 1e-4f);
+  REQUIRE(maxError(Bandpass<float>(0.05f, 0.2f), biquadFromParams<Bandpass<float>>({0.05f, 0.2f})) < 1e-4f);
+  REQUIRE(maxError(LoShelf<float>(0.1f, 0.7f, 2.f), biquadFromParams<LoShelf<float>>({0.1f, 0.7f, 2.f})) < 1e-4f);
+  REQUIRE(maxError(HiShelf<float>(0.1f, 0.7f, 2.f), biquadFromParams<HiShelf<float>>({0.1f, 0.7f, 2.f})) < 1e-4f);
+  REQUIRE(maxError(Bell<float>(0.1f, 0.7f, 2.f), biquadFromParams<Bell<float>>({0.1f, 0.7f, 2.f})) < 1e-4f);
+  REQUIRE(maxError(OnePole<float>(0.01f), biquadFromParams<OnePole<float>>({0.01f})) < 1e-4f);
+  REQUIRE(maxError(DCBlocker<float>(0.045f), biquadFromParams<DCBlocker<float>>({0.045f})) < 1e-4f);
+  
+  // a ten band EQ matches the sections run one at a time
+  constexpr size_t kBands{10};
+  BiquadCascade<kBands> eq;
+  BiquadCascadeFilter<float, kBands> serialEQ;
+  BiquadCascadeFilter<float, kBands>::Params eqParams = serialEQ.passthru();
+  for (size_t i = 0; i < kBands; ++i)
+  {
+    float omega = 0.002f * std::pow(1.8f, float(i));
+    BiquadCoeffs c = (i == 0) ? biquadFromParams<LoShelf<float>>({omega, 0.7f, 1.5f})
+                              : biquadFromParams<Bell<float>>({omega, 1.f, (i & 1) ? 1.4f : 0.7f});
+    eq.setSection(i, c);
+    serialEQ.setSection(eqParams, i, c);
+  }
+  serialEQ.coeffs = serialEQ.makeCoeffs(eqParams);
+  
+  float phase{0.f};
+  for (int b = 0; b < 4; ++b)
+  {
+    SignalBlock input = makeSine(0.011f, phase) + (b > 1 ? 0.25f : 0.f);
+    REQUIRE(nearlyEqual(eq(input), serialEQ(input), 1e-4f));
+  }
+  eq.clear();
+  REQUIRE(nearlyEqual(eq(SignalBlock(0.f)), SignalBlock(0.f), 1e-12f));
+  
+  // the float4 form in a bank matches the mono cascade in each lane
+  FilterBank<TenBandEQ, 8> eqBank;
+  std::array<FilterBank<TenBandEQ, 8>::Params, 2> bankParams;
+  for (auto& p : bankParams)
+  {
+    for (size_t i = 0; i < p.size(); ++i) p[i] = float4(eqParams[i]);
+  }
+  eqBank[0].coeffs = eqBank[1].coeffs = bankParams[0];
+  eq.clear();
+  phase = 0.f;
+  for (int b = 0; b < 4; ++b)
+  {
+    SignalBlock input = makeSine(0.011f, phase);
+    FilterBank<TenBandEQ, 8>::inputType bankInput;
+    bankInput.setRow(0, Block<float4>(0.f));
+    bankInput.setRow(1, Block<float4>(0.f));
+    for (size_t t = 0; t < kFramesPerBlock; ++t)
+    {
+      bankInput.rowPtr(0)[t] = float4(input[t]);
+      bankInput.rowPtr(1)[t] = float4(0.f, 0.f, 0.f, input[t]);
+    }
+    auto bankOutput = eqBank(bankInput, bankParams);
+    SignalBlock y = eq(input);
+    for (size_t t = 0; t < kFramesPerBlock; ++t)
+    {
+      REQUIRE(getFloat4Lane(bankOutput.rowPtr(0)[t], 0) == Approx(y[t]).margin(1e-4f));
+      REQUIRE(getFloat4Lane(bankOutput.rowPtr(1)[t], 3) == Approx(y[t]).margin(1e-4f));
+      REQUIRE(getFloat4Lane(bankOutput.rowPtr(1)[t], 0) == 0.f);
+    }
+  }
+}
+
+#if DO_TIME_TESTS
+TEST_CASE("madronalib/filters/biquad_time", "[filters][time]")
+{
+  constexpr size_t kBands{10};
+  float phase{0.f};
+  SignalBlock input = makeSine(0.03f, phase);
+  std::array<Bell<float>, kBands> bells;
+  BiquadCascade<kBands> eq;
+  for (size_t i = 0; i < kBands; ++i)
+  {
+    float omega = 0.002f * std::pow(1.8f, float(i));
+    bells[i] = Bell<float>(omega, 1.f, 1.4f);
+    eq.setSection<Bell<float>>(i, {omega, 1.f, 1.4f});
+  }
+  
+  std::function<SignalBlock(void)> chainFn = [&]() {
+    SignalBlock y = input;
+    for (auto& bell : bells) y = bell(y);
+    return y;
+  };
+  std::function<SignalBlock(void)> cascadeFn = [&]() { return eq(input); };
+  auto chainTime = timeIterations<SignalBlock>(chainFn);
+  auto cascadeTime = timeIterations<SignalBlock>(cascadeFn);
+  
+  std::cout << "ten band EQ ns per block: chained Bells " << chainTime.ns << ", BiquadCascade "
+            << cascadeTime.ns << "\n";
+}
+#endif
+
 // ================================================================
 // float4 equivalence tests
 // ================================================================
@@ -803,27 +1250,7 @@ TEST_CASE("madronalib/filters/float4", "[filters]")
 TEST_CASE("madronalib/filters/ladder", "[filters]")
 {
   // small impulse to stay in the linear region of tanh
-  auto getLadderMagnitudes = [&](LadderFilter<float>& lf) {
-    constexpr int kFFTOrder = 6;
-    ffft::FFTRealFixLen<kFFTOrder> fft;
-    
-    SignalBlock impulse{0.f};
-    impulse[0] = 0.01f;
-    
-    SignalBlock output = lf(impulse);
-    
-    std::array<float, N> fftOut{};
-    fft.do_fft(fftOut.data(), output.data());
-    
-    std::array<float, N / 2> mag{};
-    for (int i = 0; i < N / 2; ++i)
-    {
-      float re = fftOut[i];
-      float im = (i == 0) ? 0.f : fftOut[i + N / 2];
-      mag[i] = sqrtf(re * re + im * im);
-    }
-    return mag;
-  };
+  auto getLadderMagnitudes = [&](LadderFilter<float>& lf) { return getMagnitudes(lf, 0.01f); };
   
   SECTION("lowpass: DC passes, high frequencies attenuated")
   {
@@ -882,19 +1309,7 @@ TEST_CASE("madronalib/filters/ladder", "[filters]")
     svf.coeffs = Lopass<float>::makeCoeffs({0.1f, 0.5f});
     
     // scale SVF impulse the same way
-    SignalBlock impulse{0.f};
-    impulse[0] = 0.01f;
-    SignalBlock svfOut = svf(impulse);
-    ffft::FFTRealFixLen<kFFTOrder> fft;
-    std::array<float, N> fftOut{};
-    fft.do_fft(fftOut.data(), svfOut.data());
-    std::array<float, N / 2> magSVF{};
-    for (int i = 0; i < N / 2; ++i)
-    {
-      float re = fftOut[i];
-      float im = (i == 0) ? 0.f : fftOut[i + N / 2];
-      magSVF[i] = sqrtf(re * re + im * im);
-    }
+    auto magSVF = getMagnitudes(svf, 0.01f);
     
     REQUIRE(magLadder[N / 2 - 1] < magSVF[N / 2 - 1]);
   }
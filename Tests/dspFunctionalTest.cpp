@@ -3,3 +3,116 @@
 // Distributed under the MIT license: http://madrona-labs.mit-license.org/
 
 // a unit test made using the Catch framework in catch.hpp / tests.cpp.
+
+#include "catch.hpp"
+#include "MLDSPDelays.h"
+
+#include <cmath>
+#include <vector>
+
+using namespace ml;
+
+namespace
+{
+
+// Run f over blocks of the input rows and return the output rows.
+template<int IN_ROWS, int OUT_ROWS, typename ProcessFn>
+std::vector<std::vector<float>> runOverlapAdd(OverlapAddFunction<IN_ROWS, OUT_ROWS>& ola, ProcessFn fn,
+                                               const std::vector<std::vector<float>>& x)
+{
+  size_t blocks = x[0].size() / kFramesPerBlock;
+  std::vector<std::vector<float>> y(OUT_ROWS, std::vector<float>(blocks * kFramesPerBlock));
+  for (size_t b = 0; b < blocks; ++b)
+  {
+    SignalBlockArray<IN_ROWS> vx;
+    for (int j = 0; j < IN_ROWS; ++j)
+      std::copy_n(x[j].data() + b * kFramesPerBlock, kFramesPerBlock, vx.rowPtr(j));
+    auto vy = ola(fn, vx);
+    for (int j = 0; j < OUT_ROWS; ++j)
+      std::copy_n(vy.rowPtr(j), kFramesPerBlock, y[j].data() + b * kFramesPerBlock);
+  }
+  return y;
+}
+
+std::vector<float> noise(size_t n, uint32_t seed)
+{
+  RandomScalarSource rand;
+  for (uint32_t i = 0; i < seed; ++i) rand.step();
+  std::vector<float> x(n);
+  for (auto& v : x) v = rand.getFloat();
+  return x;
+}
+
+}  // namespace
+
+TEST_CASE("madronalib/functional/overlap_add", "[functional]")
+{
+  constexpr size_t kBlocks = 64;
+  constexpr size_t kLength = kBlocks * kFramesPerBlock;
+
+  SECTION("an empty spectral function passes input through, delayed by the FFT size")
+  {
+    // hops that do and do not divide the block size, with windows that
+    // are not COLA at those hops.
+    struct Setup { size_t fftSize, hop; Projection window; };
+    for (auto s : {Setup{256, 64, dspwindows::raisedCosine}, Setup{256, 96, dspwindows::hamming},
+                   Setup{512, 200, dspwindows::blackman}, Setup{64, 16, dspwindows::raisedCosine}})
+    {
+      OverlapAddFunction<1> ola(s.fftSize, s.hop, s.window);
+      REQUIRE(ola.getLatency() == s.fftSize);
+      std::vector<std::vector<float>> x{noise(kLength, 1)};
+      auto y = runOverlapAdd(ola, [](const SpectralFrames<1>&, SpectralFrames<1>&) {}, x);
+
+      // the first frame has only part of its overlaps
+      size_t start = 2 * s.fftSize;
+      float maxDiff = 0.f;
+      for (size_t t = start; t < kLength; ++t)
+        maxDiff = std::max(maxDiff, std::fabs(y[0][t] - x[0][t - s.fftSize]));
+      REQUIRE(maxDiff < 1e-4f);
+      for (size_t t = 0; t < s.fftSize; ++t) REQUIRE(y[0][t] == 0.f);
+    }
+  }
+
+  SECTION("rows in and out")
+  {
+    // sum two inputs in the frequency domain
+    OverlapAddFunction<2, 1> ola(256, 128);
+    std::vector<std::vector<float>> x{noise(kLength, 1), noise(kLength, 2)};
+    auto sumRows = [](const SpectralFrames<2>& in, SpectralFrames<1>& out) {
+      for (size_t k = 0; k < in.getNumBins(); ++k)
+      {
+        out.real(0)[k] = in.real(0)[k] + in.real(1)[k];
+        out.imag(0)[k] = in.imag(0)[k] + in.imag(1)[k];
+      }
+    };
+    auto y = runOverlapAdd(ola, sumRows, x);
+    for (size_t t = 512; t < kLength; ++t) REQUIRE(y[0][t] == Approx(x[0][t - 256] + x[1][t - 256]).margin(1e-4f));
+  }
+
+  SECTION("spectral filtering")
+  {
+    // remove the upper of two sines centered on bins 8 and 40
+    constexpr size_t kSize = 256;
+    OverlapAddFunction<1> ola(kSize, kSize / 4);
+    std::vector<std::vector<float>> x(1, std::vector<float>(kLength));
+    auto low = [&](size_t t) { return std::sin(6.2831853f * 8 * t / kSize); };
+    for (size_t t = 0; t < kLength; ++t) x[0][t] = low(t) + std::sin(6.2831853f * 40 * t / kSize);
+
+    auto lopass = [](const SpectralFrames<1>&, SpectralFrames<1>& out) {
+      for (size_t k = 20; k < out.getNumBins(); ++k) out.real(0)[k] = out.imag(0)[k] = 0.f;
+    };
+    auto y = runOverlapAdd(ola, lopass, x);
+    for (size_t t = 2 * kSize; t < kLength; ++t) REQUIRE(y[0][t] == Approx(low(t - kSize)).margin(1e-3f));
+  }
+
+  SECTION("clear")
+  {
+    OverlapAddFunction<1> ola(128, 32);
+    std::vector<std::vector<float>> x{noise(kLength, 3)};
+    auto passThru = [](const SpectralFrames<1>&, SpectralFrames<1>&) {};
+    auto y1 = runOverlapAdd(ola, passThru, x);
+    ola.clear();
+    auto y2 = runOverlapAdd(ola, passThru, x);
+    REQUIRE(y1 == y2);
+  }
+}
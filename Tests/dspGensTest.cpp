@@ -9,6 +9,9 @@
 #include "MLDSPGens.h"
 
 #include <cmath>
+#include <vector>
+
+#define DO_TIME_TESTS 0
 
 using namespace ml;
 using namespace testUtils;
@@ -54,6 +57,28 @@ TEST_CASE("madronalib/dsp/gens-template", "[template]")
     REQUIRE(g1() == ref);
     
   }
+  
+  SECTION("unchanged params")
+  {
+    // after the first block, the same params run the constant path
+    SineGen<float> g1, g2;
+    PhasorGen<float> p1, p2;
+    REQUIRE(g1(0.01f) == g2(0.01f));
+    REQUIRE(p1(0.01f) == p2(0.01f));
+    for (int i = 0; i < 3; ++i)
+    {
+      REQUIRE(g1(0.01f) == g2());
+      REQUIRE(p1(0.01f) == p2());
+    }
+    REQUIRE(g1.getCoeffCacheStats().hits == 3);
+    REQUIRE(g1.getCoeffCacheStats().misses == 1);
+    REQUIRE(p1.getCoeffCacheStats().hits == 3);
+    
+    g1(0.02f);
+    REQUIRE(g1.getCoeffCacheStats().misses == 2);
+    g1.resetCoeffCacheStats();
+    REQUIRE(g1.getCoeffCacheStats().hits == 0);
+  }
 }
 
 
@@ -128,6 +153,9 @@ TEST_CASE("madronalib/dsp/gens", "[dsp_gens]")
     Counter<float> cf; cf.clear();
     Counter<float4> cg; cg.clear();
     REQUIRE(repeatRows<4>(cf()) == verticalToHorizontal(cg()));
+
+    // the count continues across blocks
+    REQUIRE(cf()[0] == float(kFramesPerBlock));
   }
 
   SECTION("PhasorGen")
@@ -139,18 +167,31 @@ TEST_CASE("madronalib/dsp/gens", "[dsp_gens]")
     auto out = p(params);
     REQUIRE(out[0] == Approx(1.f / kFramesPerBlock));
     REQUIRE(out[kFramesPerBlock / 2 - 1] == Approx(0.5f));
+
+    // the block scan matches running nextFrame() over several blocks of changing frequency
+    PhasorGen<float> q; q.clear();
+    PhasorGen<float> r; r.clear();
+    for (int b = 0; b < 8; ++b)
+    {
+      SignalBlockArray<1> freqs(0.0123f * b + 0.001f);
+      auto y = q(freqs);
+      for (size_t t = 0; t < kFramesPerBlock; ++t)
+      {
+        REQUIRE(y[t] == Approx(r.nextFrame({freqs[t]})).margin(1e-5f));
+      }
+    }
   }
 
   SECTION("TickGen")
   {
-    // at freq = 1/8, expect exactly 8 ticks per block
+    // at freq = 1/8, expect exactly one tick per 8 frames
     TickGen<float> ticker; ticker.clear();
     SignalBlockArray<1> params(1.f / 8);
     auto out = ticker(params);
-    int ticks = 0;
+    size_t ticks = 0;
     for (size_t t = 0; t < kFramesPerBlock; ++t)
       if (out[t] > 0.5f) ticks++;
-    REQUIRE(ticks == 8);
+    REQUIRE(ticks == kFramesPerBlock / 8);
   }
 
   SECTION("NoiseGen")
@@ -206,16 +247,19 @@ TEST_CASE("madronalib/dsp/gens", "[dsp_gens]")
 
   SECTION("TestSineGen")
   {
-    // one complete cycle ends very close to 0 (higher precision than SineGen)
+    // one complete 64-sample cycle ends very close to 0 (higher precision
+    // than SineGen), and its peak amplitude is very close to 1
     TestSineGen<float> s; s.clear();
-    SignalBlockArray<1> params(1.f / kFramesPerBlock);
-    auto out = s(params);
-    REQUIRE(std::abs(out[kFramesPerBlock - 1]) < 1e-5f);
-
-    // peak amplitude very close to 1
+    SignalBlockArray<1> params(1.f / 64);
+    SignalBlock out;
     float maxVal = 0.f;
-    for (size_t t = 0; t < kFramesPerBlock; ++t)
-      maxVal = std::max(maxVal, std::abs(out[t]));
+    for (size_t b = 0; b < std::max(size_t(1), 64 / kFramesPerBlock); ++b)
+    {
+      out = s(params);
+      for (size_t t = 0; t < std::min(kFramesPerBlock, size_t(64)); ++t)
+        maxVal = std::max(maxVal, std::abs(out[t]));
+    }
+    REQUIRE(std::abs(out[63 % kFramesPerBlock]) < 1e-5f);
     REQUIRE(maxVal == Approx(1.f).margin(0.001f));
   }
 
@@ -256,3 +300,332 @@ TEST_CASE("madronalib/dsp/gens", "[dsp_gens]")
     REQUIRE(mean25 / kFramesPerBlock == Approx(0.5f).margin(0.05f));
   }
 }
+
+TEST_CASE("madronalib/dsp/gens/additive", "[dsp_gens]")
+{
+  SECTION("ramps match a reference")
+  {
+    // three partials with changing frequencies and amplitudes, against
+    // sines summed in double precision with the same linear ramps.
+    constexpr size_t kPartials = 4;
+    AdditiveBank<kPartials> bank;
+    std::array<double, kPartials> phase{}, freq{}, amp{};
+    for (int b = 0; b < 100; ++b)
+    {
+      std::array<double, kPartials> nextFreq, nextAmp;
+      for (size_t i = 0; i < kPartials - 1; ++i)
+      {
+        nextFreq[i] = 0.01 * (i + 1) * (1. + 0.1 * std::sin(0.1 * b));
+        nextAmp[i] = 0.5 + 0.4 * std::cos(0.07 * b * (i + 1));
+        bank.setPartial(i, float(nextFreq[i]), float(nextAmp[i]));
+      }
+      nextFreq[kPartials - 1] = nextAmp[kPartials - 1] = 0.;
+
+      SignalBlock y = bank();
+      for (size_t t = 0; t < kFramesPerBlock; ++t)
+      {
+        double m = double(t + 1) / kFramesPerBlock;
+        double expected = 0.;
+        for (size_t i = 0; i < kPartials; ++i)
+        {
+          phase[i] += kTwoPi * (freq[i] + m * (nextFreq[i] - freq[i]));
+          expected += (amp[i] + m * (nextAmp[i] - amp[i])) * std::sin(phase[i]);
+        }
+        REQUIRE(y[t] == Approx(expected).margin(2e-3));
+      }
+      freq = nextFreq;
+      amp = nextAmp;
+    }
+  }
+
+  SECTION("amplitude stays constant")
+  {
+    AdditiveBank<4> bank;
+    bank.setPartial(0, 0.0123f, 1.f);
+    bank();
+    float peak = 0.f;
+    for (int b = 0; b < 20000; ++b)
+    {
+      SignalBlock y = bank();
+      if (b < 19000) continue;
+      for (size_t t = 0; t < kFramesPerBlock; ++t) peak = std::max(peak, std::fabs(y[t]));
+    }
+    REQUIRE(peak == Approx(1.f).margin(1e-4f));
+  }
+
+  SECTION("partials above Nyquist are culled")
+  {
+    constexpr size_t kPartials = 256;
+    AdditiveBank<kPartials> bank;
+    for (float fundamental : {0.001f, 0.01f, 0.1f})
+    {
+      for (size_t i = 0; i < kPartials; ++i) bank.setPartial(i, fundamental * (i + 1), 1.f / (i + 1));
+      bank();
+      bank();
+      size_t audible = std::min(kPartials, size_t(std::ceil(0.5f / fundamental)) - 1);
+      REQUIRE(bank.getActivePartials() == (audible + 3) / 4 * 4);
+    }
+
+    // a partial moved above Nyquist fades out in one block.
+    AdditiveBank<4> single;
+    single.setPartial(0, 0.1f, 1.f);
+    single();
+    single.setPartial(0, 0.6f, 1.f);
+    single();
+    REQUIRE(single.getActivePartials() == 4);
+    REQUIRE(single() == SignalBlock(0.f));
+    REQUIRE(single.getActivePartials() == 0);
+  }
+
+  SECTION("quantized to a scale")
+  {
+    // with the default 12-tone scale, 445 Hz plays as 440 Hz and 430 Hz as
+    // the G# below.
+    constexpr float kSampleRate = 48000.f;
+    Scale scale;
+    REQUIRE(scale.quantizePitch(0.05f) == Approx(0.f).margin(1e-6f));
+    REQUIRE(scale.quantizePitchNearest(0.05f) == Approx(1.f / 12.f));
+    AdditiveBank<4> quantized, exact;
+    quantized.setScale(&scale, kSampleRate);
+    quantized.setPartial(0, 445.f / kSampleRate, 1.f);
+    quantized.setPartial(1, 430.f / kSampleRate, 1.f);
+    exact.setPartial(0, 440.f / kSampleRate, 1.f);
+    exact.setPartial(1, 440.f * std::pow(2.f, -1.f / 12.f) / kSampleRate, 1.f);
+    for (int b = 0; b < 8; ++b)
+    {
+      SignalBlock y = quantized(), yExact = exact();
+      for (size_t t = 0; t < kFramesPerBlock; ++t) REQUIRE(y[t] == Approx(yExact[t]).margin(1e-4f));
+    }
+  }
+}
+
+namespace
+{
+
+// the samples of a number of blocks from one lane of a generator.
+template<typename T, typename FN>
+std::vector<float> collect(FN fn, size_t blocks, int lane = 0)
+{
+  std::vector<float> y;
+  for (size_t b = 0; b < blocks; ++b)
+  {
+    auto v = fn();
+    for (size_t t = 0; t < v.kFrames; ++t)
+    {
+      if constexpr (std::is_same_v<T, float>)
+        y.push_back(v[t]);
+      else
+        y.push_back(getFloat4Lane(v[t], lane));
+    }
+  }
+  return y;
+}
+
+double correlation(const std::vector<float>& a, const std::vector<float>& b)
+{
+  double ab = 0., aa = 0., bb = 0.;
+  for (size_t i = 0; i < a.size(); ++i)
+  {
+    ab += double(a[i]) * b[i];
+    aa += double(a[i]) * a[i];
+    bb += double(b[i]) * b[i];
+  }
+  return ab / std::sqrt(aa * bb);
+}
+
+}  // namespace
+
+TEST_CASE("madronalib/dsp/gens/random", "[dsp_gens]")
+{
+  constexpr size_t kBlocks = 1000;
+
+  SECTION("reproducible")
+  {
+    RandomStream<float> a(1234, 5), b(1234, 5);
+    auto ya = collect<float>([&]() { return a.uniform(); }, 4);
+    auto yb = collect<float>([&]() { return b.uniform(); }, 4);
+    REQUIRE(ya == yb);
+
+    // seeking to a block plays it again.
+    a.setPosition(2 * kFramesPerBlock);
+    SignalBlock third = a.uniform();
+    for (size_t t = 0; t < kFramesPerBlock; ++t) REQUIRE(third[t] == ya[2 * kFramesPerBlock + t]);
+    REQUIRE(a.getPosition() == 3 * kFramesPerBlock);
+  }
+
+  SECTION("uniform")
+  {
+    RandomStream<float> r(99);
+    auto y = collect<float>([&]() { return r.uniform(); }, kBlocks);
+    double sum = 0., sumSq = 0.;
+    for (float x : y)
+    {
+      REQUIRE((x >= -1.f && x < 1.f));
+      sum += x;
+      sumSq += double(x) * x;
+    }
+    REQUIRE(sum / y.size() == Approx(0.).margin(0.01));
+    REQUIRE(sumSq / y.size() == Approx(1. / 3.).margin(0.01));
+
+    // successive samples are uncorrelated.
+    std::vector<float> next(y.begin() + 1, y.end());
+    y.pop_back();
+    REQUIRE(std::fabs(correlation(y, next)) < 0.02);
+  }
+
+  SECTION("streams are independent")
+  {
+    auto stream = [&](uint32_t seed, uint32_t id) {
+      RandomStream<float> r(seed, id);
+      return collect<float>([&]() { return r.uniform(); }, kBlocks);
+    };
+    auto y = stream(1, 0);
+    for (auto other : {stream(1, 1), stream(1, 2), stream(2, 0), stream(0, 0)})
+      REQUIRE(std::fabs(correlation(y, other)) < 0.02);
+
+    // and so are the lanes of one float4 stream.
+    for (int k = 1; k < 4; ++k)
+    {
+      RandomStream<float4> a(1), b(1);
+      auto y0 = collect<float4>([&]() { return a.uniform(); }, kBlocks, 0);
+      auto yk = collect<float4>([&]() { return b.uniform(); }, kBlocks, k);
+      REQUIRE(std::fabs(correlation(y0, yk)) < 0.02);
+    }
+  }
+
+  SECTION("float4 lanes match float streams")
+  {
+    // stream s of a float4 generator is streams 4s to 4s + 3.
+    for (int k = 0; k < 4; ++k)
+    {
+      RandomStream<float4> r4(7, 3);
+      RandomStream<float> r(7, 3 * 4 + k);
+      REQUIRE(collect<float4>([&]() { return r4.uniform(); }, 4, k) ==
+              collect<float>([&]() { return r.uniform(); }, 4));
+      REQUIRE(collect<float4>([&]() { return r4.gaussian(); }, 4, k) ==
+              collect<float>([&]() { return r.gaussian(); }, 4));
+    }
+  }
+
+  SECTION("gaussian")
+  {
+    RandomStream<float> r(42);
+    auto y = collect<float>([&]() { return r.gaussian(); }, kBlocks);
+    double m1 = 0., m2 = 0., m4 = 0.;
+    for (float x : y)
+    {
+      m1 += x;
+      m2 += double(x) * x;
+      m4 += double(x) * x * x * x;
+    }
+    m1 /= y.size();
+    m2 /= y.size();
+    m4 /= y.size();
+    REQUIRE(m1 == Approx(0.).margin(0.02));
+    REQUIRE(m2 == Approx(1.).margin(0.02));
+    REQUIRE(m4 / (m2 * m2) == Approx(3.).margin(0.1));
+  }
+
+  SECTION("pink")
+  {
+    // uniform noise from the same stream, through a PinkFilter.
+    RandomStream<float> r(3), white(3);
+    PinkFilter<float> filter(44100.f);
+    r.setSampleRate(44100.f);
+    for (int b = 0; b < 8; ++b)
+    {
+      SignalBlock expected = filter(white.uniform());
+      SignalBlock y = r.pink();
+      for (size_t t = 0; t < kFramesPerBlock; ++t) REQUIRE(y[t] == expected[t]);
+    }
+  }
+}
+
+TEST_CASE("madronalib/dsp/gens/block_size", "[dsp_gens]")
+{
+  // Gens with blocks of twice the default size make the same samples as the
+  // default ones over twice as many blocks.
+  constexpr size_t kLong{kFramesPerBlock * 2};
+
+  SineGen<float> sine(0.01f);
+  SineGen<float, kLong> sineLong(0.01f);
+  REQUIRE(collect<float>([&]() { return sineLong(0.01f); }, 4) ==
+          collect<float>([&]() { return sine(0.01f); }, 8));
+
+  TickGen<float> tick(0.03f);
+  TickGen<float, kLong> tickLong(0.03f);
+  REQUIRE(collect<float>([&]() { return tickLong(); }, 4) ==
+          collect<float>([&]() { return tick(); }, 8));
+
+  PhasorGen<float> phasor(0.01f);
+  PhasorGen<float, kLong> phasorLong(0.01f);
+  auto y = collect<float>([&]() { return phasor(0.01f); }, 8);
+  auto yLong = collect<float>([&]() { return phasorLong(0.01f); }, 4);
+  for (size_t i = 0; i < y.size(); ++i) REQUIRE(yLong[i] == Approx(y[i]).margin(1e-5f));
+
+  RandomStream<float4> noise(5);
+  RandomStream<float4, kLong> noiseLong(5);
+  REQUIRE(collect<float4>([&]() { return noiseLong.uniform(); }, 4, 2) ==
+          collect<float4>([&]() { return noise.uniform(); }, 8, 2));
+}
+
+#if DO_TIME_TESTS
+TEST_CASE("madronalib/dsp/gens/additive/time", "[dsp_gens][time]")
+{
+  // 1024 partials with amplitudes changing every block, at a low pitch where
+  // all are below Nyquist and at a pitch where a quarter are, against
+  // SineGens.
+  constexpr size_t kPartials = 1024;
+  const double blockNs = 1e9 * kFramesPerBlock / 48000.;
+  AdditiveBank<kPartials> bank;
+  int n = 0;
+  auto timeBank = [&](float fundamental, bool glide) {
+    std::function<float(void)> fn = [&]() {
+      ++n;
+      float f = glide ? fundamental * (1.f + 0.001f * (n & 15)) : fundamental;
+      for (size_t i = 0; i < kPartials; ++i) bank.setPartial(i, f * (i + 1), (1.f + 0.1f * (n & 1)) / (i + 1));
+      return bank()[0];
+    };
+    return timeIterations<float>(fn).ns;
+  };
+  for (float fundamental : {0.4f / kPartials, 1.6f / kPartials})
+  {
+    double steady = timeBank(fundamental, false), glide = timeBank(fundamental, true);
+    std::cout << "AdditiveBank<1024>, " << bank.getActivePartials() << " active: " << steady << " ns per block, "
+              << glide << " gliding (" << 100. * glide / blockNs << "% of one core)\n";
+  }
+
+  constexpr size_t kSines = 64;
+  std::vector<SineGen<float>> sines(kSines);
+  std::function<float(void)> sineFn = [&]() {
+    SignalBlock sum(0.f);
+    for (size_t i = 0; i < kSines; ++i) sum += sines[i](0.0004f * (i + 1)) * SignalBlock(1.f / (i + 1));
+    return sum[0];
+  };
+  double sineNs = timeIterations<float>(sineFn).ns;
+  std::cout << kSines << " SineGens: " << sineNs << " ns per block, " << sineNs * kPartials / kSines
+            << " for 1024\n";
+}
+
+TEST_CASE("madronalib/dsp/gens/random/time", "[dsp_gens][time]")
+{
+  // blocks of noise for 64 voices.
+  constexpr size_t kVoices = 64;
+  std::vector<NoiseGen<float4>> lcg(kVoices / 4);
+  std::vector<RandomStream<float4>> streams;
+  for (uint32_t p = 0; p < kVoices / 4; ++p) streams.emplace_back(1, p);
+
+  auto timeNoise = [&](const char* name, std::function<Block<float4>(size_t)> fn) {
+    std::function<float(void)> timed = [&]() {
+      float4 sum(0.f);
+      for (size_t p = 0; p < kVoices / 4; ++p) sum += fn(p)[0];
+      return getFloat4Lane(sum, 0);
+    };
+    std::cout << kVoices << " voices of " << name << ": " << timeIterations<float>(timed).ns << " ns per block\n";
+  };
+  timeNoise("NoiseGen", [&](size_t p) { return lcg[p](); });
+  timeNoise("RandomStream::uniform", [&](size_t p) { return streams[p].uniform(); });
+  timeNoise("RandomStream::gaussian", [&](size_t p) { return streams[p].gaussian(); });
+  timeNoise("RandomStream::pink", [&](size_t p) { return streams[p].pink(); });
+}
+#endif
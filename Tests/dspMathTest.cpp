@@ -8,6 +8,8 @@
 #include "MLDSPMath.h"
 #include "MLDSPMathApprox.h"
 
+#include <sstream>
+
 //#include <cmath>
 //#include <limits>
 
@@ -576,3 +578,112 @@ TEST_CASE("madronalib/dsp_math/special_values", "[dsp_math]")
   SECTION("setrFloat")  { REQUIRE(eq(setrFloat(1.0f, 2.0f, 3.0f, 4.0f), float4(1.0f, 2.0f, 3.0f, 4.0f))); }
   SECTION("setrInt")    { REQUIRE(eq(setrInt(1, 2, 3, 4), int4(1, 2, 3, 4))); }
 }
+
+// ================================================================
+// Wide vector backends
+// ================================================================
+
+#if defined(ML_SIMD_AVX2) || defined(ML_SIMD_AVX512)
+
+TEST_CASE("madronalib/dsp_math/float8", "[dsp_math]")
+{
+  float8 a(1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f);
+  float8 b(8.0f, 7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f);
+
+  SECTION("arithmetic")
+  {
+    REQUIRE(eq(lowHalf(a + b), float4(9.0f)));
+    REQUIRE(eq(highHalf(a + b), float4(9.0f)));
+    REQUIRE(eq(highHalf(a * b), float4(20.0f, 18.0f, 14.0f, 8.0f)));
+    REQUIRE(eq(lowHalf(multiplyAdd(a, b, float8(1.0f))), float4(9.0f, 15.0f, 19.0f, 21.0f)));
+  }
+
+  SECTION("compare and select")
+  {
+    float8 m = a > b;
+    REQUIRE(eq(lowHalf(select(a, b, m)), float4(8.0f, 7.0f, 6.0f, 5.0f)));
+    REQUIRE(eq(highHalf(select(a, b, m)), float4(5.0f, 6.0f, 7.0f, 8.0f)));
+  }
+
+  SECTION("halves and lanes")
+  {
+    float8 c = combineHalves(highHalf(a), lowHalf(a));
+    REQUIRE(getFloat8Lane(c, 0) == 5.0f);
+    REQUIRE(getFloat8Lane(c, 7) == 4.0f);
+    setFloat8Lane(c, 3, 42.0f);
+    REQUIRE(getFloat8Lane(c, 3) == 42.0f);
+  }
+
+  SECTION("horizontal")
+  {
+    REQUIRE(vecSumH(a) == 36.0f);
+    REQUIRE(vecMaxH(a) == 8.0f);
+    REQUIRE(vecMinH(a) == 1.0f);
+  }
+
+  SECTION("conversions")
+  {
+    int32x8 i = floatToIntTruncate(a * float8(1.5f));
+    REQUIRE(getFloat8Lane(intToFloat(i), 1) == 3.0f);
+    REQUIRE(getFloat8Lane(intToFloat(i), 6) == 10.0f);
+  }
+
+  SECTION("approx functions match float4")
+  {
+    float8 x(0.0f, 0.5f, 1.0f, 1.5f, -0.5f, -1.0f, 2.0f, 3.0f);
+    REQUIRE(nearlyEqual(lowHalf(sin(x)), sin(lowHalf(x))));
+    REQUIRE(nearlyEqual(highHalf(sin(x)), sin(highHalf(x))));
+    REQUIRE(nearlyEqual(highHalf(cos(x)), cos(highHalf(x))));
+    REQUIRE(nearlyEqual(highHalf(exp(x)), exp(highHalf(x))));
+    REQUIRE(nearlyEqual(lowHalf(log(a)), log(lowHalf(a))));
+  }
+}
+
+#endif
+
+#if defined(ML_SIMD_AVX512)
+
+TEST_CASE("madronalib/dsp_math/float16", "[dsp_math]")
+{
+  float8 lo(1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f);
+  float16 a = combineHalves(lo, lo + float8(8.0f));
+
+  SECTION("arithmetic")
+  {
+    float16 b = a * float16(2.0f) - float16(1.0f);
+    REQUIRE(getFloat16Lane(b, 0) == 1.0f);
+    REQUIRE(getFloat16Lane(b, 15) == 31.0f);
+    REQUIRE(getFloat16Lane(multiplyAdd(a, a, float16(1.0f)), 9) == 101.0f);
+  }
+
+  SECTION("compare and select")
+  {
+    float16 m = a >= float16(8.5f);
+    float16 s = select(float16(1.0f), float16(0.0f), m);
+    REQUIRE(vecSumH(s) == 8.0f);
+  }
+
+  SECTION("horizontal")
+  {
+    REQUIRE(vecSumH(a) == 136.0f);
+    REQUIRE(vecMaxH(a) == 16.0f);
+    REQUIRE(vecMinH(a) == 1.0f);
+  }
+
+  SECTION("approx functions match float4")
+  {
+    float16 x = a * float16(0.1f);
+    float4 x3 = lowHalf(highHalf(x));
+    REQUIRE(nearlyEqual(lowHalf(highHalf(sin(x))), sin(x3)));
+    REQUIRE(nearlyEqual(lowHalf(highHalf(exp(x))), exp(x3), 1e-4f));
+  }
+
+  SECTION("printing")
+  {
+    std::ostringstream out;
+    out << a;
+    REQUIRE(out.str() == "[1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16]");
+  }
+}
+
+#endif
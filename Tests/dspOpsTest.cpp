@@ -7,7 +7,9 @@
 #include "MLDSPOps.h"
 #include "MLDSPUtils.h"
 #include "MLDSPRouting.h"
+#include "MLDSPBuffer.h"
 #include "MLDSPGens.h"
+#include "MLDSPAnalysis.h"
 
 #include <iostream>
 #include <iomanip>
@@ -123,6 +125,7 @@ TEST_CASE("madronalib/core/dsp_ops", "[dsp_ops]")
     SignalBlock a(4.0f);
     REQUIRE(allEqual(sqrt(a), 2.0f));
     REQUIRE(nearlyEqual(sqrtApprox(a), SignalBlock(2.0f), 1e-3f));
+    REQUIRE(allEqual(sqrtApprox(SignalBlock(0.0f)), 0.0f));
     
     SignalBlock b(-3.5f);
     REQUIRE(allEqual(abs(b), 3.5f));
@@ -289,19 +292,20 @@ TEST_CASE("madronalib/core/dsp_ops", "[dsp_ops]")
   
   SECTION("horizontal operations")
   {
-    SignalBlock a = rangeClosed(0.0f, 63.0f);
+    const float n = float(kFramesPerBlock);
+    SignalBlock a = rangeClosed(0.0f, n - 1.0f);
     
     float s = sum(a);
-    REQUIRE(s == Approx(63.0f * 64.0f / 2.0f)); // Sum of 0..63
+    REQUIRE(s == Approx((n - 1.0f) * n / 2.0f)); // Sum of 0..n-1
     
     float m = mean(a);
-    REQUIRE(m == Approx(31.5f));
+    REQUIRE(m == Approx((n - 1.0f) / 2.0f));
     
     float minVal = min(a);
     REQUIRE(minVal == Approx(0.0f));
     
     float maxVal = max(a);
-    REQUIRE(maxVal == Approx(63.0f));
+    REQUIRE(maxVal == Approx(n - 1.0f));
   }
   
   SECTION("map operations")
@@ -542,6 +546,223 @@ TEST_CASE("madronalib/core/dsp_ops", "[dsp_ops]")
     }
   }
   
+  SECTION("float4 tail")
+  {
+    // 12 floats: one wide vector plus a float4 tail on AVX2, all tail on AVX-512.
+    AlignedArray<float, 12> a;
+    for (size_t i = 0; i < 12; ++i) a[i] = float(i + 1);
+    auto b = sqrt(a * a);
+    auto c = max(a, AlignedArray<float, 12>(6.0f));
+    for (size_t i = 0; i < 12; ++i) {
+      REQUIRE(b[i] == Approx(float(i + 1)));
+      REQUIRE(c[i] == std::max(float(i + 1), 6.0f));
+    }
+  }
+  
+  SECTION("expressions")
+  {
+    SignalBlock a(columnIndex());
+    SignalBlock b(2.0f);
+    SignalBlock c(rangeClosed(-1, 1));
+
+    // fused expression matches the eager named operations
+    SignalBlock fused = a * b + c * a - c / b;
+    SignalBlock eager = subtract(add(multiply(a, b), multiply(c, a)), divide(c, b));
+    for (size_t i = 0; i < kFramesPerBlock; ++i) {
+      REQUIRE(fused[i] == Approx(eager[i]).margin(1e-5f));
+    }
+
+    // scalars on either side, unary minus, temporaries as operands
+    SignalBlock s = 1.0f - (2.0f * a) / 4 + -a;
+    SignalBlock t = sqrt(a) * sqrt(a) + SignalBlock(1.0f);
+    for (size_t i = 0; i < kFramesPerBlock; ++i) {
+      REQUIRE(s[i] == Approx(1.0f - float(i) * 1.5f));
+      REQUIRE(t[i] == Approx(float(i) + 1.0f));
+    }
+
+    // an expression can be stored, indexed, compared and passed to named ops
+    auto e = a * b;
+    REQUIRE(e[3] == 6.0f);
+    REQUIRE(e == add(a, a));
+    REQUIRE(max(e) == 2.0f * (kFramesPerBlock - 1));
+    REQUIRE(eval(e) == multiply(a, b));
+    REQUIRE(min(e, b + 1.0f) == min(multiply(a, b), SignalBlock(3.0f)));
+    REQUIRE(roundFloatToInt(e) == roundFloatToInt(multiply(a, b)));
+
+    // temporaries and subexpressions are held by value, so a stored
+    // expression can use them after the statement that made it.
+    auto f = SignalBlock(1.0f) + b * 2.0f;
+    auto g = -(a + SignalBlock(2.0f)) * f;
+    for (size_t i = 0; i < kFramesPerBlock; ++i) {
+      REQUIRE(f[i] == 5.0f);
+      REQUIRE(g[i] == -5.0f * (i + 2.0f));
+    }
+
+    // compound assignment and expressions that read their destination
+    SignalBlock d(a);
+    d *= b;
+    d += a * b;
+    d = d * 0.5f + d;
+    for (size_t i = 0; i < kFramesPerBlock; ++i) {
+      REQUIRE(d[i] == 6.0f * i);
+    }
+
+    // float4 blocks with float4 and float scalars
+    SignalBlock4 v(float4(1.0f, 2.0f, 3.0f, 4.0f));
+    SignalBlock4 w = v * float4(2.0f) + 1.0f;
+    REQUIRE(eq(w[kFramesPerBlock / 4 - 1], float4(3.0f, 5.0f, 7.0f, 9.0f)));
+
+    // multiple rows keep their type
+    SignalBlockArray<3> r(1.0f);
+    SignalBlockArray<3> q = r * 3.0f + r;
+    REQUIRE(q.getRow(2) == SignalBlock(4.0f));
+
+#if DO_TIME_TESTS
+    auto fusedFn = ([&]() { return SignalBlock(a * b + c * a - c / b); });
+    auto eagerFn = ([&]() { return SignalBlock(subtract(add(multiply(a, b), multiply(c, a)), divide(c, b))); });
+    TimedResult<SignalBlock> fusedTime = timeIterations<SignalBlock>(fusedFn);
+    TimedResult<SignalBlock> eagerTime = timeIterations<SignalBlock>(eagerFn);
+    std::cout << "a * b + c * a - c / b fused: " << fusedTime.ns << ", eager: " << eagerTime.ns << " \n";
+#endif
+  }
+
+  SECTION("block sizes")
+  {
+    // blocks of other sizes work with the same operations
+    SignalBlockOf<16> a16(2.0f);
+    SignalBlockOf<256> a256(2.0f);
+    SignalBlockOf<16> b16 = a16 * a16 + 1.0f;
+    SignalBlockOf<256> b256 = sqrt(a256 * a256) - 1.0f;
+    REQUIRE(sum(b16) == 16 * 5.0f);
+    REQUIRE(sum(b256) == 256 * 1.0f);
+    REQUIRE(max(b16) == 5.0f);
+    REQUIRE(validate(b256));
+
+    // row operations keep the block size
+    SignalBlockArrayOf<3, 16> r16 = repeatRows<3>(b16);
+    REQUIRE(r16.getRow(2) == b16);
+    auto idx = frameIndex<float, 2, 256>();
+    REQUIRE(idx.row(1)[255] == 511.0f);
+
+    // vertical / horizontal round trip
+    SignalBlockArrayOf<4, 32> h;
+    for (size_t j = 0; j < 4; ++j) {
+      for (size_t i = 0; i < 32; ++i) h.row(j)[i] = float(j * 100 + i);
+    }
+    auto v = horizontalToVertical<1, 32>(h);
+    REQUIRE(eq(v.constRow(0)[5], float4(5.0f, 105.0f, 205.0f, 305.0f)));
+    REQUIRE(verticalToHorizontal(v) == h);
+
+    // DSPBuffer reads and writes blocks of any size
+    DSPBuffer buf;
+    buf.resize(512);
+    SignalBlockOf<128> ramp;
+    for (size_t i = 0; i < 128; ++i) ramp[i] = float(i);
+    buf.write(ramp);
+    auto first = buf.read<16>();
+    REQUIRE(first[15] == 15.0f);
+    SignalBlockOf<32> next;
+    next = buf.read<32>();
+    REQUIRE(next[0] == 16.0f);
+
+#if DO_TIME_TESTS
+    // per-frame cost of a short expression at the smallest and largest sizes
+    SignalBlockOf<16> c16(0.5f);
+    SignalBlockOf<256> c256(0.5f);
+    auto fn16 = ([&]() { return SignalBlockOf<16>(a16 * c16 + sin(a16)); });
+    auto fn256 = ([&]() { return SignalBlockOf<256>(a256 * c256 + sin(a256)); });
+    TimedResult<SignalBlockOf<16>> time16 = timeIterations<SignalBlockOf<16>>(fn16);
+    TimedResult<SignalBlockOf<256>> time256 = timeIterations<SignalBlockOf<256>>(fn256);
+    std::cout << "ns per frame, 16 frames: " << time16.ns / 16 << ", 256 frames: " << time256.ns / 256
+              << " \n";
+#endif
+  }
+
+  SECTION("scans")
+  {
+    // compare each scan over two blocks with the serial loop it replaces
+    SignalBlock x(uninitialized);
+    for (size_t i = 0; i < kFramesPerBlock; ++i) x[i] = 0.01f * ((i * 7) % 13) - 0.03f;
+    SignalBlock dx = x * 0.5f + 0.05f;
+    const float a = 0.99f;
+    float inc{1.f}, exc{1.f}, leaky{1.f}, wrap{0.5f}, diff{0.f};
+    float incRef{1.f}, excRef{1.f}, leakyRef{1.f}, wrapRef{0.5f}, diffRef{0.f};
+    for (int b = 0; b < 2; ++b)
+    {
+      auto yInc = inclusiveScan(x, inc);
+      auto yExc = exclusiveScan(x, exc);
+      auto yLeaky = leakyScan(x, a, leaky);
+      auto yWrap = wrappingScan(dx, wrap);
+      auto yDiff = differences(x, diff);
+      for (size_t i = 0; i < kFramesPerBlock; ++i) {
+        REQUIRE(yExc[i] == Approx(excRef).margin(1e-5f));
+        excRef += x[i];
+        incRef += x[i];
+        REQUIRE(yInc[i] == Approx(incRef).margin(1e-5f));
+        leakyRef = a * leakyRef + x[i];
+        REQUIRE(yLeaky[i] == Approx(leakyRef).margin(1e-5f));
+        wrapRef = fracPart(wrapRef + dx[i]);
+        REQUIRE(yWrap[i] == Approx(wrapRef).margin(1e-5f));
+        REQUIRE(yDiff[i] == Approx(x[i] - diffRef).margin(1e-6f));
+        diffRef = x[i];
+      }
+    }
+    REQUIRE(inc == Approx(incRef).margin(1e-5f));
+    REQUIRE(exc == Approx(excRef).margin(1e-5f));
+    REQUIRE(leaky == Approx(leakyRef).margin(1e-5f));
+    REQUIRE(diff == diffRef);
+
+    // float4 blocks scan each lane separately
+    SignalBlock4 v(float4(1.f, 2.f, 3.f, 4.f));
+    float4 c4(0.f);
+    auto y4 = inclusiveScan(v, c4);
+    REQUIRE(eq(y4[kFramesPerBlock - 1], float4(1.f, 2.f, 3.f, 4.f) * float(kFramesPerBlock)));
+
+    // the differentiator undoes the integrator
+    Integrator integrate;
+    Differentiator differentiate;
+    for (int b = 0; b < 2; ++b) {
+      auto y = differentiate(integrate(x));
+      for (size_t i = 0; i < kFramesPerBlock; ++i) {
+        REQUIRE(y[i] == Approx(x[i]).margin(1e-5f));
+      }
+    }
+
+#if DO_TIME_TESTS
+    auto serialFn = ([&]() {
+      SignalBlock y(uninitialized);
+      for (size_t n = 0; n < kFramesPerBlock; ++n) {
+        leakyRef = a * leakyRef + x[n];
+        y[n] = leakyRef;
+      }
+      return y;
+    });
+    auto scanFn = ([&]() { return SignalBlock(leakyScan(x, a, leaky)); });
+    TimedResult<SignalBlock> serialTime = timeIterations<SignalBlock>(serialFn);
+    TimedResult<SignalBlock> scanTime = timeIterations<SignalBlock>(scanFn);
+    std::cout << "leaky integrator serial: " << serialTime.ns << ", scan: " << scanTime.ns << " \n";
+#endif
+  }
+  
+  SECTION("uninitialized")
+  {
+    // uninitialized blocks hold signalling NaNs in poison builds, otherwise anything
+    auto valid = [](const SignalBlockArray<2>& x) { return validate(x.getRow(0)) && validate(x.getRow(1)); };
+    SignalBlockArray<2> u(uninitialized);
+#if defined(ML_POISON_UNINITIALIZED_BLOCKS)
+    REQUIRE(!validate(u.getRow(0)));
+    REQUIRE(!validate(u.getRow(1)));
+#endif
+
+    // ops writing into uninitialized results must write every element
+    SignalBlockArray<2> a(rowIndex<2>() + 1.0f);
+    REQUIRE(valid(sqrt(a)));
+    REQUIRE(valid(rotateLeft(a) + rotateRight(a)));
+    REQUIRE(valid(concatRows(evenRows(a), oddRows(a))));
+    REQUIRE(valid(separateRows<0, 2>(verticalToHorizontal(horizontalToVertical<1>(repeatRows<2>(a))))));
+    REQUIRE(validate(unsignedIntToFloat(roundFloatToInt(a.getRow(1)))));
+  }
+  
   SECTION("validate")
   {
     SignalBlock good(1.0f);
@@ -684,3 +905,73 @@ TEST_CASE("madronalib/core/dsp_ops", "[dsp_ops]")
 }
 
 
+
+TEST_CASE("madronalib/core/dsp_ops/dispatch", "[dsp_ops]")
+{
+  SIMDInstructionSet isa = getSIMDInstructionSet();
+#if DO_TIME_TESTS
+  std::cout << "DSP kernels: " << getSIMDInstructionSetName(isa) << "\n";
+#endif
+  REQUIRE(isSIMDInstructionSetSupported(isa));
+  
+#if defined(ML_SIMD_DISPATCH)
+  // every supported instruction set should match the baseline
+  auto x = rangeClosed(-4.0f, 4.0f);
+  auto y = rangeClosed(0.1f, 2.0f);
+  SignalBlock4Array<2> v(columnToFloat4Fn);
+  v = v * SignalBlock4Array<2>(float4(1.0f, 10.0f, 100.0f, 1000.0f));
+  
+  auto compute = [&]() {
+    auto sc = sincos(x);
+    SignalBlock4Array<2> t = v;
+    transposeRows(t);
+    return std::make_tuple(sin(x), exp(x), log(y), pow(y, x), clamp(x, y, y + SignalBlock(1.0f)),
+                           multiply1(repeatRows<2>(x), y), roundFloatToInt(x * SignalBlock(10.0f)),
+                           sc.first, sc.second, verticalToHorizontal(v), t);
+  };
+  
+  auto relativeNearlyEqual = [](const auto& a, const auto& b) {
+    for (size_t i = 0; i < size_t(a.end() - a.begin()); ++i) {
+      float d = std::fabs(a[i] - b[i]);
+      if (d > 1e-6f * std::max(1.0f, std::fabs(a[i]))) return false;
+    }
+    return true;
+  };
+  
+  const bool isNEON = (isa == SIMDInstructionSet::kNEON);
+  const SIMDInstructionSet baseline = isNEON ? SIMDInstructionSet::kNEON : SIMDInstructionSet::kSSE41;
+  REQUIRE_FALSE(setSIMDInstructionSet(isNEON ? SIMDInstructionSet::kSSE41 : SIMDInstructionSet::kNEON));
+  REQUIRE(setSIMDInstructionSet(baseline));
+  REQUIRE(getSIMDInstructionSet() == baseline);
+  auto expected = compute();
+  
+  // the baseline transpose should match transposing each 4x4 block directly
+  SignalBlock4Array<2> t = v;
+  for (size_t i = 0; i < 2 * kFramesPerBlock / 4; ++i) {
+    transpose4x4InPlace(t.data() + i * 4);
+  }
+  REQUIRE(std::get<10>(expected) == t);
+  REQUIRE(horizontalToVertical<2>(std::get<9>(expected)) == v);
+  
+  for (auto other : {SIMDInstructionSet::kAVX2, SIMDInstructionSet::kAVX512}) {
+    if (!setSIMDInstructionSet(other)) continue;
+    auto actual = compute();
+    REQUIRE(relativeNearlyEqual(std::get<0>(actual), std::get<0>(expected)));
+    REQUIRE(relativeNearlyEqual(std::get<1>(actual), std::get<1>(expected)));
+    REQUIRE(relativeNearlyEqual(std::get<2>(actual), std::get<2>(expected)));
+    REQUIRE(relativeNearlyEqual(std::get<3>(actual), std::get<3>(expected)));
+    REQUIRE(std::get<4>(actual) == std::get<4>(expected));
+    REQUIRE(std::get<5>(actual) == std::get<5>(expected));
+    REQUIRE(std::get<6>(actual) == std::get<6>(expected));
+    REQUIRE(relativeNearlyEqual(std::get<7>(actual), std::get<7>(expected)));
+    REQUIRE(relativeNearlyEqual(std::get<8>(actual), std::get<8>(expected)));
+    REQUIRE(std::get<9>(actual) == std::get<9>(expected));
+    REQUIRE(std::get<10>(actual) == std::get<10>(expected));
+    REQUIRE(horizontalToVertical<2>(std::get<9>(actual)) == v);
+  }
+  
+  REQUIRE(setSIMDInstructionSet(isa));
+#else
+  REQUIRE_FALSE(setSIMDInstructionSet(isa));
+#endif
+}
@@ -6,6 +6,8 @@
 #include "MLDSPResampling.h"
 #include "MLTestUtils.h"
 
+#define DO_TIME_TESTS 0
+
 // a unit test made using the Catch framework in catch.hpp / tests.cpp.
 using namespace ml;
 
@@ -140,21 +142,25 @@ TEST_CASE("madronalib/resampling/roundtrip_low_freq", "[resampling]")
   float phaseRef = 0.f;
   
   // run blocks to settle
-  for (int i = 0; i < 30; ++i) {
+  for (size_t i = 0; i < 1920 / kFramesPerBlock; ++i) {
     SignalBlock input = makeSine(0.01f, phaseIn);
     auto [first, second] = up(input);
     down(first, second);
   }
   
-  // now compare a settled block
-  SignalBlock input = makeSine(0.01f, phaseIn);
-  auto [first, second] = up(input);
-  SignalBlock result = down(first, second);
+  // now compare at least 64 settled samples
+  float inPower = 0.f, outPower = 0.f;
+  const size_t blocks = std::max(size_t(1), 64 / kFramesPerBlock);
+  for (size_t i = 0; i < blocks; ++i) {
+    SignalBlock input = makeSine(0.01f, phaseIn);
+    auto [first, second] = up(input);
+    SignalBlock result = down(first, second);
+    inPower += rms(input) * rms(input);
+    outPower += rms(result) * rms(result);
+  }
   
   // the roundtrip signal should have similar RMS (passband, ~unity gain)
-  float inRMS = rms(input);
-  float outRMS = rms(result);
-  float gainError = std::fabs(outRMS / inRMS - 1.0f);
+  float gainError = std::fabs(sqrtf(outPower / inPower) - 1.0f);
   REQUIRE(gainError < 0.05f);
 }
 
@@ -356,3 +362,291 @@ TEST_CASE("madronalib/resampling/multioct_roundtrip_dc", "[resampling]")
     REQUIRE(nearlyEqual(r2, dc, 0.02f));
   }
 }
+
+// ================================================================
+// UpsampleNxFunction
+// ================================================================
+
+namespace {
+
+// a soft clipper, so that the oversampled process does something nonlinear
+template<size_t ROWS>
+SignalBlockArray<ROWS> softClip(const SignalBlockArray<ROWS>& x) {
+  SignalBlockArray<ROWS> y(uninitialized);
+  for (size_t i = 0; i < ROWS * kFramesPerBlock; ++i) y.data()[i] = x.data()[i] / (1.f + std::fabs(x.data()[i]));
+  return y;
+}
+
+// largest difference between the output of an identity process and the input
+// delayed by the reported group delay, for a low sine.
+template<int OCTAVES>
+float delayedSineError() {
+  UpsampleNxFunction<float, OCTAVES, 1> f;
+  auto identity = [](const SignalBlock& x) { return x; };
+  const float omega = 0.005f;
+  const float delay = f.getGroupDelay();
+  float e = 0.f;
+  for (int b = 0; b < 20; ++b) {
+    SignalBlock x;
+    for (int i = 0; i < kFramesPerBlock; ++i) x[i] = sinf(kTwoPi * omega * (b * kFramesPerBlock + i));
+    SignalBlock y = f(identity, x);
+    if (b < 4) continue;
+    for (int i = 0; i < kFramesPerBlock; ++i) {
+      float expected = sinf(kTwoPi * omega * (b * kFramesPerBlock + i - delay));
+      e = std::max(e, std::fabs(y[i] - expected));
+    }
+  }
+  return e;
+}
+
+}
+
+TEST_CASE("madronalib/resampling/upsample_nx_delay", "[resampling]")
+{
+  // the reported delay lines a low sine up to within the filter ripple
+  REQUIRE(delayedSineError<1>() < 2e-3f);
+  REQUIRE(delayedSineError<2>() < 2e-3f);
+  REQUIRE(delayedSineError<3>() < 2e-3f);
+  REQUIRE(UpsampleNxFunction<float, 2, 1>::getGroupDelay() > UpsampleNxFunction<float, 1, 1>::getGroupDelay());
+}
+
+TEST_CASE("madronalib/resampling/upsample_nx_matches_2x", "[resampling]")
+{
+  // one octave is the same filtering as Upsample2xFunction
+  UpsampleNxFunction<float, 1, 1> nx;
+  Upsample2xFunction<float, 1> twoX;
+  float phase = 0.f;
+  for (int b = 0; b < 8; ++b) {
+    SignalBlock x = makeSine(0.05f, phase) * 2.f;
+    SignalBlock a = nx(softClip<1>, x);
+    SignalBlock c = twoX(softClip<1>, x);
+    REQUIRE(nearlyEqual(a, c, 1e-6f));
+  }
+}
+
+TEST_CASE("madronalib/resampling/upsample_nx_packed_rows", "[resampling]")
+{
+  // six rows, four packed into float4 lanes and two left over, match six
+  // single rows. Rows of float4 match too.
+  constexpr int kRows = 6;
+  UpsampleNxFunction<float, 2, kRows> packed;
+  std::array<UpsampleNxFunction<float, 2, 1>, kRows> singles;
+  UpsampleNxFunction<float4, 2, 1> lanes;
+  std::function<SignalBlock4(const SignalBlock4&)> clip4 = [](const SignalBlock4& x) {
+    SignalBlock4 y(uninitialized);
+    for (int i = 0; i < kFramesPerBlock; ++i) y[i] = x[i] / (float4(1.f) + andNotBits(float4(-0.f), x[i]));
+    return y;
+  };
+
+  for (int b = 0; b < 8; ++b) {
+    SignalBlockArray<kRows> x;
+    SignalBlock4 x4;
+    for (int j = 0; j < kRows; ++j) {
+      for (int i = 0; i < kFramesPerBlock; ++i) {
+        x.rowPtr(j)[i] = 3.f * sinf(kTwoPi * 0.01f * (j + 1) * (b * kFramesPerBlock + i));
+        if (j < 4) setFloat4Lane(x4[i], j, x.rowPtr(j)[i]);
+      }
+    }
+    auto y = packed(softClip<kRows>, x);
+    auto y4 = lanes(clip4, x4);
+    for (int j = 0; j < kRows; ++j) {
+      SignalBlock yj = singles[j](softClip<1>, x.getRow(j));
+      REQUIRE(nearlyEqual(y.getRow(j), yj, 1e-6f));
+      for (int i = 0; (j < 4) && (i < kFramesPerBlock); ++i)
+        REQUIRE(getFloat4Lane(y4[i], j) == Approx(yj[i]).margin(1e-6f));
+    }
+  }
+}
+
+// ================================================================
+// PolyphaseResampler
+// ================================================================
+
+namespace {
+
+std::vector<float> sineAtRate(double freq, double rate, size_t n) {
+  std::vector<float> x(n);
+  for (size_t i = 0; i < n; ++i) x[i] = float(std::sin(kTwoPi * freq * i / rate));
+  return x;
+}
+
+// resample all of x in one call, with room for all the output
+std::vector<float> resampleAll(PolyphaseResampler<float>& r, const std::vector<float>& x, double ratio) {
+  std::vector<float> y(size_t(x.size() * ratio) + 16);
+  auto result = r(x.data(), x.size(), y.data(), y.size());
+  REQUIRE(result.inputUsed == x.size());
+  y.resize(result.outputWritten);
+  return y;
+}
+
+// largest difference from a sine at the output rate, skipping the startup
+// and the end where the filter runs out of input
+float sineError(const std::vector<float>& y, double freq, double outRate, size_t margin) {
+  float e = 0.f;
+  for (size_t n = margin; n + margin < y.size(); ++n)
+    e = std::max(e, std::fabs(y[n] - float(std::sin(kTwoPi * freq * n / outRate))));
+  return e;
+}
+
+}
+
+TEST_CASE("madronalib/resampling/polyphase_rates", "[resampling]")
+{
+  struct Rates { int in, out; };
+  for (auto rates : {Rates{44100, 48000}, Rates{48000, 44100}, Rates{96000, 48000},
+                     Rates{96000, 44100}, Rates{44100, 96000}}) {
+    PolyphaseResampler<float> r(rates.in, rates.out);
+    REQUIRE(!r.isVariable());
+    double ratio = double(rates.out) / rates.in;
+    auto y = resampleAll(r, sineAtRate(1000., rates.in, 8192), ratio);
+    // the last half window of input is still waiting for more
+    REQUIRE(y.size() >= size_t((8192 - r.getTaps()) * ratio));
+    REQUIRE(sineError(y, 1000., rates.out, r.getTaps()) < 1e-4f);
+  }
+}
+
+TEST_CASE("madronalib/resampling/polyphase_stopband", "[resampling]")
+{
+  // a sine above the output Nyquist frequency is removed when going down
+  for (auto quality : {resamplerQuality::kNormal, resamplerQuality::kHigh}) {
+    PolyphaseResampler<float> r(48000, 44100, quality);
+    auto y = resampleAll(r, sineAtRate(23000., 48000, 16384), 44100. / 48000);
+    float peak = 0.f;
+    for (size_t n = r.getTaps(); n < y.size(); ++n) peak = std::max(peak, std::fabs(y[n]));
+    REQUIRE(peak < 1e-4f);
+  }
+}
+
+TEST_CASE("madronalib/resampling/polyphase_streaming", "[resampling]")
+{
+  // uneven input and output counts give the same output as one big call,
+  // once the output that was waiting for room has been read
+  auto x = sineAtRate(3000., 44100, 10000);
+  PolyphaseResampler<float> whole(44100, 48000);
+  auto expected = resampleAll(whole, x, 48000. / 44100);
+
+  PolyphaseResampler<float> streaming(44100, 48000);
+  std::vector<float> y;
+  std::vector<float> out(100);
+  size_t inPos = 0;
+  RandomScalarSource rand;
+  size_t written = 1;
+  while (inPos < x.size() || written > 0) {
+    size_t inCount = std::min(x.size() - inPos, size_t(1 + (rand.getUInt32() % 200)));
+    size_t outCount = 1 + rand.getUInt32() % 100;
+    auto result = streaming(x.data() + inPos, inCount, out.data(), outCount);
+    inPos += result.inputUsed;
+    written = result.outputWritten;
+    y.insert(y.end(), out.begin(), out.begin() + written);
+  }
+  REQUIRE(y.size() == expected.size());
+  REQUIRE(y == expected);
+}
+
+TEST_CASE("madronalib/resampling/polyphase_float4", "[resampling]")
+{
+  // four channels in float4 lanes match four mono resamplers
+  constexpr size_t kFrames = 2048;
+  std::array<std::vector<float>, 4> x;
+  std::vector<float4> x4(kFrames);
+  for (int c = 0; c < 4; ++c) {
+    x[c] = sineAtRate(500. * (c + 1), 44100, kFrames);
+    for (size_t i = 0; i < kFrames; ++i) setFloat4Lane(x4[i], c, x[c][i]);
+  }
+  PolyphaseResampler<float4> r4(44100, 48000);
+  std::vector<float4> y4(kFrames * 2);
+  auto result = r4(x4.data(), kFrames, y4.data(), y4.size());
+  for (int c = 0; c < 4; ++c) {
+    PolyphaseResampler<float> r(44100, 48000);
+    auto y = resampleAll(r, x[c], 48000. / 44100);
+    REQUIRE(y.size() == result.outputWritten);
+    for (size_t n = 0; n < y.size(); ++n) REQUIRE(getFloat4Lane(y4[n], c) == Approx(y[n]).margin(1e-6f));
+  }
+}
+
+TEST_CASE("madronalib/resampling/polyphase_variable", "[resampling]")
+{
+  auto x = sineAtRate(1000., 44100, 16384);
+
+  SECTION("variable mode at the nominal ratio")
+  {
+    PolyphaseResampler<float> r(44100, 48000);
+    r.setRatio(48000. / 44100);
+    REQUIRE(r.isVariable());
+    auto y = resampleAll(r, x, 48000. / 44100);
+    REQUIRE(sineError(y, 1000., 48000, r.getTaps()) < 1e-4f);
+  }
+
+  SECTION("drift correction")
+  {
+    // the output clock is 0.1% fast
+    double ratio = 48000. * 1.001 / 44100;
+    PolyphaseResampler<float> r(44100, 48000);
+    r.setRatio(ratio);
+    auto y = resampleAll(r, x, ratio);
+    REQUIRE(sineError(y, 1000., 48000. * 1.001, r.getTaps()) < 1e-4f);
+  }
+
+  SECTION("rates with no small common ratio")
+  {
+    PolyphaseResampler<float> r(44100, 47999);
+    REQUIRE(r.isVariable());
+    auto y = resampleAll(r, x, 47999. / 44100);
+    REQUIRE(sineError(y, 1000., 47999, r.getTaps()) < 1e-4f);
+  }
+}
+
+TEST_CASE("madronalib/resampling/polyphase_tables", "[resampling]")
+{
+  PolyphaseResampler<float> a(44100, 48000), b(44100, 48000);
+  PolyphaseResampler<float4> c(44100, 48000);
+  PolyphaseResampler<float> d(44100, 48000, resamplerQuality::kDraft);
+  REQUIRE(a.getTable() == b.getTable());
+  REQUIRE(a.getTable() == c.getTable());
+  REQUIRE(a.getTable() != d.getTable());
+}
+
+#if DO_TIME_TESTS
+TEST_CASE("madronalib/resampling/upsample_nx_time", "[resampling][time]")
+{
+  // 4x oversampling of eight rows: the packed cascade, against two nested
+  // Upsample2xFunctions for each row
+  constexpr int kRows = 8;
+  UpsampleNxFunction<float, 2, kRows> nx;
+  std::array<Upsample2xFunction<float, 1>, kRows> outer, inner;
+  SignalBlockArray<kRows> x(0.5f);
+  std::function<SignalBlockArray<kRows>(void)> nxFn = [&]() { return nx(softClip<kRows>, x); };
+  std::function<SignalBlockArray<kRows>(void)> nestedFn = [&]() {
+    SignalBlockArray<kRows> y(uninitialized);
+    for (int j = 0; j < kRows; ++j) {
+      auto innerFn = [&](const SignalBlock& x2) { return inner[j](softClip<1>, x2); };
+      y.setRow(j, outer[j](innerFn, x.getRow(j)));
+    }
+    return y;
+  };
+  auto nxTime = testUtils::timeIterations<SignalBlockArray<kRows>>(nxFn);
+  auto nestedTime = testUtils::timeIterations<SignalBlockArray<kRows>>(nestedFn);
+  std::cout << "4x, 8 rows: UpsampleNxFunction " << nxTime.ns << " ns, nested 2x " << nestedTime.ns << " ns\n";
+}
+
+TEST_CASE("madronalib/resampling/polyphase_time", "[resampling][time]")
+{
+  // time to convert a block of 44.1k input to 48k, for each quality and type
+  auto x = sineAtRate(1000., 44100, kFramesPerBlock);
+  std::vector<float4> x4(kFramesPerBlock, float4(0.5f));
+  std::vector<float> y(kFramesPerBlock * 2);
+  std::vector<float4> y4(kFramesPerBlock * 2);
+  for (auto quality : {resamplerQuality::kDraft, resamplerQuality::kNormal, resamplerQuality::kHigh}) {
+    PolyphaseResampler<float> r(44100, 48000, quality);
+    PolyphaseResampler<float4> r4(44100, 48000, quality);
+    std::function<float(void)> fn = [&]() { r(x.data(), x.size(), y.data(), y.size()); return y[0]; };
+    std::function<float(void)> fn4 = [&]() {
+      r4(x4.data(), x4.size(), y4.data(), y4.size());
+      return getFloat4Lane(y4[0], 0);
+    };
+    auto t = testUtils::timeIterations<float>(fn);
+    auto t4 = testUtils::timeIterations<float>(fn4);
+    std::cout << quality.taps << " taps: float " << t.ns << " ns, float4 " << t4.ns << " ns per block\n";
+  }
+}
+#endif
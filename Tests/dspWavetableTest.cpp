@@ -0,0 +1,242 @@
+// madronalib: a C++ framework for DSP applications.
+// Copyright (c) 2026 Madrona Labs LLC. http://www.madronalabs.com
+// Distributed under the MIT license: http://madrona-labs.mit-license.org/
+
+// a unit test made using the Catch framework in catch.hpp / tests.cpp.
+
+#include "catch.hpp"
+#include "MLTestUtils.h"
+#include "MLDSPWavetable.h"
+#include "MLDSPBank.h"
+
+#include <cmath>
+#include <vector>
+
+#define DO_TIME_TESTS 0
+
+using namespace ml;
+using namespace testUtils;
+
+namespace
+{
+
+// frames of frameSize samples each, fading from a sine to a naive saw.
+std::vector<float> sineToSaw(size_t frameSize, size_t numFrames)
+{
+  std::vector<float> x(frameSize * numFrames);
+  for (size_t f = 0; f < numFrames; ++f)
+  {
+    float mix = (numFrames > 1) ? float(f) / (numFrames - 1) : 0.f;
+    for (size_t i = 0; i < frameSize; ++i)
+    {
+      float phase = float(i) / frameSize;
+      float sine = std::sin(kTwoPi * phase);
+      float saw = 2.f * fracPart(phase + 0.5f) - 1.f;
+      x[f * frameSize + i] = sine + mix * (saw - sine);
+    }
+  }
+  return x;
+}
+
+template<typename GEN>
+std::vector<float> run(GEN& gen, float freq, float position, size_t blocks)
+{
+  std::vector<float> y;
+  for (size_t b = 0; b < blocks; ++b)
+  {
+    SignalBlock v = gen(freq, position);
+    y.insert(y.end(), v.begin(), v.end());
+  }
+  return y;
+}
+
+}  // namespace
+
+TEST_CASE("madronalib/wavetable/tables", "[wavetable]")
+{
+  auto frames = sineToSaw(256, 2);
+  Wavetable table(frames.data(), 256, 2);
+  REQUIRE(table.getNumFrames() == 2);
+
+  SECTION("sine frame, interpolated to the table size")
+  {
+    for (size_t level = 0; level < Wavetable::kLevels; ++level)
+    {
+      const float* t = table.getTable(level, 0);
+      for (size_t i = 0; i <= Wavetable::kTableSize; ++i)
+        REQUIRE(t[i] == Approx(std::sin(kTwoPi * float(i) / Wavetable::kTableSize)).margin(1e-5f));
+    }
+  }
+
+  SECTION("levels are band-limited")
+  {
+    constexpr size_t kSize = Wavetable::kTableSize;
+    RealFFT fft(kSize);
+    fft::FloatBuffer x(kSize), spectrum(kSize);
+    for (size_t level = 0; level < Wavetable::kLevels; ++level)
+    {
+      const float* t = table.getTable(level, 1);
+      std::copy(t, t + kSize, x.data());
+      fft.forward(x.data(), spectrum.data());
+      const float* re = spectrum.data();
+      const float* im = re + kSize / 2;
+      size_t harmonics = (kSize / 2) >> level;
+      for (size_t k = 1; k < kSize / 2; ++k)
+      {
+        float magnitude = std::hypot(re[k], im[k]) / (kSize / 2);
+        if (k > std::min(harmonics, size_t(127)))
+          REQUIRE(magnitude < 1e-5f);
+        else
+          REQUIRE(magnitude > 1e-3f);
+      }
+    }
+  }
+}
+
+TEST_CASE("madronalib/wavetable/gen", "[wavetable]")
+{
+  auto frames = sineToSaw(2048, 8);
+  auto table = std::make_shared<const Wavetable>(frames.data(), 2048, 8);
+
+  SECTION("sine")
+  {
+    WavetableGen<float> gen(table);
+    const float freq = 0.01f;
+    auto y = run(gen, freq, 0.f, 8);
+    // the first block ramps the freq up from zero.
+    double phase = 0.;
+    for (size_t t = 0; t < y.size(); ++t)
+    {
+      phase += (t < kFramesPerBlock) ? freq * (t + 1) / kFramesPerBlock : freq;
+      REQUIRE(y[t] == Approx(std::sin(kTwoPi * phase)).margin(1e-4f));
+    }
+  }
+
+  SECTION("no aliasing")
+  {
+    // a saw at exactly bin 37 of a 4096-point FFT has energy only at
+    // multiples of that bin, below Nyquist.
+    constexpr size_t kSize = 4096;
+    constexpr size_t kBin = 37;
+    for (float freqScale : {1.f, 4.f, 13.f})
+    {
+      const float freq = freqScale * kBin / kSize;
+      WavetableGen<float> gen(table);
+      run(gen, freq, 1.f, 4);
+      auto y = run(gen, freq, 1.f, kSize / kFramesPerBlock);
+      RealFFT fft(kSize);
+      fft::FloatBuffer x(kSize), spectrum(kSize);
+      std::copy(y.begin(), y.end(), x.data());
+      fft.forward(x.data(), spectrum.data());
+      const float* re = spectrum.data();
+      const float* im = re + kSize / 2;
+      double harmonic = 0., other = 0.;
+      const size_t fundamental = size_t(freqScale) * kBin;
+      for (size_t k = 1; k < kSize / 2; ++k)
+      {
+        double p = double(re[k]) * re[k] + double(im[k]) * im[k];
+        ((k % fundamental) ? other : harmonic) += p;
+      }
+      REQUIRE(10. * std::log10(other / harmonic) < -60.);
+    }
+  }
+
+  SECTION("frame position")
+  {
+    // a quarter of the way through three frames is halfway between the first
+    // two, which are at positions 0 and 0.5.
+    auto three = std::make_shared<const Wavetable>(frames.data(), 2048, 3);
+    WavetableGen<float> first(three), second(three), between(three);
+    for (float freq : {0.003f, 0.05f})
+    {
+      auto y0 = run(first, freq, 0.f, 4);
+      auto y1 = run(second, freq, 0.5f, 4);
+      auto y = run(between, freq, 0.25f, 4);
+      for (size_t t = 0; t < y.size(); ++t) REQUIRE(y[t] == Approx(0.5f * (y0[t] + y1[t])).margin(1e-6f));
+    }
+  }
+
+  SECTION("float4 lanes match float")
+  {
+    const std::array<float, 4> freqs{0.001f, 0.013f, 0.07f, 0.21f};
+    const std::array<float, 4> positions{0.f, 0.3f, 0.77f, 1.f};
+    WavetableGen<float4> gen4(table);
+    std::array<WavetableGen<float>, 4> gens;
+    for (auto& g : gens) g.setWavetable(table);
+    // the float path accumulates phase four frames at a time, so the phases
+    // drift apart by rounding over time. Compare the first 256 samples.
+    for (size_t b = 0; b < std::max(size_t(1), 256 / kFramesPerBlock); ++b)
+    {
+      WavetableGen<float4>::Params p{float4(freqs[0], freqs[1], freqs[2], freqs[3]),
+                                     float4(positions[0], positions[1], positions[2], positions[3])};
+      Block<float4> y4 = gen4(p);
+      for (int k = 0; k < 4; ++k)
+      {
+        SignalBlock y = gens[k](freqs[k], positions[k]);
+        for (size_t t = 0; t < kFramesPerBlock; ++t) REQUIRE(getFloat4Lane(y4[t], k) == Approx(y[t]).margin(1e-4f));
+      }
+    }
+  }
+
+  SECTION("no table")
+  {
+    WavetableGen<float> gen;
+    REQUIRE(gen(0.1f, 0.f) == SignalBlock(0.f));
+  }
+}
+
+TEST_CASE("madronalib/wavetable/library", "[wavetable]")
+{
+  auto frames = sineToSaw(512, 4);
+  SharedResourcePointer<WavetableLibrary> a;
+  auto loaded = a->load("sineToSaw", frames.data(), 512, 4);
+  {
+    SharedResourcePointer<WavetableLibrary> b;
+    REQUIRE(b->get("sineToSaw") == loaded);
+    REQUIRE(b->get("missing") == nullptr);
+  }
+
+  // frames that can't make a table are not stored.
+  REQUIRE(a->load("bad", frames.data(), 500, 4) == nullptr);
+  REQUIRE(a->load("bad", frames.data(), 4096, 1) == nullptr);
+  REQUIRE(a->load("bad", frames.data(), 512, 0) == nullptr);
+  REQUIRE(a->get("bad") == nullptr);
+
+  // every voice of a bank plays the one shared table.
+  constexpr int kVoices = 8;
+  GenBank<WavetableGen, kVoices> bank;
+  for (int p = 0; p < kVoices / 4; ++p) bank[p].setWavetable(a->get("sineToSaw"));
+  REQUIRE(loaded.use_count() == 2 + kVoices / 4);
+  for (int v = 0; v < kVoices; ++v) bank.setVoiceParams(v, {0.01f * (v + 1), v / 7.f});
+  auto y = bank.processVoices();
+  REQUIRE(y.rowPtr(kVoices - 1)[kFramesPerBlock - 1] != 0.f);
+
+  a->remove("sineToSaw");
+  REQUIRE(a->get("sineToSaw") == nullptr);
+}
+
+#if DO_TIME_TESTS
+TEST_CASE("madronalib/wavetable/time", "[wavetable][time]")
+{
+  // voices of a 256-frame wavetable that one core can run in real time at
+  // 48 kHz, with moving frequencies and positions.
+  constexpr int kVoices = 64;
+  const double blockNs = 1e9 * kFramesPerBlock / 48000.;
+  auto frames = sineToSaw(2048, 256);
+  SharedResourcePointer<WavetableLibrary> library;
+  auto table = library->load("time", frames.data(), 2048, 256);
+
+  GenBank<WavetableGen, kVoices> bank;
+  for (int p = 0; p < kVoices / 4; ++p) bank[p].setWavetable(table);
+  int n = 0;
+  std::function<float(void)> fn = [&]() {
+    ++n;
+    for (int v = 0; v < kVoices; ++v)
+      bank.setVoiceParams(v, {0.001f * (v + 1) * (1.f + 0.01f * (n & 7)), fracPart(0.01f * (n + v))});
+    return bank.processVoices().rowPtr(0)[0];
+  };
+  auto t = timeIterations<float>(fn);
+  std::cout << kVoices << " wavetable voices: " << t.ns << " ns per block, " << kVoices * blockNs / t.ns
+            << " voices per core\n";
+}
+#endif
@@ -186,7 +186,7 @@ TEST_CASE("madronalib/core/events/small_buffer_16", "[events]")
 TEST_CASE("madronalib/core/events/multiple_notes_small_buffer", "[events]")
 {
   TestFixture t;
-  const int bufSize = 32;
+  const int bufSize = kFramesPerBlock/2;
   
   // callback 1: note on key 60
   t.callback(bufSize, {makeNoteOn(60, 60.f, 0.8f, 0)});
@@ -295,3 +295,53 @@ TEST_CASE("madronalib/core/events/sustained_sequence_small_buffer", "[events]")
   }
 }
 
+
+// copy the inputs to the outputs
+template<size_t FRAMES>
+static void passThroughProcessFn(AudioContextOf<FRAMES>* ctx, void*)
+{
+  for (size_t c = 0; c < ctx->outputs.size(); ++c)
+  {
+    ctx->outputs[c] = ctx->inputs[c];
+  }
+}
+
+// Run a ramp through a pass-through AudioContextOf<FRAMES> in host buffers of
+// an unrelated size. The output should be the input delayed by one block, and
+// a held note should make a gate in the voice outputs.
+template<size_t FRAMES>
+static void testBlockSize()
+{
+  constexpr int kHostFrames = 100;
+  constexpr int kCallbacks = 8;
+  AudioContextOf<FRAMES> ctx{1, 1, kSampleRate};
+  ctx.setInputPolyphony(kPolyphony);
+  ctx.addInputEvent(makeNoteOn(60, 60.f, 0.8f, 37));
+
+  std::vector<float> input(kHostFrames * kCallbacks), output(kHostFrames * kCallbacks);
+  for (size_t i = 0; i < input.size(); ++i)
+  {
+    input[i] = static_cast<float>(i + 1);
+  }
+
+  for (int i = 0; i < kCallbacks; ++i)
+  {
+    const float* in[1]{input.data() + i * kHostFrames};
+    float* out[1]{output.data() + i * kHostFrames};
+    ctx.process(in, out, kHostFrames, passThroughProcessFn<FRAMES>, nullptr);
+  }
+
+  for (size_t i = 0; i < output.size(); ++i)
+  {
+    float expected = (i < FRAMES) ? 0.f : input[i - FRAMES];
+    REQUIRE(output[i] == expected);
+  }
+  REQUIRE(ctx.getInputVoice(0).outputs.constRow(kGate)[FRAMES - 1] > 0.f);
+}
+
+TEST_CASE("madronalib/core/events/block_sizes", "[events]")
+{
+  testBlockSize<16>();
+  testBlockSize<64>();
+  testBlockSize<256>();
+}
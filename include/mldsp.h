@@ -11,6 +11,8 @@
 #include "MLDSPFilters.h"
 #include "MLDSPShapes.h"
 #include "MLDSPAnalysis.h"
+#include "MLDSPFFT.h"
+#include "MLDSPConvolution.h"
 #include "MLDSPDelays.h"
 #include "MLDSPBuffer.h"
 #include "MLDSPUtils.h"
@@ -19,4 +21,5 @@
 #include "MLDSPRouting.h"
 #include "MLDSPSample.h"
 #include "MLDSPScale.h"
+#include "MLDSPWavetable.h"
 
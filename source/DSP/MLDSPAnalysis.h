@@ -26,19 +26,7 @@ class Differentiator
   float _x1{0};
 
  public:
-  inline SignalBlock operator()(const SignalBlock vx)
-  {
-    SignalBlock vy;
-    vy[0] = vx[0] - _x1;
-
-    // TODO SIMD
-    for (int n = 1; n < kFramesPerBlock; ++n)
-    {
-      vy[n] = vx[n] - vx[n - 1];
-    }
-    _x1 = vx[kFramesPerBlock - 1];
-    return vy;
-  }
+  inline SignalBlock operator()(const SignalBlock vx) { return differences(vx, _x1); }
 };
 
 // Integrator
@@ -53,14 +41,7 @@ class Integrator
 
   inline SignalBlock operator()(const SignalBlock vx)
   {
-    SignalBlock vy;
-    for (int n = 0; n < kFramesPerBlock; ++n)
-    {
-      y1 -= y1 * mLeak;
-      y1 += vx[n];
-      vy[n] = y1;
-    }
-    return vy;
+    return (mLeak == 0.f) ? inclusiveScan(vx, y1) : leakyScan(vx, 1.f - mLeak, y1);
   }
 };
 
@@ -90,7 +71,7 @@ class Peak
 
   inline SignalBlock operator()(const SignalBlock vx)
   {
-    SignalBlock vy;
+    SignalBlock vy(uninitialized);
     SignalBlock vxSquared = vx * vx;
     for (int n = 0; n < kFramesPerBlock; ++n)
     {
@@ -147,7 +128,7 @@ class RMS
 
   inline SignalBlock operator()(const SignalBlock vx)
   {
-    SignalBlock vy;
+    SignalBlock vy(uninitialized);
     SignalBlock vxSquared = vx * vx;
 
     for (int n = 0; n < kFramesPerBlock; ++n)
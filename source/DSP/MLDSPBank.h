@@ -5,56 +5,274 @@
 // Banks of float4 processors for polyphonic DSP.
 // GenBank: a bank of generators (no audio input, params → audio).
 // FilterBank: a bank of filters (audio + optional params → audio).
+// EnvelopeBank: a bank of ADSR envelopes (gates → envelopes).
 // Internally, ceil(ROWS/4) float4 processors handle groups of 4 voices each.
+//
+// Each bank has two interfaces. The per-voice interface takes and returns
+// ordinary SignalBlockArrays with one row per voice, and stores params per
+// voice with setVoiceParams(). The banks convert to and from the float4
+// layout internally. The float4 interface takes and returns the vertical
+// float4 rows directly, for chaining banks without converting in between.
+//
+// Both interfaces of GenBank and FilterBank skip the float4 processors whose
+// voices are all at rest, see VoiceActivity below. Their processors must
+// have a clearLanes(mask) method, which clears the state of the lanes where
+// mask is set as clear() does for all of them.
 
 #pragma once
 
+#include <bitset>
 #include <functional>
 
 #include "MLDSPOps.h"
 #include "MLDSPFilters.h"
-#include "MLDSPDelays.h"
-#include "MLDSPResampling.h"
+#include "MLDSPShapes.h"
 
 namespace ml
 {
 
-// These Bank templates are just a start. TODO: determine a good API for setting
-// banks of parameters. Callers shouldn't have to worry about float4- rather, set one or more
-// rows of the stored params, or pass in a Block of params with nicer syntax. Look at
-// relationship to Projections. 
+// Convert the horizontal rows for voices [4 * group, 4 * group + 4) of an
+// array of numVoices rows to one vertical float4 row at dest. Voices past
+// the end of the array are zero.
+template<size_t FRAMES = kFramesPerBlock>
+inline void voicesToLanes(const float* voiceRows, size_t numVoices, size_t group, float4* dest)
+{
+  size_t firstVoice = group * 4;
+  if (firstVoice + 4 <= numVoices)
+  {
+    horizontalToVertical<FRAMES>(voiceRows + firstVoice * FRAMES, dest, 1);
+  }
+  else
+  {
+    SignalBlockArrayOf<4, FRAMES> padded;
+    std::copy(voiceRows + firstVoice * FRAMES, voiceRows + numVoices * FRAMES, padded.data());
+    horizontalToVertical<FRAMES>(padded.data(), dest, 1);
+  }
+}
+
+// Convert one vertical float4 row to the horizontal rows for voices
+// [4 * group, 4 * group + 4) of an array of numVoices rows. Lanes for voices
+// past the end of the array are dropped.
+template<size_t FRAMES = kFramesPerBlock>
+inline void lanesToVoices(const float4* src, size_t group, float* voiceRows, size_t numVoices)
+{
+  size_t firstVoice = group * 4;
+  if (firstVoice + 4 <= numVoices)
+  {
+    verticalToHorizontal<FRAMES>(src, voiceRows + firstVoice * FRAMES, 1);
+  }
+  else
+  {
+    SignalBlockArrayOf<4, FRAMES> padded(uninitialized);
+    verticalToHorizontal<FRAMES>(src, padded.data(), 1);
+    std::copy(padded.data(), padded.data() + (numVoices - firstVoice) * FRAMES,
+              voiceRows + firstVoice * FRAMES);
+  }
+}
+
+// the peak level in each lane of a float4 row
+template<size_t FRAMES = kFramesPerBlock>
+inline float4 lanePeaks(const float4* row)
+{
+  float4 peaks{0.f};
+  for (size_t t = 0; t < FRAMES; ++t)
+    peaks = max(peaks, max(row[t], -row[t]));
+  return peaks;
+}
+
+// ----------------------------------------------------------------
+// VoiceActivity: which voices of a bank need processing.
+//
+// All voices start active. A voice that the caller deactivates keeps running
+// until it comes to rest: for generators right away, and for filters once
+// the voice's input and output have both stayed below kRestThreshold for a
+// whole block. The outputs of resting voices are zero. A float4 processor
+// whose voices are all at rest is skipped and its state is cleared. A
+// resting voice that is activated again has its lane of the state cleared
+// before the next block, so it starts from rest even if the other voices of
+// its processor kept running.
+
+template<int ROWS>
+class VoiceActivity
+{
+public:
+  static constexpr float kRestThreshold{1e-5f};  // -100 dB
+
+  VoiceActivity() { _active.set(); }
+
+  void setActive(size_t voice, bool active)
+  {
+    _active[voice] = active;
+    if (active && _resting[voice])
+    {
+      _resting[voice] = false;
+      _woken[voice] = true;
+    }
+  }
+
+  bool isActive(size_t voice) const { return _active[voice]; }
+
+  // the voices that were processed in the last block
+  std::bitset<ROWS> getRunning() const { return ~_resting; }
+
+  bool isGroupRunning(int group) const
+  {
+    for (int v = group * 4; v < std::min(group * 4 + 4, ROWS); ++v)
+      if (!_resting[v]) return true;
+    return false;
+  }
+
+  // A mask of the lanes of group whose voices were woken since the last call,
+  // or zero if there are none.
+  float4 takeWoken(int group)
+  {
+    alignas(16) float mask[4];
+    for (int lane = 0; lane < 4; ++lane)
+    {
+      int v = group * 4 + lane;
+      bool woken = (v < ROWS) && _woken[v];
+      mask[lane] = woken ? 1.f : 0.f;
+      if (woken) _woken[v] = false;
+    }
+    return loadFloat4(mask) > float4(0.f);
+  }
+
+  bool anyWoken(int group) const
+  {
+    for (int v = group * 4; v < std::min(group * 4 + 4, ROWS); ++v)
+      if (_woken[v]) return true;
+    return false;
+  }
+
+  // After a block of group, set each inactive voice to rest if its peak
+  // level is below the threshold. Returns true if the whole group is at rest.
+  bool update(int group, float4 peaks)
+  {
+    for (int v = group * 4; v < std::min(group * 4 + 4, ROWS); ++v)
+      _resting[v] = !_active[v] && (getFloat4Lane(peaks, v - group * 4) < kRestThreshold);
+    return !isGroupRunning(group);
+  }
+
+  // Zero the lanes of a float4 row for the voices of group that are at rest.
+  template<size_t FRAMES = kFramesPerBlock>
+  void maskResting(int group, float4* row) const
+  {
+    alignas(16) float mask[4];
+    bool anyResting{false};
+    for (int lane = 0; lane < 4; ++lane)
+    {
+      int v = group * 4 + lane;
+      bool resting = (v < ROWS) && _resting[v];
+      mask[lane] = resting ? 0.f : 1.f;
+      anyResting |= resting;
+    }
+    if (!anyResting) return;
+    float4 m = loadFloat4(mask);
+    for (size_t t = 0; t < FRAMES; ++t)
+      row[t] = row[t] * m;
+  }
+
+private:
+  std::bitset<ROWS> _active;
+  std::bitset<ROWS> _resting;
+  std::bitset<ROWS> _woken;
+};
 
 // ----------------------------------------------------------------
 // GenBank: a bank of generator processors (no audio input).
-// FN must be a generator with the Gen<T, Derived> interface.
+// FN must be a generator with the Gen<T, Derived> interface, as a template
+// FN<T, FRAMES>. The bank runs FN<float4, FRAMES> on blocks of FRAMES frames.
 // Input rows are stacked param signals: kNumFloat4Procs * nParams rows total,
 // with each processor's nParams rows grouped together.
 
-template <template<typename> class FN, int ROWS>
+template <template<typename, size_t> class FN, int ROWS, size_t FRAMES = kFramesPerBlock>
 class GenBank
 {
 public:
   static constexpr int kNumFloat4Procs = (ROWS + 3) / 4;
-  using Processor = FN<float4>;
+  using Processor = FN<float4, FRAMES>;
 
   static constexpr int nParams  = Processor::nParams;
   static constexpr int IN_ROWS  = kNumFloat4Procs * nParams;
   static constexpr int OUT_ROWS = kNumFloat4Procs;
 
-  using inputType  = SignalBlockArrayBase<float4, IN_ROWS>;
-  using outputType = SignalBlockArrayBase<float4, OUT_ROWS>;
+  using inputType  = SignalBlockArrayBase<float4, IN_ROWS, FRAMES>;
+  using outputType = SignalBlockArrayBase<float4, OUT_ROWS, FRAMES>;
   using Params     = typename Processor::Params;
 
+  // per-voice types: one row or one param value per voice
+  using VoiceParams      = std::array<float, nParams>;
+  using voiceInputType   = SignalBlockArrayOf<ROWS * nParams, FRAMES>;
+  using voiceOutputType  = SignalBlockArrayOf<ROWS, FRAMES>;
+
+  // ----------------------------------------------------------------
+  // per-voice interface
+
+  void setVoiceParams(size_t voice, const VoiceParams& p)
+  {
+    for (int i = 0; i < nParams; ++i)
+      setFloat4Lane(_voiceParams[voice / 4][i], voice % 4, p[i]);
+  }
+
+  VoiceParams getVoiceParams(size_t voice) const
+  {
+    VoiceParams p;
+    for (int i = 0; i < nParams; ++i)
+      p[i] = getFloat4Lane(_voiceParams[voice / 4][i], voice % 4);
+    return p;
+  }
+
+  // Turn a voice on or off. An inactive voice outputs zero, and a processor
+  // whose four voices are inactive is not run. See VoiceActivity.
+  void setVoiceActive(size_t voice, bool active) { _activity.setActive(voice, active); }
+
+  // a bit for each voice that was processed in the last block
+  std::bitset<ROWS> getRunningVoices() const { return _activity.getRunning(); }
+
+  // Run with the stored voice params, interpolating from the previous block
+  // when they change. Returns one row per voice.
+  voiceOutputType processVoices()
+  {
+    voiceOutputType output(uninitialized);
+    for (int p = 0; p < kNumFloat4Procs; ++p)
+    {
+      auto y = runProcessor(p, [&](Processor& proc) { return proc(_voiceParams[p]); });
+      lanesToVoices<FRAMES>(y.data(), p, output.data(), ROWS);
+    }
+    return output;
+  }
+
+  // Signal-rate params: nParams * ROWS rows, all the voices for the first
+  // param, then all the voices for the next. Each group of voices is
+  // converted straight into the params for its processor.
+  voiceOutputType processVoices(const voiceInputType& paramSignals)
+  {
+    voiceOutputType output(uninitialized);
+    SignalBlockArrayBase<float4, nParams, FRAMES> procParams(uninitialized);
+    for (int p = 0; p < kNumFloat4Procs; ++p)
+    {
+      auto y = runProcessor(p, [&](Processor& proc) {
+        for (int i = 0; i < nParams; ++i)
+          voicesToLanes<FRAMES>(paramSignals.rowPtr(i * ROWS), ROWS, p, procParams.rowPtr(i));
+        return proc(procParams);
+      });
+      lanesToVoices<FRAMES>(y.data(), p, output.data(), ROWS);
+    }
+    return output;
+  }
+
+  // ----------------------------------------------------------------
+  // float4 interface
+
   // Signal-rate params: IN_ROWS rows of param signals, nParams per processor.
   outputType operator()(const inputType& input)
   {
-    outputType output;
+    outputType output(uninitialized);
     for (int p = 0; p < kNumFloat4Procs; ++p)
     {
-      SignalBlockArrayBase<float4, nParams> paramSlice;
-      for (int r = 0; r < nParams; ++r)
-        paramSlice.setRow(r, input.getRow(p * nParams + r));
-      output.setRow(p, _processors[p](paramSlice));
+      output.setRow(p, runProcessor(p, [&](Processor& proc) {
+        return proc.processParamRows(input.rowPtr(p * nParams));
+      }));
     }
     return output;
   }
@@ -62,18 +280,18 @@ public:
   // Per-block params (interpolated), one Params per processor.
   outputType operator()(const std::array<Params, kNumFloat4Procs>& params)
   {
-    outputType output;
+    outputType output(uninitialized);
     for (int p = 0; p < kNumFloat4Procs; ++p)
-      output.setRow(p, _processors[p](params[p]));
+      output.setRow(p, runProcessor(p, [&](Processor& proc) { return proc(params[p]); }));
     return output;
   }
 
   // Constant stored coefficients.
   outputType operator()()
   {
-    outputType output;
+    outputType output(uninitialized);
     for (int p = 0; p < kNumFloat4Procs; ++p)
-      output.setRow(p, _processors[p]());
+      output.setRow(p, runProcessor(p, [&](Processor& proc) { return proc(); }));
     return output;
   }
 
@@ -81,40 +299,131 @@ public:
   Processor& operator[](size_t n) { return _processors[n]; }
 
 private:
+  // Run processor p unless its voices are all at rest, clearing the lanes
+  // of woken voices first. Generators do not ring, so inactive voices rest
+  // right away.
+  template<typename PROCESS>
+  Block<float4, FRAMES> runProcessor(int p, PROCESS&& process)
+  {
+    if (_activity.update(p, float4(0.f)))
+    {
+      _processors[p].clear();
+      return Block<float4, FRAMES>(0.f);
+    }
+    if (_activity.anyWoken(p)) _processors[p].clearLanes(_activity.takeWoken(p));
+    Block<float4, FRAMES> y = process(_processors[p]);
+    _activity.template maskResting<FRAMES>(p, y.data());
+    return y;
+  }
+
   std::array<Processor, kNumFloat4Procs> _processors;
+  std::array<Params, kNumFloat4Procs> _voiceParams{};
+  VoiceActivity<ROWS> _activity;
 };
 
 
 // ----------------------------------------------------------------
 // FilterBank: a bank of filter processors (audio input → audio output).
-// FN must be a filter with the Filter<T, Derived> interface.
+// FN must be a filter with the Filter<T, Derived> interface, as a template
+// FN<T, FRAMES>. The bank runs FN<float4, FRAMES> on blocks of FRAMES frames.
 // Audio input and output are OUT_ROWS = kNumFloat4Procs rows.
 // Signal-rate params use PARAM_ROWS = kNumFloat4Procs * nParams rows,
 // with each processor's nParams rows grouped together.
 
-template <template<typename> class FN, int ROWS>
+template <template<typename, size_t> class FN, int ROWS, size_t FRAMES = kFramesPerBlock>
 class FilterBank
 {
 public:
   static constexpr int kNumFloat4Procs = (ROWS + 3) / 4;
-  using Processor = FN<float4>;
+  using Processor = FN<float4, FRAMES>;
 
   static constexpr int nParams    = Processor::nParams;
   static constexpr int IN_ROWS    = kNumFloat4Procs;
   static constexpr int OUT_ROWS   = kNumFloat4Procs;
   static constexpr int PARAM_ROWS = kNumFloat4Procs * nParams;
 
-  using inputType  = SignalBlockArrayBase<float4, IN_ROWS>;
-  using outputType = SignalBlockArrayBase<float4, OUT_ROWS>;
-  using paramType  = SignalBlockArrayBase<float4, PARAM_ROWS>;
+  using inputType  = SignalBlockArrayBase<float4, IN_ROWS, FRAMES>;
+  using outputType = SignalBlockArrayBase<float4, OUT_ROWS, FRAMES>;
+  using paramType  = SignalBlockArrayBase<float4, PARAM_ROWS, FRAMES>;
   using Params     = typename Processor::Params;
 
+  // per-voice types: one row or one param value per voice
+  using VoiceParams     = std::array<float, nParams>;
+  using voiceType       = SignalBlockArrayOf<ROWS, FRAMES>;
+  using voiceParamType  = SignalBlockArrayOf<ROWS * nParams, FRAMES>;
+
+  // ----------------------------------------------------------------
+  // per-voice interface
+
+  void setVoiceParams(size_t voice, const VoiceParams& p)
+  {
+    for (int i = 0; i < nParams; ++i)
+      setFloat4Lane(_voiceParams[voice / 4][i], voice % 4, p[i]);
+  }
+
+  VoiceParams getVoiceParams(size_t voice) const
+  {
+    VoiceParams p;
+    for (int i = 0; i < nParams; ++i)
+      p[i] = getFloat4Lane(_voiceParams[voice / 4][i], voice % 4);
+    return p;
+  }
+
+  // Turn a voice on or off. An inactive voice runs until its input and
+  // output are quiet, then outputs zero, and a processor whose four voices
+  // are at rest is not run. See VoiceActivity.
+  void setVoiceActive(size_t voice, bool active) { _activity.setActive(voice, active); }
+
+  // a bit for each voice that was processed in the last block
+  std::bitset<ROWS> getRunningVoices() const { return _activity.getRunning(); }
+
+  // Filter one row per voice with the stored voice params, interpolating
+  // from the previous block when they change.
+  voiceType processVoices(const voiceType& input)
+  {
+    voiceType output(uninitialized);
+    Block<float4, FRAMES> procInput(uninitialized);
+    for (int p = 0; p < kNumFloat4Procs; ++p)
+    {
+      auto y = runProcessor(p, procInput.data(), [&](Processor& proc) {
+        voicesToLanes<FRAMES>(input.data(), ROWS, p, procInput.data());
+        return proc(procInput, _voiceParams[p]);
+      });
+      lanesToVoices<FRAMES>(y.data(), p, output.data(), ROWS);
+    }
+    return output;
+  }
+
+  // Signal-rate params: nParams * ROWS rows, all the voices for the first
+  // param, then all the voices for the next. Each group of voices is
+  // converted straight into the params for its processor.
+  voiceType processVoices(const voiceType& input, const voiceParamType& paramSignals)
+  {
+    voiceType output(uninitialized);
+    Block<float4, FRAMES> procInput(uninitialized);
+    SignalBlockArrayBase<float4, nParams, FRAMES> procParams(uninitialized);
+    for (int p = 0; p < kNumFloat4Procs; ++p)
+    {
+      auto y = runProcessor(p, procInput.data(), [&](Processor& proc) {
+        voicesToLanes<FRAMES>(input.data(), ROWS, p, procInput.data());
+        for (int i = 0; i < nParams; ++i)
+          voicesToLanes<FRAMES>(paramSignals.rowPtr(i * ROWS), ROWS, p, procParams.rowPtr(i));
+        return proc(procInput, procParams);
+      });
+      lanesToVoices<FRAMES>(y.data(), p, output.data(), ROWS);
+    }
+    return output;
+  }
+
+  // ----------------------------------------------------------------
+  // float4 interface
+
   // Constant stored coefficients.
   outputType operator()(const inputType& input)
   {
-    outputType output;
+    outputType output(uninitialized);
     for (int p = 0; p < kNumFloat4Procs; ++p)
-      output.setRow(p, _processors[p](input.getRow(p)));
+      output.setRow(p, runProcessor(p, input.rowPtr(p), [&](Processor& proc) { return proc(input.getRow(p)); }));
     return output;
   }
 
@@ -122,22 +431,22 @@ public:
   outputType operator()(const inputType& input,
                         const std::array<Params, kNumFloat4Procs>& params)
   {
-    outputType output;
+    outputType output(uninitialized);
     for (int p = 0; p < kNumFloat4Procs; ++p)
-      output.setRow(p, _processors[p](input.getRow(p), params[p]));
+      output.setRow(p, runProcessor(p, input.rowPtr(p),
+                                    [&](Processor& proc) { return proc(input.getRow(p), params[p]); }));
     return output;
   }
 
   // Signal-rate params: PARAM_ROWS rows, nParams per processor.
   outputType operator()(const inputType& input, const paramType& paramSignals)
   {
-    outputType output;
+    outputType output(uninitialized);
     for (int p = 0; p < kNumFloat4Procs; ++p)
     {
-      SignalBlockArrayBase<float4, nParams> paramSlice;
-      for (int r = 0; r < nParams; ++r)
-        paramSlice.setRow(r, paramSignals.getRow(p * nParams + r));
-      output.setRow(p, _processors[p](input.getRow(p), paramSlice));
+      output.setRow(p, runProcessor(p, input.rowPtr(p), [&](Processor& proc) {
+        return proc.processParamRows(input.getRow(p), paramSignals.rowPtr(p * nParams));
+      }));
     }
     return output;
   }
@@ -146,7 +455,229 @@ public:
   Processor& operator[](size_t n) { return _processors[n]; }
 
 private:
+  // Run processor p unless its voices are all at rest, clearing the lanes
+  // of woken voices first, then put its quiet inactive voices to rest. input
+  // is read after process() runs.
+  template<typename PROCESS>
+  Block<float4, FRAMES> runProcessor(int p, const float4* input, PROCESS&& process)
+  {
+    if (!_activity.isGroupRunning(p)) return Block<float4, FRAMES>(0.f);
+    if (_activity.anyWoken(p)) _processors[p].clearLanes(_activity.takeWoken(p));
+    Block<float4, FRAMES> y = process(_processors[p]);
+    if (_activity.update(p, max(lanePeaks<FRAMES>(input), lanePeaks<FRAMES>(y.data()))))
+      _processors[p].clear();
+    _activity.template maskResting<FRAMES>(p, y.data());
+    return y;
+  }
+
   std::array<Processor, kNumFloat4Procs> _processors;
+  std::array<Params, kNumFloat4Procs> _voiceParams{};
+  VoiceActivity<ROWS> _activity;
+};
+
+// ----------------------------------------------------------------
+// EnvelopeBank: ADSR envelopes for ROWS voices, four to a float4.
+//
+// Each lane runs the same state machine as ADSR::processSample(), so a voice
+// of the bank makes the same envelope as an ADSR given the same gate. The
+// segment transitions are made with masks and select() for all four lanes
+// at once, and skipped in the frames where no lane changes segment. A group
+// of four voices whose lanes are all either idle, with the gate off, or
+// sustaining, with the gate on for the whole block, is not run per sample:
+// its output is constant.
+//
+// The gates are amplitudes, like the gate rows that EventsToSignals makes.
+// An envelope starts when its gate goes above zero, and is scaled by the
+// gate at that frame. It releases when the gate goes back to zero.
+
+template<int ROWS>
+class EnvelopeBank
+{
+public:
+  static constexpr int kNumFloat4Procs = (ROWS + 3) / 4;
+  static constexpr int IN_ROWS  = kNumFloat4Procs;
+  static constexpr int OUT_ROWS = kNumFloat4Procs;
+
+  using inputType  = SignalBlockArrayBase<float4, IN_ROWS>;
+  using outputType = SignalBlockArrayBase<float4, OUT_ROWS>;
+
+  // per-voice types: one row per voice
+  using voiceType = SignalBlockArray<ROWS>;
+  using voiceRowPtrs = std::array<const float*, ROWS>;
+
+  // Set the coefficients from ADSR::calcCoeffs() for all voices, or one.
+  void setCoeffs(const ADSR::Coeffs& c)
+  {
+    for (size_t v = 0; v < ROWS; ++v) setVoiceCoeffs(v, c);
+  }
+
+  void setVoiceCoeffs(size_t voice, const ADSR::Coeffs& c)
+  {
+    Coeffs4& k = _coeffs[voice / 4];
+    int lane = voice % 4;
+    setFloat4Lane(k.ka, lane, c.ka);
+    setFloat4Lane(k.kd, lane, c.kd);
+    setFloat4Lane(k.s, lane, c.s);
+    setFloat4Lane(k.kr, lane, c.kr);
+  }
+
+  // true if the voice has finished its release, or never started.
+  bool isVoiceIdle(size_t voice) const
+  {
+    return getFloat4Lane(_lanes[voice / 4].segment, voice % 4) == float(ADSR::off);
+  }
+
+  void clear() { _lanes.fill(Lanes{}); }
+
+  // ----------------------------------------------------------------
+  // per-voice interface
+
+  // One gate row per voice.
+  voiceType processVoices(const voiceType& gates)
+  {
+    voiceType output(uninitialized);
+    SignalBlock4 gateLanes(uninitialized), y(uninitialized);
+    for (int p = 0; p < kNumFloat4Procs; ++p)
+    {
+      voicesToLanes(gates.data(), ROWS, p, gateLanes.data());
+      processGroup(p, gateLanes.data(), y.data());
+      lanesToVoices(y.data(), p, output.data(), ROWS);
+    }
+    return output;
+  }
+
+  // A pointer to the gate row of each voice, for reading the rows where
+  // they are, for example from EventsToSignals:
+  //   gateRows[v] = events.getVoice(v).outputs.rowPtr(kGate);
+  voiceType processVoices(const voiceRowPtrs& gateRows)
+  {
+    voiceType output(uninitialized);
+    SignalBlockArray<4> gates(uninitialized);
+    SignalBlock4 gateLanes(uninitialized), y(uninitialized);
+    for (int p = 0; p < kNumFloat4Procs; ++p)
+    {
+      for (int lane = 0; lane < 4; ++lane)
+      {
+        int v = p * 4 + lane;
+        if (v < ROWS)
+          std::copy(gateRows[v], gateRows[v] + kFramesPerBlock, gates.rowPtr(lane));
+        else
+          gates.row(lane) = SignalBlock(0.f);
+      }
+      voicesToLanes(gates.data(), 4, 0, gateLanes.data());
+      processGroup(p, gateLanes.data(), y.data());
+      lanesToVoices(y.data(), p, output.data(), ROWS);
+    }
+    return output;
+  }
+
+  // ----------------------------------------------------------------
+  // float4 interface
+
+  outputType operator()(const inputType& gates)
+  {
+    outputType output(uninitialized);
+    for (int p = 0; p < kNumFloat4Procs; ++p)
+      processGroup(p, gates.rowPtr(p), output.rowPtr(p));
+    return output;
+  }
+
+private:
+  static constexpr float kA{float(ADSR::A)}, kD{float(ADSR::D)}, kS{float(ADSR::S)}, kR{float(ADSR::R)},
+      kOff{float(ADSR::off)};
+
+  struct Coeffs4
+  {
+    float4 ka{0.f}, kd{0.f}, s{0.f}, kr{0.f};
+  };
+
+  // the state of ADSR, for four voices.
+  struct Lanes
+  {
+    float4 y{0.f}, y1{0.f}, x1{0.f};
+    float4 threshold{0.f}, target{0.f}, k{0.f}, amp{0.f};
+    float4 segment{kOff};
+  };
+
+  std::array<Coeffs4, kNumFloat4Procs> _coeffs{};
+  std::array<Lanes, kNumFloat4Procs> _lanes{};
+
+  static bool allLanes(float4 mask) { return vecSumH(andBits(mask, float4(1.f))) == 4.f; }
+  static bool anyLanes(float4 mask) { return vecSumH(andBits(mask, float4(1.f))) != 0.f; }
+
+  void processGroup(int p, const float4* gates, float4* y)
+  {
+    Lanes& s = _lanes[p];
+    const Coeffs4& c = _coeffs[p];
+
+    // If every lane is idle or sustaining for the whole block, the state
+    // is unchanged but for the last gate, and the output is constant.
+    float4 lo = gates[0], hi = gates[0];
+    for (size_t t = 1; t < kFramesPerBlock; ++t)
+    {
+      lo = min(lo, gates[t]);
+      hi = max(hi, gates[t]);
+    }
+    const float4 zero(0.f);
+    float4 idle = andBits(s.segment == float4(kOff), hi == zero);
+    float4 sustaining = andBits(andBits(s.segment == float4(kS), s.x1 > zero), lo > zero);
+    if (allLanes(orBits(idle, sustaining)))
+    {
+      float4 out = andBits(s.y * s.amp, sustaining);
+      for (size_t t = 0; t < kFramesPerBlock; ++t) y[t] = out;
+      s.x1 = select(gates[kFramesPerBlock - 1], s.x1, sustaining);
+      return;
+    }
+
+    for (size_t t = 0; t < kFramesPerBlock; ++t) y[t] = nextFrame(s, c, gates[t]);
+  }
+
+  static float4 nextFrame(Lanes& s, const Coeffs4& c, float4 x)
+  {
+    const float4 zero(0.f);
+
+    // crossing the threshold advances to the next segment. A gate going
+    // on restarts the attack, and a gate going off starts the release.
+    float4 crossed = xorBits(s.y1 > s.threshold, s.y > s.threshold);
+    float4 advance = andBits(crossed, s.segment < float4(kOff));
+    float4 trigOn = andBits(s.x1 == zero, x > zero);
+    float4 trigOff = andBits(s.x1 > zero, x == zero);
+    float4 recalc = orBits(advance, orBits(trigOn, trigOff));
+    if (anyLanes(recalc))
+    {
+      float4 segment = s.segment + andBits(advance, float4(1.f));
+      segment = select(float4(kA), segment, trigOn);
+      segment = select(float4(kR), segment, trigOff);
+      s.segment = segment;
+      s.amp = select(x, s.amp, trigOn);
+
+      // the start, end and coefficient of each lane's segment, as in ADSR.
+      float4 isA = segment == float4(kA);
+      float4 isD = segment == float4(kD);
+      float4 isS = segment == float4(kS);
+      float4 isR = segment == float4(kR);
+      float4 isOff = segment == float4(kOff);
+      float4 startEnv = select(float4(1.f), andBits(c.s, orBits(isS, isR)), isD);
+      float4 endEnv = select(float4(1.f), andBits(c.s, orBits(isD, isS)), isA);
+      float4 k = select(c.ka, select(c.kd, andBits(c.kr, isR), isD), isA);
+      float4 segmentBias = (endEnv - startEnv) * float4(ADSR::bias);
+      s.threshold = select(endEnv, s.threshold, recalc);
+      s.target = select(endEnv + segmentBias, s.target, recalc);
+      s.k = select(k, s.k, recalc);
+
+      // sustain holds its level, and off is silent.
+      s.y = select(andBits(c.s, isS), s.y, andBits(recalc, orBits(isS, isOff)));
+    }
+
+    // history and IIR filter. Lanes that are off with the gate off stay at
+    // zero, as ADSR does by returning early.
+    s.x1 = x;
+    s.y1 = s.y;
+    s.y = s.y + s.k * (s.target - s.y);
+
+    // scale by amp
+    return s.y * s.amp;
+  }
 };
 
 }  // namespace ml
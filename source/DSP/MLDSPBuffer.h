@@ -101,6 +101,15 @@ class DSPBuffer
     readIndex_.store(currentWriteIndex, std::memory_order_release);
   }
 
+  // clear the buffer and fill it with zeros, so that overlap-adds start
+  // from silence.
+  void clearToZero()
+  {
+    std::fill(data_.begin(), data_.end(), 0.f);
+    readIndex_.store(0, std::memory_order_release);
+    writeIndex_.store(0, std::memory_order_release);
+  }
+
   // resize the buffer, allocating 2^n samples sufficient to contain the
   // requested length.
   size_t resize(int sizeInSamples)
@@ -170,10 +179,10 @@ class DSPBuffer
   }
 
   // write a single SignalBlockArray to the buffer, advancing the write index.
-  template <size_t VECTORS>
-  void write(const SignalBlockArray<VECTORS> &srcVec)
+  template <size_t VECTORS, size_t FRAMES>
+  void write(const SignalBlockArrayOf<VECTORS, FRAMES> &srcVec)
   {
-    constexpr int samples = kFramesPerBlock * VECTORS;
+    constexpr int samples = FRAMES * VECTORS;
 
     bool full = (getWriteAvailable() < samples);
 
@@ -225,10 +234,10 @@ class DSPBuffer
   }
 
   // read a single SignalBlockArray from the buffer, advancing the read index.
-  template <size_t VECTORS>
-  void read(SignalBlockArray<VECTORS> &destVec)
+  template <size_t VECTORS, size_t FRAMES>
+  void read(SignalBlockArrayOf<VECTORS, FRAMES> &destVec)
   {
-    constexpr int samples = kFramesPerBlock * VECTORS;
+    constexpr int samples = FRAMES * VECTORS;
     if (getReadAvailable() < samples) return;
 
     const auto currentReadIndex = readIndex_.load(std::memory_order_acquire);
@@ -251,11 +260,13 @@ class DSPBuffer
   }
 
   // read a single SignalBlock from the buffer, advancing the read index.
-  SignalBlock read()
+  // To read a block of another size, give the number of frames: read<FRAMES>().
+  template <size_t FRAMES = kFramesPerBlock>
+  SignalBlockOf<FRAMES> read()
   {
-    SignalBlock destVec;
-    constexpr int samples = kFramesPerBlock;
-    if (getReadAvailable() < samples) return SignalBlock{};
+    SignalBlockOf<FRAMES> destVec(uninitialized);
+    constexpr int samples = FRAMES;
+    if (getReadAvailable() < samples) return SignalBlockOf<FRAMES>{};
 
     const auto currentReadIndex = readIndex_.load(std::memory_order_acquire);
     DataRegions dr = getDataRegions(currentReadIndex, samples);
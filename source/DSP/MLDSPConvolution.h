@@ -0,0 +1,318 @@
+// madronalib: a C++ framework for DSP applications.
+// Copyright (c) 2026 Madrona Labs LLC. http://www.madronalabs.com
+// Distributed under the MIT license: http://madrona-labs.mit-license.org/
+
+// Partitioned FFT convolution for long impulse responses.
+//
+// ConvolutionIR holds the spectra of an impulse response cut into partitions.
+// The first partitions are kFramesPerBlock long, and later ones grow by
+// factors of four up to a maximum size, which keeps the cost of long IRs
+// down. Each partition size is a layer of a uniformly partitioned
+// convolution with its own frequency-domain delay line. A layer's first
+// partition starts late enough that its output is ready when it is needed, so
+// the convolution adds no latency: each output block includes the input
+// block of the same call.
+//
+// A ConvolutionIR is not changed after it is made, so one can be shared by
+// the Convolvers for any number of channels.
+//
+// Convolver processes one SignalBlock per call. The complex multiply-adds of
+// the larger layers are spread over the blocks in which their next input
+// partition is collected, but their FFTs are done in the block that completes
+// it. Use a maximum partition size of kFramesPerBlock for the same cost in
+// every block.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "MLDSPOps.h"
+#include "MLDSPMath.h"
+#include "MLDSPFFT.h"
+#include "MLDSPSample.h"
+
+namespace ml
+{
+
+constexpr size_t kDefaultMaxPartitionSize{4096};
+
+namespace convolution
+{
+
+// acc += x * h for spectra in the packed layout of RealFFT, with size floats
+// each. Lane 0 of the vector loop mixes bin 0 with bin size/2, which are both
+// real, so those two are done separately.
+inline void multiplyAccumulate(const float* x, const float* h, float* acc, size_t size)
+{
+  const size_t half = size / 2;
+  float dc = acc[0] + x[0] * h[0];
+  float nyquist = acc[half] + x[half] * h[half];
+  for (size_t k = 0; k < half; k += 4)
+  {
+    float4 xr = loadFloat4(x + k), xi = loadFloat4(x + half + k);
+    float4 hr = loadFloat4(h + k), hi = loadFloat4(h + half + k);
+    storeFloat4(acc + k, loadFloat4(acc + k) + xr * hr - xi * hi);
+    storeFloat4(acc + half + k, loadFloat4(acc + half + k) + xr * hi + xi * hr);
+  }
+  acc[0] = dc;
+  acc[half] = nyquist;
+}
+
+}  // namespace convolution
+
+class ConvolutionIR
+{
+ public:
+  // one uniformly partitioned piece of the impulse response
+  struct Layer
+  {
+    size_t blockSize;    // partition length
+    size_t offset;       // start of the first partition in the IR
+    size_t partitions;   // number of partitions
+    std::shared_ptr<fft::FloatBuffer> spectra;  // partitions * blockSize * 2 floats
+
+    const float* getSpectrum(size_t p) const { return spectra->data() + p * blockSize * 2; }
+  };
+
+  // Make the partitioned spectra of length samples of ir. maxPartitionSize
+  // is rounded to a power of two in [kFramesPerBlock, kMaxFFTSize / 2].
+  ConvolutionIR(const float* ir, size_t length, size_t maxPartitionSize = kDefaultMaxPartitionSize)
+  {
+    make(ir, length, maxPartitionSize);
+  }
+
+  // Use one channel of a Sample as the impulse response. A channel past the
+  // last one uses the last, so that a mono IR can be given to each channel of
+  // a stereo convolution.
+  explicit ConvolutionIR(const Sample& sample, size_t channel = 0,
+                         size_t maxPartitionSize = kDefaultMaxPartitionSize)
+  {
+    size_t frames = getFrames(sample);
+    std::vector<float> ir(frames);
+    if (sample.channels > 0)
+    {
+      channel = std::min(channel, sample.channels - 1);
+      for (size_t i = 0; i < frames; ++i) ir[i] = getConstFramePtr(sample, i)[channel];
+    }
+    make(ir.data(), frames, maxPartitionSize);
+  }
+
+  const std::vector<Layer>& getLayers() const { return layers_; }
+  size_t getLength() const { return length_; }
+
+ private:
+  void make(const float* ir, size_t length, size_t maxPartitionSize)
+  {
+    length_ = length;
+    size_t maxSize = size_t(1) << bitsToContain(int(maxPartitionSize));
+    maxSize = std::clamp(maxSize, size_t(kFramesPerBlock), kMaxFFTSize / 2);
+
+    // Each layer runs until the next, larger layer can start: the output of
+    // a layer with partitions of size b is ready b - kFramesPerBlock samples
+    // after the start of its input, so it must start at least that far into
+    // the IR.
+    size_t offset = 0;
+    size_t blockSize = kFramesPerBlock;
+    while (offset < length)
+    {
+      size_t nextSize = std::min(blockSize * 4, maxSize);
+      size_t end = length;
+      if (nextSize > blockSize) end = std::min(end, std::max(offset + 1, nextSize - kFramesPerBlock));
+      size_t partitions = (end - offset + blockSize - 1) / blockSize;
+      layers_.push_back(makeLayer(ir, length, blockSize, offset, partitions));
+      offset += partitions * blockSize;
+      blockSize = nextSize;
+    }
+  }
+
+  // The spectra include the 1 / fftSize scale of the inverse FFT.
+  static Layer makeLayer(const float* ir, size_t length, size_t blockSize, size_t offset, size_t partitions)
+  {
+    const size_t fftSize = blockSize * 2;
+    Layer layer{blockSize, offset, partitions, std::make_shared<fft::FloatBuffer>(partitions * fftSize)};
+    RealFFT fft(fftSize);
+    fft::FloatBuffer frame(fftSize);
+    const float scale = 1.f / fftSize;
+    for (size_t p = 0; p < partitions; ++p)
+    {
+      std::fill(frame.data(), frame.data() + fftSize, 0.f);
+      size_t start = offset + p * blockSize;
+      size_t n = std::min(blockSize, length - start);
+      for (size_t i = 0; i < n; ++i) frame.data()[i] = ir[start + i] * scale;
+      fft.forward(frame.data(), layer.spectra->data() + p * fftSize);
+    }
+    return layer;
+  }
+
+  size_t length_{0};
+  std::vector<Layer> layers_;
+};
+
+class Convolver
+{
+ public:
+  Convolver() = default;
+  explicit Convolver(std::shared_ptr<const ConvolutionIR> ir) { setImpulseResponse(std::move(ir)); }
+
+  // Set the impulse response and clear. This allocates, so call it from
+  // setup code.
+  void setImpulseResponse(std::shared_ptr<const ConvolutionIR> ir)
+  {
+    ir_ = std::move(ir);
+    layers_.clear();
+    size_t outputSize = kFramesPerBlock;
+    for (const auto& irLayer : ir_->getLayers())
+    {
+      layers_.emplace_back(irLayer);
+      outputSize = std::max(outputSize, irLayer.offset + irLayer.blockSize + kFramesPerBlock);
+    }
+    output_.assign(size_t(1) << bitsToContain(int(outputSize)), 0.f);
+    outputMask_ = output_.size() - 1;
+    clear();
+  }
+
+  void clear()
+  {
+    for (auto& layer : layers_) layer.clear();
+    std::fill(output_.begin(), output_.end(), 0.f);
+    time_ = 0;
+  }
+
+  SignalBlock operator()(const SignalBlock& x)
+  {
+    for (auto& layer : layers_)
+    {
+      if (layer.process(x))
+      {
+        // The finished partition started at time_ + kFramesPerBlock -
+        // blockSize, so its output starts offset samples after that.
+        size_t start = time_ + kFramesPerBlock - layer.ir.blockSize + layer.ir.offset;
+        const float* y = layer.getOutput();
+        for (size_t i = 0; i < layer.ir.blockSize; ++i) output_[(start + i) & outputMask_] += y[i];
+      }
+    }
+
+    SignalBlock y(uninitialized);
+    float* out = output_.data() + (time_ & outputMask_);
+    std::copy(out, out + kFramesPerBlock, y.data());
+    std::fill(out, out + kFramesPerBlock, 0.f);
+    time_ += kFramesPerBlock;
+    return y;
+  }
+
+ private:
+  // the running state of one layer: its input, delay line and accumulator.
+  struct LayerState
+  {
+    ConvolutionIR::Layer ir;
+    RealFFT fft;
+    fft::FloatBuffer input;     // the previous and current input partitions
+    fft::FloatBuffer delayLine; // spectra of the last ir.partitions inputs
+    fft::FloatBuffer acc;
+    fft::FloatBuffer result;
+    size_t steps;               // blocks per partition
+    size_t step{0};
+    size_t newest{0};           // delay line slot of the newest spectrum
+
+    explicit LayerState(const ConvolutionIR::Layer& l)
+        : ir(l),
+          fft(l.blockSize * 2),
+          input(l.blockSize * 2),
+          delayLine(l.partitions * l.blockSize * 2),
+          acc(l.blockSize * 2),
+          result(l.blockSize * 2),
+          steps(l.blockSize / kFramesPerBlock)
+    {
+    }
+
+    void clear()
+    {
+      const size_t fftSize = ir.blockSize * 2;
+      std::fill(input.data(), input.data() + fftSize, 0.f);
+      std::fill(delayLine.data(), delayLine.data() + ir.partitions * fftSize, 0.f);
+      std::fill(acc.data(), acc.data() + fftSize, 0.f);
+      step = 0;
+      newest = 0;
+    }
+
+    // Add a block of input. Returns true when a partition of output is ready.
+    bool process(const SignalBlock& x)
+    {
+      const size_t b = ir.blockSize;
+      const size_t fftSize = b * 2;
+      std::copy(x.data(), x.data() + kFramesPerBlock, input.data() + b + step * kFramesPerBlock);
+
+      // accumulate this step's share of the older partitions
+      const size_t older = ir.partitions - 1;
+      size_t pStart = 1 + older * step / steps;
+      size_t pEnd = 1 + older * (step + 1) / steps;
+      for (size_t p = pStart; p < pEnd; ++p)
+      {
+        size_t slot = (newest + ir.partitions - (p - 1)) % ir.partitions;
+        convolution::multiplyAccumulate(delayLine.data() + slot * fftSize, ir.getSpectrum(p), acc.data(),
+                                        fftSize);
+      }
+
+      if (++step < steps) return false;
+      step = 0;
+
+      // transform the newest input and add its product
+      newest = (newest + 1) % ir.partitions;
+      float* spectrum = delayLine.data() + newest * fftSize;
+      fft.forward(input.data(), spectrum);
+      convolution::multiplyAccumulate(spectrum, ir.getSpectrum(0), acc.data(), fftSize);
+      std::copy(input.data() + b, input.data() + fftSize, input.data());
+
+      // the second half of the inverse is this partition's output
+      fft.inverse(acc.data(), result.data());
+      std::fill(acc.data(), acc.data() + fftSize, 0.f);
+      return true;
+    }
+
+    const float* getOutput() const { return result.data() + ir.blockSize; }
+  };
+
+  std::shared_ptr<const ConvolutionIR> ir_;
+  std::vector<LayerState> layers_;
+  std::vector<float> output_;
+  size_t outputMask_{0};
+  size_t time_{0};
+};
+
+// ConvolverBank runs a Convolver on each row of a SignalBlockArray. The rows
+// can share one impulse response, or each can have its own.
+
+template<int ROWS>
+class ConvolverBank
+{
+ public:
+  void setImpulseResponse(std::shared_ptr<const ConvolutionIR> ir)
+  {
+    for (auto& c : convolvers_) c.setImpulseResponse(ir);
+  }
+
+  void setImpulseResponse(int row, std::shared_ptr<const ConvolutionIR> ir)
+  {
+    convolvers_[row].setImpulseResponse(std::move(ir));
+  }
+
+  void clear()
+  {
+    for (auto& c : convolvers_) c.clear();
+  }
+
+  SignalBlockArray<ROWS> operator()(const SignalBlockArray<ROWS>& x)
+  {
+    SignalBlockArray<ROWS> y(uninitialized);
+    for (int j = 0; j < ROWS; ++j) y.setRow(j, convolvers_[j](x.getRow(j)));
+    return y;
+  }
+
+ private:
+  std::array<Convolver, ROWS> convolvers_;
+};
+
+}  // namespace ml
@@ -12,45 +12,46 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <memory>
 #include <vector>
 
 #include "MLDSPOps.h"
 #include "MLDSPMath.h"
 #include "MLDSPFilters.h"
+#include "MLDSPBank.h"
+#include "MLDSPBuffer.h"
+#include "MLDSPFFT.h"
+#include "MLDSPUtils.h"
 
 namespace ml
 {
 
 
 
-// IntegerDelay delays a signal a whole number of samples.
+// DelayMemory holds the samples of a delay line in a ring that is a power of
+// two in size, followed by a guard region of kFramesPerBlock samples that
+// mirrors the start of the ring. Any run of up to kFramesPerBlock samples
+// that starts inside the ring can be read without wrapping, so blocks are read
+// with one contiguous copy, and interpolating readers can take the neighbours
+// of a sample without masking their indices.
 
-class IntegerDelay
+class DelayMemory
 {
   std::vector<float> mBuffer;
-  int mIntDelayInSamples{0};
   uintptr_t mWriteIndex{0};
   uintptr_t mLengthMask{0};
 
  public:
-  IntegerDelay() = default;
-  IntegerDelay(int d)
-  {
-    setMaxDelayInSamples(static_cast<float>(d));
-    setDelayInSamples(d);
-  }
-  ~IntegerDelay() = default;
-
-  // for efficiency, no bounds checking is done. Because mLengthMask is used to
-  // constrain all reads, bad values here may make bad sounds (buffer wraps) but
-  // will not attempt to read from outside the buffer.
-  inline void setDelayInSamples(int d) { mIntDelayInSamples = d; }
-
-  void setMaxDelayInSamples(float d)
+  // allocate enough memory to read a block with a delay of up to maxDelay
+  // samples, and clear.
+  void resize(int maxDelay)
   {
-    int dMax = static_cast<int>(floorf(d));
-    int newSize = 1 << bitsToContain(dMax + kFramesPerBlock);
-    mBuffer.resize(newSize);
+    int newSize = 1 << bitsToContain(maxDelay + kFramesPerBlock);
+    mBuffer.resize(newSize + kFramesPerBlock);
     mLengthMask = newSize - 1;
     mWriteIndex = 0;
     clear();
@@ -58,90 +59,126 @@ class IntegerDelay
 
   inline void clear() { std::fill(mBuffer.begin(), mBuffer.end(), 0.f); }
 
-  inline SignalBlock operator()(const SignalBlock vx)
+  inline const float* data() const { return mBuffer.data(); }
+  inline uintptr_t getLengthMask() const { return mLengthMask; }
+  inline uintptr_t getWriteIndex() const { return mWriteIndex; }
+
+  // index of the sample d samples before frame n of the block at the write
+  // position. For efficiency, no bounds checking is done, but the mask keeps
+  // all reads inside the buffer.
+  inline uintptr_t getIndex(int n, int d) const { return (mWriteIndex + n - d) & mLengthMask; }
+
+  // write a block at the write position, which may run into the guard
+  // region, and keep the guard region and the start of the ring the same.
+  inline void writeBlock(const float* src)
   {
-    // write
+    float* buf = mBuffer.data();
+    uintptr_t size = mLengthMask + 1;
     uintptr_t writeEnd = mWriteIndex + kFramesPerBlock;
-    if (writeEnd <= mLengthMask + 1)
+    std::copy(src, src + kFramesPerBlock, buf + mWriteIndex);
+    if (writeEnd > size)
     {
-      const float* srcStart = vx.data();
-      std::copy(srcStart, srcStart + kFramesPerBlock, mBuffer.data() + mWriteIndex);
+      std::copy(buf + size, buf + writeEnd, buf);
     }
-    else
+    if (mWriteIndex < kFramesPerBlock)
     {
-      uintptr_t excess = writeEnd - mLengthMask - 1;
-      const float* srcStart = vx.data();
-      const float* srcSplice = srcStart + kFramesPerBlock - excess;
-      const float* srcEnd = srcStart + kFramesPerBlock;
-      std::copy(srcStart, srcSplice, mBuffer.data() + mWriteIndex);
-      std::copy(srcSplice, srcEnd, mBuffer.data());
+      std::copy(buf + mWriteIndex, buf + kFramesPerBlock, buf + size + mWriteIndex);
     }
+  }
 
-    // read
-    SignalBlock vy;
-    uintptr_t readStart = (mWriteIndex - mIntDelayInSamples) & mLengthMask;
-    uintptr_t readEnd = readStart + kFramesPerBlock;
-    float* srcBuf = mBuffer.data();
-    if (readEnd <= mLengthMask + 1)
-    {
-      std::copy(srcBuf + readStart, srcBuf + readEnd, vy.data());
-    }
-    else
-    {
-      uintptr_t excess = readEnd - mLengthMask - 1;
-      uintptr_t readSplice = readStart + kFramesPerBlock - excess;
-      float* pDest = vy.data();
-      std::copy(srcBuf + readStart, srcBuf + readSplice, pDest);
-      std::copy(srcBuf, srcBuf + excess, pDest + (kFramesPerBlock - excess));
-    }
+  // write one sample at the write position, and at its mirror if it has one.
+  // note that, for performance, there is no bounds checking. If you crash
+  // here, you probably didn't allocate enough delay memory.
+  inline void writeSample(float x)
+  {
+    mBuffer[mWriteIndex] = x;
+    mBuffer[mWriteIndex + ((mWriteIndex < kFramesPerBlock) ? mLengthMask + 1 : 0)] = x;
+  }
+
+  inline void advance(uintptr_t frames) { mWriteIndex = (mWriteIndex + frames) & mLengthMask; }
+};
+
+// IntegerDelay delays a signal a whole number of samples.
+
+class IntegerDelay
+{
+  DelayMemory mMemory;
+  int mIntDelayInSamples{0};
 
-    // update index
-    mWriteIndex += kFramesPerBlock;
-    mWriteIndex &= mLengthMask;
+ public:
+  IntegerDelay() = default;
+  IntegerDelay(int d)
+  {
+    setMaxDelayInSamples(static_cast<float>(d));
+    setDelayInSamples(d);
+  }
+  ~IntegerDelay() = default;
+
+  // for efficiency, no bounds checking is done. Because the length mask is
+  // used to constrain all reads, bad values here may make bad sounds (buffer
+  // wraps) but will not attempt to read from outside the buffer.
+  inline void setDelayInSamples(int d) { mIntDelayInSamples = d; }
+  inline int getDelayInSamples() const { return mIntDelayInSamples; }
+
+  void setMaxDelayInSamples(float d) { mMemory.resize(static_cast<int>(floorf(d))); }
+
+  inline void clear() { mMemory.clear(); }
+
+  inline SignalBlock operator()(const SignalBlock vx)
+  {
+    mMemory.writeBlock(vx.data());
+    const float* src = mMemory.data() + mMemory.getIndex(0, mIntDelayInSamples);
+    SignalBlock vy(src);
+    mMemory.advance(kFramesPerBlock);
     return vy;
   }
 
   inline SignalBlock operator()(const SignalBlock x, const SignalBlock delay)
   {
-    SignalBlock y;
+    // the whole block is written first, which is the same as writing each
+    // sample before its read as long as no delay is negative.
+    mMemory.writeBlock(x.data());
 
+    SignalBlock y(uninitialized);
+    const float* buf = mMemory.data();
+    const uintptr_t writeIndex = mMemory.getWriteIndex();
+    const uintptr_t mask = mMemory.getLengthMask();
     for (int n = 0; n < kFramesPerBlock; ++n)
     {
-      // write
-      mBuffer[mWriteIndex] = x[n];
-
-      // read
-      mIntDelayInSamples = static_cast<int>(delay[n]);
-      uintptr_t readIndex = (mWriteIndex - mIntDelayInSamples) & mLengthMask;
-
-      y[n] = mBuffer[readIndex];
-      mWriteIndex++;
-      mWriteIndex &= mLengthMask;
+      y[n] = buf[(writeIndex + n - static_cast<int>(delay[n])) & mask];
     }
-
+    mIntDelayInSamples = static_cast<int>(delay[kFramesPerBlock - 1]);
+    mMemory.advance(kFramesPerBlock);
     return y;
   }
 
   inline float processSample(float x)
   {
-    // write
-    // note that, for performance, there is no bounds checking. If you crash
-    // here, you probably didn't allocate enough delay memory.
-    mBuffer[mWriteIndex] = x;
-
-    // read
-    uintptr_t readIndex = (mWriteIndex - mIntDelayInSamples) & mLengthMask;
-    float y = mBuffer[readIndex];
-
-    // update index
-    mWriteIndex++;
-    mWriteIndex &= mLengthMask;
+    mMemory.writeSample(x);
+    float y = mMemory.data()[mMemory.getIndex(0, mIntDelayInSamples)];
+    mMemory.advance(1);
     return y;
   }
 };
 
 
 
+// Split delay times d into whole samples and the coefficient of a first order
+// allpass for the rest. To minimize modulation noise, the allpass delay is
+// constrained to [0.618 - 1.618] if possible.
+inline void splitAllpassDelay(float4 d, float4& delayInt, float4& coeff)
+{
+  delayInt = intToFloat(floatToIntTruncate(d));
+  float4 delayFrac = d - delayInt;
+  float4 borrow = andBits(delayFrac < float4(0.618f), delayInt > float4(0.f));
+  delayFrac = select(delayFrac + float4(1.f), delayFrac, borrow);
+  delayInt = select(delayInt - float4(1.f), delayInt, borrow);
+
+  // as in Allpass1::makeCoeffs()
+  float4 xm1 = delayFrac - float4(1.f);
+  coeff = float4(-0.53f) * xm1 + float4(0.24f) * xm1 * xm1;
+}
+
 // Combining the integer delay and first order allpass section
 // gives us an allpass-interpolated fractional delay. In general, modulating the
 // delay time will change the allpass coefficient, producing clicks in the
@@ -193,13 +230,10 @@ public:
   // return the input signal, delayed by the varying delay time vDelayInSamples.
   inline SignalBlock operator()(const SignalBlock vx, const SignalBlock vDelayInSamples)
   {
-    SignalBlock vy;
-    for (int n = 0; n < kFramesPerBlock; ++n)
-    {
-      setDelayInSamples(vDelayInSamples[n]);
-      vy[n] = mAllpassSection.nextFrame(mIntegerDelay.processSample(vx[n]));
-    }
-    return vy;
+    SignalBlock vDelayInt(uninitialized), vCoeff(uninitialized);
+    splitDelays(vDelayInSamples, vDelayInt, vCoeff);
+    mDelayInSamples = vDelayInSamples[kFramesPerBlock - 1];
+    return processVarying(vx, vDelayInt, vCoeff);
   }
   
   // return the input signal, delayed by the varying delay time vDelayInSamples,
@@ -207,16 +241,51 @@ public:
   inline SignalBlock operator()(const SignalBlock vx, const SignalBlock vDelayInSamples,
                                 const SignalBlockInt vChangeTicks)
   {
-    SignalBlock vy;
+    SignalBlock vDelayInt(uninitialized), vCoeff(uninitialized);
+    splitDelays(vDelayInSamples, vDelayInt, vCoeff);
+
+    // hold the last delay time set until the next tick
+    float delayInt = static_cast<float>(mIntegerDelay.getDelayInSamples());
+    float coeff = mAllpassSection.coeffs[0];
     for (int n = 0; n < kFramesPerBlock; ++n)
     {
       if (vChangeTicks[n] != 0)
       {
-        setDelayInSamples(vDelayInSamples[n]);
+        mDelayInSamples = vDelayInSamples[n];
+        delayInt = vDelayInt[n];
+        coeff = vCoeff[n];
       }
-      
-      vy[n] = mAllpassSection.nextFrame(mIntegerDelay.processSample(vx[n]));
+      vDelayInt[n] = delayInt;
+      vCoeff[n] = coeff;
+    }
+    return processVarying(vx, vDelayInt, vCoeff);
+  }
+
+ private:
+  // split delay times into integer delays and allpass coefficients, as
+  // setDelayInSamples() does.
+  static void splitDelays(const SignalBlock& vDelay, SignalBlock& vDelayInt, SignalBlock& vCoeff)
+  {
+    for (size_t i = 0; i < kFramesPerBlock; i += 4)
+    {
+      float4 delayInt, coeff;
+      splitAllpassDelay(loadFloat4(vDelay.data() + i), delayInt, coeff);
+      storeFloat4(vDelayInt.data() + i, delayInt);
+      storeFloat4(vCoeff.data() + i, coeff);
     }
+  }
+
+  // read the integer delays for the whole block, then run the allpass with a
+  // coefficient for each sample.
+  inline SignalBlock processVarying(const SignalBlock& vx, const SignalBlock& vDelayInt, const SignalBlock& vCoeff)
+  {
+    SignalBlock vDelayed = mIntegerDelay(vx, vDelayInt);
+    SignalBlock vy(uninitialized);
+    for (int n = 0; n < kFramesPerBlock; ++n)
+    {
+      vy[n] = mAllpassSection.nextFrame(vDelayed[n], {vCoeff[n]});
+    }
+    mAllpassSection.coeffs = {vCoeff[kFramesPerBlock - 1]};
     return vy;
   }
 };
@@ -227,8 +296,8 @@ public:
 namespace PitchbendableDelayConsts
 {
 // period in samples of allpass fade cycle. must be a power of 2 less than or
-// equal to kFramesPerBlock. 32 sounds good.
-constexpr int kFadePeriod{32};
+// equal to kFramesPerBlock. 32 sounds good, shorter blocks use their size.
+constexpr int kFadePeriod{std::min(32, int(kFramesPerBlock))};
 constexpr int fadeRamp(size_t n) { return n % kFadePeriod; }
 constexpr int ticks1(size_t n) { return fadeRamp(n) == kFadePeriod / 2; }
 constexpr int ticks2(size_t n) { return fadeRamp(n) == 0; }
@@ -331,17 +400,481 @@ class Allpass
   }
 };
 
+// Interpolation for reading delay lines at fractional times. kLinear,
+// kHermite (cubic Hermite, or Catmull-Rom), kLagrange (4-point, third order)
+// and kSinc (8-point windowed sinc) are stateless, and read from a
+// DelayMemory with DelayInterpolator. kAllpass is the allpass interpolation
+// of FractionalDelay, which has state for each tap.
+//
+// Peak error for a sine delayed by n + 0.25 or n + 0.5 samples, and the time
+// for a ModulatedDelay block (SSE4.1, about 270 ns for a varying
+// FractionalDelay):
+//
+//              omega 0.02   omega 0.1   omega 0.25   ns per block
+//   kLinear     -54 dB       -26 dB      -14 dB          70
+//   kHermite    -90 dB       -47 dB      -21 dB         130
+//   kLagrange  -104 dB       -49 dB      -22 dB         120
+//   kSinc       -69 dB       -64 dB      -70 dB         250
+//
+// The cubics are best for low frequencies, and the sinc for bright signals.
+// Allpass interpolation has no amplitude error, but its phase error grows
+// with frequency, and it smears fast changes of the delay.
+
+enum class TapInterpolation
+{
+  kLinear,
+  kAllpass,
+  kHermite,
+  kLagrange,
+  kSinc
+};
+
+// DelayInterpolator<INTERP> reads four fractional times at once, one in each
+// lane. kTaps samples are read around each time, starting kTaps / 2 - 1
+// samples before it, and the guard region of DelayMemory lets each lane load
+// them with no masking. So the newest sample read is kTaps / 2 after the
+// read time, and the delay, when the block is written before reading it,
+// must be at least kTaps / 2 - 1.
+
+namespace interpolation
+{
+// load four samples from each lane's start, and transpose so that v[k] holds
+// sample k of every lane.
+inline void loadTaps(const float* buf, int4 start, float4* v)
+{
+  alignas(16) int32_t idx[4];
+  storeInt4(idx, start);
+  for (int k = 0; k < 4; ++k) v[k] = loadFloat4Unaligned(buf + idx[k]);
+  transpose4x4InPlace(v);
+}
+}  // namespace interpolation
+
+template<TapInterpolation INTERP>
+struct DelayInterpolator;
+
+template<>
+struct DelayInterpolator<TapInterpolation::kLinear>
+{
+  static constexpr int kTaps{2};
+  float4 operator()(const float* buf, int4 start, float4 mu) const
+  {
+    float4 v[4];
+    interpolation::loadTaps(buf, start, v);
+    return v[0] + mu * (v[1] - v[0]);
+  }
+};
+
+template<>
+struct DelayInterpolator<TapInterpolation::kHermite>
+{
+  static constexpr int kTaps{4};
+  float4 operator()(const float* buf, int4 start, float4 mu) const
+  {
+    float4 v[4];
+    interpolation::loadTaps(buf, start, v);
+    float4 c1 = float4(0.5f) * (v[2] - v[0]);
+    float4 c2 = v[0] - float4(2.5f) * v[1] + float4(2.f) * v[2] - float4(0.5f) * v[3];
+    float4 c3 = float4(0.5f) * (v[3] - v[0]) + float4(1.5f) * (v[1] - v[2]);
+    return ((c3 * mu + c2) * mu + c1) * mu + v[1];
+  }
+};
+
+template<>
+struct DelayInterpolator<TapInterpolation::kLagrange>
+{
+  static constexpr int kTaps{4};
+  float4 operator()(const float* buf, int4 start, float4 mu) const
+  {
+    float4 v[4];
+    interpolation::loadTaps(buf, start, v);
+    // the Lagrange basis for the points -1, 0, 1, 2
+    float4 a = mu + float4(1.f);
+    float4 c = mu - float4(1.f);
+    float4 d = mu - float4(2.f);
+    float4 ab = a * mu;
+    float4 cd = c * d;
+    return float4(1.f / 6.f) * (ab * c * v[3] - mu * cd * v[0]) + float4(0.5f) * (a * cd * v[1] - ab * d * v[2]);
+  }
+};
+
+// The windowed sinc coefficients come from a table of kPhases + 1 fractional
+// times, interpolated linearly. Each lane is a dot product of its 8 samples
+// with the interpolated coefficients.
+
+template<>
+struct DelayInterpolator<TapInterpolation::kSinc>
+{
+  static constexpr int kTaps{8};
+  static constexpr int kPhases{256};
+  using Table = std::array<float, (kPhases + 1) * kTaps>;
+
+  float4 operator()(const float* buf, int4 start, float4 mu) const
+  {
+    float4 phase = mu * float4(float(kPhases));
+    int4 phaseInt = floatToIntTruncate(min(phase, float4(kPhases - 1.f)));
+    float4 phaseFrac = phase - intToFloat(phaseInt);
+    alignas(16) int32_t idx[4], row[4];
+    alignas(16) float frac[4];
+    storeInt4(idx, start);
+    storeInt4(row, phaseInt);
+    storeFloat4(frac, phaseFrac);
+
+    float4 sums[4];
+    for (int k = 0; k < 4; ++k)
+    {
+      const float* h = mTable.data() + row[k] * kTaps;
+      const float4 f(frac[k]);
+      float4 h0 = loadFloat4(h), h1 = loadFloat4(h + 4);
+      h0 = h0 + f * (loadFloat4(h + kTaps) - h0);
+      h1 = h1 + f * (loadFloat4(h + kTaps + 4) - h1);
+      sums[k] = loadFloat4Unaligned(buf + idx[k]) * h0 + loadFloat4Unaligned(buf + idx[k] + 4) * h1;
+    }
+    transpose4x4InPlace(sums);
+    return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+  }
+
+  // Kaiser-windowed sinc, normalized to unit gain at DC for each phase. A
+  // beta of 6 keeps the error near -64 dB up to a quarter of the sample rate.
+  static const Table& getTable()
+  {
+    alignas(16) static const Table table = [] {
+      auto besselI0 = [](double x) {
+        double sum = 1., term = 1.;
+        for (int k = 1; k < 64 && term > 1e-12 * sum; ++k)
+        {
+          term *= (x / (2. * k)) * (x / (2. * k));
+          sum += term;
+        }
+        return sum;
+      };
+      constexpr double kBeta{6.};
+      Table t;
+      for (int p = 0; p <= kPhases; ++p)
+      {
+        double mu = double(p) / kPhases;
+        double h[kTaps];
+        double sum = 0.;
+        for (int k = 0; k < kTaps; ++k)
+        {
+          double x = k - (kTaps / 2 - 1) - mu;
+          double r = x / (kTaps / 2);
+          double sinc = (x == 0.) ? 1. : std::sin(kPi * x) / (kPi * x);
+          double w = (std::fabs(r) < 1.) ? besselI0(kBeta * std::sqrt(1. - r * r)) / besselI0(kBeta) : 0.;
+          h[k] = sinc * w;
+          sum += h[k];
+        }
+        for (int k = 0; k < kTaps; ++k) t[p * kTaps + k] = float(h[k] / sum);
+      }
+      return t;
+    }();
+    return table;
+  }
+
+ private:
+  const Table& mTable{getTable()};
+};
+
+// ModulatedDelay is a delay line for chorus, flanging and vibrato, with a
+// delay time for every frame. The read positions of four frames at a time
+// are computed in the lanes of float4 vectors and read with a
+// DelayInterpolator. The input block is written before reading, so the delay
+// can be as short as DelayInterpolator<INTERP>::kTaps / 2 - 1 samples, and
+// shorter times are clamped.
+
+template<TapInterpolation INTERP = TapInterpolation::kHermite>
+class ModulatedDelay
+{
+  static_assert(INTERP != TapInterpolation::kAllpass, "ModulatedDelay: use FractionalDelay for allpass interpolation");
+  using Interpolator = DelayInterpolator<INTERP>;
+  static constexpr int kHalfTaps{Interpolator::kTaps / 2};
+
+  DelayMemory mMemory;
+  Interpolator mInterpolate;
+
+ public:
+  static constexpr TapInterpolation kInterpolation{INTERP};
+
+  ModulatedDelay() = default;
+  ModulatedDelay(float maxDelay) { setMaxDelayInSamples(maxDelay); }
+
+  // interpolation reads kHalfTaps samples past the delay time, so that many
+  // more are allocated.
+  inline void setMaxDelayInSamples(float d) { mMemory.resize(static_cast<int>(floorf(d)) + kHalfTaps); }
+
+  inline void clear() { mMemory.clear(); }
+
+  inline SignalBlock operator()(const SignalBlock vx, const SignalBlock vDelayInSamples)
+  {
+    mMemory.writeBlock(vx.data());
+    SignalBlock vy(uninitialized);
+    const float* buf = mMemory.data();
+    const int4 mask(static_cast<int32_t>(mMemory.getLengthMask()));
+    const int4 writeIndex(static_cast<int32_t>(mMemory.getWriteIndex()) - kHalfTaps);
+    const float4 minDelay(float(kHalfTaps - 1));
+    for (int i = 0; i < kFramesPerBlock; i += 4)
+    {
+      // the read time is between the samples before and after
+      // now - delayInt - 1, at mu past it.
+      float4 d = max(loadFloat4(vDelayInSamples.data() + i), minDelay);
+      int4 delayInt = floatToIntTruncate(d);
+      float4 mu = float4(1.f) - (d - intToFloat(delayInt));
+      int4 start = andBits(writeIndex + int4(i, i + 1, i + 2, i + 3) - delayInt, mask);
+      storeFloat4(vy.data() + i, mInterpolate(buf, start, mu));
+    }
+    mMemory.advance(kFramesPerBlock);
+    return vy;
+  }
+};
+
+// MultiTapDelay writes one delay line and reads TAPS taps from it, each with
+// its own delay time in samples for every frame. The taps are read four at a
+// time in the lanes of float4 vectors, with any of the TapInterpolation
+// modes. TAPS must be a multiple of 4. As for ModulatedDelay, the delay
+// times must be at least DelayInterpolator<INTERP>::kTaps / 2 - 1 samples,
+// and shorter times are clamped.
+
+template<size_t TAPS, TapInterpolation INTERP = TapInterpolation::kLinear>
+class MultiTapDelay
+{
+  static_assert(TAPS % 4 == 0, "MultiTapDelay: TAPS must be a multiple of 4");
+  static constexpr size_t kGroups{TAPS / 4};
+
+  static constexpr bool kAllpass{INTERP == TapInterpolation::kAllpass};
+  using Interpolator = DelayInterpolator<kAllpass ? TapInterpolation::kLinear : INTERP>;
+  static constexpr int kHalfTaps{Interpolator::kTaps / 2};
+
+  DelayMemory mMemory;
+  std::array<Allpass1<float4>, kGroups> mAllpasses{};
+  Interpolator mInterpolate;
+
+ public:
+  MultiTapDelay() = default;
+  MultiTapDelay(float maxDelay) { setMaxDelayInSamples(maxDelay); }
+
+  // interpolation reads up to kHalfTaps samples past the delay time, so that
+  // many more are allocated.
+  inline void setMaxDelayInSamples(float d) { mMemory.resize(static_cast<int>(floorf(d)) + kHalfTaps); }
+
+  inline void clear()
+  {
+    mMemory.clear();
+    for (auto& ap : mAllpasses) ap.clear();
+  }
+
+  // write the input and return each tap, delayed by the times in the row of
+  // vDelays with the same index.
+  inline SignalBlockArray<TAPS> operator()(const SignalBlock vx, const SignalBlockArray<TAPS>& vDelays)
+  {
+    mMemory.writeBlock(vx.data());
+    SignalBlockArray<TAPS> vy(uninitialized);
+    SignalBlock4 vTaps(uninitialized);
+    for (size_t g = 0; g < kGroups; ++g)
+    {
+      readGroup(g, vDelays, vTaps);
+      verticalToHorizontal(vTaps.data(), vy.rowPtr(g * 4), 1);
+    }
+    mMemory.advance(kFramesPerBlock);
+    return vy;
+  }
+
+  // write the input and return the sum of the taps, each multiplied by the
+  // gains in its row of vGains.
+  inline SignalBlock operator()(const SignalBlock vx, const SignalBlockArray<TAPS>& vDelays,
+                                const SignalBlockArray<TAPS>& vGains)
+  {
+    mMemory.writeBlock(vx.data());
+    SignalBlock4 vSum(0.f), vTaps(uninitialized), vTapGains(uninitialized);
+    for (size_t g = 0; g < kGroups; ++g)
+    {
+      readGroup(g, vDelays, vTaps);
+      horizontalToVertical(vGains.rowPtr(g * 4), vTapGains.data(), 1);
+      vSum += vTaps * vTapGains;
+    }
+    mMemory.advance(kFramesPerBlock);
+
+    SignalBlock vy(uninitialized);
+    for (int n = 0; n < kFramesPerBlock; ++n)
+    {
+      vy[n] = vecSumH(vSum[n]);
+    }
+    return vy;
+  }
+
+ private:
+  // read taps 4g to 4g + 3 of the block just written into the lanes of vTaps.
+  inline void readGroup(size_t g, const SignalBlockArray<TAPS>& vDelays, SignalBlock4& vTaps)
+  {
+    SignalBlock4 vTapDelays(uninitialized);
+    horizontalToVertical(vDelays.rowPtr(g * 4), vTapDelays.data(), 1);
+
+    const float* buf = mMemory.data();
+    const int4 mask(static_cast<int32_t>(mMemory.getLengthMask()));
+    const float4 minDelay(float(kHalfTaps - 1));
+    alignas(16) int32_t idx[4];
+    for (int n = 0; n < kFramesPerBlock; ++n)
+    {
+      const int4 now(static_cast<int32_t>(mMemory.getWriteIndex()) + n);
+      if constexpr (!kAllpass)
+      {
+        float4 d = max(vTapDelays[n], minDelay);
+        int4 delayInt = floatToIntTruncate(d);
+        float4 mu = float4(1.f) - (d - intToFloat(delayInt));
+        vTaps[n] = mInterpolate(buf, andBits(now - delayInt - int4(kHalfTaps), mask), mu);
+      }
+      else
+      {
+        float4 delayInt, coeff;
+        splitAllpassDelay(vTapDelays[n], delayInt, coeff);
+        storeInt4(idx, andBits(now - floatToIntTruncate(delayInt), mask));
+        float4 x(buf[idx[0]], buf[idx[1]], buf[idx[2]], buf[idx[3]]);
+        vTaps[n] = mAllpasses[g].nextFrame(x, {coeff});
+      }
+    }
+  }
+};
+
+// Mixers for FDN: orthogonal matrices applied in place to each frame of the
+// SIZE rows of a SignalBlockArray.
+
+// HouseholderMixer is the identity matrix minus 2/SIZE. Since multiplying by
+// it can be simplified so much, it costs only a sum and a subtract per row.
+
+template<int SIZE>
+struct HouseholderMixer
+{
+  void operator()(SignalBlockArray<SIZE>& x) const
+  {
+    for (size_t i = 0; i < kFramesPerBlock; i += 4)
+    {
+      float4 sum(0.f);
+      for (int j = 0; j < SIZE; ++j) sum = sum + loadFloat4(x.rowPtr(j) + i);
+      sum = sum * float4(2.f / SIZE);
+      for (int j = 0; j < SIZE; ++j) storeFloat4(x.rowPtr(j) + i, loadFloat4(x.rowPtr(j) + i) - sum);
+    }
+  }
+};
+
+// HadamardMixer is the Walsh-Hadamard matrix scaled by 1/sqrt(SIZE), applied as
+// log2(SIZE) stages of butterflies. Every line feeds every other line with
+// the same gain. SIZE must be a power of two.
+
+template<int SIZE>
+struct HadamardMixer
+{
+  static_assert((SIZE & (SIZE - 1)) == 0, "HadamardMixer: SIZE must be a power of two");
+
+  void operator()(SignalBlockArray<SIZE>& x) const
+  {
+    const float4 scale(1.f / std::sqrt(static_cast<float>(SIZE)));
+    std::array<float4, SIZE> v;
+    for (size_t i = 0; i < kFramesPerBlock; i += 4)
+    {
+      for (int j = 0; j < SIZE; ++j) v[j] = loadFloat4(x.rowPtr(j) + i);
+      for (int h = 1; h < SIZE; h *= 2)
+      {
+        for (int j = 0; j < SIZE; j += h * 2)
+        {
+          for (int k = j; k < j + h; ++k)
+          {
+            float4 a = v[k];
+            float4 b = v[k + h];
+            v[k] = a + b;
+            v[k + h] = a - b;
+          }
+        }
+      }
+      for (int j = 0; j < SIZE; ++j) storeFloat4(x.rowPtr(j) + i, v[j] * scale);
+    }
+  }
+};
+
+// OrthogonalMixer is a dense random orthogonal matrix, applied as a
+// matrix-vector product with float4 frames. The matrix is made from a fixed
+// seed when the mixer is constructed, so each mixer of a given SIZE has the
+// same one, and nothing is computed or allocated when it runs.
+
+template<int SIZE>
+struct OrthogonalMixer
+{
+  using Matrix = std::array<float, SIZE * SIZE>;
+
+  void operator()(SignalBlockArray<SIZE>& x) const
+  {
+    const Matrix& m = mMatrix;
+    std::array<float4, SIZE> v;
+    for (size_t i = 0; i < kFramesPerBlock; i += 4)
+    {
+      for (int j = 0; j < SIZE; ++j) v[j] = loadFloat4(x.rowPtr(j) + i);
+      for (int r = 0; r < SIZE; ++r)
+      {
+        const float* row = m.data() + r * SIZE;
+        float4 sum(0.f);
+        for (int c = 0; c < SIZE; ++c) sum = sum + float4(row[c]) * v[c];
+        storeFloat4(x.rowPtr(r) + i, sum);
+      }
+    }
+  }
+
+  // the elements in row-major order
+  const Matrix& getMatrix() const { return mMatrix; }
+
+ private:
+  Matrix mMatrix{makeMatrix()};
+
+  // Gram-Schmidt orthonormalization of the rows of a random matrix.
+  static Matrix makeMatrix()
+  {
+    RandomScalarSource rand;
+    std::vector<double> a(SIZE * SIZE);
+    for (auto& e : a) e = rand.getFloat();
+    for (int r = 0; r < SIZE; ++r)
+    {
+      double* row = a.data() + r * SIZE;
+      for (int q = 0; q < r; ++q)
+      {
+        const double* prev = a.data() + q * SIZE;
+        double dot = 0.;
+        for (int c = 0; c < SIZE; ++c) dot += row[c] * prev[c];
+        for (int c = 0; c < SIZE; ++c) row[c] -= dot * prev[c];
+      }
+      double norm = 0.;
+      for (int c = 0; c < SIZE; ++c) norm += row[c] * row[c];
+      norm = std::sqrt(norm);
+      for (int c = 0; c < SIZE; ++c) row[c] /= norm;
+    }
+    Matrix m;
+    for (int i = 0; i < SIZE * SIZE; ++i) m[i] = static_cast<float>(a[i]);
+    return m;
+  }
+};
+
 // FDN
-// A general Feedback Delay Network with N delay lines connected in an NxN
-// matrix.
-// TODO DELAY_TYPE parameter for modulation?
+// A general Feedback Delay Network with SIZE delay lines connected through an
+// orthogonal SIZE x SIZE matrix, applied by MIXER. Each line is damped by a
+// one-pole lowpass, run four lines at a time by a FilterBank, and has its own
+// feedback gain. Input row i feeds the lines i, i + IN_ROWS, ... and output
+// row o sums the lines o - 1, o - 1 + OUT_ROWS, ... so that with stereo output
+// the odd lines are on the left and the even lines on the right.
+//
+// Each line's delay time can be modulated by a sine LFO. The LFOs are
+// evaluated once per block and the delay times ramp linearly in between,
+// with the lines read by linear interpolation. Delay times are at least
+// kFramesPerBlock, because each block of the lines is read before the
+// block that feeds back into them is written.
 
-template <int SIZE>
+template<int SIZE, template<int> class MIXER = HouseholderMixer, int IN_ROWS = 1, int OUT_ROWS = 2>
 class FDN
 {
-  std::array<IntegerDelay, SIZE> mDelays;
-  std::array<OnePole<float>, SIZE> mFilters;
-  std::array<SignalBlock, SIZE> mDelayInputVectors{{{SignalBlock(0.f)}}};
+  std::array<DelayMemory, SIZE> mMemories;
+  FilterBank<OnePole, SIZE> mFilters;
+  MIXER<SIZE> mMixer;
+  SignalBlockArray<SIZE> mLines;
+
+  std::array<float, SIZE> mDelayTimes;
+  std::array<float, SIZE> mPrevDelays;
+  std::array<float, SIZE> mModPhases;
+  std::array<float, SIZE> mModSteps{};
+  float mModDepth{0.f};
 
  public:
   // feedback gains array is public—just copy values to set.
@@ -351,104 +884,334 @@ class FDN
   {
     static constexpr size_t kDefaultMaxDelay{128};
     setMaxDelayInSamples(kDefaultMaxDelay);
+    mDelayTimes.fill(float(kFramesPerBlock));
+    mPrevDelays.fill(float(kFramesPerBlock));
+    for (int n = 0; n < SIZE; ++n) mModPhases[n] = float(n) / SIZE;
   }
 
+  // set the longest delay time, including modulation, and clear.
   void setMaxDelayInSamples(size_t d)
   {
-    for (auto& delay : mDelays)
+    for (auto& m : mMemories)
     {
-      delay.setMaxDelayInSamples(d);
+      // one more sample for the linear interpolation
+      m.resize(static_cast<int>(d) + 1);
     }
+    mFilters.clear();
   }
   
   void setDelaysInSamples(std::array<float, SIZE> times)
+  {
+    mDelayTimes = times;
+  }
+  
+  void setFilterCutoffs(std::array<float, SIZE> omegas)
   {
     for (int n = 0; n < SIZE; ++n)
     {
-      // we have one SignalBlock feedback latency, so compensate delay times for
-      // that.
-      int len = times[n] - kFramesPerBlock;
-      len = std::max(1, len);
-      mDelays[n].setDelayInSamples(len);
+      mFilters.setVoiceParams(n, {omegas[n]});
     }
   }
-  
-  void setFilterCutoffs(std::array<float, SIZE> omegas)
+
+  // Modulate the delay times by up to depth samples, with LFOs near the
+  // frequency omega. The LFO frequencies are spread over omega * [0.75, 1.25]
+  // so that the lines do not move together.
+  void setModulation(float depth, float omega)
   {
+    mModDepth = depth;
     for (int n = 0; n < SIZE; ++n)
     {
-      mFilters[n].coeffs = ml::OnePole<float>::makeCoeffs(omegas[n]);
+      float spread = 0.75f + 0.5f * ((n * 0.618034f) - floorf(n * 0.618034f));
+      mModSteps[n] = omega * spread * kFramesPerBlock;
     }
   }
 
-  // stereo output function
-  // TODO generalize n-channel output function somehow
-  SignalBlockArray<2> operator()(const SignalBlock x)
+  void clear()
   {
-    // run delays, getting SignalBlock for each delay
+    for (auto& m : mMemories) m.clear();
+    mFilters.clear();
+  }
+
+  SignalBlockArray<OUT_ROWS> operator()(const SignalBlockArray<IN_ROWS>& x)
+  {
+    // read the lines
     for (int n = 0; n < SIZE; ++n)
     {
-      mDelayInputVectors[n] = mDelays[n](mDelayInputVectors[n]);
+      readLine(n);
     }
 
-    // get output sum
-    SignalBlock sumR, sumL;
-    for (int n = 0; n < (SIZE & (~1)); ++n)
+    // get output sums
+    SignalBlockArray<OUT_ROWS> y;
+    for (int n = 0; n < SIZE; ++n)
     {
-      if (n & 1)
-      {
-        sumL += mDelayInputVectors[n];
-      }
-      else
+      y.row((n + 1) % OUT_ROWS) += mLines.getRow(n);
+    }
+
+    // inputs = input gains*input sample + filters(M*delay outputs)
+    mMixer(mLines);
+    mLines = mFilters.processVoices(mLines);
+    for (int n = 0; n < SIZE; ++n)
+    {
+      float* line = mLines.rowPtr(n);
+      const float* input = x.rowPtr(n % IN_ROWS);
+      const float4 gain(mFeedbackGains[n]);
+      for (size_t i = 0; i < kFramesPerBlock; i += 4)
       {
-        sumR += mDelayInputVectors[n];
+        storeFloat4(line + i, loadFloat4(line + i) * gain + loadFloat4(input + i));
       }
+      mMemories[n].writeBlock(line);
+      mMemories[n].advance(kFramesPerBlock);
     }
 
-    // inputs = input gains*input sample + filters(M*delay outputs)
-    // The feedback matrix M is a unit-gain Householder matrix, which is just
-    // the identity matrix minus a constant k, where k = 2/size. Since
-    // multiplying this can be simplified so much, you just see a few operations
-    // here, not a general matrix multiply.
+    return y;
+  }
 
-    SignalBlock sumOfDelays;
-    for (int n = 0; n < SIZE; ++n)
+ private:
+  // Read a block of line n into mLines, with the delay time ramping from
+  // the end of the last block to the current time and LFO position.
+  void readLine(int n)
+  {
+    float delay = mDelayTimes[n];
+    if (mModDepth > 0.f)
     {
-      sumOfDelays += mDelayInputVectors[n];
+      mModPhases[n] += mModSteps[n];
+      mModPhases[n] -= floorf(mModPhases[n]);
+      delay += mModDepth * sinf(kTwoPi * mModPhases[n]);
     }
-    sumOfDelays *= SignalBlock(2.0f / SIZE);
+    delay = std::max(delay, float(kFramesPerBlock));
+    float start = mPrevDelays[n];
+    mPrevDelays[n] = delay;
 
-    for (int n = 0; n < SIZE; ++n)
+    // the delay reaches its new value at the last frame.
+    const DelayMemory& m = mMemories[n];
+    const float* buf = m.data();
+    const int4 mask(static_cast<int32_t>(m.getLengthMask()));
+    const int4 writeIndex(static_cast<int32_t>(m.getWriteIndex()));
+    const float4 step((delay - start) / kFramesPerBlock);
+    const DelayInterpolator<TapInterpolation::kLinear> interpolate;
+    for (int i = 0; i < kFramesPerBlock; i += 4)
+    {
+      const int4 frames(i, i + 1, i + 2, i + 3);
+      float4 d = float4(start) + step * (intToFloat(frames) + float4(1.f));
+      int4 delayInt = floatToIntTruncate(d);
+      float4 mu = float4(1.f) - (d - intToFloat(delayInt));
+      storeFloat4(mLines.rowPtr(n) + i, interpolate(buf, andBits(writeIndex + frames - delayInt - int4(1), mask), mu));
+    }
+  }
+};
+
+// SpectralFrames holds one complex spectrum per row, as split arrays of real
+// and imaginary parts for bins 0 ... fftSize/2.
+
+template<int ROWS>
+class SpectralFrames
+{
+ public:
+  void resize(size_t fftSize)
+  {
+    mBins = fftSize / 2 + 1;
+    mStride = (mBins + 3) & ~size_t(3);
+    mData.assign(ROWS * mStride * 2 / 4, float4(0.f));
+  }
+
+  size_t getNumBins() const { return mBins; }
+
+  float* real(int row) { return data() + 2 * row * mStride; }
+  float* imag(int row) { return data() + (2 * row + 1) * mStride; }
+  const float* real(int row) const { return data() + 2 * row * mStride; }
+  const float* imag(int row) const { return data() + (2 * row + 1) * mStride; }
+
+  // unpack a RealFFT spectrum to a row.
+  void fromPacked(int row, const float* f)
+  {
+    const size_t half = mBins - 1;
+    float* re = real(row);
+    float* im = imag(row);
+    for (size_t k = 0; k < half; k += 4)
+    {
+      storeFloat4(re + k, loadFloat4(f + k));
+      storeFloat4(im + k, -loadFloat4(f + half + k));
+    }
+    re[half] = f[half];
+    im[0] = im[half] = 0.f;
+  }
+
+  // pack a row to a RealFFT spectrum. The imaginary parts of bins 0 and
+  // fftSize/2 are dropped.
+  void toPacked(int row, float* f) const
+  {
+    const size_t half = mBins - 1;
+    const float* re = real(row);
+    const float* im = imag(row);
+    for (size_t k = 0; k < half; k += 4)
     {
-      mDelayInputVectors[n] -= (sumOfDelays);
-      mDelayInputVectors[n] = mFilters[n](mDelayInputVectors[n]) * SignalBlock(mFeedbackGains[n]);
-      mDelayInputVectors[n] += x;
+      storeFloat4(f + k, loadFloat4(re + k));
+      storeFloat4(f + half + k, -loadFloat4(im + k));
     }
+    f[half] = re[half];
+  }
 
-    return concatRows(sumL, sumR);
+  void copyRow(int row, const float* re, const float* im)
+  {
+    std::copy(re, re + mStride, real(row));
+    std::copy(im, im + mStride, imag(row));
   }
+
+  void clearRow(int row)
+  {
+    std::fill(real(row), real(row) + mStride, 0.f);
+    std::fill(imag(row), imag(row) + mStride, 0.f);
+  }
+
+ private:
+  float* data() { return reinterpret_cast<float*>(mData.data()); }
+  const float* data() const { return reinterpret_cast<const float*>(mData.data()); }
+
+  size_t mBins{0};
+  size_t mStride{0};
+  std::vector<float4> mData;
 };
 
+// OverlapAddFunction is a short-time Fourier transform engine. Given a
+// spectral function fn, it cuts each row of the input into windowed frames
+// of fftSize samples every hop samples, transforms them, calls
+// fn(const SpectralFrames<IN_ROWS>& in, SpectralFrames<OUT_ROWS>& out), then
+// transforms the out spectra back and overlap-adds them to the output.
+//
+// out starts as a copy of in, with any extra rows zeroed, so a function that
+// does nothing passes the input through. The same window is used for analysis
+// and synthesis, and the synthesis window is normalized so that the windows'
+// overlapping products sum to one for any hop. The output is delayed by
+// fftSize samples.
+//
+// All memory is allocated in setup(). The spectral function is a template
+// parameter rather than a std::function so that passing a lambda does not
+// allocate either.
+
+template<int IN_ROWS, int OUT_ROWS = IN_ROWS>
+class OverlapAddFunction
+{
+  using inputType = const SignalBlockArray<IN_ROWS>;
+  using outputType = SignalBlockArray<OUT_ROWS>;
 
-// OverlapAddFunction TODO
-/*
- template<int LENGTH, int DIVISIONS, int IN_ROWS, int OUT_ROWS>
- class OverlapAddFunction
- {
- typedef std::function<SignalBlockArray<OUT_ROWS>(const
- SignalBlockArray<IN_ROWS>)> ProcessFn;
- 
  public:
- inline SignalBlockArray<OUT_ROWS> operator()(ProcessFn fn, const
- SignalBlockArray<IN_ROWS> vx)
- {
- }
- 
+  OverlapAddFunction(size_t fftSize = 1024, size_t hop = 256, Projection window = dspwindows::raisedCosine)
+  {
+    setup(fftSize, hop, window);
+  }
+
+  // fftSize must be a valid RealFFT size and hop must be in [1, fftSize].
+  void setup(size_t fftSize, size_t hop, Projection window)
+  {
+    assert(isValidFFTSize(fftSize));
+    mFFTSize = fftSize;
+    mHop = std::clamp(hop, size_t(1), fftSize);
+    mFFT = std::make_unique<RealFFT>(fftSize);
+    mFrame = std::make_unique<fft::FloatBuffer>(fftSize);
+    mSpectrum = std::make_unique<fft::FloatBuffer>(fftSize);
+    mAnalysisWindow = std::make_unique<fft::FloatBuffer>(fftSize);
+    mSynthesisWindow = std::make_unique<fft::FloatBuffer>(fftSize);
+    mInFrames.resize(fftSize);
+    mOutFrames.resize(fftSize);
+
+    // sum the squared window over each phase of the hop, and divide it out of
+    // the synthesis window along with the fftSize scale of the inverse FFT.
+    float* wa = mAnalysisWindow->data();
+    float* ws = mSynthesisWindow->data();
+    makeWindow(wa, fftSize, window);
+    std::vector<float> overlapSum(mHop, 0.f);
+    for (size_t n = 0; n < fftSize; ++n) overlapSum[n % mHop] += wa[n] * wa[n];
+    for (size_t n = 0; n < fftSize; ++n)
+    {
+      float s = overlapSum[n % mHop];
+      ws[n] = (s > 0.f) ? wa[n] / (s * fftSize) : 0.f;
+    }
+
+    for (auto& b : mInBuffers) b.resize(int(fftSize + kFramesPerBlock));
+    for (auto& b : mOutBuffers) b.resize(int(2 * (fftSize + mHop) + kFramesPerBlock));
+    clear();
+  }
+
+  size_t getFFTSize() const { return mFFTSize; }
+  size_t getHop() const { return mHop; }
+  size_t getLatency() const { return mFFTSize; }
+
+  void clear()
+  {
+    for (auto& b : mInBuffers) b.clear();
+
+    // Start the output with fftSize samples of silence. The overlap-add
+    // always finishes at least (input so far - fftSize) samples, so reads
+    // never run dry.
+    float* frame = mFrame->data();
+    std::fill(frame, frame + mFFTSize, 0.f);
+    for (auto& b : mOutBuffers)
+    {
+      b.clearToZero();
+      b.write(frame, mFFTSize);
+    }
+  }
+
+  template<typename ProcessFn>
+  inline outputType operator()(ProcessFn&& fn, inputType vx)
+  {
+    for (int j = 0; j < IN_ROWS; ++j) mInBuffers[j].write(vx.rowPtr(j), kFramesPerBlock);
+
+    float* frame = mFrame->data();
+    float* spectrum = mSpectrum->data();
+    const size_t overlap = mFFTSize - mHop;
+    while (mInBuffers[0].getReadAvailable() >= mFFTSize)
+    {
+      for (int j = 0; j < IN_ROWS; ++j)
+      {
+        mInBuffers[j].readWithOverlap(frame, mFFTSize, overlap);
+        applyWindow(frame, mAnalysisWindow->data());
+        mFFT->forward(frame, spectrum);
+        mInFrames.fromPacked(j, spectrum);
+      }
+      for (int j = 0; j < OUT_ROWS; ++j)
+      {
+        if (j < IN_ROWS)
+          mOutFrames.copyRow(j, mInFrames.real(j), mInFrames.imag(j));
+        else
+          mOutFrames.clearRow(j);
+      }
+
+      fn(static_cast<const SpectralFrames<IN_ROWS>&>(mInFrames), mOutFrames);
+
+      for (int j = 0; j < OUT_ROWS; ++j)
+      {
+        mOutFrames.toPacked(j, spectrum);
+        mFFT->inverse(spectrum, frame);
+        applyWindow(frame, mSynthesisWindow->data());
+        mOutBuffers[j].writeWithOverlapAdd(frame, mFFTSize, overlap);
+      }
+    }
+
+    outputType vy(uninitialized);
+    for (int j = 0; j < OUT_ROWS; ++j) mOutBuffers[j].read(vy.rowPtr(j), kFramesPerBlock);
+    return vy;
+  }
+
  private:
- //Matrix mHistory;
- const SignalBlock& mWindow;
- };
- */
+  void applyWindow(float* frame, const float* window)
+  {
+    for (size_t i = 0; i < mFFTSize; i += 4)
+      storeFloat4(frame + i, loadFloat4(frame + i) * loadFloat4(window + i));
+  }
+
+  size_t mFFTSize{0};
+  size_t mHop{0};
+  std::unique_ptr<RealFFT> mFFT;
+  std::unique_ptr<fft::FloatBuffer> mFrame;
+  std::unique_ptr<fft::FloatBuffer> mSpectrum;
+  std::unique_ptr<fft::FloatBuffer> mAnalysisWindow;
+  std::unique_ptr<fft::FloatBuffer> mSynthesisWindow;
+  SpectralFrames<IN_ROWS> mInFrames;
+  SpectralFrames<OUT_ROWS> mOutFrames;
+  std::array<DSPBuffer, IN_ROWS> mInBuffers;
+  std::array<DSPBuffer, OUT_ROWS> mOutBuffers;
+};
 
 // FeedbackDelayFunction
 // Wraps a function in a pitchbendable delay with feedback per row.
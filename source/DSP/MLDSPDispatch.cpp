@@ -0,0 +1,264 @@
+// madronalib: a C++ framework for DSP applications.
+// Copyright (c) 2026 Madrona Labs LLC. http://www.madronalabs.com
+// Distributed under the MIT license: http://madrona-labs.mit-license.org/
+
+#include "MLDSPDispatch.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define ML_DISPATCH_X86 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace ml
+{
+
+namespace
+{
+
+// the instruction set compiled into the headers
+constexpr SIMDInstructionSet kCompiledInstructionSet
+{
+#if (defined __ARM_NEON) || (defined __ARM_NEON__)
+  SIMDInstructionSet::kNEON
+#elif defined(ML_SIMD_AVX512)
+  SIMDInstructionSet::kAVX512
+#elif defined(ML_SIMD_AVX2)
+  SIMDInstructionSet::kAVX2
+#else
+  SIMDInstructionSet::kSSE41
+#endif
+};
+
+}  // namespace
+
+const char* getSIMDInstructionSetName(SIMDInstructionSet isa)
+{
+  switch (isa)
+  {
+    case SIMDInstructionSet::kSSE41:
+      return "SSE4.1";
+    case SIMDInstructionSet::kAVX2:
+      return "AVX2";
+    case SIMDInstructionSet::kAVX512:
+      return "AVX-512";
+    case SIMDInstructionSet::kNEON:
+      return "NEON";
+  }
+  return "unknown";
+}
+
+#if defined(ML_SIMD_DISPATCH)
+
+// ----------------------------------------------------------------
+// CPU feature detection
+
+namespace
+{
+
+#if defined(ML_DISPATCH_X86)
+
+struct CPUIDRegs
+{
+  uint32_t eax{0}, ebx{0}, ecx{0}, edx{0};
+};
+
+CPUIDRegs cpuid(uint32_t leaf, uint32_t subleaf)
+{
+  CPUIDRegs r;
+#if defined(_MSC_VER)
+  int regs[4];
+  __cpuidex(regs, static_cast<int>(leaf), static_cast<int>(subleaf));
+  r.eax = regs[0];
+  r.ebx = regs[1];
+  r.ecx = regs[2];
+  r.edx = regs[3];
+#else
+  __cpuid_count(leaf, subleaf, r.eax, r.ebx, r.ecx, r.edx);
+#endif
+  return r;
+}
+
+// the register state the OS saves and restores, from XCR0
+uint64_t getXCR0()
+{
+#if defined(_MSC_VER)
+  return _xgetbv(0);
+#else
+  uint32_t lo, hi;
+  __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+  return (static_cast<uint64_t>(hi) << 32) | lo;
+#endif
+}
+
+bool hasBit(uint32_t reg, int bit) { return (reg >> bit) & 1; }
+
+// Both the CPU and the OS must support an instruction set before we can use it:
+// the OS has to save the wider registers on context switches.
+SIMDInstructionSet detectBestInstructionSet()
+{
+  if (cpuid(0, 0).eax < 7) return SIMDInstructionSet::kSSE41;
+
+  CPUIDRegs leaf1 = cpuid(1, 0);
+  bool osxsave = hasBit(leaf1.ecx, 27);
+  bool avx = hasBit(leaf1.ecx, 28);
+  bool fma = hasBit(leaf1.ecx, 12);
+  if (!(osxsave && avx && fma)) return SIMDInstructionSet::kSSE41;
+
+  uint64_t xcr0 = getXCR0();
+  constexpr uint64_t kYMMState = 0x6;    // SSE and AVX registers
+  constexpr uint64_t kZMMState = 0xE6;   // plus opmask and upper ZMM registers
+  if ((xcr0 & kYMMState) != kYMMState) return SIMDInstructionSet::kSSE41;
+
+  CPUIDRegs leaf7 = cpuid(7, 0);
+  bool avx2 = hasBit(leaf7.ebx, 5);
+  bool avx512f = hasBit(leaf7.ebx, 16);
+  bool avx512dq = hasBit(leaf7.ebx, 17);
+  bool avx512bw = hasBit(leaf7.ebx, 30);
+  bool avx512vl = hasBit(leaf7.ebx, 31);
+  if (!avx2) return SIMDInstructionSet::kSSE41;
+
+  if (avx512f && avx512dq && avx512bw && avx512vl && ((xcr0 & kZMMState) == kZMMState))
+  {
+    return SIMDInstructionSet::kAVX512;
+  }
+  return SIMDInstructionSet::kAVX2;
+}
+
+#else
+
+SIMDInstructionSet detectBestInstructionSet() { return SIMDInstructionSet::kNEON; }
+
+#endif
+
+// ----------------------------------------------------------------
+// runtime dispatch
+
+std::atomic<SIMDInstructionSet> gSelectedInstructionSet{kCompiledInstructionSet};
+
+const DSPKernels* getKernelsFor(SIMDInstructionSet isa)
+{
+  switch (isa)
+  {
+    case SIMDInstructionSet::kAVX512:
+      return getDSPKernelsAVX512();
+    case SIMDInstructionSet::kAVX2:
+      return getDSPKernelsAVX2();
+    default:
+      return getDSPKernelsBaseline();
+  }
+}
+
+bool isSupported(SIMDInstructionSet isa)
+{
+  if (!getKernelsFor(isa)) return false;
+  SIMDInstructionSet best = detectBestInstructionSet();
+  if (best == SIMDInstructionSet::kNEON) return isa == SIMDInstructionSet::kNEON;
+  if (isa == SIMDInstructionSet::kNEON) return false;
+  return static_cast<int>(isa) <= static_cast<int>(best);
+}
+
+void install(SIMDInstructionSet isa)
+{
+  gSelectedInstructionSet.store(isa, std::memory_order_relaxed);
+  gDSPKernels.store(getKernelsFor(isa), std::memory_order_relaxed);
+}
+
+// Select and install the best kernels. Threads racing here all compute the
+// same answer, so the race is harmless.
+const DSPKernels& resolve()
+{
+  install(detectBestInstructionSet());
+  return getDSPKernels();
+}
+
+// The initial table: each entry resolves the real table, then forwards the call.
+
+#define ML_RESOLVE_F2F(name, expr) \
+void name##Resolve(const float* a, float* r, size_t n) { resolve().name(a, r, n); }
+#define ML_RESOLVE_FF2F(name, expr) \
+void name##Resolve(const float* a, const float* b, float* r, size_t n) { resolve().name(a, b, r, n); }
+#define ML_RESOLVE_FFF2F(name, expr) \
+void name##Resolve(const float* a, const float* b, const float* c, float* r, size_t n) \
+{ resolve().name(a, b, c, r, n); }
+#define ML_RESOLVE_II2I(name, expr) \
+void name##Resolve(const int32_t* a, const int32_t* b, int32_t* r, size_t n) { resolve().name(a, b, r, n); }
+#define ML_RESOLVE_FF2F_MS(name, expr) \
+void name##Resolve(const float* a, const float* b, float* r, size_t rows, size_t rowSize) \
+{ resolve().name(a, b, r, rows, rowSize); }
+#define ML_RESOLVE_F2I(name, expr) \
+void name##Resolve(const float* a, int32_t* r, size_t n) { resolve().name(a, r, n); }
+#define ML_RESOLVE_I2F(name, expr) \
+void name##Resolve(const int32_t* a, float* r, size_t n) { resolve().name(a, r, n); }
+
+ML_DSP_OPS_F2F(ML_RESOLVE_F2F)
+ML_DSP_OPS_FF2F(ML_RESOLVE_FF2F)
+ML_DSP_OPS_FFF2F(ML_RESOLVE_FFF2F)
+ML_DSP_OPS_II2I(ML_RESOLVE_II2I)
+ML_DSP_OPS_FF2F_MS(ML_RESOLVE_FF2F_MS)
+ML_DSP_OPS_F2I(ML_RESOLVE_F2I)
+ML_DSP_OPS_I2F(ML_RESOLVE_I2F)
+
+void sincosResolve(const float* x, float* s, float* c, size_t n) { resolve().sincos(x, s, c, n); }
+void transpose4x4BlocksResolve(float* p, size_t numBlocks) { resolve().transpose4x4Blocks(p, numBlocks); }
+void verticalToHorizontalResolve(const float* src, float* dest, size_t rows, size_t framesPerRow)
+{
+  resolve().verticalToHorizontal(src, dest, rows, framesPerRow);
+}
+void horizontalToVerticalResolve(const float* src, float* dest, size_t rows, size_t framesPerRow)
+{
+  resolve().horizontalToVertical(src, dest, rows, framesPerRow);
+}
+
+#define ML_RESOLVE_ENTRY(name, expr) &name##Resolve,
+
+constexpr DSPKernels kResolverKernels{
+  ML_DSP_OPS_F2F(ML_RESOLVE_ENTRY)
+  ML_DSP_OPS_FF2F(ML_RESOLVE_ENTRY)
+  ML_DSP_OPS_FFF2F(ML_RESOLVE_ENTRY)
+  ML_DSP_OPS_II2I(ML_RESOLVE_ENTRY)
+  ML_DSP_OPS_FF2F_MS(ML_RESOLVE_ENTRY)
+  ML_DSP_OPS_F2I(ML_RESOLVE_ENTRY)
+  ML_DSP_OPS_I2F(ML_RESOLVE_ENTRY)
+  &sincosResolve,
+  &transpose4x4BlocksResolve,
+  &verticalToHorizontalResolve,
+  &horizontalToVerticalResolve
+};
+
+}  // namespace
+
+std::atomic<const DSPKernels*> gDSPKernels{&kResolverKernels};
+
+SIMDInstructionSet getSIMDInstructionSet()
+{
+  if (gDSPKernels.load(std::memory_order_relaxed) == &kResolverKernels) resolve();
+  return gSelectedInstructionSet.load(std::memory_order_relaxed);
+}
+
+bool isSIMDInstructionSetSupported(SIMDInstructionSet isa) { return isSupported(isa); }
+
+bool setSIMDInstructionSet(SIMDInstructionSet isa)
+{
+  if (!isSupported(isa)) return false;
+  install(isa);
+  return true;
+}
+
+#else
+
+// ----------------------------------------------------------------
+// single instruction set, chosen at compile time
+
+SIMDInstructionSet getSIMDInstructionSet() { return kCompiledInstructionSet; }
+
+bool isSIMDInstructionSetSupported(SIMDInstructionSet isa) { return isa == kCompiledInstructionSet; }
+
+bool setSIMDInstructionSet(SIMDInstructionSet) { return false; }
+
+#endif
+
+}  // namespace ml
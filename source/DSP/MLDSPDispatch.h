@@ -0,0 +1,113 @@
+// madronalib: a C++ framework for DSP applications.
+// Copyright (c) 2026 Madrona Labs LLC. http://www.madronalabs.com
+// Distributed under the MIT license: http://madrona-labs.mit-license.org/
+
+// MLDSPDispatch.h
+// Runtime selection of the SIMD instruction set for the stateless block kernels.
+//
+// When the library is configured with ML_SIMD_ISA=DISPATCH, the headers are
+// compiled for the float4 baseline (SSE 4.1 or NEON) and the operations listed
+// in MLDSPOpList.h, plus the transposes and the cephes sincos, are also compiled
+// for AVX2 and AVX-512 in separate translation units. The first call through
+// the kernel table reads CPUID, picks the widest instruction set the CPU and OS
+// support, and swaps in that table. After that, each block operation costs one
+// pointer load and an indirect call.
+//
+// In builds configured for a single instruction set the kernel table is not
+// used, and getSIMDInstructionSet() reports the one compiled in.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "MLDSPOpList.h"
+
+namespace ml
+{
+
+enum class SIMDInstructionSet
+{
+  kSSE41 = 0,
+  kAVX2 = 1,
+  kAVX512 = 2,
+  kNEON = 3
+};
+
+// The instruction set used by the block operations. Call this at startup to log it.
+SIMDInstructionSet getSIMDInstructionSet();
+
+// Readable name of the instruction set: "SSE4.1", "AVX2", "AVX-512" or "NEON".
+const char* getSIMDInstructionSetName(SIMDInstructionSet isa);
+inline const char* getSIMDInstructionSetName() { return getSIMDInstructionSetName(getSIMDInstructionSet()); }
+
+// True if the kernels for the given instruction set are compiled in and the
+// CPU and OS can run them.
+bool isSIMDInstructionSetSupported(SIMDInstructionSet isa);
+
+// Switch the block kernels to the given instruction set, for testing and
+// benchmarking. Returns false and changes nothing if the instruction set is
+// not supported, or if this build does not use runtime dispatch. Not safe to
+// call while other threads are running block operations.
+bool setSIMDInstructionSet(SIMDInstructionSet isa);
+
+// ----------------------------------------------------------------
+// Kernel table. Sizes are in elements and must be multiples of 4. Pointers
+// must be 16-byte aligned; the wider kernels use unaligned loads and stores.
+
+struct DSPKernels
+{
+#define ML_KERNEL_F2F(name, expr) void (*name)(const float* a, float* r, size_t n);
+#define ML_KERNEL_FF2F(name, expr) void (*name)(const float* a, const float* b, float* r, size_t n);
+#define ML_KERNEL_FFF2F(name, expr) \
+  void (*name)(const float* a, const float* b, const float* c, float* r, size_t n);
+#define ML_KERNEL_II2I(name, expr) void (*name)(const int32_t* a, const int32_t* b, int32_t* r, size_t n);
+#define ML_KERNEL_FF2F_MS(name, expr) \
+  void (*name)(const float* a, const float* b, float* r, size_t rows, size_t rowSize);
+#define ML_KERNEL_F2I(name, expr) void (*name)(const float* a, int32_t* r, size_t n);
+#define ML_KERNEL_I2F(name, expr) void (*name)(const int32_t* a, float* r, size_t n);
+
+  ML_DSP_OPS_F2F(ML_KERNEL_F2F)
+  ML_DSP_OPS_FF2F(ML_KERNEL_FF2F)
+  ML_DSP_OPS_FFF2F(ML_KERNEL_FFF2F)
+  ML_DSP_OPS_II2I(ML_KERNEL_II2I)
+  ML_DSP_OPS_FF2F_MS(ML_KERNEL_FF2F_MS)
+  ML_DSP_OPS_F2I(ML_KERNEL_F2I)
+  ML_DSP_OPS_I2F(ML_KERNEL_I2F)
+
+#undef ML_KERNEL_F2F
+#undef ML_KERNEL_FF2F
+#undef ML_KERNEL_FFF2F
+#undef ML_KERNEL_II2I
+#undef ML_KERNEL_FF2F_MS
+#undef ML_KERNEL_F2I
+#undef ML_KERNEL_I2F
+
+  // sine and cosine of each element of x
+  void (*sincos)(const float* x, float* s, float* c, size_t n);
+
+  // transpose each of the numBlocks consecutive 4x4 blocks at p in place
+  void (*transpose4x4Blocks)(float* p, size_t numBlocks);
+
+  // Convert rows of vertical float4 frames to four horizontal rows each, as
+  // verticalToHorizontal() in MLDSPOps.h, and back. framesPerRow counts float4 frames.
+  void (*verticalToHorizontal)(const float* src, float* dest, size_t rows, size_t framesPerRow);
+  void (*horizontalToVertical)(const float* src, float* dest, size_t rows, size_t framesPerRow);
+};
+
+// The active table. Until the instruction set is chosen this points to a table
+// of resolvers that choose it on first use, so no static initialization is
+// needed and the kernels are safe to call from other static initializers. The
+// tables themselves are constants, so a relaxed load is enough.
+extern std::atomic<const DSPKernels*> gDSPKernels;
+
+inline const DSPKernels& getDSPKernels() { return *gDSPKernels.load(std::memory_order_relaxed); }
+
+// The kernel table for each instruction set, defined in the MLDSPKernels*.cpp files.
+// The AVX2 and AVX-512 tables are null on platforms where they are not compiled.
+const DSPKernels* getDSPKernelsBaseline();
+const DSPKernels* getDSPKernelsAVX2();
+const DSPKernels* getDSPKernelsAVX512();
+
+}  // namespace ml
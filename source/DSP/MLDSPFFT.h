@@ -0,0 +1,429 @@
+// madronalib: a C++ framework for DSP applications.
+// Copyright (c) 2026 Madrona Labs LLC. http://www.madronalabs.com
+// Distributed under the MIT license: http://madrona-labs.mit-license.org/
+
+// RealFFT: forward and inverse FFTs of real signals, for power-of-two sizes
+// from 64 to 65536.
+//
+// Spectra use the packed layout of ffft::FFTReal, so the two can be swapped
+// for one another. For a size N transform, f[0 ... N/2] hold the real parts of
+// bins 0 ... N/2, and f[N/2 + k] holds the negated imaginary part of bin k,
+// for k in (0, N/2). Like FFTReal, the inverse is not scaled:
+// inverse(forward(x)) = N * x.
+//
+// A size N real FFT is done as a size N/2 complex FFT of the even and odd
+// samples. The complex FFT is a radix-4 Stockham kernel that works on split
+// real and imaginary arrays, four complex values at a time. Twiddles for each
+// size are computed once and shared by all RealFFT objects of that size. Each
+// RealFFT owns its work buffers, so different objects can run on different
+// threads.
+//
+// All float buffers passed in must be aligned for float4.
+
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "MLDSPOps.h"
+#include "MLDSPMath.h"
+
+namespace ml
+{
+
+constexpr size_t kMinFFTSize{64};
+constexpr size_t kMaxFFTSize{65536};
+
+constexpr bool isValidFFTSize(size_t n)
+{
+  return (n >= kMinFFTSize) && (n <= kMaxFFTSize) && ((n & (n - 1)) == 0);
+}
+
+namespace fft
+{
+
+// float storage aligned for float4.
+class FloatBuffer
+{
+ public:
+  explicit FloatBuffer(size_t n) : data_((n + 3) / 4) {}
+  float* data() { return reinterpret_cast<float*>(data_.data()); }
+  const float* data() const { return reinterpret_cast<const float*>(data_.data()); }
+
+ private:
+  std::vector<float4> data_;
+};
+
+// multiply complex vectors in split form: (ar + i ai) * (br + i bi)
+inline void complexMultiply(float4 ar, float4 ai, float4 br, float4 bi, float4& yr, float4& yi)
+{
+  yr = ar * br - ai * bi;
+  yi = ar * bi + ai * br;
+}
+
+// Twiddles for the complex FFT of size M used by a real FFT of size 2M, and
+// for the step that splits its result into the real spectrum.
+class Tables
+{
+ public:
+  struct Stage
+  {
+    size_t quarter;   // n/4 for a stage that splits length n subsequences
+    size_t stride;    // distance between elements of a subsequence
+    size_t offset;    // start of this stage's twiddles in twiddles_
+  };
+
+  explicit Tables(size_t realSize) : size_(realSize), splitCos_(realSize / 2), splitSin_(realSize / 2)
+  {
+    const size_t m = realSize / 2;
+    const double kTwoPi = 6.283185307179586;
+
+    // Each radix-4 stage stores W^p, W^2p, W^3p for p in [0, n/4), as six
+    // split arrays of n/4 values padded to a whole number of float4s.
+    size_t totalTwiddles = 0;
+    for (size_t n = m, s = 1; n >= 4; n /= 4, s *= 4)
+    {
+      size_t padded = ((n / 4) + 3) & ~size_t(3);
+      stages_.push_back({n / 4, s, totalTwiddles});
+      totalTwiddles += 6 * padded;
+    }
+    finalRadix2_ = (m >> (2 * stages_.size())) == 2;
+
+    twiddles_ = std::make_unique<FloatBuffer>(totalTwiddles);
+    for (const auto& stage : stages_)
+    {
+      size_t n = stage.quarter * 4;
+      size_t padded = (stage.quarter + 3) & ~size_t(3);
+      float* w = twiddles_->data() + stage.offset;
+      for (size_t p = 0; p < stage.quarter; ++p)
+      {
+        for (size_t j = 1; j <= 3; ++j)
+        {
+          double theta = kTwoPi * double(j * p) / double(n);
+          w[(2 * j - 2) * padded + p] = float(std::cos(theta));
+          w[(2 * j - 1) * padded + p] = float(-std::sin(theta));
+        }
+      }
+    }
+
+    for (size_t k = 0; k < m; ++k)
+    {
+      double theta = kTwoPi * double(k) / double(realSize);
+      splitCos_.data()[k] = float(std::cos(theta));
+      splitSin_.data()[k] = float(std::sin(theta));
+    }
+  }
+
+  size_t getSize() const { return size_; }
+  const std::vector<Stage>& getStages() const { return stages_; }
+  bool hasFinalRadix2() const { return finalRadix2_; }
+
+  const float* getTwiddles(const Stage& stage, size_t j) const
+  {
+    size_t padded = (stage.quarter + 3) & ~size_t(3);
+    return twiddles_->data() + stage.offset + j * padded;
+  }
+  const float* getSplitCos() const { return splitCos_.data(); }
+  const float* getSplitSin() const { return splitSin_.data(); }
+
+  // Get the shared tables for a real FFT of the given size, making them the
+  // first time a size is asked for. This locks, so call it from setup code.
+  // Each valid size has its own slot, so the size must be valid.
+  static std::shared_ptr<const Tables> get(size_t realSize)
+  {
+    assert(isValidFFTSize(realSize));
+    static std::mutex mutex;
+    static std::array<std::shared_ptr<const Tables>, 32> cache;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& tables = cache[bitsToContain(int(realSize))];
+    if (!tables) tables = std::make_shared<const Tables>(realSize);
+    return tables;
+  }
+
+ private:
+  size_t size_;
+  std::vector<Stage> stages_;
+  bool finalRadix2_{false};
+  std::unique_ptr<FloatBuffer> twiddles_;
+  FloatBuffer splitCos_;
+  FloatBuffer splitSin_;
+};
+
+// One radix-4 butterfly on four complex vectors a, b, c, d. Outputs y0 ... y3
+// before twiddling.
+struct Radix4
+{
+  float4 y0r, y0i, y1r, y1i, y2r, y2i, y3r, y3i;
+
+  Radix4(float4 ar, float4 ai, float4 br, float4 bi, float4 cr, float4 ci, float4 dr, float4 di)
+  {
+    float4 apcR = ar + cr, apcI = ai + ci;
+    float4 amcR = ar - cr, amcI = ai - ci;
+    float4 bpdR = br + dr, bpdI = bi + di;
+    float4 bmdR = br - dr, bmdI = bi - di;
+    y0r = apcR + bpdR;
+    y0i = apcI + bpdI;
+    y2r = apcR - bpdR;
+    y2i = apcI - bpdI;
+    // (a - c) -/+ i(b - d)
+    y1r = amcR + bmdI;
+    y1i = amcI - bmdR;
+    y3r = amcR - bmdI;
+    y3i = amcI + bmdR;
+  }
+};
+
+// The first radix-4 stage, where the stride is 1. Four values of p are done
+// at once, then transposed so each p's four outputs land next to each other.
+inline void firstStage(const Tables& t, const Tables::Stage& stage, const float* xr, const float* xi,
+                       float* yr, float* yi)
+{
+  const size_t q = stage.quarter;
+  const float* w1r = t.getTwiddles(stage, 0);
+  const float* w1i = t.getTwiddles(stage, 1);
+  const float* w2r = t.getTwiddles(stage, 2);
+  const float* w2i = t.getTwiddles(stage, 3);
+  const float* w3r = t.getTwiddles(stage, 4);
+  const float* w3i = t.getTwiddles(stage, 5);
+
+  for (size_t p = 0; p < q; p += 4)
+  {
+    Radix4 b(loadFloat4(xr + p), loadFloat4(xi + p), loadFloat4(xr + p + q), loadFloat4(xi + p + q),
+             loadFloat4(xr + p + 2 * q), loadFloat4(xi + p + 2 * q), loadFloat4(xr + p + 3 * q),
+             loadFloat4(xi + p + 3 * q));
+    std::array<float4, 4> re, im;
+    re[0] = b.y0r;
+    im[0] = b.y0i;
+    complexMultiply(b.y1r, b.y1i, loadFloat4(w1r + p), loadFloat4(w1i + p), re[1], im[1]);
+    complexMultiply(b.y2r, b.y2i, loadFloat4(w2r + p), loadFloat4(w2i + p), re[2], im[2]);
+    complexMultiply(b.y3r, b.y3i, loadFloat4(w3r + p), loadFloat4(w3i + p), re[3], im[3]);
+    transpose4x4InPlace(re.data());
+    transpose4x4InPlace(im.data());
+    for (size_t j = 0; j < 4; ++j)
+    {
+      storeFloat4(yr + 4 * (p + j), re[j]);
+      storeFloat4(yi + 4 * (p + j), im[j]);
+    }
+  }
+}
+
+// A radix-4 stage with stride s >= 4, done four values of q at a time.
+inline void laterStage(const Tables& t, const Tables::Stage& stage, const float* xr, const float* xi,
+                       float* yr, float* yi)
+{
+  const size_t q = stage.quarter;
+  const size_t s = stage.stride;
+  const float* w1r = t.getTwiddles(stage, 0);
+  const float* w1i = t.getTwiddles(stage, 1);
+  const float* w2r = t.getTwiddles(stage, 2);
+  const float* w2i = t.getTwiddles(stage, 3);
+  const float* w3r = t.getTwiddles(stage, 4);
+  const float* w3i = t.getTwiddles(stage, 5);
+
+  for (size_t p = 0; p < q; ++p)
+  {
+    const float4 v1r(w1r[p]), v1i(w1i[p]), v2r(w2r[p]), v2i(w2i[p]), v3r(w3r[p]), v3i(w3i[p]);
+    const size_t a = s * p, b = s * (p + q), c = s * (p + 2 * q), d = s * (p + 3 * q);
+    const size_t y = 4 * s * p;
+    for (size_t i = 0; i < s; i += 4)
+    {
+      Radix4 r(loadFloat4(xr + a + i), loadFloat4(xi + a + i), loadFloat4(xr + b + i),
+               loadFloat4(xi + b + i), loadFloat4(xr + c + i), loadFloat4(xi + c + i),
+               loadFloat4(xr + d + i), loadFloat4(xi + d + i));
+      float4 re, im;
+      storeFloat4(yr + y + i, r.y0r);
+      storeFloat4(yi + y + i, r.y0i);
+      complexMultiply(r.y1r, r.y1i, v1r, v1i, re, im);
+      storeFloat4(yr + y + s + i, re);
+      storeFloat4(yi + y + s + i, im);
+      complexMultiply(r.y2r, r.y2i, v2r, v2i, re, im);
+      storeFloat4(yr + y + 2 * s + i, re);
+      storeFloat4(yi + y + 2 * s + i, im);
+      complexMultiply(r.y3r, r.y3i, v3r, v3i, re, im);
+      storeFloat4(yr + y + 3 * s + i, re);
+      storeFloat4(yi + y + 3 * s + i, im);
+    }
+  }
+}
+
+// the last stage when log4 of the size is not whole: radix 2, stride m/2.
+inline void radix2Stage(size_t m, const float* xr, const float* xi, float* yr, float* yi)
+{
+  const size_t s = m / 2;
+  for (size_t i = 0; i < s; i += 4)
+  {
+    float4 ar = loadFloat4(xr + i), ai = loadFloat4(xi + i);
+    float4 br = loadFloat4(xr + s + i), bi = loadFloat4(xi + s + i);
+    storeFloat4(yr + i, ar + br);
+    storeFloat4(yi + i, ai + bi);
+    storeFloat4(yr + s + i, ar - br);
+    storeFloat4(yi + s + i, ai - bi);
+  }
+}
+
+// Forward complex FFT of size m in split form. The input is in buffer A
+// and is overwritten, buffer B is scratch. Returns true if the result ended
+// up in buffer B.
+inline bool complexForward(const Tables& t, float* ar, float* ai, float* br, float* bi)
+{
+  bool inB = false;
+  const auto& stages = t.getStages();
+  for (size_t i = 0; i < stages.size(); ++i)
+  {
+    const float* xr = inB ? br : ar;
+    const float* xi = inB ? bi : ai;
+    float* yr = inB ? ar : br;
+    float* yi = inB ? ai : bi;
+    if (i == 0)
+      firstStage(t, stages[i], xr, xi, yr, yi);
+    else
+      laterStage(t, stages[i], xr, xi, yr, yi);
+    inB = !inB;
+  }
+  if (t.hasFinalRadix2())
+  {
+    radix2Stage(t.getSize() / 2, inB ? br : ar, inB ? bi : ai, inB ? ar : br, inB ? ai : bi);
+    inB = !inB;
+  }
+  return inB;
+}
+
+// Load x[m - k - 3 ... m - k] in reverse order, where x has period m and k is
+// a multiple of 4.
+inline float4 loadReversed(const float* x, size_t m, size_t k)
+{
+  float4 u = loadFloat4(x + ((m - k) & (m - 1)));
+  float4 v = loadFloat4(x + m - k - 4);
+  return shuffle<0, 2, 2, 1>(shuffle<0, 0, 3, 3>(u, v), v);
+}
+
+}  // namespace fft
+
+class RealFFT
+{
+ public:
+  // size must be a power of two in [64, 65536]: see isValidFFTSize().
+  explicit RealFFT(size_t size)
+      : tables_((assert(isValidFFTSize(size)), fft::Tables::get(size))),
+        bufA_(size),
+        bufB_(size)
+  {
+  }
+
+  size_t getSize() const { return tables_->getSize(); }
+
+  // Forward transform of getSize() samples x to the packed spectrum f.
+  void forward(const float* x, float* f)
+  {
+    const size_t m = getSize() / 2;
+    float* ar = bufA_.data();
+    float* ai = ar + m;
+    float* br = bufB_.data();
+    float* bi = br + m;
+
+    // even samples to the real part, odd to the imaginary part
+    for (size_t i = 0; i < m; i += 4)
+    {
+      float4 x0 = loadFloat4(x + 2 * i);
+      float4 x1 = loadFloat4(x + 2 * i + 4);
+      storeFloat4(ar + i, shuffle<0, 2, 0, 2>(x0, x1));
+      storeFloat4(ai + i, shuffle<1, 3, 1, 3>(x0, x1));
+    }
+
+    bool inB = fft::complexForward(*tables_, ar, ai, br, bi);
+    const float* zr = inB ? br : ar;
+    const float* zi = inB ? bi : ai;
+
+    // Split Z into the spectra E and O of the even and odd samples, then
+    // X[k] = E[k] + W^k O[k]. f holds -Im(X).
+    const float* wc = tables_->getSplitCos();
+    const float* ws = tables_->getSplitSin();
+    const float4 half(0.5f);
+    for (size_t k = 0; k < m; k += 4)
+    {
+      float4 ar4 = loadFloat4(zr + k), ai4 = loadFloat4(zi + k);
+      float4 br4 = fft::loadReversed(zr, m, k), bi4 = fft::loadReversed(zi, m, k);
+      float4 eR = (ar4 + br4) * half, eI = (ai4 - bi4) * half;
+      float4 oR = (ai4 + bi4) * half, oI = (br4 - ar4) * half;
+      float4 c = loadFloat4(wc + k), s = loadFloat4(ws + k);
+      storeFloat4(f + k, eR + c * oR + s * oI);
+      storeFloat4(f + m + k, s * oR - c * oI - eI);
+    }
+    f[m] = zr[0] - zi[0];
+  }
+
+  // Inverse transform of the packed spectrum f to getSize() samples x.
+  // The result is scaled by getSize().
+  void inverse(const float* f, float* x)
+  {
+    const size_t m = getSize() / 2;
+    float* ar = bufA_.data();
+    float* ai = ar + m;
+    float* br = bufB_.data();
+    float* bi = br + m;
+
+    // Z[k] = (X[k] + conj X[m-k]) + i conj(W^k) (X[k] - conj X[m-k]).
+    // Lane 0 of the first vector reads f[m] as an imaginary part, so Z[0] is
+    // fixed afterwards.
+    const float* fr = f;
+    const float* fi = f + m;
+    const float* wc = tables_->getSplitCos();
+    const float* ws = tables_->getSplitSin();
+    for (size_t k = 0; k < m; k += 4)
+    {
+      float4 xr4 = loadFloat4(fr + k), xi4 = -loadFloat4(fi + k);
+      float4 yr4 = fft::loadReversed(fr, m, k), yi4 = -fft::loadReversed(fi, m, k);
+      float4 pR = xr4 + yr4, pI = xi4 - yi4;
+      float4 qR = xr4 - yr4, qI = xi4 + yi4;
+      float4 c = loadFloat4(wc + k), s = loadFloat4(ws + k);
+      storeFloat4(ar + k, pR - c * qI - s * qR);
+      storeFloat4(ai + k, pI + c * qR - s * qI);
+    }
+    ar[0] = f[0] + f[m];
+    ai[0] = f[0] - f[m];
+
+    // the inverse complex FFT is the forward FFT with real and imaginary
+    // parts swapped on the way in and out.
+    bool inB = fft::complexForward(*tables_, ai, ar, bi, br);
+    const float* zr = inB ? br : ar;
+    const float* zi = inB ? bi : ai;
+
+    for (size_t i = 0; i < m; i += 4)
+    {
+      float4 re = loadFloat4(zr + i), im = loadFloat4(zi + i);
+      storeFloat4(x + 2 * i, unpackLo(re, im));
+      storeFloat4(x + 2 * i + 4, unpackHi(re, im));
+    }
+  }
+
+  // Transform a whole SignalBlockArray as one frame of ROWS * FRAMES samples,
+  // which must equal getSize().
+  template<size_t ROWS, size_t FRAMES>
+  void forward(const SignalBlockArrayBase<float, ROWS, FRAMES>& x,
+               SignalBlockArrayBase<float, ROWS, FRAMES>& f)
+  {
+    static_assert(isValidFFTSize(ROWS * FRAMES), "FFT size must be a power of two in [64, 65536]");
+    assert(getSize() == ROWS * FRAMES);
+    forward(x.data(), f.data());
+  }
+
+  template<size_t ROWS, size_t FRAMES>
+  void inverse(const SignalBlockArrayBase<float, ROWS, FRAMES>& f,
+               SignalBlockArrayBase<float, ROWS, FRAMES>& x)
+  {
+    static_assert(isValidFFTSize(ROWS * FRAMES), "FFT size must be a power of two in [64, 65536]");
+    assert(getSize() == ROWS * FRAMES);
+    inverse(f.data(), x.data());
+  }
+
+ private:
+  std::shared_ptr<const fft::Tables> tables_;
+  fft::FloatBuffer bufA_;
+  fft::FloatBuffer bufB_;
+};
+
+}  // namespace ml
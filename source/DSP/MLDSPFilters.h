@@ -10,6 +10,7 @@
 
 #pragma once
 
+#include <utility>
 #include <vector>
 
 #include "MLDSPOps.h"
@@ -19,45 +20,188 @@
 namespace ml
 {
 
-template<typename T, typename Derived>
+// ----------------------------------------------------------------
+// Coefficient blocks
+//
+// With signal-rate params, Filter computes the coefficients for the whole
+// block before running the filter. It calls the filter's makeCoeffs() with
+// blocks in place of single values, so the arithmetic and the sin, cos, tan,
+// exp and sqrt in makeCoeffs() all run as block operations. The loop over
+// frames then only reads the precomputed coefficient rows.
+//
+// Passing approxCoeffs to the signal-rate operator() computes the coefficients
+// with ApproxCoeffBlock instead, whose trig, exp and sqrt use the faster
+// polynomial approximations. sin and cos are good to about 1e-5 on [-pi, pi];
+// tan loses relative accuracy as it approaches pi/2, so near Nyquist cutoffs
+// shift slightly.
+
+struct approxCoeffs_t
+{
+  explicit constexpr approxCoeffs_t() = default;
+};
+inline constexpr approxCoeffs_t approxCoeffs{};
+
+template<typename T, size_t FRAMES = kFramesPerBlock>
+struct ApproxCoeffBlock
+{
+  Block<T, FRAMES> v;
+  
+  ApproxCoeffBlock() : v(uninitialized) {}
+  ApproxCoeffBlock(float f) : v(T(f)) {}
+  explicit ApproxCoeffBlock(const Block<T, FRAMES>& b) : v(b) {}
+  
+  const T* data() const { return v.data(); }
+};
+
+#define DEFINE_APPROX_COEFF_BLOCK_OP(op) \
+template<typename T, size_t FRAMES> \
+inline ApproxCoeffBlock<T, FRAMES> operator op(const ApproxCoeffBlock<T, FRAMES>& a, \
+                                               const ApproxCoeffBlock<T, FRAMES>& b) \
+{ return ApproxCoeffBlock<T, FRAMES>(Block<T, FRAMES>(a.v op b.v)); }
+
+DEFINE_APPROX_COEFF_BLOCK_OP(+)
+DEFINE_APPROX_COEFF_BLOCK_OP(-)
+DEFINE_APPROX_COEFF_BLOCK_OP(*)
+DEFINE_APPROX_COEFF_BLOCK_OP(/)
+
+template<typename T, size_t FRAMES>
+inline ApproxCoeffBlock<T, FRAMES> operator-(const ApproxCoeffBlock<T, FRAMES>& a)
+{ return ApproxCoeffBlock<T, FRAMES>(Block<T, FRAMES>(-a.v)); }
+
+#define DEFINE_APPROX_COEFF_BLOCK_FN(fn, approxFn) \
+template<typename T, size_t FRAMES> \
+inline ApproxCoeffBlock<T, FRAMES> fn(const ApproxCoeffBlock<T, FRAMES>& a) \
+{ return ApproxCoeffBlock<T, FRAMES>(approxFn(a.v)); }
+
+DEFINE_APPROX_COEFF_BLOCK_FN(sin, sinApprox)
+DEFINE_APPROX_COEFF_BLOCK_FN(cos, cosApprox)
+DEFINE_APPROX_COEFF_BLOCK_FN(tan, tanApprox)
+DEFINE_APPROX_COEFF_BLOCK_FN(exp, sigExpApprox)
+DEFINE_APPROX_COEFF_BLOCK_FN(sqrt, sqrtApprox)
+
+template<typename T, size_t FRAMES>
+inline ApproxCoeffBlock<T, FRAMES> clamp(const ApproxCoeffBlock<T, FRAMES>& a,
+                                         const ApproxCoeffBlock<T, FRAMES>& b,
+                                         const ApproxCoeffBlock<T, FRAMES>& c)
+{
+  return ApproxCoeffBlock<T, FRAMES>(clamp(a.v, b.v, c.v));
+}
+
+// the same filter template with another value type: Lopass<float> -> Lopass<U>.
+template<typename FILTER, typename U>
+struct RebindFilter;
+template<template<typename, size_t> class F, typename T, size_t FRAMES, typename U>
+struct RebindFilter<F<T, FRAMES>, U>
+{
+  using type = F<U, FRAMES>;
+};
+
+// ----------------------------------------------------------------
+// Filter: base class for filters. Each block is FRAMES frames long. Filters
+// whose makeCoeffs() is expensive pass a CACHE_SIZE to keep a CoeffCache of
+// that many params and coefficients together, usually kDefaultCoeffCacheSize.
+// The others keep no cache.
+
+template<typename T, typename Derived, size_t FRAMES = kFramesPerBlock, size_t CACHE_SIZE = 0>
 struct Filter
 {
+  static constexpr size_t kFrames{FRAMES};
+  
   // Block processing with signal-rate params (one Params per frame)
   template<size_t N_PARAMS>
-  Block<T> operator()(const Block<T>& input,
-                      const SignalBlockArrayBase<T, N_PARAMS>& paramBlock)
+  Block<T, FRAMES> operator()(const Block<T, FRAMES>& input,
+                              const SignalBlockArrayBase<T, N_PARAMS, FRAMES>& paramBlock)
   {
     static_assert(N_PARAMS == Derived::nParams, "paramBlock row count must match nParams");
-    auto& self = *static_cast<Derived*>(this);
-    Block<T> output;
-    
-    for (size_t t = 0; t < kFramesPerBlock; ++t)
-    {
-      typename Derived::Params p;
-      for (size_t i = 0; i < Derived::nParams; ++i)
-      {
-        p[i] = paramBlock.rowPtr(i)[t];
-      }
-      self.coeffs = Derived::makeCoeffs(p);
-      output[t] = self.nextFrame(input[t], self.coeffs);
-    }
-    return output;
+    return processWithCoeffBlocks<Block<T, FRAMES>>(input, paramBlock.data());
+  }
+  
+  // Block processing with signal-rate params and approximate coefficients
+  template<size_t N_PARAMS>
+  Block<T, FRAMES> operator()(const Block<T, FRAMES>& input,
+                              const SignalBlockArrayBase<T, N_PARAMS, FRAMES>& paramBlock,
+                              approxCoeffs_t)
+  {
+    static_assert(N_PARAMS == Derived::nParams, "paramBlock row count must match nParams");
+    return processWithCoeffBlocks<ApproxCoeffBlock<T, FRAMES>>(input, paramBlock.data());
+  }
+  
+  // Block processing with signal-rate params read in place: nParams rows of
+  // FRAMES frames, one after another from paramRows. The banks use this to
+  // run each processor on its slice of their param rows.
+  Block<T, FRAMES> processParamRows(const Block<T, FRAMES>& input, const T* paramRows)
+  {
+    return processWithCoeffBlocks<Block<T, FRAMES>>(input, paramRows);
   }
   
   // Block processing with parameter interpolation from std::array argument
   template<size_t N_PARAMS>
-  Block<T> operator()(const Block<T>& input,
-                      const std::array<T, N_PARAMS>& nextParams)
+  Block<T, FRAMES> operator()(const Block<T, FRAMES>& input,
+                              const std::array<T, N_PARAMS>& nextParams)
   {
     static_assert(N_PARAMS == Derived::nParams, "paramBlock row count must match nParams");
+    return processInterpolated(input, nextParams);
+  }
+  
+  // Block processing with parameter interpolation — list of float arguments
+  template<typename... Args,
+  typename = std::enable_if_t<(std::is_same_v<std::remove_cv_t<std::remove_reference_t<Args>>, float> && ...)>>
+  Block<T, FRAMES> operator()(const Block<T, FRAMES>& input, Args&&... args)
+  {
+    std::array<std::common_type_t<Args...>, sizeof...(Args)> arr = { std::forward<Args>(args)... };
+    const std::array nextParams = arr;
+    return processInterpolated(input, nextParams);
+  }
+
+  // Block processing with constant stored coefficients
+  Block<T, FRAMES> operator()(const Block<T, FRAMES>& input)
+  {
+    return processConstant(input);
+  }
+  
+  // How many interpolating calls ran with constant coefficients, because the
+  // params were unchanged or, with no cache, the coefficients made from them.
+  const CoeffCacheStats& getCoeffCacheStats() const { return coeffCache_.getStats(); }
+  void resetCoeffCacheStats() { coeffCache_.resetStats(); }
+  
+  // Clear the state of the lanes where mask is set, as clear() does for all
+  // of them. Filters keep their state in the array state.
+  void clearLanes(T mask)
+  {
+    auto& self = *static_cast<Derived*>(this);
+    for (auto& s : self.state) s = andNotBits(mask, s);
+  }
+  
+ private:
+  CoeffCache<T, CACHE_SIZE> coeffCache_;
+  
+  // Interpolate from the stored coefficients to those for nextParams over
+  // the block. If nextParams made the stored coefficients, skip straight to
+  // the constant path.
+  template<size_t N_PARAMS>
+  Block<T, FRAMES> processInterpolated(const Block<T, FRAMES>& input,
+                                       const std::array<T, N_PARAMS>& nextParams)
+  {
     auto& self = *static_cast<Derived*>(this);
-    Block<T> output;
+    if constexpr (CACHE_SIZE > 0)
+    {
+      if (coeffCache_.matches(nextParams, self.coeffs)) return processConstant(input);
+    }
     
+    Block<T, FRAMES> output(uninitialized);
     auto nextCoeffs = Derived::makeCoeffs(nextParams);
-    auto coeffsBlock = interpolateCoeffsLinear(self.coeffs, nextCoeffs);
+    if constexpr (CACHE_SIZE > 0)
+    {
+      coeffCache_.store(nextParams, nextCoeffs);
+    }
+    else if (coeffCache_.matches(nextCoeffs, self.coeffs))
+    {
+      return processConstant(input);
+    }
+    auto coeffsBlock = interpolateCoeffsLinear<FRAMES>(self.coeffs, nextCoeffs);
     self.coeffs = nextCoeffs;
     
-    for (size_t t = 0; t < kFramesPerBlock; ++t)
+    for (size_t t = 0; t < FRAMES; ++t)
     {
       typename Derived::Coeffs c;
       for (size_t i = 0; i < Derived::nCoeffs; ++i)
@@ -69,40 +213,47 @@ struct Filter
     return output;
   }
   
-  // Block processing with parameter interpolation — list of float arguments
-  template<typename... Args,
-  typename = std::enable_if_t<(std::is_same_v<std::remove_cv_t<std::remove_reference_t<Args>>, float> && ...)>>
-  Block<T> operator()(const Block<T>& input, Args&&... args)
+  // Run with the stored coefficients. The local copy lets the compiler keep
+  // them in registers, since nextFrame() writes the state through this.
+  Block<T, FRAMES> processConstant(const Block<T, FRAMES>& input)
   {
-    std::array<std::common_type_t<Args...>, sizeof...(Args)> arr = { std::forward<Args>(args)... };
-    const std::array nextParams = arr;
-    
     auto& self = *static_cast<Derived*>(this);
-    Block<T> output;
-    
-    auto nextCoeffs = Derived::makeCoeffs(nextParams);
-    auto coeffsBlock = interpolateCoeffsLinear(self.coeffs, nextCoeffs);
-    self.coeffs = nextCoeffs;
-    
-    for (size_t t = 0; t < kFramesPerBlock; ++t)
+    const typename Derived::Coeffs c = self.coeffs;
+    Block<T, FRAMES> output(uninitialized);
+    for (size_t t = 0; t < FRAMES; ++t)
     {
-      typename Derived::Coeffs c;
-      for (size_t i = 0; i < Derived::nCoeffs; ++i)
-        c[i] = coeffsBlock.rowPtr(i)[t];
       output[t] = self.nextFrame(input[t], c);
     }
     return output;
   }
-
-  // Block processing with constant stored coefficients
-  Block<T> operator()(const Block<T>& input)
+  
+  // Make a block of each coefficient from the param rows, using value type V
+  // for the calculation, then run the filter. The stored coefficients are
+  // left at the values for the last frame.
+  template<typename V>
+  Block<T, FRAMES> processWithCoeffBlocks(const Block<T, FRAMES>& input, const T* paramRows)
   {
+    using BlockFilter = typename RebindFilter<Derived, V>::type;
     auto& self = *static_cast<Derived*>(this);
-    Block<T> output;
-    for (size_t t = 0; t < kFramesPerBlock; ++t)
+    
+    typename BlockFilter::Params blockParams;
+    for (size_t i = 0; i < Derived::nParams; ++i)
     {
-      output[t] = self.nextFrame(input[t], self.coeffs);
+      blockParams[i] = V(Block<T, FRAMES>(paramRows + i * FRAMES));
     }
+    const typename BlockFilter::Coeffs blockCoeffs = BlockFilter::makeCoeffs(blockParams);
+    
+    Block<T, FRAMES> output(uninitialized);
+    typename Derived::Coeffs c;
+    for (size_t t = 0; t < FRAMES; ++t)
+    {
+      for (size_t i = 0; i < Derived::nCoeffs; ++i)
+      {
+        c[i] = blockCoeffs[i].data()[t];
+      }
+      output[t] = self.nextFrame(input[t], c);
+    }
+    self.coeffs = c;
     return output;
   }
 };
@@ -115,8 +266,8 @@ struct Filter
 // where Q is the analog filter "quality." Maximum resonance is at k=0.
 // For bell and shelf filters, gain is specified as an output / input ratio A.
 
-template<typename T>
-struct Lopass : Filter<T, Lopass<T>>
+template<typename T, size_t FRAMES = kFramesPerBlock>
+struct Lopass : Filter<T, Lopass<T, FRAMES>, FRAMES, kDefaultCoeffCacheSize>
 {
   enum { omega, k, nParams };
   enum { g0, g1, g2, nCoeffs };
@@ -160,8 +311,8 @@ struct Lopass : Filter<T, Lopass<T>>
   }
 };
 
-template<typename T>
-struct Hipass : Filter<T, Hipass<T>>
+template<typename T, size_t FRAMES = kFramesPerBlock>
+struct Hipass : Filter<T, Hipass<T, FRAMES>, FRAMES, kDefaultCoeffCacheSize>
 {
   enum { omega, k, nParams };
   enum { g0, g1, g2, gk, nCoeffs };
@@ -206,8 +357,8 @@ struct Hipass : Filter<T, Hipass<T>>
   }
 };
 
-template<typename T>
-struct Bandpass : Filter<T, Bandpass<T>>
+template<typename T, size_t FRAMES = kFramesPerBlock>
+struct Bandpass : Filter<T, Bandpass<T, FRAMES>, FRAMES, kDefaultCoeffCacheSize>
 {
   enum { omega, k, nParams };
   enum { g0, g1, g2, nCoeffs };
@@ -251,8 +402,8 @@ struct Bandpass : Filter<T, Bandpass<T>>
   }
 };
 
-template<typename T>
-struct LoShelf : Filter<T, LoShelf<T>>
+template<typename T, size_t FRAMES = kFramesPerBlock>
+struct LoShelf : Filter<T, LoShelf<T, FRAMES>, FRAMES, kDefaultCoeffCacheSize>
 {
   enum { omega, k, A, nParams };
   enum { a1, a2, a3, m1, m2, nCoeffs };
@@ -295,8 +446,8 @@ struct LoShelf : Filter<T, LoShelf<T>>
   }
 };
 
-template<typename T>
-struct HiShelf : Filter<T, HiShelf<T>>
+template<typename T, size_t FRAMES = kFramesPerBlock>
+struct HiShelf : Filter<T, HiShelf<T, FRAMES>, FRAMES, kDefaultCoeffCacheSize>
 {
   enum { omega, k, A, nParams };
   enum { a1, a2, a3, m0, m1, m2, nCoeffs };
@@ -340,8 +491,8 @@ struct HiShelf : Filter<T, HiShelf<T>>
   }
 };
 
-template<typename T>
-struct Bell : Filter<T, Bell<T>>
+template<typename T, size_t FRAMES = kFramesPerBlock>
+struct Bell : Filter<T, Bell<T, FRAMES>, FRAMES, kDefaultCoeffCacheSize>
 {
   enum { omega, k, A, nParams };
   enum { a1, a2, a3, m1, nCoeffs };
@@ -387,8 +538,8 @@ struct Bell : Filter<T, Bell<T>>
 // --------------------------------------------------------------------------------
 // A one pole filter. see https://ccrma.stanford.edu/~jos/fp/One_Pole.html
 
-template<typename T>
-struct OnePole : Filter<T, OnePole<T>>
+template<typename T, size_t FRAMES = kFramesPerBlock>
+struct OnePole : Filter<T, OnePole<T, FRAMES>, FRAMES, kDefaultCoeffCacheSize>
 {
   enum { omega, nParams };
   enum { a0, b1, nCoeffs };
@@ -426,8 +577,8 @@ struct OnePole : Filter<T, OnePole<T>>
 // A one-pole, one-zero filter to attenuate DC.
 // see https://ccrma.stanford.edu/~jos/fp/DC_Blocker.html
 
-template<typename T>
-struct DCBlocker : Filter<T, DCBlocker<T>>
+template<typename T, size_t FRAMES = kFramesPerBlock>
+struct DCBlocker : Filter<T, DCBlocker<T, FRAMES>, FRAMES, kDefaultCoeffCacheSize>
 {
   enum { omega, nParams };
   enum { c0, nCoeffs };
@@ -466,8 +617,8 @@ struct DCBlocker : Filter<T, DCBlocker<T>>
 // One-multiply form, see
 // https://ccrma.stanford.edu/~jos/pasp/One_Multiply_Scattering_Junctions.html
 
-template<typename T>
-struct Allpass1 : Filter<T, Allpass1<T>>
+template<typename T, size_t FRAMES = kFramesPerBlock>
+struct Allpass1 : Filter<T, Allpass1<T, FRAMES>, FRAMES>
 {
   enum { d, nParams };
   enum { c0, nCoeffs };
@@ -526,8 +677,8 @@ struct Allpass1 : Filter<T, Allpass1<T>>
 // Reference: "An Improved Virtual Analog Model of the Moog Ladder Filter"
 // Original Implementation: D'Angelo, Valimaki
 
-template<typename T>
-struct LadderFilter : Filter<T, LadderFilter<T>>
+template<typename T, size_t FRAMES = kFramesPerBlock>
+struct LadderFilter : Filter<T, LadderFilter<T, FRAMES>, FRAMES>
 {
   enum Mode { kLopass = 0, kBandpass, kHipass, kThru };
   enum { omega, q, nParams };
@@ -592,6 +743,395 @@ struct LadderFilter : Filter<T, LadderFilter<T>>
   }
 };
 
+// ----------------------------------------------------------------
+// StateSpaceFilter
+//
+// A linear filter with fixed coefficients is a state-space system:
+//   s[n+1] = A s[n] + B x[n]
+//   y[n] = C s[n] + D x[n]
+// Unrolled over four frames, the four outputs and the state after them are
+// matrix products of the starting state and the four inputs:
+//   y[n..n+3] = O s[n] + H x[n..n+3]
+//   s[n+4] = A^4 s[n] + G x[n..n+3]
+// StateSpaceFilter computes O, H, A^4 and G when the coefficients are set, by
+// running the filter's own nextFrame() from each unit state and from an
+// impulse. Each group of four frames then takes a few float4 multiply-adds,
+// and the recursion from group to group is one step deep instead of four. So
+// a mono filter uses the whole vector.
+//
+// F must be a linear filter on floats with at most four state variables:
+// Lopass, Hipass, Bandpass, LoShelf, HiShelf, Bell, OnePole, DCBlocker or
+// Allpass1. The coefficients are fixed for each block. Call setParams() or
+// setCoeffs() between blocks to change them; each costs about 4 * (nStateVars
+// + 1) calls to nextFrame().
+
+template<typename F>
+class StateSpaceFilter
+{
+  static constexpr size_t kStateSize{F::nStateVars};
+  static constexpr size_t kFrames{F::kFrames};
+  static_assert(kStateSize <= 4, "StateSpaceFilter supports up to four state variables");
+
+ public:
+  using Params = typename F::Params;
+  using Coeffs = typename F::Coeffs;
+
+  StateSpaceFilter() { setCoeffs(F().coeffs); }
+  explicit StateSpaceFilter(const Params& p) { setParams(p); }
+
+  void setParams(const Params& p) { setCoeffs(F::makeCoeffs(p)); }
+
+  void setCoeffs(const Coeffs& c)
+  {
+    F f;
+    alignas(16) float y[4];
+    alignas(16) float s[4];
+
+    // the outputs and final state from each unit state, with no input
+    for (size_t j = 0; j < 4; ++j)
+    {
+      stateToOutput_[j] = stateToState_[j] = setZero();
+      if (j >= kStateSize) continue;
+      f.state.fill(0.f);
+      f.state[j] = 1.f;
+      for (size_t t = 0; t < 4; ++t)
+      {
+        y[t] = f.nextFrame(0.f, c);
+      }
+      stateToOutput_[j] = loadFloat4(y);
+      stateToState_[j] = loadFloat4(getState(f, s));
+    }
+
+    // The impulse response h and the state after each frame. An input at
+    // frame k adds h delayed by k to the outputs, and the state after the
+    // remaining 4 - k frames to the final state.
+    alignas(16) float h[4];
+    float4 impulseStates[4];
+    f.state.fill(0.f);
+    for (size_t t = 0; t < 4; ++t)
+    {
+      h[t] = f.nextFrame(t == 0 ? 1.f : 0.f, c);
+      impulseStates[t] = loadFloat4(getState(f, s));
+    }
+    for (size_t k = 0; k < 4; ++k)
+    {
+      for (size_t t = 0; t < 4; ++t)
+      {
+        y[t] = (t >= k) ? h[t - k] : 0.f;
+      }
+      inputToOutput_[k] = loadFloat4(y);
+      inputToState_[k] = impulseStates[3 - k];
+    }
+  }
+
+  void clear() { state_ = setZero(); }
+
+  SignalBlockOf<kFrames> operator()(const SignalBlockOf<kFrames>& input)
+  {
+    SignalBlockOf<kFrames> output(uninitialized);
+    const float* px = input.data();
+    float* py = output.data();
+    float4 s = state_;
+    for (size_t t = 0; t < kFrames; t += 4)
+    {
+      float4 x0(px[t]), x1(px[t + 1]), x2(px[t + 2]), x3(px[t + 3]);
+      float4 y = x0 * inputToOutput_[0] + x1 * inputToOutput_[1] + x2 * inputToOutput_[2] +
+                 x3 * inputToOutput_[3];
+      float4 nextState = x0 * inputToState_[0] + x1 * inputToState_[1] + x2 * inputToState_[2] +
+                         x3 * inputToState_[3];
+      addStateTerms(s, y, nextState, std::make_index_sequence<kStateSize>());
+      storeFloat4(py + t, y);
+      s = nextState;
+    }
+    state_ = s;
+    return output;
+  }
+
+ private:
+  static const float* getState(const F& f, float* s)
+  {
+    for (size_t i = 0; i < 4; ++i)
+    {
+      s[i] = (i < kStateSize) ? f.state[i] : 0.f;
+    }
+    return s;
+  }
+
+  template<size_t... J>
+  void addStateTerms(float4 s, float4& y, float4& nextState, std::index_sequence<J...>) const
+  {
+    ((y += broadcastLane<J>(s) * stateToOutput_[J]), ...);
+    ((nextState += broadcastLane<J>(s) * stateToState_[J]), ...);
+  }
+
+  // columns of O and A^4, one per state variable, and of H and G, one per input frame
+  float4 stateToOutput_[4];
+  float4 stateToState_[4];
+  float4 inputToOutput_[4];
+  float4 inputToState_[4];
+  float4 state_{setZero()};
+};
+
+// ----------------------------------------------------------------
+// Biquads
+//
+// BiquadCoeffs are the coefficients of one second-order section,
+//   H(z) = (b0 + b1 z^-1 + b2 z^-2) / (1 + a1 z^-1 + a2 z^-2),
+// run in transposed direct form II. The default section passes its input
+// through unchanged.
+
+struct BiquadCoeffs
+{
+  float b0{1.f}, b1{0.f}, b2{0.f}, a1{0.f}, a2{0.f};
+};
+
+// The biquad with the same response as the linear filter F with coefficients
+// c. F must have at most two state variables, like the SVF filters and
+// OnePole. As in StateSpaceFilter, the filter's own nextFrame() is probed:
+// the poles come from the state transition and the zeros from the impulse
+// response.
+template<typename F>
+BiquadCoeffs biquadFromFilter(const typename F::Coeffs& c)
+{
+  static_assert(F::nStateVars <= 2, "biquadFromFilter needs a filter of order two or less");
+  F f;
+  
+  // the state transition A, one column per unit state
+  float A[2][2]{};
+  for (size_t j = 0; j < F::nStateVars; ++j)
+  {
+    f.state.fill(0.f);
+    f.state[j] = 1.f;
+    f.nextFrame(0.f, c);
+    for (size_t i = 0; i < F::nStateVars; ++i)
+    {
+      A[i][j] = f.state[i];
+    }
+  }
+  
+  float h[3];
+  f.state.fill(0.f);
+  for (size_t t = 0; t < 3; ++t)
+  {
+    h[t] = f.nextFrame(t == 0 ? 1.f : 0.f, c);
+  }
+  
+  // The denominator is the characteristic polynomial of A. The numerator is
+  // the denominator times the impulse response, which ends after z^-2.
+  float a1 = -(A[0][0] + A[1][1]);
+  float a2 = A[0][0] * A[1][1] - A[0][1] * A[1][0];
+  return {h[0], h[1] + a1 * h[0], h[2] + a1 * h[1] + a2 * h[0], a1, a2};
+}
+
+template<typename F>
+BiquadCoeffs biquadFromParams(const typename F::Params& p)
+{
+  return biquadFromFilter<F>(F::makeCoeffs(p));
+}
+
+// BiquadCascade: N biquad sections in series, on one channel.
+//
+// The sections are interleaved across float4 lanes, four to a group. All
+// the lanes run each step, and each lane takes its input from the lane below
+// at the previous step, so lane k works on the frame k steps behind the input.
+// The first and last steps of each block only update the lanes that have a
+// frame to work on, so there is no added latency. A block takes
+// FRAMES + 4 * kNumGroups - 1 steps for all the sections, and the values
+// between sections stay in registers.
+
+template<size_t N, size_t FRAMES = kFramesPerBlock>
+class BiquadCascade
+{
+ public:
+  static constexpr size_t kNumGroups{(N + 3) / 4};
+  static constexpr size_t kNumLanes{kNumGroups * 4};
+  
+  BiquadCascade() { clear(); }
+  
+  void setSection(size_t i, const BiquadCoeffs& c)
+  {
+    sections_[i] = c;
+    size_t g = i / 4;
+    auto lanes = [&](float BiquadCoeffs::*m) {
+      return setrFloat(sections_[4 * g].*m, sections_[4 * g + 1].*m,
+                       sections_[4 * g + 2].*m, sections_[4 * g + 3].*m);
+    };
+    groups_[g].b0 = lanes(&BiquadCoeffs::b0);
+    groups_[g].b1 = lanes(&BiquadCoeffs::b1);
+    groups_[g].b2 = lanes(&BiquadCoeffs::b2);
+    groups_[g].a1 = lanes(&BiquadCoeffs::a1);
+    groups_[g].a2 = lanes(&BiquadCoeffs::a2);
+  }
+  
+  // set section i to the response of filter F with params p.
+  template<typename F>
+  void setSection(size_t i, const typename F::Params& p)
+  {
+    setSection(i, biquadFromParams<F>(p));
+  }
+  
+  const BiquadCoeffs& getSection(size_t i) const { return sections_[i]; }
+  
+  void clear()
+  {
+    for (auto& g : groups_)
+    {
+      g.s1 = g.s2 = setZero();
+    }
+  }
+  
+  SignalBlockOf<FRAMES> operator()(const SignalBlockOf<FRAMES>& input)
+  {
+    constexpr size_t kSkew{kNumLanes - 1};
+    const float* px = input.data();
+    SignalBlockOf<FRAMES> output(uninitialized);
+    float* py = output.data();
+    
+    Group g[kNumGroups];
+    float4 out[kNumGroups];
+    for (size_t j = 0; j < kNumGroups; ++j)
+    {
+      g[j] = groups_[j];
+      out[j] = setZero();
+    }
+    
+    // Run step n of the pipeline. Each group takes its input from lane 3 of
+    // the group below, as it was after the last step, so go from the top down.
+    auto step = [&](size_t n, bool partial) {
+      for (size_t j = kNumGroups; j-- > 0;)
+      {
+        float4 below = (j == 0) ? float4(n < FRAMES ? px[n] : 0.f) : out[j - 1];
+        float4 x = vecShuffleRight(below, out[j]);
+        float4 y = g[j].b0 * x + g[j].s1;
+        float4 s1 = g[j].b1 * x - g[j].a1 * y + g[j].s2;
+        float4 s2 = g[j].b2 * x - g[j].a2 * y;
+        if (partial)
+        {
+          // lane k works on frame n - k, if that is in this block
+          float4 k = setrFloat(4.f * j, 4.f * j + 1.f, 4.f * j + 2.f, 4.f * j + 3.f);
+          float4 frame = float4(static_cast<float>(n)) - k;
+          float4 active = andBits(frame >= float4(0.f), frame < float4(static_cast<float>(FRAMES)));
+          s1 = select(s1, g[j].s1, active);
+          s2 = select(s2, g[j].s2, active);
+        }
+        g[j].s1 = s1;
+        g[j].s2 = s2;
+        out[j] = y;
+      }
+    };
+    
+    // fill the pipeline
+    for (size_t n = 0; n < kSkew; ++n)
+    {
+      step(n, true);
+    }
+    
+    // Each output frame is lane 3 of the top group. Collect four steps of it
+    // and transpose to store four frames at a time.
+    for (size_t t = 0; t < FRAMES; t += 4)
+    {
+      float4 top[4];
+      for (size_t k = 0; k < 4; ++k)
+      {
+        size_t n = t + k + kSkew;
+        step(n, n >= FRAMES);
+        top[k] = out[kNumGroups - 1];
+      }
+      storeFloat4(py + t, moveHL(unpackHi(top[2], top[3]), unpackHi(top[0], top[1])));
+    }
+    
+    for (size_t j = 0; j < kNumGroups; ++j)
+    {
+      groups_[j].s1 = g[j].s1;
+      groups_[j].s2 = g[j].s2;
+    }
+    return output;
+  }
+  
+ private:
+  struct Group
+  {
+    float4 b0{1.f}, b1{0.f}, b2{0.f}, a1{0.f}, a2{0.f};
+    float4 s1{0.f}, s2{0.f};
+  };
+  
+  std::array<BiquadCoeffs, kNumLanes> sections_{};
+  std::array<Group, kNumGroups> groups_{};
+};
+
+// BiquadCascadeFilter: N biquad sections in series with the Filter interface.
+// The params are the raw coefficients, kCoeffsPerSection per section in
+// BiquadCoeffs order, and are interpolated like any other filter's. With T =
+// float4 each lane is an independent channel, so this is the form to use in a
+// FilterBank, through an alias template:
+//   template<typename T, size_t FRAMES> using TenBandEQ = BiquadCascadeFilter<T, 10, FRAMES>;
+//   FilterBank<TenBandEQ, 16> eqs;
+// makeCoeffs() only copies the params, so there is no CoeffCache.
+
+template<typename T, size_t N, size_t FRAMES = kFramesPerBlock>
+struct BiquadCascadeFilter : Filter<T, BiquadCascadeFilter<T, N, FRAMES>, FRAMES>
+{
+  enum { b0, b1, b2, a1, a2, kCoeffsPerSection };
+  static constexpr size_t nParams{N * kCoeffsPerSection};
+  static constexpr size_t nCoeffs{nParams};
+  static constexpr size_t nStateVars{N * 2};
+  
+  using Params = std::array<T, nParams>;
+  using Coeffs = std::array<T, nCoeffs>;
+  using State = std::array<T, nStateVars>;
+  
+  Coeffs coeffs{makeCoeffs(passthru())};
+  State state{};
+  
+  BiquadCascadeFilter() = default;
+  
+  // params that pass the input through unchanged
+  static Params passthru()
+  {
+    Params p{};
+    for (size_t i = 0; i < N; ++i)
+    {
+      p[i * kCoeffsPerSection + b0] = T{1.f};
+    }
+    return p;
+  }
+  
+  // set section i in params p, the same in every lane
+  static void setSection(Params& p, size_t i, const BiquadCoeffs& c)
+  {
+    T* q = p.data() + i * kCoeffsPerSection;
+    q[b0] = T{c.b0};
+    q[b1] = T{c.b1};
+    q[b2] = T{c.b2};
+    q[a1] = T{c.a1};
+    q[a2] = T{c.a2};
+  }
+  
+  void clear() { state.fill(T{0.f}); }
+  
+  static Coeffs makeCoeffs(Params p) { return p; }
+  
+  T nextFrame(T x, const Coeffs& c)
+  {
+    for (size_t i = 0; i < N; ++i)
+    {
+      const T* q = c.data() + i * kCoeffsPerSection;
+      T* s = state.data() + 2 * i;
+      T y = q[b0] * x + s[0];
+      s[0] = q[b1] * x - q[a1] * y + s[1];
+      s[1] = q[b2] * x - q[a2] * y;
+      x = y;
+    }
+    return x;
+  }
+};
+
+template<typename T, size_t N, size_t FRAMES, typename U>
+struct RebindFilter<BiquadCascadeFilter<T, N, FRAMES>, U>
+{
+  using type = BiquadCascadeFilter<U, N, FRAMES>;
+};
+
 // ----------------------------------------------------------------
 // PinkFilter
 // Pink noise filter: parallel one-pole bank approximating -3 dB/octave.
@@ -600,7 +1140,7 @@ struct LadderFilter : Filter<T, LadderFilter<T>>
 // Apply to white noise to produce pink noise.
 // Based on Paul Kellet's parallel one-pole approximation.
 
-template<typename T>
+template<typename T, size_t FRAMES = kFramesPerBlock>
 struct PinkFilter
 {
   static constexpr int kNumPoles = 6;
@@ -686,10 +1226,10 @@ struct PinkFilter
     return sum;
   }
   
-  Block<T> operator()(const Block<T>& input)
+  Block<T, FRAMES> operator()(const Block<T, FRAMES>& input)
   {
-    Block<T> output;
-    for (size_t t = 0; t < kFramesPerBlock; ++t)
+    Block<T, FRAMES> output(uninitialized);
+    for (size_t t = 0; t < FRAMES; ++t)
       output[t] = nextFrame(input[t]);
     return output;
   }
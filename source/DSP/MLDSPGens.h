@@ -6,31 +6,72 @@
 
 #include "MLDSPOps.h"
 #include "MLDSPUtils.h"
+#include "MLDSPScale.h"
+#include "MLDSPFilters.h"
 
 namespace ml
 {
 
 // ----------------------------------------------------------------
 // Block generation objects, used by Gens
-template<typename T, typename Derived>
+
+// True if a generator has a nextBlock(coeffsBlock) method that makes a whole
+// block at once from nCoeffs rows of coefficients. Gen uses it instead of
+// calling nextFrame() for each frame. This is for generators that can work
+// across frames in parallel, like the accumulators built on the scans in
+// MLDSPOps.h.
+template<typename D, typename = void>
+struct HasNextBlock : std::false_type {};
+template<typename D>
+struct HasNextBlock<D, std::void_t<decltype(&D::nextBlock)>> : std::true_type {};
+
+// Gen: base class for generators. Each block is FRAMES frames long. As for
+// Filter, a CACHE_SIZE keeps a CoeffCache for generators whose makeCoeffs()
+// is expensive.
+
+template<typename T, typename Derived, size_t FRAMES = kFramesPerBlock, size_t CACHE_SIZE = 0>
 struct Gen
 {
+  static constexpr size_t kFrames{FRAMES};
   
   Gen() = default;
 
   // Block processing with signal-rate params (one Params per frame)
   template<size_t N_PARAMS>
-  Block<T> operator()(const SignalBlockArrayBase<T, N_PARAMS>& paramBlock)
+  Block<T, FRAMES> operator()(const SignalBlockArrayBase<T, N_PARAMS, FRAMES>& paramBlock)
   {
     static_assert(N_PARAMS == Derived::nParams, "paramBlock row count must match nParams");
+    return processParamRows(paramBlock.data());
+  }
+
+  // Block processing with signal-rate params read in place: nParams rows of
+  // FRAMES frames, one after another from paramRows. The banks use this to
+  // run each processor on its slice of their param rows.
+  Block<T, FRAMES> processParamRows(const T* paramRows)
+  {
     auto& self = *static_cast<Derived*>(this);
-    Block<T> output;
     
-    for (size_t t = 0; t < kFramesPerBlock; ++t)
+    if constexpr (HasNextBlock<Derived>::value)
+    {
+      SignalBlockArrayBase<T, Derived::nCoeffs, FRAMES> coeffsBlock(uninitialized);
+      for (size_t t = 0; t < FRAMES; ++t)
+      {
+        typename Derived::Params p;
+        for (size_t i = 0; i < Derived::nParams; ++i)
+          p[i] = paramRows[i * FRAMES + t];
+        self.coeffs = Derived::makeCoeffs(p);
+        for (size_t i = 0; i < Derived::nCoeffs; ++i)
+          coeffsBlock.rowPtr(i)[t] = self.coeffs[i];
+      }
+      return self.nextBlock(coeffsBlock);
+    }
+    
+    Block<T, FRAMES> output(uninitialized);
+    for (size_t t = 0; t < FRAMES; ++t)
     {
       typename Derived::Params p;
       for (size_t i = 0; i < Derived::nParams; ++i)
-        p[i] = paramBlock.rowPtr(i)[t];
+        p[i] = paramRows[i * FRAMES + t];
       self.coeffs = Derived::makeCoeffs(p);
       output[t] = self.nextFrame(self.coeffs);
     }
@@ -39,43 +80,67 @@ struct Gen
   
   // Block processing with coefficient interpolation from std::array argument
   template<size_t N_PARAMS>
-  Block<T> operator()(const std::array<T, N_PARAMS>& nextParams)
+  Block<T, FRAMES> operator()(const std::array<T, N_PARAMS>& nextParams)
   {
     static_assert(N_PARAMS == Derived::nParams, "paramBlock row count must match nParams");
-    auto& self = *static_cast<Derived*>(this);
-    Block<T> output;
-    
-    auto nextCoeffs = Derived::makeCoeffs(nextParams);
-    auto coeffsBlock = interpolateCoeffsLinear(self.coeffs, nextCoeffs);
-    self.coeffs = nextCoeffs;
-    
-    for (size_t t = 0; t < kFramesPerBlock; ++t)
-    {
-      typename Derived::Coeffs c;
-      for (size_t i = 0; i < Derived::nCoeffs; ++i)
-        c[i] = coeffsBlock.rowPtr(i)[t];
-      output[t] = self.nextFrame(c);
-    }
-    return output;
+    return processInterpolated(nextParams);
   }
   
   
   // Block processing with coefficient interpolation — list of float arguments
   template<typename... Args,
   typename = std::enable_if_t<(std::is_same_v<std::remove_cv_t<std::remove_reference_t<Args>>, float> && ...)>>
-  Block<T> operator()(Args&&... args)
+  Block<T, FRAMES> operator()(Args&&... args)
   {
     std::array<std::common_type_t<Args...>, sizeof...(Args)> arr = { std::forward<Args>(args)... };
     const std::array nextParams = arr;
-    
+    return processInterpolated(nextParams);
+  }
+
+  // Block processing with constant stored coefficients
+  Block<T, FRAMES> operator()()
+  {
+    return processConstant();
+  }
+  
+  // How many interpolating calls ran with constant coefficients, because the
+  // params were unchanged or, with no cache, the coefficients made from them.
+  const CoeffCacheStats& getCoeffCacheStats() const { return coeffCache_.getStats(); }
+  void resetCoeffCacheStats() { coeffCache_.resetStats(); }
+  
+ private:
+  CoeffCache<T, CACHE_SIZE> coeffCache_;
+  
+  // Interpolate from the stored coefficients to those for nextParams over
+  // the block. If nextParams made the stored coefficients, skip straight to
+  // the constant path.
+  template<size_t N_PARAMS>
+  Block<T, FRAMES> processInterpolated(const std::array<T, N_PARAMS>& nextParams)
+  {
     auto& self = *static_cast<Derived*>(this);
-    Block<T> output;
+    if constexpr (CACHE_SIZE > 0)
+    {
+      if (coeffCache_.matches(nextParams, self.coeffs)) return processConstant();
+    }
     
     auto nextCoeffs = Derived::makeCoeffs(nextParams);
-    auto coeffsBlock = interpolateCoeffsLinear(self.coeffs, nextCoeffs);
+    if constexpr (CACHE_SIZE > 0)
+    {
+      coeffCache_.store(nextParams, nextCoeffs);
+    }
+    else if (coeffCache_.matches(nextCoeffs, self.coeffs))
+    {
+      return processConstant();
+    }
+    auto coeffsBlock = interpolateCoeffsLinear<FRAMES>(self.coeffs, nextCoeffs);
     self.coeffs = nextCoeffs;
+    if constexpr (HasNextBlock<Derived>::value)
+    {
+      return self.nextBlock(coeffsBlock);
+    }
     
-    for (size_t t = 0; t < kFramesPerBlock; ++t)
+    Block<T, FRAMES> output(uninitialized);
+    for (size_t t = 0; t < FRAMES; ++t)
     {
       typename Derived::Coeffs c;
       for (size_t i = 0; i < Derived::nCoeffs; ++i)
@@ -84,27 +149,39 @@ struct Gen
     }
     return output;
   }
-
-  // Block processing with constant stored coefficients
-  Block<T> operator()()
+  
+  // Run with the stored coefficients. The local copy lets the compiler keep
+  // them in registers, since nextFrame() writes the state through this.
+  Block<T, FRAMES> processConstant()
   {
     auto& self = *static_cast<Derived*>(this);
-    Block<T> output;
-    for (size_t t = 0; t < kFramesPerBlock; ++t)
-      output[t] = self.nextFrame(self.coeffs);
+    const typename Derived::Coeffs c = self.coeffs;
+    if constexpr (HasNextBlock<Derived>::value)
+    {
+      SignalBlockArrayBase<T, Derived::nCoeffs, FRAMES> coeffsBlock(uninitialized);
+      for (size_t i = 0; i < Derived::nCoeffs; ++i)
+        coeffsBlock.setRow(i, Block<T, FRAMES>(c[i]));
+      return self.nextBlock(coeffsBlock);
+    }
+    
+    Block<T, FRAMES> output(uninitialized);
+    for (size_t t = 0; t < FRAMES; ++t)
+      output[t] = self.nextFrame(c);
     return output;
   }
 };
 
 // a generator with no params.
-template<typename T, typename Derived>
+template<typename T, typename Derived, size_t FRAMES = kFramesPerBlock>
 struct Gen0
 {
-  Block<T> operator()()
+  static constexpr size_t kFrames{FRAMES};
+  
+  Block<T, FRAMES> operator()()
   {
     auto& self = *static_cast<Derived*>(this);
-    Block<T> output;
-    for (size_t t = 0; t < kFramesPerBlock; ++t)
+    Block<T, FRAMES> output(uninitialized);
+    for (size_t t = 0; t < FRAMES; ++t)
       output[t] = self.nextFrame();
     return output;
   }
@@ -197,8 +274,8 @@ T phasorToSawSample(T phase, T freq)
 // ----------------------------------------------------------------
 // Frame counter generator
 
-template<typename T>
-struct Counter : Gen<T, Counter<T>>
+template<typename T, size_t FRAMES = kFramesPerBlock>
+struct Counter : Gen<T, Counter<T, FRAMES>, FRAMES>
 {
   enum { nParams = 0 };
   enum { nCoeffs = 0 };
@@ -210,6 +287,7 @@ struct Counter : Gen<T, Counter<T>>
   T state_{0.f};
   
   void clear() { state_ = T{0.f}; }
+  void clearLanes(T mask) { state_ = andNotBits(mask, state_); }
   
   static Coeffs makeCoeffs(Params) { return {}; }
   
@@ -219,14 +297,19 @@ struct Counter : Gen<T, Counter<T>>
     state_ += T{1.0f};
     return currentValue;
   }
+  
+  Block<T, FRAMES> nextBlock(const SignalBlockArrayBase<T, nCoeffs, FRAMES>&)
+  {
+    return exclusiveScan(Block<T, FRAMES>(T{1.0f}), state_);
+  }
 };
 
 // ----------------------------------------------------------------
 // TickGen
 // Generate a single-sample tick, repeating at a frequency given by the input.
 
-template<typename T>
-struct TickGen : Gen<T, TickGen<T>>
+template<typename T, size_t FRAMES = kFramesPerBlock>
+struct TickGen : Gen<T, TickGen<T, FRAMES>, FRAMES>
 {
   enum { freq, nParams };
   enum { freqCoeff, nCoeffs };
@@ -241,6 +324,7 @@ struct TickGen : Gen<T, TickGen<T>>
   TickGen(T freq) { coeffs = makeCoeffs(Params{freq}); }
 
   void clear() { omega_ = T{0.f}; }
+  void clearLanes(T mask) { omega_ = andNotBits(mask, omega_); }
 
   static Coeffs makeCoeffs(Params p) { return Coeffs(p); }
 
@@ -271,8 +355,8 @@ struct TickGen : Gen<T, TickGen<T>>
 // Uses a windowed sinc table with two readout voices for crossfading
 // when impulses overlap at high frequencies.
 
-template<typename T>
-struct ImpulseGen : Gen<T, ImpulseGen<T>>
+template<typename T, size_t FRAMES = kFramesPerBlock>
+struct ImpulseGen : Gen<T, ImpulseGen<T, FRAMES>, FRAMES>
 {
   enum { freq, nParams };
   enum { freqCoeff, nCoeffs };
@@ -326,6 +410,17 @@ struct ImpulseGen : Gen<T, ImpulseGen<T>>
     ampA_ = ampB_ = T{0.f};
     ampStepA_ = ampStepB_ = T{0.f};
   }
+
+  void clearLanes(T mask)
+  {
+    phase_ = select(T{1.f}, phase_, mask);
+    posA_ = select(T{kTableEnd}, posA_, mask);
+    posB_ = select(T{kTableEnd}, posB_, mask);
+    ampA_ = andNotBits(mask, ampA_);
+    ampB_ = andNotBits(mask, ampB_);
+    ampStepA_ = andNotBits(mask, ampStepA_);
+    ampStepB_ = andNotBits(mask, ampStepB_);
+  }
   
   // TODO verify: hopefully the compiler can get rid of this unneccessary copy. If not,
   // we could make another base class for when no calculation is needed
@@ -438,8 +533,8 @@ struct ImpulseGen : Gen<T, ImpulseGen<T>>
 // ----------------------------------------------------------------
 // NoiseGen
 
-template<typename T>
-struct NoiseGen : Gen0<T, NoiseGen<T>>
+template<typename T, size_t FRAMES = kFramesPerBlock>
+struct NoiseGen : Gen0<T, NoiseGen<T, FRAMES>, FRAMES>
 {
   using IntState = std::conditional_t<std::is_same_v<T, float>, uint32_t, int4>;
   IntState seed_{};
@@ -452,7 +547,8 @@ struct NoiseGen : Gen0<T, NoiseGen<T>>
     }
     else
     {
-      // set different seeds for each lane
+      // set different seeds for each lane. The lanes are offsets into one
+      // sequence; for independent streams, see RandomStream.
       seed_ = setrInt(x, x * 2, x * 3, x * 4);
     }
   }
@@ -466,11 +562,155 @@ struct NoiseGen : Gen0<T, NoiseGen<T>>
   }
 };
 
+// ----------------------------------------------------------------
+// RandomStream: counter-based random numbers, a block at a time.
+//
+// Sample n of a stream is a hash of n and a key made from a seed and a stream
+// id. The streams made from one seed are independent, and each one is
+// reproducible no matter how the others are used. The only state is the
+// position n, so a stream can be moved to any point at no cost. A whole block
+// is hashed at once, four samples to an int4.
+//
+// The hash is two keyed rounds of a 32-bit xorshift-multiply mixer (Chris
+// Wellons' lowbias32), which needs only the 32-bit integer ops of int4. A
+// stream repeats after 2^32 samples, about a day at 48 kHz.
+//
+// RandomStream<float> makes the one stream with its stream id s.
+// RandomStream<float4> makes four streams, one per lane, with ids 4s to
+// 4s + 3. So a voice v of a bank played by lane v % 4 of processor v / 4,
+// seeded with setSeed(seed, v / 4), gets the same noise as a
+// RandomStream<float> seeded with setSeed(seed, v).
+
+template<typename T, size_t FRAMES = kFramesPerBlock>
+class RandomStream
+{
+  static constexpr size_t kLanes{std::is_same_v<T, float> ? 1 : 4};
+
+  // the int4 vectors in one block of output
+  static constexpr size_t kVectors{FRAMES * kLanes / 4};
+
+ public:
+  RandomStream(uint32_t seed = 0, uint32_t stream = 0)
+  {
+    setSeed(seed, stream);
+    setSampleRate(48000.f);
+  }
+
+  void setSeed(uint32_t seed, uint32_t stream = 0)
+  {
+    int32_t k0[4], k1[4];
+    for (size_t k = 0; k < 4; ++k)
+    {
+      uint32_t id = (kLanes == 1) ? stream : stream * 4 + uint32_t(k);
+      uint32_t a = mix(seed ^ mix(id + kGolden));
+      k0[k] = int32_t(a);
+      k1[k] = int32_t(mix(a + kGolden));
+    }
+    key0_ = int4(k0[0], k0[1], k0[2], k0[3]);
+    key1_ = int4(k1[0], k1[1], k1[2], k1[3]);
+    position_ = 0;
+  }
+
+  // Set the sample rate of the pink noise. This computes the PinkFilter
+  // coefficients, so don't call it from the audio thread.
+  void setSampleRate(float sr) { pink_.init(sr); }
+
+  // The position is the index of the next sample in each stream.
+  void setPosition(uint32_t n) { position_ = n; }
+  uint32_t getPosition() const { return position_; }
+
+  // Go back to the start of the streams.
+  void clear()
+  {
+    position_ = 0;
+    pink_.clear();
+  }
+
+  // white noise, uniform on [-1, 1).
+  Block<T, FRAMES> uniform()
+  {
+    Block<T, FRAMES> y(uninitialized);
+    float* py = reinterpret_cast<float*>(y.data());
+    for (size_t i = 0; i < kVectors; ++i)
+    {
+      storeFloat4(py + i * 4, bitsToFloat(hash(counters(i))) * float4(2.f) - float4(3.f));
+    }
+    position_ += FRAMES;
+    return y;
+  }
+
+  // white noise with a normal distribution, zero mean and unit variance.
+  // The Box-Muller transform makes each pair of samples i and
+  // i + FRAMES / 2 of a block from the hashes of both.
+  Block<T, FRAMES> gaussian()
+  {
+    constexpr size_t kHalf = kVectors / 2;
+    Block<T, FRAMES> y(uninitialized);
+    float* py = reinterpret_cast<float*>(y.data());
+    for (size_t i = 0; i < kHalf; ++i)
+    {
+      // u1 on (0, 1], and the angle on [-pi, pi).
+      float4 u1 = float4(2.f) - bitsToFloat(hash(counters(i)));
+      float4 angle = (bitsToFloat(hash(counters(i + kHalf))) - float4(1.5f)) * float4(kTwoPi);
+      float4 r = sqrt(float4(-2.f) * log(u1));
+      auto [s, c] = sincos(angle);
+      storeFloat4(py + i * 4, r * c);
+      storeFloat4(py + (i + kHalf) * 4, r * s);
+    }
+    position_ += FRAMES;
+    return y;
+  }
+
+  // uniform white noise through a PinkFilter.
+  Block<T, FRAMES> pink() { return pink_(uniform()); }
+
+ private:
+  static constexpr uint32_t kGolden{0x9E3779B9};
+
+  int4 key0_, key1_;
+  uint32_t position_{0};
+  PinkFilter<T, FRAMES> pink_;
+
+  static uint32_t mix(uint32_t x)
+  {
+    x ^= x >> 16;
+    x *= 0x7FEB352D;
+    x ^= x >> 15;
+    x *= 0x846CA68B;
+    x ^= x >> 16;
+    return x;
+  }
+
+  static int4 mix(int4 x)
+  {
+    x = xorBits(x, x >> 16);
+    x = x * int4(int32_t(0x7FEB352D));
+    x = xorBits(x, x >> 15);
+    x = x * int4(int32_t(0x846CA68B));
+    return xorBits(x, x >> 16);
+  }
+
+  int4 hash(int4 n) const { return mix(xorBits(mix(n + key0_), key1_)); }
+
+  // the counters for int4 vector i of a block: four samples of one stream,
+  // or one sample of four streams.
+  int4 counters(size_t i) const
+  {
+    if constexpr (kLanes == 1)
+      return int4(int32_t(position_ + i * 4)) + int4(0, 1, 2, 3);
+    else
+      return int4(int32_t(position_ + i));
+  }
+
+  // the top 23 bits as a float on [1, 2).
+  static float4 bitsToFloat(int4 x) { return reinterpretIntAsFloat((x >> 9) | int4(0x3F800000)); }
+};
+
 // ----------------------------------------------------------------
 // PhasorGen: naive (not antialiased) sawtooth / phase ramp on (0, 1).
 
-template<typename T>
-struct PhasorGen : Gen<T, PhasorGen<T>>
+template<typename T, size_t FRAMES = kFramesPerBlock>
+struct PhasorGen : Gen<T, PhasorGen<T, FRAMES>, FRAMES>
 {
   enum { freq, nParams };
   enum { freqCoeff, nCoeffs };
@@ -485,6 +725,7 @@ struct PhasorGen : Gen<T, PhasorGen<T>>
   PhasorGen(T freq) { coeffs = makeCoeffs(Params{freq}); }
 
   void clear() { omega_ = T{0.f}; }
+  void clearLanes(T mask) { omega_ = andNotBits(mask, omega_); }
 
   // just copying param to get the coefficient, needed for template compatibility
   static Coeffs makeCoeffs(Params p) { return Coeffs(p); }
@@ -494,13 +735,18 @@ struct PhasorGen : Gen<T, PhasorGen<T>>
     omega_ = fracPart(omega_ + c[freqCoeff]);
     return omega_;
   }
+  
+  Block<T, FRAMES> nextBlock(const SignalBlockArrayBase<T, nCoeffs, FRAMES>& c)
+  {
+    return wrappingScan(c.getRow(freqCoeff), omega_);
+  }
 };
 
 // ----------------------------------------------------------------
 // super slow + accurate sine generator for testing
 
-template<typename T>
-struct TestSineGen : Gen<T, TestSineGen<T>>
+template<typename T, size_t FRAMES = kFramesPerBlock>
+struct TestSineGen : Gen<T, TestSineGen<T, FRAMES>, FRAMES>
 {
   enum { freq, nParams };
   enum { freqCoeff, nCoeffs };
@@ -515,6 +761,7 @@ struct TestSineGen : Gen<T, TestSineGen<T>>
   TestSineGen(T freq) { coeffs = makeCoeffs(Params{freq}); }
 
   void clear() { omega_ = T{0.f}; }
+  void clearLanes(T mask) { omega_ = andNotBits(mask, omega_); }
 
   static Coeffs makeCoeffs(Params p) { return Coeffs(p); }
 
@@ -538,8 +785,8 @@ struct TestSineGen : Gen<T, TestSineGen<T>>
 // ----------------------------------------------------------------
 // Antialiased waveform generators using PhasorGen
 
-template<typename T>
-struct SineGen : Gen<T, SineGen<T>>
+template<typename T, size_t FRAMES = kFramesPerBlock>
+struct SineGen : Gen<T, SineGen<T, FRAMES>, FRAMES>
 {
   enum { freq, nParams };
   enum { freqCoeff, nCoeffs };
@@ -548,24 +795,26 @@ struct SineGen : Gen<T, SineGen<T>>
   using Coeffs = std::array<T, nCoeffs>;
   
   Coeffs coeffs{};
-  PhasorGen<T> phasor_;
+  PhasorGen<T, FRAMES> phasor_;
 
   SineGen() = default;
   SineGen(T freq) { coeffs = makeCoeffs(Params{freq}); }
 
   // initial phase of 0.75 maps to zero-crossing of the sine approximation
   void clear() { phasor_.clear(); phasor_.omega_ = T{0.75f}; }
+  void clearLanes(T mask) { phasor_.omega_ = select(T{0.75f}, phasor_.omega_, mask); }
   
   static Coeffs makeCoeffs(Params p) { return Coeffs(p); }
   
   T nextFrame(Coeffs c)
   {
-    return phasorToSineSample(phasor_.nextFrame(typename PhasorGen<T>::Coeffs{c[freqCoeff]}));
+    T phase = phasor_.nextFrame(typename PhasorGen<T, FRAMES>::Coeffs{c[freqCoeff]});
+    return phasorToSineSample(phase);
   }
 };
 
-template<typename T>
-struct SawGen : Gen<T, SawGen<T>>
+template<typename T, size_t FRAMES = kFramesPerBlock>
+struct SawGen : Gen<T, SawGen<T, FRAMES>, FRAMES>
 {
   enum { freq, nParams };
   enum { freqCoeff, nCoeffs };
@@ -574,27 +823,28 @@ struct SawGen : Gen<T, SawGen<T>>
   using Coeffs = std::array<T, nCoeffs>;
   
   Coeffs coeffs{};
-  PhasorGen<T> phasor_;
+  PhasorGen<T, FRAMES> phasor_;
 
   SawGen() = default;
   SawGen(T freq) { coeffs = makeCoeffs(Params{freq}); }
 
   void clear() { phasor_.clear(); }
+  void clearLanes(T mask) { phasor_.clearLanes(mask); }
 
   static Coeffs makeCoeffs(Params p) { return Coeffs(p); }
 
   T nextFrame(Coeffs c)
   {
     T f = c[freqCoeff];
-    T phase = phasor_.nextFrame(typename PhasorGen<T>::Coeffs{f});
+    T phase = phasor_.nextFrame(typename PhasorGen<T, FRAMES>::Coeffs{f});
     return phasorToSawSample(phase, f);
   }
 };
 
 // PulseGen takes two inputs (freq and width).
 
-template<typename T>
-struct PulseGen : Gen<T, PulseGen<T>>
+template<typename T, size_t FRAMES = kFramesPerBlock>
+struct PulseGen : Gen<T, PulseGen<T, FRAMES>, FRAMES>
 {
   enum { freq, width, nParams };
   enum { freqCoeff, widthCoeff, nCoeffs };
@@ -604,7 +854,7 @@ struct PulseGen : Gen<T, PulseGen<T>>
   
   const Params kDefaultParams{0.f, 0.5f};
   Coeffs coeffs{makeCoeffs(kDefaultParams)};
-  PhasorGen<T> phasor_;
+  PhasorGen<T, FRAMES> phasor_;
 
   PulseGen() = default;
   PulseGen(T freq, T width = 0.5f) { coeffs = makeCoeffs(Params{freq, width}); }
@@ -613,15 +863,201 @@ struct PulseGen : Gen<T, PulseGen<T>>
   {
     phasor_.clear();
   }
+
+  void clearLanes(T mask) { phasor_.clearLanes(mask); }
   
   static Coeffs makeCoeffs(Params p) { return Coeffs(p); }
   
   T nextFrame(Coeffs c)
   {
     T f = c[freqCoeff];
-    T phase = phasor_.nextFrame(typename PhasorGen<T>::Coeffs{f});
+    T phase = phasor_.nextFrame(typename PhasorGen<T, FRAMES>::Coeffs{f});
     return phasorToPulseSample(phase, f, c[widthCoeff]);
   }
 };
 
+// ----------------------------------------------------------------
+// AdditiveBank: PARTIALS sine partials, summed to one output.
+//
+// The partials are run four at a time in float4 lanes. Each partial is a
+// unit complex number z, rotated every frame by its frequency r = e^(i w).
+// When a frequency changes, r is rotated in turn by a constant step over the
+// block, so that both the frequency and the amplitude of each partial ramp
+// linearly from their values at the end of the last block to the new ones.
+// The rotations are computed once per block, or per 64 frames in longer
+// blocks, and the magnitude of z is corrected at the same times, so no sines
+// are computed per frame.
+//
+// Partials at or above Nyquist are faded out over one block, and groups of
+// four partials that are all silent are skipped. With partials in order of
+// frequency, the cost of the bank falls as the pitch rises.
+//
+// Frequencies are in cycles per sample, as for the Gens. If a Scale is set,
+// each partial's frequency is moved to the note of the scale just below it,
+// by Scale::quantizePitch(). This is done only when a frequency changes.
+
+template<size_t PARTIALS, size_t FRAMES = kFramesPerBlock>
+class AdditiveBank
+{
+  static_assert(PARTIALS % 4 == 0, "AdditiveBank: PARTIALS must be a multiple of 4");
+  static constexpr size_t kGroups{PARTIALS / 4};
+  using FloatArray = std::array<float4, kGroups>;
+
+ public:
+  AdditiveBank() { clear(); }
+
+  // Start all partials at zero phase, amplitude and frequency.
+  void clear()
+  {
+    zr_.fill(float4(1.f));
+    zi_.fill(float4(0.f));
+    freqs_.fill(float4(0.f));
+    amps_.fill(float4(0.f));
+    nextFreqs_.fill(float4(0.f));
+    nextAmps_.fill(float4(0.f));
+    inputFreqs_.fill(0.f);
+  }
+
+  // Quantize the frequencies of the partials to a scale, or stop quantizing
+  // with nullptr. The Scale must outlive its use here.
+  void setScale(const Scale* scale, float sampleRate)
+  {
+    scale_ = scale;
+    sampleRate_ = sampleRate;
+    for (size_t i = 0; i < PARTIALS; ++i) setFrequency(i, inputFreqs_[i], true);
+  }
+
+  // Set the frequency and amplitude that partial i will reach at the end of
+  // the next block.
+  void setPartial(size_t i, float freq, float amp)
+  {
+    setFrequency(i, freq);
+    setFloat4Lane(nextAmps_[i / 4], i % 4, amp);
+  }
+
+  void setFrequencies(const std::array<float, PARTIALS>& freqs)
+  {
+    for (size_t i = 0; i < PARTIALS; ++i) setFrequency(i, freqs[i]);
+  }
+
+  void setAmplitudes(const std::array<float, PARTIALS>& amps)
+  {
+    for (size_t g = 0; g < kGroups; ++g) nextAmps_[g] = loadFloat4Unaligned(amps.data() + g * 4);
+  }
+
+  // the number of partials, in groups of four, that made the last block.
+  size_t getActivePartials() const { return activeGroups_ * 4; }
+
+  SignalBlockOf<FRAMES> operator()()
+  {
+    constexpr float kBlockScale = 1.f / FRAMES;
+    Block<float4, FRAMES> sums(0.f);
+    activeGroups_ = 0;
+    for (size_t g = 0; g < kGroups; ++g)
+    {
+      // the amplitude of a partial is zero when it is at or above Nyquist.
+      const float4 nyquist(0.5f);
+      float4 amp0 = andBits(amps_[g], abs4(freqs_[g]) < nyquist);
+      float4 amp1 = andBits(nextAmps_[g], abs4(nextFreqs_[g]) < nyquist);
+      bool silent = vecSumH(abs4(amp0) + abs4(amp1)) == 0.f;
+
+      if (!silent)
+      {
+        activeGroups_++;
+        float4 w0 = freqs_[g] * float4(kTwoPi);
+        float4 w1 = nextFreqs_[g] * float4(kTwoPi);
+        float4 dAmp = (amp1 - amp0) * float4(kBlockScale);
+        if (allEqual(w0, w1))
+        {
+          renderGroup<false>(g, sums, w1, float4(0.f), amp0, dAmp);
+        }
+        else
+        {
+          renderGroup<true>(g, sums, w0, (w1 - w0) * float4(kBlockScale), amp0, dAmp);
+        }
+      }
+
+      freqs_[g] = nextFreqs_[g];
+      amps_[g] = nextAmps_[g];
+    }
+
+    SignalBlockOf<FRAMES> y(uninitialized);
+    for (size_t t = 0; t < FRAMES; ++t) y[t] = vecSumH(sums[t]);
+    return y;
+  }
+
+ private:
+  FloatArray zr_, zi_;
+  FloatArray freqs_, amps_;
+  FloatArray nextFreqs_, nextAmps_;
+  std::array<float, PARTIALS> inputFreqs_;
+  const Scale* scale_{nullptr};
+  float sampleRate_{48000.f};
+  size_t activeGroups_{0};
+
+  static float4 abs4(float4 x) { return andNotBits(float4(-0.f), x); }
+  static bool allEqual(float4 a, float4 b) { return vecSumH(abs4(a - b)) == 0.f; }
+
+  void setFrequency(size_t i, float freq, bool force = false)
+  {
+    if (!force && (freq == inputFreqs_[i])) return;
+    inputFreqs_[i] = freq;
+    if (scale_ && (freq > 0.f))
+    {
+      // log pitches of the scale are relative to 440 Hz.
+      float pitch = scale_->quantizePitch(log2f(freq * sampleRate_ / 440.f));
+      freq = 440.f * exp2f(pitch) / sampleRate_;
+    }
+    setFloat4Lane(nextFreqs_[i / 4], i % 4, freq);
+  }
+
+  // The recurrences are restarted from rotations computed with sincos(), and
+  // |z| is corrected, every kSpan frames, so that their rounding errors do
+  // not grow with the block size.
+  static constexpr size_t kSpan{std::min(FRAMES, size_t(64))};
+
+  // Add the partials of group g to the sums, starting from frequency w and
+  // amplitude amp, and stepping them by dw and dAmp each frame.
+  template<bool RAMP>
+  void renderGroup(size_t g, Block<float4, FRAMES>& sums, float4 w, float4 dw, float4 amp,
+                   float4 dAmp)
+  {
+    float4 zr = zr_[g], zi = zi_[g];
+    float4 dr(1.f), di(0.f);
+    if constexpr (RAMP)
+    {
+      auto [ds, dc] = sincos(dw);
+      dr = dc;
+      di = ds;
+    }
+    for (size_t t0 = 0; t0 < FRAMES; t0 += kSpan)
+    {
+      auto [rs, rc] = sincos(w + dw * float4(float(t0 + 1)));
+      float4 rr = rc, ri = rs;
+      float4 a = amp + dAmp * float4(float(t0));
+      for (size_t t = t0; t < t0 + kSpan; ++t)
+      {
+        float4 zrNext = zr * rr - zi * ri;
+        zi = zr * ri + zi * rr;
+        zr = zrNext;
+        a += dAmp;
+        sums[t] += a * zi;
+        if constexpr (RAMP)
+        {
+          float4 rrNext = rr * dr - ri * di;
+          ri = rr * di + ri * dr;
+          rr = rrNext;
+        }
+      }
+
+      // one Newton step toward |z| = 1.
+      float4 k = float4(1.5f) - float4(0.5f) * (zr * zr + zi * zi);
+      zr = zr * k;
+      zi = zi * k;
+    }
+    zr_[g] = zr;
+    zi_[g] = zi;
+  }
+};
+
 }  // namespace ml
@@ -0,0 +1,354 @@
+// madronalib: a C++ framework for DSP applications.
+// Copyright (c) 2026 Madrona Labs LLC. http://www.madronalabs.com
+// Distributed under the MIT license: http://madrona-labs.mit-license.org/
+
+// MLDSPKernels.h
+// Kernel bodies for runtime dispatch. Each MLDSPKernels*.cpp file defines the
+// ML_SIMD_* macro for its instruction set and ML_DSP_KERNELS_NAMESPACE, then
+// includes this file once. The file is deliberately not include-guarded.
+//
+// The SIMD headers are included inside ml::ML_DSP_KERNELS_NAMESPACE, so every
+// inline function and template instantiated here gets a name private to one
+// instruction set. Otherwise the linker could merge, for example, an AVX2-encoded
+// copy of operator+(float4, float4) with the baseline one used everywhere else,
+// and the program would crash on older CPUs. The system headers the SIMD headers
+// use are included first, at global scope, so their include guards keep them
+// out of the namespace.
+
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <type_traits>
+#include <utility>
+#include <float.h>
+#include <assert.h>
+
+#if (defined __ARM_NEON) || (defined __ARM_NEON__)
+#include <arm_neon.h>
+#else
+#include <immintrin.h>
+#endif
+
+#include "MLPlatform.h"
+#include "MLDSPDispatch.h"
+
+namespace ml
+{
+namespace ML_DSP_KERNELS_NAMESPACE
+{
+
+#include "MLDSPMathSIMD.h"
+#include "MLDSPMathApprox.h"
+
+// ----------------------------------------------------------------
+// loads and stores. The float4 tail uses aligned access; wider vectors may
+// straddle 16-byte boundaries so they use unaligned access.
+
+template<typename V> inline V loadVec(const float* p);
+template<> inline float4 loadVec<float4>(const float* p) { return loadFloat4(p); }
+inline void storeVec(float* p, float4 v) { storeFloat4(p, v); }
+inline void storeVec(int32_t* p, int4 v) { storeInt4(p, v); }
+
+#if (defined ML_SIMD_AVX2) || (defined ML_SIMD_AVX512)
+template<> inline float8 loadVec<float8>(const float* p) { return loadFloat8Unaligned(p); }
+inline void storeVec(float* p, float8 v) { storeFloat8Unaligned(p, v); }
+inline void storeVec(int32_t* p, int32x8 v) {
+  storeFloat8Unaligned(reinterpret_cast<float*>(p), reinterpretIntAsFloat(v));
+}
+#endif
+
+#if (defined ML_SIMD_AVX512)
+template<> inline float16 loadVec<float16>(const float* p) { return loadFloat16Unaligned(p); }
+inline void storeVec(float* p, float16 v) { storeFloat16Unaligned(p, v); }
+inline void storeVec(int32_t* p, int32x16 v) {
+  storeFloat16Unaligned(reinterpret_cast<float*>(p), reinterpretIntAsFloat(v));
+}
+#endif
+
+template<typename V>
+inline IntTypeFor_t<V> loadIntVec(const int32_t* p) {
+  return reinterpretFloatAsInt(loadVec<V>(reinterpret_cast<const float*>(p)));
+}
+
+// ----------------------------------------------------------------
+// element-wise loops: floatN vectors, then a float4 tail
+
+constexpr size_t kW = kSIMDWideVectorElems;
+
+template<typename OP>
+inline void runF2F(const float* a, float* r, size_t n, OP op) {
+  size_t i = 0;
+  for (; i + kW <= n; i += kW) storeVec(r + i, op(loadVec<floatN>(a + i)));
+  for (; i < n; i += 4) storeVec(r + i, op(loadVec<float4>(a + i)));
+}
+
+template<typename OP>
+inline void runFF2F(const float* a, const float* b, float* r, size_t n, OP op) {
+  size_t i = 0;
+  for (; i + kW <= n; i += kW) storeVec(r + i, op(loadVec<floatN>(a + i), loadVec<floatN>(b + i)));
+  for (; i < n; i += 4) storeVec(r + i, op(loadVec<float4>(a + i), loadVec<float4>(b + i)));
+}
+
+template<typename OP>
+inline void runFFF2F(const float* a, const float* b, const float* c, float* r, size_t n, OP op) {
+  size_t i = 0;
+  for (; i + kW <= n; i += kW) {
+    storeVec(r + i, op(loadVec<floatN>(a + i), loadVec<floatN>(b + i), loadVec<floatN>(c + i)));
+  }
+  for (; i < n; i += 4) {
+    storeVec(r + i, op(loadVec<float4>(a + i), loadVec<float4>(b + i), loadVec<float4>(c + i)));
+  }
+}
+
+template<typename OP>
+inline void runII2I(const int32_t* a, const int32_t* b, int32_t* r, size_t n, OP op) {
+  size_t i = 0;
+  for (; i + kW <= n; i += kW) storeVec(r + i, op(loadIntVec<floatN>(a + i), loadIntVec<floatN>(b + i)));
+  for (; i < n; i += 4) storeVec(r + i, op(loadInt4(a + i), loadInt4(b + i)));
+}
+
+template<typename OP>
+inline void runF2I(const float* a, int32_t* r, size_t n, OP op) {
+  size_t i = 0;
+  for (; i + kW <= n; i += kW) storeVec(r + i, op(loadVec<floatN>(a + i)));
+  for (; i < n; i += 4) storeVec(r + i, op(loadVec<float4>(a + i)));
+}
+
+template<typename OP>
+inline void runI2F(const int32_t* a, float* r, size_t n, OP op) {
+  size_t i = 0;
+  for (; i + kW <= n; i += kW) storeVec(r + i, op(loadIntVec<floatN>(a + i)));
+  for (; i < n; i += 4) storeVec(r + i, op(loadInt4(a + i)));
+}
+
+// ----------------------------------------------------------------
+// kernels for the op lists
+
+#define ML_KERNEL_F2F(name, expr) \
+void name##Kernel(const float* a, float* r, size_t n) { \
+runF2F(a, r, n, [](auto x) { return (expr); }); \
+}
+
+#define ML_KERNEL_FF2F(name, expr) \
+void name##Kernel(const float* a, const float* b, float* r, size_t n) { \
+runFF2F(a, b, r, n, [](auto x, auto y) { return (expr); }); \
+}
+
+#define ML_KERNEL_FFF2F(name, expr) \
+void name##Kernel(const float* a, const float* b, const float* c, float* r, size_t n) { \
+runFFF2F(a, b, c, r, n, [](auto x, auto y, auto z) { return (expr); }); \
+}
+
+#define ML_KERNEL_II2I(name, expr) \
+void name##Kernel(const int32_t* a, const int32_t* b, int32_t* r, size_t n) { \
+runII2I(a, b, r, n, [](auto x, auto y) { return (expr); }); \
+}
+
+#define ML_KERNEL_FF2F_MS(name, expr) \
+void name##Kernel(const float* a, const float* b, float* r, size_t rows, size_t rowSize) { \
+for (size_t row = 0; row < rows; ++row) { \
+runFF2F(a + row * rowSize, b, r + row * rowSize, rowSize, [](auto x, auto y) { return (expr); }); \
+} \
+}
+
+#define ML_KERNEL_F2I(name, expr) \
+void name##Kernel(const float* a, int32_t* r, size_t n) { \
+runF2I(a, r, n, [](auto x) { return (expr); }); \
+}
+
+#define ML_KERNEL_I2F(name, expr) \
+void name##Kernel(const int32_t* a, float* r, size_t n) { \
+runI2F(a, r, n, [](auto x) { return (expr); }); \
+}
+
+ML_DSP_OPS_F2F(ML_KERNEL_F2F)
+ML_DSP_OPS_FF2F(ML_KERNEL_FF2F)
+ML_DSP_OPS_FFF2F(ML_KERNEL_FFF2F)
+ML_DSP_OPS_II2I(ML_KERNEL_II2I)
+ML_DSP_OPS_FF2F_MS(ML_KERNEL_FF2F_MS)
+ML_DSP_OPS_F2I(ML_KERNEL_F2I)
+ML_DSP_OPS_I2F(ML_KERNEL_I2F)
+
+#undef ML_KERNEL_F2F
+#undef ML_KERNEL_FF2F
+#undef ML_KERNEL_FFF2F
+#undef ML_KERNEL_II2I
+#undef ML_KERNEL_FF2F_MS
+#undef ML_KERNEL_F2I
+#undef ML_KERNEL_I2F
+
+void sincosKernel(const float* x, float* s, float* c, size_t n) {
+  size_t i = 0;
+  for (; i + kW <= n; i += kW) {
+    auto sc = sincos(loadVec<floatN>(x + i));
+    storeVec(s + i, sc.first);
+    storeVec(c + i, sc.second);
+  }
+  for (; i < n; i += 4) {
+    auto sc = sincos(loadVec<float4>(x + i));
+    storeVec(s + i, sc.first);
+    storeVec(c + i, sc.second);
+  }
+}
+
+// ----------------------------------------------------------------
+// 4x4 transposes. A vector of kW floats holds the same row of kW / 4
+// consecutive 4x4 blocks, one block per 128-bit lane. The unpack and move
+// primitives work within 128-bit lanes, so the float4 transpose sequence
+// transposes all of the blocks at once.
+
+// row k of the blocks starting at p is loaded from p + 4k, p + 16 + 4k, ...
+template<typename V> inline V loadBlockRows(const float* p);
+template<> inline float4 loadBlockRows<float4>(const float* p) { return loadFloat4(p); }
+inline void storeBlockRows(float* p, float4 v) { storeFloat4(p, v); }
+
+#if (defined ML_SIMD_AVX2) || (defined ML_SIMD_AVX512)
+template<> inline float8 loadBlockRows<float8>(const float* p) {
+  return combineHalves(loadFloat4(p), loadFloat4(p + 16));
+}
+inline void storeBlockRows(float* p, float8 v) {
+  storeFloat4(p, lowHalf(v));
+  storeFloat4(p + 16, highHalf(v));
+}
+#endif
+
+#if (defined ML_SIMD_AVX512)
+template<> inline float16 loadBlockRows<float16>(const float* p) {
+  return combineHalves(loadBlockRows<float8>(p), loadBlockRows<float8>(p + 32));
+}
+inline void storeBlockRows(float* p, float16 v) {
+  storeBlockRows(p, lowHalf(v));
+  storeBlockRows(p + 32, highHalf(v));
+}
+#endif
+
+template<typename V>
+inline void transpose4(V& r0, V& r1, V& r2, V& r3) {
+  V t0 = unpackLo(r0, r1);
+  V t1 = unpackLo(r2, r3);
+  V t2 = unpackHi(r0, r1);
+  V t3 = unpackHi(r2, r3);
+  r0 = moveLH(t0, t1);
+  r1 = moveHL(t1, t0);
+  r2 = moveLH(t2, t3);
+  r3 = moveHL(t3, t2);
+}
+
+template<typename V>
+inline void transposeBlocks(float* p) {
+  V r0 = loadBlockRows<V>(p);
+  V r1 = loadBlockRows<V>(p + 4);
+  V r2 = loadBlockRows<V>(p + 8);
+  V r3 = loadBlockRows<V>(p + 12);
+  transpose4(r0, r1, r2, r3);
+  storeBlockRows(p, r0);
+  storeBlockRows(p + 4, r1);
+  storeBlockRows(p + 8, r2);
+  storeBlockRows(p + 12, r3);
+}
+
+void transpose4x4BlocksKernel(float* p, size_t numBlocks) {
+  constexpr size_t kBlocksPerVector = kW / 4;
+  size_t i = 0;
+  for (; i + kBlocksPerVector <= numBlocks; i += kBlocksPerVector) transposeBlocks<floatN>(p + i * 16);
+  for (; i < numBlocks; ++i) transposeBlocks<float4>(p + i * 16);
+}
+
+// Transposing block i of a vertical row gives lane L of frames 4i..4i+3, which
+// belong at 4i in horizontal row L. For consecutive blocks these are
+// contiguous, so one wide store writes kW / 4 blocks' worth of a lane.
+template<typename V>
+inline void verticalToHorizontalBlocks(const float* src, float* d0, float* d1, float* d2, float* d3) {
+  V r0 = loadBlockRows<V>(src);
+  V r1 = loadBlockRows<V>(src + 4);
+  V r2 = loadBlockRows<V>(src + 8);
+  V r3 = loadBlockRows<V>(src + 12);
+  transpose4(r0, r1, r2, r3);
+  storeVec(d0, r0);
+  storeVec(d1, r1);
+  storeVec(d2, r2);
+  storeVec(d3, r3);
+}
+
+template<typename V>
+inline void horizontalToVerticalBlocks(const float* s0, const float* s1, const float* s2,
+                                       const float* s3, float* dest) {
+  V r0 = loadVec<V>(s0);
+  V r1 = loadVec<V>(s1);
+  V r2 = loadVec<V>(s2);
+  V r3 = loadVec<V>(s3);
+  transpose4(r0, r1, r2, r3);
+  storeBlockRows(dest, r0);
+  storeBlockRows(dest + 4, r1);
+  storeBlockRows(dest + 8, r2);
+  storeBlockRows(dest + 12, r3);
+}
+
+void verticalToHorizontalKernel(const float* src, float* dest, size_t rows, size_t framesPerRow) {
+  const size_t rowSize = framesPerRow * 4;
+  const size_t numBlocks = framesPerRow / 4;
+  constexpr size_t kBlocksPerVector = kW / 4;
+  for (size_t r = 0; r < rows; ++r) {
+    const float* s = src + r * rowSize;
+    float* d = dest + r * 4 * framesPerRow;
+    float* d0 = d;
+    float* d1 = d + framesPerRow;
+    float* d2 = d + framesPerRow * 2;
+    float* d3 = d + framesPerRow * 3;
+    size_t i = 0;
+    for (; i + kBlocksPerVector <= numBlocks; i += kBlocksPerVector) {
+      verticalToHorizontalBlocks<floatN>(s + i * 16, d0 + i * 4, d1 + i * 4, d2 + i * 4, d3 + i * 4);
+    }
+    for (; i < numBlocks; ++i) {
+      verticalToHorizontalBlocks<float4>(s + i * 16, d0 + i * 4, d1 + i * 4, d2 + i * 4, d3 + i * 4);
+    }
+  }
+}
+
+void horizontalToVerticalKernel(const float* src, float* dest, size_t rows, size_t framesPerRow) {
+  const size_t rowSize = framesPerRow * 4;
+  const size_t numBlocks = framesPerRow / 4;
+  constexpr size_t kBlocksPerVector = kW / 4;
+  for (size_t r = 0; r < rows; ++r) {
+    const float* s = src + r * 4 * framesPerRow;
+    const float* s0 = s;
+    const float* s1 = s + framesPerRow;
+    const float* s2 = s + framesPerRow * 2;
+    const float* s3 = s + framesPerRow * 3;
+    float* d = dest + r * rowSize;
+    size_t i = 0;
+    for (; i + kBlocksPerVector <= numBlocks; i += kBlocksPerVector) {
+      horizontalToVerticalBlocks<floatN>(s0 + i * 4, s1 + i * 4, s2 + i * 4, s3 + i * 4, d + i * 16);
+    }
+    for (; i < numBlocks; ++i) {
+      horizontalToVerticalBlocks<float4>(s0 + i * 4, s1 + i * 4, s2 + i * 4, s3 + i * 4, d + i * 16);
+    }
+  }
+}
+
+// ----------------------------------------------------------------
+// the table, in the member order of DSPKernels
+
+#define ML_KERNEL_ENTRY(name, expr) &name##Kernel,
+
+const DSPKernels kDSPKernels{
+  ML_DSP_OPS_F2F(ML_KERNEL_ENTRY)
+  ML_DSP_OPS_FF2F(ML_KERNEL_ENTRY)
+  ML_DSP_OPS_FFF2F(ML_KERNEL_ENTRY)
+  ML_DSP_OPS_II2I(ML_KERNEL_ENTRY)
+  ML_DSP_OPS_FF2F_MS(ML_KERNEL_ENTRY)
+  ML_DSP_OPS_F2I(ML_KERNEL_ENTRY)
+  ML_DSP_OPS_I2F(ML_KERNEL_ENTRY)
+  &sincosKernel,
+  &transpose4x4BlocksKernel,
+  &verticalToHorizontalKernel,
+  &horizontalToVerticalKernel
+};
+
+#undef ML_KERNEL_ENTRY
+
+}  // namespace ML_DSP_KERNELS_NAMESPACE
+}  // namespace ml
@@ -0,0 +1,23 @@
+// madronalib: a C++ framework for DSP applications.
+// Copyright (c) 2026 Madrona Labs LLC. http://www.madronalabs.com
+// Distributed under the MIT license: http://madrona-labs.mit-license.org/
+
+// MLDSPKernelsAVX512.cpp
+// Runtime dispatch kernels for AVX-512 F, DQ, BW and VL. The build compiles this
+// file alone with AVX-512 enabled; nothing here runs unless the CPU supports it.
+
+#include "MLDSPDispatch.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+
+#define ML_SIMD_AVX512 1
+#define ML_DSP_KERNELS_NAMESPACE avx512
+#include "MLDSPKernels.h"
+
+const ml::DSPKernels* ml::getDSPKernelsAVX512() { return &ml::avx512::kDSPKernels; }
+
+#else
+
+const ml::DSPKernels* ml::getDSPKernelsAVX512() { return nullptr; }
+
+#endif
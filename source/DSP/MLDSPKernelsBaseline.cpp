@@ -0,0 +1,12 @@
+// madronalib: a C++ framework for DSP applications.
+// Copyright (c) 2026 Madrona Labs LLC. http://www.madronalabs.com
+// Distributed under the MIT license: http://madrona-labs.mit-license.org/
+
+// MLDSPKernelsBaseline.cpp
+// Runtime dispatch kernels for the float4 baseline: SSE 4.1 on x86, NEON on ARM.
+// Compiled with the same flags as the rest of the library.
+
+#define ML_DSP_KERNELS_NAMESPACE baseline
+#include "MLDSPKernels.h"
+
+const ml::DSPKernels* ml::getDSPKernelsBaseline() { return &ml::baseline::kDSPKernels; }
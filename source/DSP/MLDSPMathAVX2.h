@@ -0,0 +1,233 @@
+// madronalib: a C++ framework for DSP applications.
+// Copyright (c) 2026 Madrona Labs LLC. http://www.madronalabs.com
+// Distributed under the MIT license: http://madrona-labs.mit-license.org/
+
+// MLDSPMathAVX2.h
+// AVX2 + FMA implementations of madronalib SIMD primitives on 8-element vectors.
+// Included by MLDSPMathSIMD.h alongside the float4 backend when the build
+// selects the AVX2 or AVX-512 ISA. As with the 256-bit instructions themselves,
+// shuffles, unpacks and byte shifts operate independently on each 128-bit half.
+
+#pragma once
+
+#include "MLPlatform.h"
+
+// AVX2 and FMA required
+#include <immintrin.h>
+
+#include <cstdint>
+#include <float.h>
+#include <assert.h>
+
+// ----------------------------------------------------------------
+// Type definitions
+
+struct ML_MAY_ALIAS float8 {
+  __m256 v;
+
+  float8() = default;
+  explicit float8(__m256 x) : v(x) {}
+  float8(float x) : v(_mm256_set1_ps(x)) {}
+  explicit float8(float a, float b, float c, float d, float e, float f, float g, float h)
+  : v(_mm256_setr_ps(a, b, c, d, e, f, g, h)) {}
+  operator __m256() const { return v; }
+};
+
+struct ML_MAY_ALIAS int32x8 {
+  __m256i v;
+
+  int32x8() = default;
+  explicit int32x8(__m256i x) : v(x) {}
+  int32x8(int32_t x) : v(_mm256_set1_epi32(x)) {}
+  explicit int32x8(int32_t a, int32_t b, int32_t c, int32_t d, int32_t e, int32_t f, int32_t g, int32_t h)
+  : v(_mm256_setr_epi32(a, b, c, d, e, f, g, h)) {}
+  operator __m256i() const { return v; }
+};
+
+// ----------------------------------------------------------------
+// float8 math functions that have scalar equivalents
+
+inline float8 operator+(float8 a, float8 b) { return float8(_mm256_add_ps(a, b)); }
+inline float8 operator-(float8 a, float8 b) { return float8(_mm256_sub_ps(a, b)); }
+inline float8 operator*(float8 a, float8 b) { return float8(_mm256_mul_ps(a, b)); }
+inline float8 operator/(float8 a, float8 b) { return float8(_mm256_div_ps(a, b)); }
+
+inline float8& operator+=(float8& a, float8 b) { a = a + b; return a; }
+inline float8& operator-=(float8& a, float8 b) { a = a - b; return a; }
+inline float8& operator*=(float8& a, float8 b) { a = a * b; return a; }
+inline float8& operator/=(float8& a, float8 b) { a = a / b; return a; }
+
+inline float8 operator-(float8 a) {
+  return float8(_mm256_xor_ps(a, _mm256_set1_ps(-0.0f)));
+}
+
+inline float8 min(float8 a, float8 b) { return float8(_mm256_min_ps(a, b)); }
+inline float8 max(float8 a, float8 b) { return float8(_mm256_max_ps(a, b)); }
+inline float8 sqrt(float8 a) { return float8(_mm256_sqrt_ps(a)); }
+inline float8 rsqrt(float8 a) { return float8(_mm256_rsqrt_ps(a)); }
+inline float8 rcp(float8 a) { return float8(_mm256_rcp_ps(a)); }
+
+// multiply-add, fused
+inline float8 multiplyAdd(float8 a, float8 b, float8 c) { return float8(_mm256_fmadd_ps(a, b, c)); }
+
+// Float logical
+inline float8 andBits(float8 a, float8 b) { return float8(_mm256_and_ps(a, b)); }
+inline float8 andNotBits(float8 a, float8 b) { return float8(_mm256_andnot_ps(a, b)); }
+inline float8 orBits(float8 a, float8 b) { return float8(_mm256_or_ps(a, b)); }
+inline float8 xorBits(float8 a, float8 b) { return float8(_mm256_xor_ps(a, b)); }
+
+// Float comparisons (return float8 masks, all bits on or off)
+inline float8 operator==(float8 a, float8 b) { return float8(_mm256_cmp_ps(a, b, _CMP_EQ_OQ)); }
+inline float8 operator!=(float8 a, float8 b) { return float8(_mm256_cmp_ps(a, b, _CMP_NEQ_UQ)); }
+inline float8 operator>(float8 a, float8 b) { return float8(_mm256_cmp_ps(a, b, _CMP_GT_OS)); }
+inline float8 operator>=(float8 a, float8 b) { return float8(_mm256_cmp_ps(a, b, _CMP_GE_OS)); }
+inline float8 operator<(float8 a, float8 b) { return float8(_mm256_cmp_ps(a, b, _CMP_LT_OS)); }
+inline float8 operator<=(float8 a, float8 b) { return float8(_mm256_cmp_ps(a, b, _CMP_LE_OS)); }
+
+// select using float8 mask
+inline float8 select(float8 whenTrue, float8 whenFalse, float8 conditionMask) {
+  return float8(_mm256_blendv_ps(whenFalse, whenTrue, conditionMask));
+}
+
+// ----------------------------------------------------------------
+// float8 multi-lane
+
+inline float8 setZero8() { return float8(_mm256_setzero_ps()); }
+inline float8 set1Float8(float a) { return float8(_mm256_set1_ps(a)); }
+inline float8 setrFloat8(float a, float b, float c, float d, float e, float f, float g, float h) {
+  return float8(_mm256_setr_ps(a, b, c, d, e, f, g, h));
+}
+
+// Float shuffle/move, within each 128-bit half
+template<int i0, int i1, int i2, int i3>
+inline float8 shuffle(float8 a, float8 b) {
+  return float8(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(i3, i2, i1, i0)));
+}
+inline float8 unpackLo(float8 a, float8 b) { return float8(_mm256_unpacklo_ps(a, b)); }
+inline float8 unpackHi(float8 a, float8 b) { return float8(_mm256_unpackhi_ps(a, b)); }
+inline float8 moveLH(float8 a, float8 b) {
+  return float8(_mm256_castpd_ps(_mm256_unpacklo_pd(_mm256_castps_pd(a), _mm256_castps_pd(b))));
+}
+inline float8 moveHL(float8 a, float8 b) {
+  return float8(_mm256_castpd_ps(_mm256_unpackhi_pd(_mm256_castps_pd(b), _mm256_castps_pd(a))));
+}
+
+// 128-bit halves
+inline float4 lowHalf(float8 a) { return float4(_mm256_castps256_ps128(a)); }
+inline float4 highHalf(float8 a) { return float4(_mm256_extractf128_ps(a, 1)); }
+inline float8 combineHalves(float4 lo, float4 hi) {
+  return float8(_mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1));
+}
+
+inline float extractScalar(float8 a) { return _mm256_cvtss_f32(a); }
+
+// ----------------------------------------------------------------
+// int32x8 math
+
+inline int32x8 operator+(int32x8 a, int32x8 b) { return int32x8(_mm256_add_epi32(a, b)); }
+inline int32x8 operator-(int32x8 a, int32x8 b) { return int32x8(_mm256_sub_epi32(a, b)); }
+
+inline int32x8& operator+=(int32x8& a, int32x8 b) { a = a + b; return a; }
+inline int32x8& operator-=(int32x8& a, int32x8 b) { a = a - b; return a; }
+
+inline int32x8 operator-(int32x8 a) {
+  return int32x8(_mm256_sub_epi32(_mm256_setzero_si256(), a));
+}
+
+inline int32x8 multiplyUnsigned(int32x8 a, int32x8 b) { return int32x8(_mm256_mullo_epi32(a, b)); }
+
+// Integer logical
+inline int32x8 andBits(int32x8 a, int32x8 b) { return int32x8(_mm256_and_si256(a, b)); }
+inline int32x8 andNotBits(int32x8 a, int32x8 b) { return int32x8(_mm256_andnot_si256(a, b)); }
+inline int32x8 orBits(int32x8 a, int32x8 b) { return int32x8(_mm256_or_si256(a, b)); }
+inline int32x8 xorBits(int32x8 a, int32x8 b) { return int32x8(_mm256_xor_si256(a, b)); }
+
+// Integer special
+inline int32x8 setZeroInt32x8() { return int32x8(_mm256_setzero_si256()); }
+inline int32x8 set1Int32x8(int32_t a) { return int32x8(_mm256_set1_epi32(a)); }
+inline int32x8 setrInt32x8(int32_t a, int32_t b, int32_t c, int32_t d,
+                     int32_t e, int32_t f, int32_t g, int32_t h) {
+  return int32x8(_mm256_setr_epi32(a, b, c, d, e, f, g, h));
+}
+
+// Integer shifts (byte shifts within each 128-bit half) - require compile-time constants
+template<int count>
+inline int32x8 shiftLeftBytes(int32x8 a) { return int32x8(_mm256_slli_si256(a, count)); }
+
+template<int count>
+inline int32x8 shiftRightBytes(int32x8 a) { return int32x8(_mm256_srli_si256(a, count)); }
+
+// Integer shifts (element shifts)
+inline int32x8 shiftLeftElements(int32x8 a, int count) { return int32x8(_mm256_sll_epi32(a, _mm_cvtsi32_si128(count))); }
+inline int32x8 shiftRightElements(int32x8 a, int count) { return int32x8(_mm256_srl_epi32(a, _mm_cvtsi32_si128(count))); }
+
+// Integer comparisons
+inline int32x8 compareEqualInt(int32x8 a, int32x8 b) { return int32x8(_mm256_cmpeq_epi32(a, b)); }
+
+// Conversions
+inline int32x8 floatToIntRound(float8 a) { return int32x8(_mm256_cvtps_epi32(a)); }
+inline int32x8 floatToIntTruncate(float8 a) { return int32x8(_mm256_cvttps_epi32(a)); }
+inline float8 intToFloat(int32x8 a) { return float8(_mm256_cvtepi32_ps(a)); }
+
+// _mm256_cvtepi32_ps approximation for unsigned int data
+inline float8 unsignedIntToFloat(int32x8 v) {
+  int32x8 v_hi = shiftRightElements(v, 1);
+  float8 v_hi_flt = intToFloat(v_hi);
+  return v_hi_flt + v_hi_flt;
+}
+
+// Casts (reinterpret bits)
+inline int32x8 reinterpretFloatAsInt(float8 a) { return int32x8(_mm256_castps_si256(a)); }
+inline float8 reinterpretIntAsFloat(int32x8 a) { return float8(_mm256_castsi256_ps(a)); }
+
+// ----------------------------------------------------------------
+// float8 horizontal operations
+
+inline float vecSumH(float8 v) {
+  float4 s = lowHalf(v) + highHalf(v);
+  float4 tmp0 = s + moveHL(s, s);
+  float4 tmp1 = addScalar(tmp0, shuffle<1,1,1,1>(tmp0, tmp0));
+  return extractScalar(tmp1);
+}
+
+inline float vecMaxH(float8 v) {
+  float4 m = max(lowHalf(v), highHalf(v));
+  float4 tmp0 = max(m, moveHL(m, m));
+  float4 tmp1 = maxScalar(tmp0, shuffle<1,1,1,1>(tmp0, tmp0));
+  return extractScalar(tmp1);
+}
+
+inline float vecMinH(float8 v) {
+  float4 m = min(lowHalf(v), highHalf(v));
+  float4 tmp0 = min(m, moveHL(m, m));
+  float4 tmp1 = minScalar(tmp0, shuffle<1,1,1,1>(tmp0, tmp0));
+  return extractScalar(tmp1);
+}
+
+// ----------------------------------------------------------------
+// Load/store functions
+
+inline float8 loadFloat8(const float* ptr) { return float8(_mm256_load_ps(ptr)); }
+inline void storeFloat8(float* ptr, float8 v) { _mm256_store_ps(ptr, v); }
+inline float8 loadFloat8Unaligned(const float* ptr) { return float8(_mm256_loadu_ps(ptr)); }
+inline void storeFloat8Unaligned(float* ptr, float8 v) { _mm256_storeu_ps(ptr, v); }
+inline int32x8 loadInt32x8(const int32_t* ptr) { return int32x8(_mm256_load_si256((const __m256i*)ptr)); }
+inline void storeInt32x8(int32_t* ptr, int32x8 v) { _mm256_store_si256((__m256i*)ptr, v); }
+
+// ----------------------------------------------------------------
+// Lane access (slow - avoid!)
+
+inline float getFloat8Lane(float8 v, size_t lane) {
+  assert(lane < 8);
+  alignas(32) float tmp[8];
+  _mm256_store_ps(tmp, v);
+  return tmp[lane];
+}
+
+inline void setFloat8Lane(float8& v, size_t lane, float val) {
+  assert(lane < 8);
+  alignas(32) float tmp[8];
+  _mm256_store_ps(tmp, v);
+  tmp[lane] = val;
+  v = float8(_mm256_load_ps(tmp));
+}
@@ -0,0 +1,209 @@
+// madronalib: a C++ framework for DSP applications.
+// Copyright (c) 2026 Madrona Labs LLC. http://www.madronalabs.com
+// Distributed under the MIT license: http://madrona-labs.mit-license.org/
+
+// MLDSPMathAVX512.h
+// AVX-512 implementations of madronalib SIMD primitives on 16-element vectors.
+// Requires the F, DQ, BW and VL subsets (x86-64-v4). Included by MLDSPMathSIMD.h
+// after MLDSPMathAVX2.h when the build selects the AVX-512 ISA. Comparisons
+// return full-width lane masks like the other backends, not k-register masks.
+// Shuffles, unpacks and byte shifts operate independently on each 128-bit lane.
+
+#pragma once
+
+#include "MLPlatform.h"
+
+#include <immintrin.h>
+
+#include <cstdint>
+#include <float.h>
+#include <assert.h>
+
+// ----------------------------------------------------------------
+// Type definitions
+
+struct ML_MAY_ALIAS float16 {
+  __m512 v;
+
+  float16() = default;
+  explicit float16(__m512 x) : v(x) {}
+  float16(float x) : v(_mm512_set1_ps(x)) {}
+  operator __m512() const { return v; }
+};
+
+struct ML_MAY_ALIAS int32x16 {
+  __m512i v;
+
+  int32x16() = default;
+  explicit int32x16(__m512i x) : v(x) {}
+  int32x16(int32_t x) : v(_mm512_set1_epi32(x)) {}
+  operator __m512i() const { return v; }
+};
+
+// ----------------------------------------------------------------
+// float16 math functions that have scalar equivalents
+
+inline float16 operator+(float16 a, float16 b) { return float16(_mm512_add_ps(a, b)); }
+inline float16 operator-(float16 a, float16 b) { return float16(_mm512_sub_ps(a, b)); }
+inline float16 operator*(float16 a, float16 b) { return float16(_mm512_mul_ps(a, b)); }
+inline float16 operator/(float16 a, float16 b) { return float16(_mm512_div_ps(a, b)); }
+
+inline float16& operator+=(float16& a, float16 b) { a = a + b; return a; }
+inline float16& operator-=(float16& a, float16 b) { a = a - b; return a; }
+inline float16& operator*=(float16& a, float16 b) { a = a * b; return a; }
+inline float16& operator/=(float16& a, float16 b) { a = a / b; return a; }
+
+inline float16 operator-(float16 a) {
+  return float16(_mm512_xor_ps(a, _mm512_set1_ps(-0.0f)));
+}
+
+inline float16 min(float16 a, float16 b) { return float16(_mm512_min_ps(a, b)); }
+inline float16 max(float16 a, float16 b) { return float16(_mm512_max_ps(a, b)); }
+inline float16 sqrt(float16 a) { return float16(_mm512_sqrt_ps(a)); }
+inline float16 rsqrt(float16 a) { return float16(_mm512_rsqrt14_ps(a)); }
+inline float16 rcp(float16 a) { return float16(_mm512_rcp14_ps(a)); }
+
+// multiply-add, fused
+inline float16 multiplyAdd(float16 a, float16 b, float16 c) { return float16(_mm512_fmadd_ps(a, b, c)); }
+
+// Float logical
+inline float16 andBits(float16 a, float16 b) { return float16(_mm512_and_ps(a, b)); }
+inline float16 andNotBits(float16 a, float16 b) { return float16(_mm512_andnot_ps(a, b)); }
+inline float16 orBits(float16 a, float16 b) { return float16(_mm512_or_ps(a, b)); }
+inline float16 xorBits(float16 a, float16 b) { return float16(_mm512_xor_ps(a, b)); }
+
+// Float comparisons (return float16 masks, all bits on or off)
+inline float16 maskToFloat16(__mmask16 m) { return float16(_mm512_castsi512_ps(_mm512_movm_epi32(m))); }
+inline float16 operator==(float16 a, float16 b) { return maskToFloat16(_mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ)); }
+inline float16 operator!=(float16 a, float16 b) { return maskToFloat16(_mm512_cmp_ps_mask(a, b, _CMP_NEQ_UQ)); }
+inline float16 operator>(float16 a, float16 b) { return maskToFloat16(_mm512_cmp_ps_mask(a, b, _CMP_GT_OS)); }
+inline float16 operator>=(float16 a, float16 b) { return maskToFloat16(_mm512_cmp_ps_mask(a, b, _CMP_GE_OS)); }
+inline float16 operator<(float16 a, float16 b) { return maskToFloat16(_mm512_cmp_ps_mask(a, b, _CMP_LT_OS)); }
+inline float16 operator<=(float16 a, float16 b) { return maskToFloat16(_mm512_cmp_ps_mask(a, b, _CMP_LE_OS)); }
+
+// select using float16 mask
+inline float16 select(float16 whenTrue, float16 whenFalse, float16 conditionMask) {
+  // bitwise (mask & whenTrue) | (~mask & whenFalse)
+  return float16(_mm512_castsi512_ps(_mm512_ternarylogic_epi32(_mm512_castps_si512(conditionMask),
+                                                               _mm512_castps_si512(whenTrue),
+                                                               _mm512_castps_si512(whenFalse), 0xCA)));
+}
+
+// ----------------------------------------------------------------
+// float16 multi-lane
+
+inline float16 setZero16() { return float16(_mm512_setzero_ps()); }
+inline float16 set1Float16(float a) { return float16(_mm512_set1_ps(a)); }
+
+// Float shuffle/move, within each 128-bit lane
+template<int i0, int i1, int i2, int i3>
+inline float16 shuffle(float16 a, float16 b) {
+  return float16(_mm512_shuffle_ps(a, b, _MM_SHUFFLE(i3, i2, i1, i0)));
+}
+inline float16 unpackLo(float16 a, float16 b) { return float16(_mm512_unpacklo_ps(a, b)); }
+inline float16 unpackHi(float16 a, float16 b) { return float16(_mm512_unpackhi_ps(a, b)); }
+inline float16 moveLH(float16 a, float16 b) {
+  return float16(_mm512_castpd_ps(_mm512_unpacklo_pd(_mm512_castps_pd(a), _mm512_castps_pd(b))));
+}
+inline float16 moveHL(float16 a, float16 b) {
+  return float16(_mm512_castpd_ps(_mm512_unpackhi_pd(_mm512_castps_pd(b), _mm512_castps_pd(a))));
+}
+
+// 256-bit halves
+inline float8 lowHalf(float16 a) { return float8(_mm512_castps512_ps256(a)); }
+inline float8 highHalf(float16 a) { return float8(_mm512_extractf32x8_ps(a, 1)); }
+inline float16 combineHalves(float8 lo, float8 hi) {
+  return float16(_mm512_insertf32x8(_mm512_castps256_ps512(lo), hi, 1));
+}
+
+inline float extractScalar(float16 a) { return _mm512_cvtss_f32(a); }
+
+// ----------------------------------------------------------------
+// int32x16 math
+
+inline int32x16 operator+(int32x16 a, int32x16 b) { return int32x16(_mm512_add_epi32(a, b)); }
+inline int32x16 operator-(int32x16 a, int32x16 b) { return int32x16(_mm512_sub_epi32(a, b)); }
+
+inline int32x16& operator+=(int32x16& a, int32x16 b) { a = a + b; return a; }
+inline int32x16& operator-=(int32x16& a, int32x16 b) { a = a - b; return a; }
+
+inline int32x16 operator-(int32x16 a) {
+  return int32x16(_mm512_sub_epi32(_mm512_setzero_si512(), a));
+}
+
+inline int32x16 multiplyUnsigned(int32x16 a, int32x16 b) { return int32x16(_mm512_mullo_epi32(a, b)); }
+
+// Integer logical
+inline int32x16 andBits(int32x16 a, int32x16 b) { return int32x16(_mm512_and_si512(a, b)); }
+inline int32x16 andNotBits(int32x16 a, int32x16 b) { return int32x16(_mm512_andnot_si512(a, b)); }
+inline int32x16 orBits(int32x16 a, int32x16 b) { return int32x16(_mm512_or_si512(a, b)); }
+inline int32x16 xorBits(int32x16 a, int32x16 b) { return int32x16(_mm512_xor_si512(a, b)); }
+
+// Integer special
+inline int32x16 setZeroInt32x16() { return int32x16(_mm512_setzero_si512()); }
+inline int32x16 set1Int32x16(int32_t a) { return int32x16(_mm512_set1_epi32(a)); }
+
+// Integer shifts (byte shifts within each 128-bit lane) - require compile-time constants
+template<int count>
+inline int32x16 shiftLeftBytes(int32x16 a) { return int32x16(_mm512_bslli_epi128(a, count)); }
+
+template<int count>
+inline int32x16 shiftRightBytes(int32x16 a) { return int32x16(_mm512_bsrli_epi128(a, count)); }
+
+// Integer shifts (element shifts)
+inline int32x16 shiftLeftElements(int32x16 a, int count) { return int32x16(_mm512_sll_epi32(a, _mm_cvtsi32_si128(count))); }
+inline int32x16 shiftRightElements(int32x16 a, int count) { return int32x16(_mm512_srl_epi32(a, _mm_cvtsi32_si128(count))); }
+
+// Integer comparisons
+inline int32x16 compareEqualInt(int32x16 a, int32x16 b) { return int32x16(_mm512_movm_epi32(_mm512_cmpeq_epi32_mask(a, b))); }
+
+// Conversions
+inline int32x16 floatToIntRound(float16 a) { return int32x16(_mm512_cvtps_epi32(a)); }
+inline int32x16 floatToIntTruncate(float16 a) { return int32x16(_mm512_cvttps_epi32(a)); }
+inline float16 intToFloat(int32x16 a) { return float16(_mm512_cvtepi32_ps(a)); }
+
+// _mm512_cvtepi32_ps approximation for unsigned int data, matching the narrower backends
+inline float16 unsignedIntToFloat(int32x16 v) {
+  int32x16 v_hi = shiftRightElements(v, 1);
+  float16 v_hi_flt = intToFloat(v_hi);
+  return v_hi_flt + v_hi_flt;
+}
+
+// Casts (reinterpret bits)
+inline int32x16 reinterpretFloatAsInt(float16 a) { return int32x16(_mm512_castps_si512(a)); }
+inline float16 reinterpretIntAsFloat(int32x16 a) { return float16(_mm512_castsi512_ps(a)); }
+
+// ----------------------------------------------------------------
+// float16 horizontal operations
+
+inline float vecSumH(float16 v) { return vecSumH(lowHalf(v) + highHalf(v)); }
+inline float vecMaxH(float16 v) { return vecMaxH(max(lowHalf(v), highHalf(v))); }
+inline float vecMinH(float16 v) { return vecMinH(min(lowHalf(v), highHalf(v))); }
+
+// ----------------------------------------------------------------
+// Load/store functions
+
+inline float16 loadFloat16(const float* ptr) { return float16(_mm512_load_ps(ptr)); }
+inline void storeFloat16(float* ptr, float16 v) { _mm512_store_ps(ptr, v); }
+inline float16 loadFloat16Unaligned(const float* ptr) { return float16(_mm512_loadu_ps(ptr)); }
+inline void storeFloat16Unaligned(float* ptr, float16 v) { _mm512_storeu_ps(ptr, v); }
+inline int32x16 loadInt32x16(const int32_t* ptr) { return int32x16(_mm512_load_si512(ptr)); }
+inline void storeInt32x16(int32_t* ptr, int32x16 v) { _mm512_store_si512(ptr, v); }
+
+// ----------------------------------------------------------------
+// Lane access (slow - avoid!)
+
+inline float getFloat16Lane(float16 v, size_t lane) {
+  assert(lane < 16);
+  alignas(64) float tmp[16];
+  _mm512_store_ps(tmp, v);
+  return tmp[lane];
+}
+
+inline void setFloat16Lane(float16& v, size_t lane, float val) {
+  assert(lane < 16);
+  alignas(64) float tmp[16];
+  _mm512_store_ps(tmp, v);
+  tmp[lane] = val;
+  v = float16(_mm512_load_ps(tmp));
+}
@@ -12,84 +12,91 @@
 // cephes-derived approximate math functions adapted from code by Julien Pommier
 // Copyright (C) 2007 Julien Pommier and licensed under the zlib license
 
+// The functions are templates over the SIMD float vector types so that every
+// backend (float4, and float8 / float16 where enabled) shares one implementation.
+// Constants are scalars broadcast at the point of use rather than static vector
+// objects, so no SIMD code runs during static initialization.
+
 // Float constants
-static const float4 _ps_1(1.0f);
-static const float4 _ps_0p5(0.5f);
-static const float4 _ps_cephes_SQRTHF(0.707106781186547524f);
-static const float4 _ps_cephes_log_p0(7.0376836292E-2f);
-static const float4 _ps_cephes_log_p1(-1.1514610310E-1f);
-static const float4 _ps_cephes_log_p2(1.1676998740E-1f);
-static const float4 _ps_cephes_log_p3(-1.2420140846E-1f);
-static const float4 _ps_cephes_log_p4(+1.4249322787E-1f);
-static const float4 _ps_cephes_log_p5(-1.6668057665E-1f);
-static const float4 _ps_cephes_log_p6(+2.0000714765E-1f);
-static const float4 _ps_cephes_log_p7(-2.4999993993E-1f);
-static const float4 _ps_cephes_log_p8(+3.3333331174E-1f);
-static const float4 _ps_cephes_log_q1(-2.12194440e-4f);
-static const float4 _ps_cephes_log_q2(0.693359375f);
-static const float4 _ps_exp_hi(88.3762626647949f);
-static const float4 _ps_exp_lo(-88.3762626647949f);
-static const float4 _ps_cephes_LOG2EF(1.44269504088896341f);
-static const float4 _ps_cephes_exp_C1(0.693359375f);
-static const float4 _ps_cephes_exp_C2(-2.12194440e-4f);
-static const float4 _ps_cephes_exp_p0(1.9875691500E-4f);
-static const float4 _ps_cephes_exp_p1(1.3981999507E-3f);
-static const float4 _ps_cephes_exp_p2(8.3334519073E-3f);
-static const float4 _ps_cephes_exp_p3(4.1665795894E-2f);
-static const float4 _ps_cephes_exp_p4(1.6666665459E-1f);
-static const float4 _ps_cephes_exp_p5(5.0000001201E-1f);
-static const float4 _ps_minus_cephes_DP1(-0.78515625f);
-static const float4 _ps_minus_cephes_DP2(-2.4187564849853515625e-4f);
-static const float4 _ps_minus_cephes_DP3(-3.77489497744594108e-8f);
-static const float4 _ps_sincof_p0(-1.9515295891E-4f);
-static const float4 _ps_sincof_p1(8.3321608736E-3f);
-static const float4 _ps_sincof_p2(-1.6666654611E-1f);
-static const float4 _ps_coscof_p0(2.443315711809948E-005f);
-static const float4 _ps_coscof_p1(-1.388731625493765E-003f);
-static const float4 _ps_coscof_p2(4.166664568298827E-002f);
-static const float4 _ps_cephes_FOPI(1.27323954473516f);  // 4 / M_PI
+constexpr float _ps_1 = 1.0f;
+constexpr float _ps_0p5 = 0.5f;
+constexpr float _ps_cephes_SQRTHF = 0.707106781186547524f;
+constexpr float _ps_cephes_log_p0 = 7.0376836292E-2f;
+constexpr float _ps_cephes_log_p1 = -1.1514610310E-1f;
+constexpr float _ps_cephes_log_p2 = 1.1676998740E-1f;
+constexpr float _ps_cephes_log_p3 = -1.2420140846E-1f;
+constexpr float _ps_cephes_log_p4 = +1.4249322787E-1f;
+constexpr float _ps_cephes_log_p5 = -1.6668057665E-1f;
+constexpr float _ps_cephes_log_p6 = +2.0000714765E-1f;
+constexpr float _ps_cephes_log_p7 = -2.4999993993E-1f;
+constexpr float _ps_cephes_log_p8 = +3.3333331174E-1f;
+constexpr float _ps_cephes_log_q1 = -2.12194440e-4f;
+constexpr float _ps_cephes_log_q2 = 0.693359375f;
+constexpr float _ps_exp_hi = 88.3762626647949f;
+constexpr float _ps_exp_lo = -88.3762626647949f;
+constexpr float _ps_cephes_LOG2EF = 1.44269504088896341f;
+constexpr float _ps_cephes_exp_C1 = 0.693359375f;
+constexpr float _ps_cephes_exp_C2 = -2.12194440e-4f;
+constexpr float _ps_cephes_exp_p0 = 1.9875691500E-4f;
+constexpr float _ps_cephes_exp_p1 = 1.3981999507E-3f;
+constexpr float _ps_cephes_exp_p2 = 8.3334519073E-3f;
+constexpr float _ps_cephes_exp_p3 = 4.1665795894E-2f;
+constexpr float _ps_cephes_exp_p4 = 1.6666665459E-1f;
+constexpr float _ps_cephes_exp_p5 = 5.0000001201E-1f;
+constexpr float _ps_minus_cephes_DP1 = -0.78515625f;
+constexpr float _ps_minus_cephes_DP2 = -2.4187564849853515625e-4f;
+constexpr float _ps_minus_cephes_DP3 = -3.77489497744594108e-8f;
+constexpr float _ps_sincof_p0 = -1.9515295891E-4f;
+constexpr float _ps_sincof_p1 = 8.3321608736E-3f;
+constexpr float _ps_sincof_p2 = -1.6666654611E-1f;
+constexpr float _ps_coscof_p0 = 2.443315711809948E-005f;
+constexpr float _ps_coscof_p1 = -1.388731625493765E-003f;
+constexpr float _ps_coscof_p2 = 4.166664568298827E-002f;
+constexpr float _ps_cephes_FOPI = 1.27323954473516f;  // 4 / M_PI
 
 // Integer constants
-static const int4 _pi32_min_norm_pos(0x00800000);  // the smallest non denormalized float number
-static const int4 _pi32_mant_mask(0x7f800000);
-static const int4 _pi32_inv_mant_mask(~0x7f800000);
-static const int4 _pi32_sign_mask((int32_t)0x80000000);
-static const int4 _pi32_inv_sign_mask(~0x80000000);
-static const int4 _pi32_1(1);
-static const int4 _pi32_inv1(~1);
-static const int4 _pi32_2(2);
-static const int4 _pi32_4(4);
-static const int4 _pi32_0x7f(0x7f);
+constexpr int32_t _pi32_min_norm_pos = 0x00800000;  // the smallest non denormalized float number
+constexpr int32_t _pi32_mant_mask = 0x7f800000;
+constexpr int32_t _pi32_inv_mant_mask = ~0x7f800000;
+constexpr int32_t _pi32_sign_mask = static_cast<int32_t>(0x80000000);
+constexpr int32_t _pi32_inv_sign_mask = 0x7fffffff;
+constexpr int32_t _pi32_1 = 1;
+constexpr int32_t _pi32_inv1 = ~1;
+constexpr int32_t _pi32_2 = 2;
+constexpr int32_t _pi32_4 = 4;
+constexpr int32_t _pi32_0x7f = 0x7f;
 
 // ----------------------------------------------------------------
 // vecLog - natural logarithm
 
-inline float4 log(float4 x) {
-  int4 emm0;
-  float4 one = _ps_1;
-  float4 invalid_mask = (x <= setZero());
+template<typename V, typename = std::enable_if_t<IsFloatVector_v<V>>>
+inline V log(V x) {
+  using I = IntTypeFor_t<V>;
+  I emm0;
+  V one = _ps_1;
+  V invalid_mask = (x <= V(0.0f));
   
-  x = max(x, reinterpretIntAsFloat(_pi32_min_norm_pos));
+  x = max(x, reinterpretIntAsFloat(I(_pi32_min_norm_pos)));
   
   emm0 = shiftRightElements(reinterpretFloatAsInt(x), 23);
   
-  x = andBits(x, reinterpretIntAsFloat(_pi32_inv_mant_mask));
+  x = andBits(x, reinterpretIntAsFloat(I(_pi32_inv_mant_mask)));
   x = orBits(x, _ps_0p5);
   
   emm0 = emm0 - _pi32_0x7f;
-  float4 e = intToFloat(emm0);
+  V e = intToFloat(emm0);
   
   e = e + one;
   
-  float4 mask = (x < _ps_cephes_SQRTHF);
-  float4 tmp = andBits(x, mask);
+  V mask = (x < _ps_cephes_SQRTHF);
+  V tmp = andBits(x, mask);
   x = x - one;
   e = e - andBits(one, mask);
   x = x + tmp;
   
-  float4 z = x * x;
+  V z = x * x;
   
-  float4 y = _ps_cephes_log_p0;
+  V y = _ps_cephes_log_p0;
   y = y * x;
   y = y + _ps_cephes_log_p1;
   y = y * x;
@@ -126,10 +133,12 @@ inline float4 log(float4 x) {
 // ----------------------------------------------------------------
 // exp - exponential
 
-inline float4 exp(float4 x) {
-  float4 tmp = setZero(), fx;
-  int4 emm0;
-  float4 one = _ps_1;
+template<typename V, typename = std::enable_if_t<IsFloatVector_v<V>>>
+inline V exp(V x) {
+  using I = IntTypeFor_t<V>;
+  V tmp = V(0.0f), fx;
+  I emm0;
+  V one = _ps_1;
   
   x = min(x, _ps_exp_hi);
   x = max(x, _ps_exp_lo);
@@ -140,17 +149,17 @@ inline float4 exp(float4 x) {
   emm0 = floatToIntTruncate(fx);
   tmp = intToFloat(emm0);
   
-  float4 mask = (tmp > fx);
+  V mask = (tmp > fx);
   mask = andBits(mask, one);
   fx = tmp - mask;
   
   tmp = fx * _ps_cephes_exp_C1;
-  float4 z = fx * _ps_cephes_exp_C2;
+  V z = fx * _ps_cephes_exp_C2;
   x = x - tmp;
   x = x - z;
   z = x * x;
   
-  float4 y = _ps_cephes_exp_p0;
+  V y = _ps_cephes_exp_p0;
   y = y * x;
   y = y + _ps_cephes_exp_p1;
   y = y * x;
@@ -168,7 +177,7 @@ inline float4 exp(float4 x) {
   emm0 = floatToIntTruncate(fx);
   emm0 = emm0 + _pi32_0x7f;
   emm0 = shiftLeftElements(emm0, 23);
-  float4 pow2n = reinterpretIntAsFloat(emm0);
+  V pow2n = reinterpretIntAsFloat(emm0);
   
   y = y * pow2n;
   return y;
@@ -177,29 +186,31 @@ inline float4 exp(float4 x) {
 // ----------------------------------------------------------------
 // vecSin - sine
 
-inline float4 sin(float4 x) {
-  float4 xmm1, xmm2 = setZero(), xmm3, sign_bit, y;
-  int4 emm0, emm2;
+template<typename V, typename = std::enable_if_t<IsFloatVector_v<V>>>
+inline V sin(V x) {
+  using I = IntTypeFor_t<V>;
+  V xmm1, xmm2 = V(0.0f), xmm3, sign_bit, y;
+  I emm0, emm2;
   
   sign_bit = x;
-  x = andBits(x, reinterpretIntAsFloat(_pi32_inv_sign_mask));
-  sign_bit = andBits(sign_bit, reinterpretIntAsFloat(_pi32_sign_mask));
+  x = andBits(x, reinterpretIntAsFloat(I(_pi32_inv_sign_mask)));
+  sign_bit = andBits(sign_bit, reinterpretIntAsFloat(I(_pi32_sign_mask)));
   
   y = x * _ps_cephes_FOPI;
   
   emm2 = floatToIntTruncate(y);
   emm2 = emm2 + _pi32_1;
-  emm2 = andBits(emm2, _pi32_inv1);
+  emm2 = andBits(emm2, I(_pi32_inv1));
   y = intToFloat(emm2);
   
-  emm0 = andBits(emm2, _pi32_4);
+  emm0 = andBits(emm2, I(_pi32_4));
   emm0 = shiftLeftElements(emm0, 29);
   
-  emm2 = andBits(emm2, _pi32_2);
-  emm2 = compareEqualInt(emm2, setZeroInt());
+  emm2 = andBits(emm2, I(_pi32_2));
+  emm2 = compareEqualInt(emm2, I(0));
   
-  float4 swap_sign_bit = reinterpretIntAsFloat(emm0);
-  float4 poly_mask = reinterpretIntAsFloat(emm2);
+  V swap_sign_bit = reinterpretIntAsFloat(emm0);
+  V poly_mask = reinterpretIntAsFloat(emm2);
   sign_bit = xorBits(sign_bit, swap_sign_bit);
   
   xmm1 = _ps_minus_cephes_DP1;
@@ -213,7 +224,7 @@ inline float4 sin(float4 x) {
   x = x + xmm3;
   
   y = _ps_coscof_p0;
-  float4 z = x * x;
+  V z = x * x;
   
   y = y * z;
   y = y + _ps_coscof_p1;
@@ -221,11 +232,11 @@ inline float4 sin(float4 x) {
   y = y + _ps_coscof_p2;
   y = y * z;
   y = y * z;
-  float4 tmp = z * _ps_0p5;
+  V tmp = z * _ps_0p5;
   y = y - tmp;
   y = y + _ps_1;
   
-  float4 y2 = _ps_sincof_p0;
+  V y2 = _ps_sincof_p0;
   y2 = y2 * z;
   y2 = y2 + _ps_sincof_p1;
   y2 = y2 * z;
@@ -245,28 +256,30 @@ inline float4 sin(float4 x) {
 // ----------------------------------------------------------------
 // cos - cosine
 
-inline float4 cos(float4 x) {
-  float4 xmm1, xmm2 = setZero(), xmm3, y;
-  int4 emm0, emm2;
+template<typename V, typename = std::enable_if_t<IsFloatVector_v<V>>>
+inline V cos(V x) {
+  using I = IntTypeFor_t<V>;
+  V xmm1, xmm2 = V(0.0f), xmm3, y;
+  I emm0, emm2;
   
-  x = andBits(x, reinterpretIntAsFloat(_pi32_inv_sign_mask));
+  x = andBits(x, reinterpretIntAsFloat(I(_pi32_inv_sign_mask)));
   
   y = x * _ps_cephes_FOPI;
   
   emm2 = floatToIntTruncate(y);
   emm2 = emm2 + _pi32_1;
-  emm2 = andBits(emm2, _pi32_inv1);
+  emm2 = andBits(emm2, I(_pi32_inv1));
   y = intToFloat(emm2);
   emm2 = emm2 - _pi32_2;
   
-  emm0 = andNotBits(emm2, _pi32_4);
+  emm0 = andNotBits(emm2, I(_pi32_4));
   emm0 = shiftLeftElements(emm0, 29);
   
-  emm2 = andBits(emm2, _pi32_2);
-  emm2 = compareEqualInt(emm2, setZeroInt());
+  emm2 = andBits(emm2, I(_pi32_2));
+  emm2 = compareEqualInt(emm2, I(0));
   
-  float4 sign_bit = reinterpretIntAsFloat(emm0);
-  float4 poly_mask = reinterpretIntAsFloat(emm2);
+  V sign_bit = reinterpretIntAsFloat(emm0);
+  V poly_mask = reinterpretIntAsFloat(emm2);
   
   xmm1 = _ps_minus_cephes_DP1;
   xmm2 = _ps_minus_cephes_DP2;
@@ -279,7 +292,7 @@ inline float4 cos(float4 x) {
   x = x + xmm3;
   
   y = _ps_coscof_p0;
-  float4 z = x * x;
+  V z = x * x;
   
   y = y * z;
   y = y + _ps_coscof_p1;
@@ -287,11 +300,11 @@ inline float4 cos(float4 x) {
   y = y + _ps_coscof_p2;
   y = y * z;
   y = y * z;
-  float4 tmp = z * _ps_0p5;
+  V tmp = z * _ps_0p5;
   y = y - tmp;
   y = y + _ps_1;
   
-  float4 y2 = _ps_sincof_p0;
+  V y2 = _ps_sincof_p0;
   y2 = y2 * z;
   y2 = y2 + _ps_sincof_p1;
   y2 = y2 * z;
@@ -312,31 +325,33 @@ inline float4 cos(float4 x) {
 // ----------------------------------------------------------------
 // vecSinCos - simultaneous sine and cosine
 
-inline std::pair<float4, float4> sincos(float4 x) {
-  float4 xmm1, xmm2, xmm3 = setZero(), sign_bit_sin, y;
-  int4 emm0, emm2, emm4;
+template<typename V, typename = std::enable_if_t<IsFloatVector_v<V>>>
+inline std::pair<V, V> sincos(V x) {
+  using I = IntTypeFor_t<V>;
+  V xmm1, xmm2, xmm3 = V(0.0f), sign_bit_sin, y;
+  I emm0, emm2, emm4;
   
   sign_bit_sin = x;
-  x = andBits(x, reinterpretIntAsFloat(_pi32_inv_sign_mask));
-  sign_bit_sin = andBits(sign_bit_sin, reinterpretIntAsFloat(_pi32_sign_mask));
+  x = andBits(x, reinterpretIntAsFloat(I(_pi32_inv_sign_mask)));
+  sign_bit_sin = andBits(sign_bit_sin, reinterpretIntAsFloat(I(_pi32_sign_mask)));
   
   y = x * _ps_cephes_FOPI;
   
   emm2 = floatToIntTruncate(y);
   
   emm2 = emm2 + _pi32_1;
-  emm2 = andBits(emm2, _pi32_inv1);
+  emm2 = andBits(emm2, I(_pi32_inv1));
   y = intToFloat(emm2);
   
   emm4 = emm2;
   
-  emm0 = andBits(emm2, _pi32_4);
+  emm0 = andBits(emm2, I(_pi32_4));
   emm0 = shiftLeftElements(emm0, 29);
-  float4 swap_sign_bit_sin = reinterpretIntAsFloat(emm0);
+  V swap_sign_bit_sin = reinterpretIntAsFloat(emm0);
   
-  emm2 = andBits(emm2, _pi32_2);
-  emm2 = compareEqualInt(emm2, setZeroInt());
-  float4 poly_mask = reinterpretIntAsFloat(emm2);
+  emm2 = andBits(emm2, I(_pi32_2));
+  emm2 = compareEqualInt(emm2, I(0));
+  V poly_mask = reinterpretIntAsFloat(emm2);
   
   xmm1 = _ps_minus_cephes_DP1;
   xmm2 = _ps_minus_cephes_DP2;
@@ -349,13 +364,13 @@ inline std::pair<float4, float4> sincos(float4 x) {
   x = x + xmm3;
   
   emm4 = emm4 - _pi32_2;
-  emm4 = andNotBits(emm4, _pi32_4);
+  emm4 = andNotBits(emm4, I(_pi32_4));
   emm4 = shiftLeftElements(emm4, 29);
-  float4 sign_bit_cos = reinterpretIntAsFloat(emm4);
+  V sign_bit_cos = reinterpretIntAsFloat(emm4);
   
   sign_bit_sin = xorBits(sign_bit_sin, swap_sign_bit_sin);
   
-  float4 z = x * x;
+  V z = x * x;
   y = _ps_coscof_p0;
   
   y = y * z;
@@ -364,11 +379,11 @@ inline std::pair<float4, float4> sincos(float4 x) {
   y = y + _ps_coscof_p2;
   y = y * z;
   y = y * z;
-  float4 tmp = z * _ps_0p5;
+  V tmp = z * _ps_0p5;
   y = y - tmp;
   y = y + _ps_1;
   
-  float4 y2 = _ps_sincof_p0;
+  V y2 = _ps_sincof_p0;
   y2 = y2 * z;
   y2 = y2 + _ps_sincof_p1;
   y2 = y2 * z;
@@ -378,16 +393,16 @@ inline std::pair<float4, float4> sincos(float4 x) {
   y2 = y2 + x;
   
   xmm3 = poly_mask;
-  float4 ysin2 = andBits(xmm3, y2);
-  float4 ysin1 = andNotBits(xmm3, y);
+  V ysin2 = andBits(xmm3, y2);
+  V ysin1 = andNotBits(xmm3, y);
   y2 = y2 - ysin2;
   y = y - ysin1;
   
   xmm1 = ysin1 + ysin2;
   xmm2 = y + y2;
   
-  float4 s = xorBits(xmm1, sign_bit_sin);
-  float4 c = xorBits(xmm2, sign_bit_cos);
+  V s = xorBits(xmm1, sign_bit_sin);
+  V c = xorBits(xmm2, sign_bit_cos);
   return {s, c};
 }
 
@@ -472,7 +487,7 @@ constexpr float kLogC7 = 0.69314718055995f;
 
 template<typename T>
 inline T expApprox(T x) {
-  using I = std::conditional_t<std::is_same_v<T, float>, int32_t, int4>;
+  using I = std::conditional_t<std::is_same_v<T, float>, int32_t, IntTypeFor_t<T>>;
   
   T val2 = x * T{kExpC2} + T{kExpC3};
   T val3 = min(val2, T{kExpC1});
@@ -487,7 +502,7 @@ inline T expApprox(T x) {
 
 template<typename T>
 inline T logApprox(T x) {
-  using I = std::conditional_t<std::is_same_v<T, float>, int32_t, int4>;
+  using I = std::conditional_t<std::is_same_v<T, float>, int32_t, IntTypeFor_t<T>>;
   
   I valAsInt = reinterpretFloatAsInt(x);
   I expi = shiftRightElements(valAsInt, 23);
@@ -18,7 +18,7 @@
 // ----------------------------------------------------------------
 // Type definitions
 
-struct float4 {
+struct ML_MAY_ALIAS float4 {
   float32x4_t v;
 
   float4() = default;
@@ -30,7 +30,7 @@ struct float4 {
   operator float32x4_t() const { return v; }
 };
 
-struct int4 {
+struct ML_MAY_ALIAS int4 {
   int32x4_t v;
 
   int4() = default;
@@ -269,6 +269,8 @@ inline float vecMinH(float4 v) {
 
 inline float4 loadFloat4(const float* ptr) { return float4(vld1q_f32(ptr)); }
 inline void storeFloat4(float* ptr, float4 v) { vst1q_f32(ptr, v.v); }
+inline float4 loadFloat4Unaligned(const float* ptr) { return float4(vld1q_f32(ptr)); }
+inline void storeFloat4Unaligned(float* ptr, float4 v) { vst1q_f32(ptr, v.v); }
 inline int4 loadInt4(const int32_t* ptr) { return int4(vld1q_s32(ptr)); }
 inline void storeInt4(int32_t* ptr, int4 v) { vst1q_s32(ptr, v.v); }
 
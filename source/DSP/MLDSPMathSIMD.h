@@ -5,16 +5,47 @@
 #pragma once
 
 #include <ostream>
+#include <type_traits>
 
 // Load definitions for low-level SIMD math.
-// These define float4, int4, and a bunch of operations on them.
-// We are currently only using 4-element vectors on both SSE and NEON.
+// These define float4, int4, and a bunch of operations on them. float4 is
+// available everywhere and is the unit for four-voice (SignalBlock4) data.
+// x86 builds configured with ML_SIMD_AVX2 or ML_SIMD_AVX512 (see the ML_SIMD_ISA
+// CMake option) also get float8 / int32x8 and float16 / int32x16 with the same
+// primitive set. The int vectors are named for their 32-bit lanes, so as not
+// to be read as 8- or 16-bit integers. floatN / intN name the widest vector
+// type enabled for the build, and are used by the whole-block operations in
+// MLDSPOps.h.
 constexpr size_t kSIMDVectorElems{4};
 #if (defined __ARM_NEON) || (defined __ARM_NEON__)
 #include "MLDSPMathNEON.h" // NEON
 #else
 #include "MLDSPMathSSE.h" // SSE 4.1
+#if (defined ML_SIMD_AVX2) || (defined ML_SIMD_AVX512)
+#if !defined(__AVX2__)
+#error "ML_SIMD_AVX2 requires compiling with AVX2 and FMA enabled (-mavx2 -mfma or /arch:AVX2)"
 #endif
+#include "MLDSPMathAVX2.h" // AVX2 + FMA
+#endif
+#if (defined ML_SIMD_AVX512)
+#if !defined(__AVX512F__) || !defined(__AVX512DQ__) || !defined(__AVX512BW__) || !defined(__AVX512VL__)
+#error "ML_SIMD_AVX512 requires compiling with AVX-512 F, DQ, BW and VL enabled"
+#endif
+#include "MLDSPMathAVX512.h" // AVX-512
+#endif
+#endif
+
+#if (defined ML_SIMD_AVX512) && !((defined __ARM_NEON) || (defined __ARM_NEON__))
+using floatN = float16;
+using intN = int32x16;
+#elif (defined ML_SIMD_AVX2) && !((defined __ARM_NEON) || (defined __ARM_NEON__))
+using floatN = float8;
+using intN = int32x8;
+#else
+using floatN = float4;
+using intN = int4;
+#endif
+constexpr size_t kSIMDWideVectorElems{sizeof(floatN) / sizeof(float)};
 
 // ----------------------------------------------------------------
 // traits for int/float conversions
@@ -22,35 +53,65 @@ constexpr size_t kSIMDVectorElems{4};
 template<typename T> struct IntTypeFor;
 template<> struct IntTypeFor<float> { using type = uint32_t; };
 template<> struct IntTypeFor<float4> { using type = int4; };
+#if (defined ML_SIMD_AVX2) || (defined ML_SIMD_AVX512)
+template<> struct IntTypeFor<float8> { using type = int32x8; };
+#endif
+#if (defined ML_SIMD_AVX512)
+template<> struct IntTypeFor<float16> { using type = int32x16; };
+#endif
 
 template<typename T>
 using IntTypeFor_t = typename IntTypeFor<T>::type;
 
-// ----------------------------------------------------------------
-// float4 utilities with scalar equivalents
-
-inline float4 clamp(float4 a, float4 b, float4 c) { return min(max(a, b), c); }
-
-inline float4 lerp(float4 a, float4 b, float4 mix) { return a + (mix * (b - a)); }
-
-// up/down sign: -1 or 1
-inline float4 sign(float4 x) { return orBits(andBits(set1Float(-0.0f), x), set1Float(1.0f)); }
+// true for the SIMD float vector types, used to keep vector templates
+// from matching scalar floats.
+template<typename T> struct IsFloatVector : std::false_type {};
+template<> struct IsFloatVector<float4> : std::true_type {};
+#if (defined ML_SIMD_AVX2) || (defined ML_SIMD_AVX512)
+template<> struct IsFloatVector<float8> : std::true_type {};
+#endif
+#if (defined ML_SIMD_AVX512)
+template<> struct IsFloatVector<float16> : std::true_type {};
+#endif
 
-inline float4 intPart(float4 val) {
-  return intToFloat(floatToIntTruncate(val));
-}
+template<typename T>
+constexpr bool IsFloatVector_v = IsFloatVector<T>::value;
 
-inline float4 fracPart(float4 val) {
-  return val - intPart(val);
-}
+// ----------------------------------------------------------------
+// float vector utilities with scalar equivalents
+
+#define DEFINE_FLOAT_VECTOR_UTILS(F) \
+inline F clamp(F a, F b, F c) { return min(max(a, b), c); } \
+inline F lerp(F a, F b, F mix) { return a + (mix * (b - a)); } \
+inline F sign(F x) { return orBits(andBits(F(-0.0f), x), F(1.0f)); } \
+inline F intPart(F val) { return intToFloat(floatToIntTruncate(val)); } \
+inline F fracPart(F val) { return val - intPart(val); }
+
+// clamp, lerp, sign (up/down: -1 or 1), intPart and fracPart
+DEFINE_FLOAT_VECTOR_UTILS(float4)
+#if (defined ML_SIMD_AVX2) || (defined ML_SIMD_AVX512)
+DEFINE_FLOAT_VECTOR_UTILS(float8)
+#endif
+#if (defined ML_SIMD_AVX512)
+DEFINE_FLOAT_VECTOR_UTILS(float16)
+#endif
 
 // ----------------------------------------------------------------
-// int4 utilities with scalar equivalents
+// int vector utilities with scalar equivalents
 
-inline int4 operator*(int4 a, int4 b) { return multiplyUnsigned(a, b); }
-inline int4 operator>>(int4 a, int n) { return shiftRightElements(a, n); }
-inline int4 operator&(int4 a, int4 b) { return andBits(a, b); }
-inline int4 operator|(int4 a, int4 b) { return orBits(a, b); }
+#define DEFINE_INT_VECTOR_UTILS(I) \
+inline I operator*(I a, I b) { return multiplyUnsigned(a, b); } \
+inline I operator>>(I a, int n) { return shiftRightElements(a, n); } \
+inline I operator&(I a, I b) { return andBits(a, b); } \
+inline I operator|(I a, I b) { return orBits(a, b); }
+
+DEFINE_INT_VECTOR_UTILS(int4)
+#if (defined ML_SIMD_AVX2) || (defined ML_SIMD_AVX512)
+DEFINE_INT_VECTOR_UTILS(int32x8)
+#endif
+#if (defined ML_SIMD_AVX512)
+DEFINE_INT_VECTOR_UTILS(int32x16)
+#endif
 
 // ----------------------------------------------------------------
 // Shuffle and transpose
@@ -63,6 +124,21 @@ inline float4 vecShuffleLeft(float4 v1, float4 v2) {
   return shuffle<1, 2, 0, 3>(v1, shuffle<3, 3, 0, 0>(v1, v2));
 }
 
+// move each lane up by one or two, toward lane 3, shifting in zeros.
+inline float4 shiftLanesUp1(float4 v) { return vecShuffleRight(setZero(), v); }
+inline float4 shiftLanesUp2(float4 v) { return moveLH(setZero(), v); }
+
+// copy lane I to all lanes.
+template<int I>
+inline float4 broadcastLane(float4 v) { return shuffle<I, I, I, I>(v, v); }
+inline float4 broadcastLane3(float4 v) { return broadcastLane<3>(v); }
+
+// inclusive prefix sum of the lanes: (a, b, c, d) -> (a, a+b, a+b+c, a+b+c+d).
+inline float4 prefixSum(float4 v) {
+  v += shiftLanesUp1(v);
+  return v + shiftLanesUp2(v);
+}
+
 inline void transpose4x4InPlace(float4* ptr) {
   float4 r0 = ptr[0];
   float4 r1 = ptr[1];
@@ -141,3 +217,25 @@ inline std::ostream& operator<<(std::ostream& out, float4 x) {
   out << "]";
   return out;
 }
+
+#if (defined ML_SIMD_AVX2) || (defined ML_SIMD_AVX512)
+inline std::ostream& operator<<(std::ostream& out, float8 x) {
+  out << "[";
+  for (size_t i = 0; i < 8; ++i) {
+    out << getFloat8Lane(x, i) << ((i < 7) ? ", " : "");
+  }
+  out << "]";
+  return out;
+}
+#endif
+
+#if (defined ML_SIMD_AVX512)
+inline std::ostream& operator<<(std::ostream& out, float16 x) {
+  out << "[";
+  for (size_t i = 0; i < 16; ++i) {
+    out << getFloat16Lane(x, i) << ((i < 15) ? ", " : "");
+  }
+  out << "]";
+  return out;
+}
+#endif
@@ -19,7 +19,7 @@
 // ----------------------------------------------------------------
 // Type definitions
 
-struct float4 {
+struct ML_MAY_ALIAS float4 {
   __m128 v;
   
   float4() = default;
@@ -29,7 +29,7 @@ struct float4 {
   operator __m128() const { return v; }
 };
 
-struct int4 {
+struct ML_MAY_ALIAS int4 {
   __m128i v;
   
   int4() = default;
@@ -196,6 +196,8 @@ inline float vecMinH(float4 v) {
 
 inline float4 loadFloat4(const float* ptr) { return float4(_mm_load_ps(ptr)); }
 inline void storeFloat4(float* ptr, float4 v) { _mm_store_ps(ptr, v); }
+inline float4 loadFloat4Unaligned(const float* ptr) { return float4(_mm_loadu_ps(ptr)); }
+inline void storeFloat4Unaligned(float* ptr, float4 v) { _mm_storeu_ps(ptr, v); }
 inline int4 loadInt4(const int32_t* ptr) { return int4(_mm_load_si128((const __m128i*)ptr)); }
 inline void storeInt4(int32_t* ptr, int4 v) { _mm_store_si128((__m128i*)ptr, v); }
 
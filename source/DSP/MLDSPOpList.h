@@ -0,0 +1,122 @@
+// madronalib: a C++ framework for DSP applications.
+// Copyright (c) 2026 Madrona Labs LLC. http://www.madronalabs.com
+// Distributed under the MIT license: http://madrona-labs.mit-license.org/
+
+// MLDSPOpList.h
+// The stateless whole-block operations as X-macro lists of (name, expression).
+// MLDSPOps.h expands them into the AlignedArray operations, and the runtime
+// dispatch kernels (MLDSPKernels.h) expand the same lists once per instruction
+// set, so each expression is written in exactly one place.
+//
+// Each expression is the body of a generic lambda over vector arguments x, y
+// and z, so it must compile for float4 and for the wider vector types.
+
+#pragma once
+
+namespace ml {
+
+// Constants for the lazy log2 and exp2 expressions
+constexpr float kLogTwo{0.69314718055994529f};
+constexpr float kLogTwoR{1.4426950408889634f};
+
+}  // namespace ml
+
+// ----------------------------------------------------------------
+// Unary operations, (float) -> float
+
+#define ML_DSP_OPS_F2F(X) \
+X(recipApprox, rcp(x)) \
+X(sqrt, sqrt(x)) \
+/* x * rsqrt(x) is NaN at 0, so non-positive x gives 0 */ \
+X(sqrtApprox, select(x * rsqrt(x), decltype(x)(0.f), x > decltype(x)(0.f))) \
+X(abs, andNotBits(decltype(x)(-0.0f), x)) \
+/* up/down sign: -1 or 1 */ \
+X(sign, sign(x)) \
+/* Trig, log and exp, using accurate cephes-derived library */ \
+X(sin, sin(x)) \
+X(cos, cos(x)) \
+X(tan, sin(x) / cos(x)) \
+X(log, log(x)) \
+X(exp, exp(x)) \
+/* Lazy log2 and exp2 from natural log / exp */ \
+X(log2, log(x) * decltype(x)(kLogTwoR)) \
+X(exp2, exp(decltype(x)(kLogTwo) * x)) \
+/* Trig, log and exp, using polynomial approximations */ \
+X(sinApprox, sinApprox(x)) \
+X(cosApprox, cosApprox(x)) \
+X(tanApprox, sinApprox(x) / cosApprox(x)) \
+X(sigLogApprox, logApprox(x)) \
+X(sigExpApprox, expApprox(x)) \
+/* Lazy log2 and exp2 approximations */ \
+X(log2Approx, logApprox(x) * decltype(x)(kLogTwoR)) \
+X(exp2Approx, expApprox(decltype(x)(kLogTwo) * x)) \
+/* Cubic tanh approx */ \
+X(sigTanhApprox, tanhApprox(x)) \
+/* Fractional part */ \
+X(fractionalPart, x - intToFloat(floatToIntTruncate(x)))
+
+// ----------------------------------------------------------------
+// Binary operations, (float, float) -> float
+
+#define ML_DSP_OPS_FF2F(X) \
+X(add, x + y) \
+X(subtract, x - y) \
+X(multiply, x * y) \
+X(divide, x / y) \
+X(divideApprox, x * rcp(y)) \
+X(pow, exp(log(x) * y)) \
+X(powApprox, expApprox(logApprox(x) * y)) \
+X(min, min(x, y)) \
+X(max, max(x, y)) \
+X(equal, operator==(x, y)) \
+X(notEqual, operator!=(x, y)) \
+X(greaterThan, operator>(x, y)) \
+X(greaterThanOrEqual, operator>=(x, y)) \
+X(lessThan, operator<(x, y)) \
+X(lessThanOrEqual, operator<=(x, y))
+
+// ----------------------------------------------------------------
+// Ternary operations, (float, float, float) -> float
+
+#define ML_DSP_OPS_FFF2F(X) \
+X(lerp, lerp(x, y, z))                      /* x = lerp(a, b, mix) */ \
+X(inverseLerp, (z - x) / (y - x))           /* mix = inverseLerp(a, b, x) */ \
+X(clamp, min(max(x, y), z))                 /* clamp(x, minBound, maxBound) */ \
+X(within, andBits((x >= y), (x < z)))       /* is x in [y, z)? */ \
+X(select, select(x, y, z))                  /* select(resultIfTrue, resultIfFalse, conditionMask) */
+
+// ----------------------------------------------------------------
+// Binary operations, (int32, int32) -> int32
+
+#define ML_DSP_OPS_II2I(X) \
+X(addInt32, x + y) \
+X(subtractInt32, x - y)
+
+// ----------------------------------------------------------------
+// Binary operations with a multiple-row first operand and a single-row
+// second operand, (float, float) -> float
+
+#define ML_DSP_OPS_FF2F_MS(X) \
+X(add1, x + y) \
+X(subtract1, x - y) \
+X(multiply1, x * y) \
+X(divide1, x / y) \
+X(divideApprox1, x * rcp(y)) \
+X(pow1, exp(log(x) * y)) \
+X(powApprox1, expApprox(logApprox(x) * y)) \
+X(min1, min(x, y)) \
+X(max1, max(x, y))
+
+// ----------------------------------------------------------------
+// Unary operations, (float) -> int32
+
+#define ML_DSP_OPS_F2I(X) \
+X(roundFloatToInt, floatToIntRound(x)) \
+X(truncateFloatToInt, floatToIntTruncate(x))
+
+// ----------------------------------------------------------------
+// Unary operations, (int32) -> float
+
+#define ML_DSP_OPS_I2F(X) \
+X(intToFloat, intToFloat(x)) \
+X(unsignedIntToFloat, unsignedIntToFloat(x))
@@ -22,23 +22,37 @@
 #define snprintf _snprintf
 #endif
 
+#include <algorithm>
 #include <array>
+#include <cstring>
 #include <iostream>
 
 #include "MLDSPMath.h"
 #include "MLDSPMathApprox.h"
+#include "MLDSPOpList.h"
+#include "MLDSPDispatch.h"
 
 namespace ml {
 
 
 // Here is the signal block size, an important constant. All processing is done in
 // chunks of this block size so that loops can be unrolled at compile time.
-constexpr size_t kFramesPerBlockBits = 6;
+// The default is 64 frames. It can be changed for the whole build with
+// ML_FRAMES_PER_BLOCK_BITS (see the CMake option of the same name). The block
+// types and the operations on them also take the number of frames as a template
+// parameter, so blocks of other sizes can be used alongside the default ones:
+// see SignalBlockOf<FRAMES> below.
+#ifndef ML_FRAMES_PER_BLOCK_BITS
+#define ML_FRAMES_PER_BLOCK_BITS 6
+#endif
+constexpr size_t kFramesPerBlockBits = ML_FRAMES_PER_BLOCK_BITS;
 constexpr size_t kFramesPerBlock = 1 << kFramesPerBlockBits;
-static_assert((kFramesPerBlockBits <= 8),
-              "We count on kFramesPerBlockBits to be 8 or less.");
+static_assert((kFramesPerBlockBits >= 4) && (kFramesPerBlockBits <= 8),
+              "We count on kFramesPerBlockBits to be from 4 to 8.");
 
-constexpr size_t kSIMDAlignBytes{16};
+// Arrays are aligned for the widest SIMD vector type enabled in the build:
+// 16 bytes for SSE / NEON, 32 for AVX2, 64 for AVX-512.
+constexpr size_t kSIMDAlignBytes{sizeof(floatN)};
 constexpr size_t kSIMDVectorsPerBlock{kFramesPerBlock / kSIMDVectorElems};
 static_assert((kFramesPerBlock % kSIMDVectorElems == 0),
               "Block size must be a multiple of SIMD vectors.");
@@ -66,10 +80,39 @@ constexpr auto make_array(Function f)
 // AlignedArray
 // array type on which we define all of the underlying SIMD operators.
 
+// Pass uninitialized to an AlignedArray or SignalBlock constructor to skip the
+// default zero fill, for blocks that are about to be completely overwritten.
+// In builds with ML_POISON_UNINITIALIZED_BLOCKS, uninitialized blocks are
+// instead filled with signalling NaNs, so that any element read before it is
+// written shows up as a NaN in the output.
+struct uninitialized_t
+{
+  explicit constexpr uninitialized_t() = default;
+};
+inline constexpr uninitialized_t uninitialized{};
+
+// the bits of a signalling NaN: exponent all ones, quiet bit clear, payload nonzero.
+constexpr uint32_t kSignallingNaNBits{0x7FA00000};
+
+// true for the expression types made by the arithmetic operators, see
+// "Expression templates" below.
+template<typename E, typename = void>
+struct IsBlockExpr : std::false_type {};
+template<typename E>
+struct IsBlockExpr<E, std::void_t<decltype(E::kIsBlockExpr)>> : std::true_type {};
+
+// true if E is an expression that evaluates to an AlignedArray<T, N>.
+template<typename E, typename T, size_t N, typename = void>
+struct IsBlockExprFor : std::false_type {};
+template<typename E, typename T, size_t N>
+struct IsBlockExprFor<E, T, N, std::enable_if_t<IsBlockExpr<E>::value>>
+: std::bool_constant<std::is_same_v<typename E::scalar_type, T> && (E::kSize == N)> {};
+
 template<typename T, size_t N>
 struct alignas(kSIMDAlignBytes) AlignedArray
 {
   std::array<T, N> dataAligned;
+  static constexpr size_t kSize{N};
   static_assert(sizeof(T) * N % sizeof(float4) == 0,
                 "AlignedArray size must be a multiple of float4 size (16 bytes)");
   
@@ -77,11 +120,23 @@ struct alignas(kSIMDAlignBytes) AlignedArray
   constexpr AlignedArray<T, N>(const T* dataPtr) { std::copy(dataPtr, dataPtr + N, dataAligned.data() );}
   AlignedArray<T, N>(T val) { fill(val); }
   AlignedArray<T, N>() { fill(T(0.f)); } // TODO: find bugs and remove default fill!
+  explicit AlignedArray<T, N>(uninitialized_t) { poison(); }
   
   // constexpr constructor taking a function(size_t -> T)
   constexpr AlignedArray(T (*fn)(size_t))
   : AlignedArray(make_array<N>(fn)) {}
   
+  // evaluate an expression
+  template<typename E, typename = std::enable_if_t<IsBlockExprFor<E, T, N>::value>>
+  AlignedArray(const E& e) { e.evaluateInto(reinterpret_cast<float*>(dataAligned.data())); }
+  
+  template<typename E, typename = std::enable_if_t<IsBlockExprFor<E, T, N>::value>>
+  AlignedArray& operator=(const E& e)
+  {
+    e.evaluateInto(reinterpret_cast<float*>(dataAligned.data()));
+    return *this;
+  }
+  
   const T& operator[](size_t i) const { return dataAligned[i]; }
   T& operator[](size_t i) { return dataAligned[i]; }
   const T* data() const { return dataAligned.data(); }
@@ -100,41 +155,40 @@ struct alignas(kSIMDAlignBytes) AlignedArray
   
   void fill(T f) {dataAligned.fill(f);}
   
-  inline AlignedArray& operator+=(const AlignedArray& x1)
+  // fill with signalling NaNs if ML_POISON_UNINITIALIZED_BLOCKS is set, otherwise do nothing.
+  void poison()
   {
-    *this = add(*this, x1);
-    return *this;
+#if defined(ML_POISON_UNINITIALIZED_BLOCKS)
+    uint32_t* p = reinterpret_cast<uint32_t*>(dataAligned.data());
+    std::fill(p, p + sizeof(T) * N / sizeof(uint32_t), kSignallingNaNBits);
+#endif
   }
-  inline AlignedArray& operator-=(const AlignedArray& x1)
+  
+  // Arithmetic operators. For float and float4 arrays these build expressions,
+  // see "Expression templates" below.
+  template<typename X>
+  inline AlignedArray& operator+=(const X& x1)
   {
-    *this = subtract(*this, x1);
+    *this = *this + x1;
     return *this;
   }
-  inline AlignedArray& operator*=(const AlignedArray& x1)
+  template<typename X>
+  inline AlignedArray& operator-=(const X& x1)
   {
-    *this = multiply(*this, x1);
+    *this = *this - x1;
     return *this;
   }
-  inline AlignedArray& operator/=(const AlignedArray& x1)
+  template<typename X>
+  inline AlignedArray& operator*=(const X& x1)
   {
-    *this = divide(*this, x1);
+    *this = *this * x1;
     return *this;
   }
-  friend inline AlignedArray operator+(const AlignedArray& x1, const AlignedArray& x2)
+  template<typename X>
+  inline AlignedArray& operator/=(const X& x1)
   {
-    return add(x1, x2);
-  }
-  friend inline AlignedArray operator-(const AlignedArray& x1, const AlignedArray& x2)
-  {
-    return subtract(x1, x2);
-  }
-  friend inline AlignedArray operator*(const AlignedArray& x1, const AlignedArray& x2)
-  {
-    return multiply(x1, x2);
-  }
-  friend inline AlignedArray operator/(const AlignedArray& x1, const AlignedArray& x2)
-  {
-    return divide(x1, x2);
+    *this = *this / x1;
+    return *this;
   }
 };
 
@@ -156,33 +210,47 @@ inline std::ostream& operator<<(std::ostream& out, const AlignedArray<T, N>& aa)
 }
 
 // ----------------------------------------------------------------
-// SignalBlockArrayBase - common base for signal types with kFramesPerBlock frames
-// per row and some number of rows
+// SignalBlockArrayBase - common base for signal types with FRAMES frames
+// per row and some number of rows. FRAMES is kFramesPerBlock unless given.
 
-template<typename T, size_t ROWS>
-struct SignalBlockArrayBase : public AlignedArray<T, ROWS * kFramesPerBlock>
+template<typename T, size_t ROWS, size_t FRAMES = kFramesPerBlock>
+struct SignalBlockArrayBase : public AlignedArray<T, ROWS * FRAMES>
 {
-  using Base = AlignedArray<T, ROWS * kFramesPerBlock>;
+  using Base = AlignedArray<T, ROWS * FRAMES>;
   using scalar_type = T;
+  static constexpr size_t kRows{ROWS};
+  static constexpr size_t kFrames{FRAMES};
+  static_assert(FRAMES % kSIMDVectorElems == 0, "Block size must be a multiple of SIMD vectors.");
   
   SignalBlockArrayBase() : Base() {}
+  explicit SignalBlockArrayBase(uninitialized_t u) : Base(u) {}
   SignalBlockArrayBase(T val) : Base(val) {}
   constexpr SignalBlockArrayBase(const Base& b) : Base(b) {}
   
-  SignalBlockArrayBase<T, 1> getRow(size_t i) const {
-    return SignalBlockArrayBase<T, 1>(this->data() + i * kFramesPerBlock);
+  template<typename E, typename = std::enable_if_t<IsBlockExprFor<E, T, Base::kSize>::value>>
+  SignalBlockArrayBase(const E& e) : Base(e) {}
+  
+  template<typename E, typename = std::enable_if_t<IsBlockExprFor<E, T, Base::kSize>::value>>
+  SignalBlockArrayBase& operator=(const E& e)
+  {
+    Base::operator=(e);
+    return *this;
+  }
+  
+  SignalBlockArrayBase<T, 1, FRAMES> getRow(size_t i) const {
+    return SignalBlockArrayBase<T, 1, FRAMES>(this->data() + i * FRAMES);
   }
   
-  void setRow(size_t i, const SignalBlockArrayBase<T, 1>& block) {
-    std::copy(block.begin(), block.end(), this->data() + i * kFramesPerBlock);
+  void setRow(size_t i, const SignalBlockArrayBase<T, 1, FRAMES>& block) {
+    std::copy(block.begin(), block.end(), this->data() + i * FRAMES);
   }
   
   T* rowPtr(size_t i) {
-    return this->data() + i * kFramesPerBlock;
+    return this->data() + i * FRAMES;
   }
   
   const T* rowPtr(size_t i) const {
-    return this->data() + i * kFramesPerBlock;
+    return this->data() + i * FRAMES;
   }
   
   // because there are no actual single-row objects, we can't return a reference
@@ -194,29 +262,29 @@ struct SignalBlockArrayBase : public AlignedArray<T, ROWS * kFramesPerBlock>
     T& operator[](size_t i) { return _data[i]; }
     const T& operator[](size_t i) const { return _data[i]; }
     
-    RowView& operator=(const SignalBlockArrayBase<T, 1>& other) {
-      for (size_t i = 0; i < kFramesPerBlock; ++i) {
+    RowView& operator=(const SignalBlockArrayBase<T, 1, FRAMES>& other) {
+      for (size_t i = 0; i < FRAMES; ++i) {
         _data[i] = other[i];
       }
       return *this;
     }
     
-    RowView& operator+=(const SignalBlockArrayBase<T, 1>& other) {
-      for (size_t i = 0; i < kFramesPerBlock; ++i) {
+    RowView& operator+=(const SignalBlockArrayBase<T, 1, FRAMES>& other) {
+      for (size_t i = 0; i < FRAMES; ++i) {
         _data[i] += other[i];
       }
       return *this;
     }
     
-    RowView& operator-=(const SignalBlockArrayBase<T, 1>& other) {
-      for (size_t i = 0; i < kFramesPerBlock; ++i) {
+    RowView& operator-=(const SignalBlockArrayBase<T, 1, FRAMES>& other) {
+      for (size_t i = 0; i < FRAMES; ++i) {
         _data[i] -= other[i];
       }
       return *this;
     }
     
-    RowView& operator*=(const SignalBlockArrayBase<T, 1>& other) {
-      for (size_t i = 0; i < kFramesPerBlock; ++i) {
+    RowView& operator*=(const SignalBlockArrayBase<T, 1, FRAMES>& other) {
+      for (size_t i = 0; i < FRAMES; ++i) {
         _data[i] *= other[i];
       }
       return *this;
@@ -226,16 +294,16 @@ struct SignalBlockArrayBase : public AlignedArray<T, ROWS * kFramesPerBlock>
     // rows of SignalBlockArrayBase classes with different N.
     template<typename T2>
     bool operator==(const T2& other) const {
-      return std::equal(_data, _data + kFramesPerBlock, other._data);
+      return std::equal(_data, _data + FRAMES, other._data);
     }
     template<typename T2>
     bool operator!=(const T2& other) const {
-      return !std::equal(_data, _data + kFramesPerBlock, other._data);
+      return !std::equal(_data, _data + FRAMES, other._data);
     }
 
     // conversion operator to SignalBlock (defined later)
-    operator SignalBlockArrayBase<T, 1>() const {
-      return SignalBlockArrayBase<T, 1>(_data);
+    operator SignalBlockArrayBase<T, 1, FRAMES>() const {
+      return SignalBlockArrayBase<T, 1, FRAMES>(_data);
     }
   };
   
@@ -244,17 +312,17 @@ struct SignalBlockArrayBase : public AlignedArray<T, ROWS * kFramesPerBlock>
     
     const T& operator[](size_t i) const { return _data[i]; }
     
-    operator SignalBlockArrayBase<T, 1>() const {
-      return SignalBlockArrayBase<T, 1>(_data);
+    operator SignalBlockArrayBase<T, 1, FRAMES>() const {
+      return SignalBlockArrayBase<T, 1, FRAMES>(_data);
     }
   };
 
   RowView row(size_t i) {
-    return RowView{this->data() + i * kFramesPerBlock};
+    return RowView{this->data() + i * FRAMES};
   }
   
   ConstRowView constRow(size_t i) const {
-    return ConstRowView{this->data() + i * kFramesPerBlock};
+    return ConstRowView{this->data() + i * FRAMES};
   }
 };
 
@@ -272,10 +340,372 @@ using SignalBlockInt = SignalBlockArrayBase<int32_t, 1>;
 template<size_t ROWS>
 using SignalBlockIntArray = SignalBlockArrayBase<int32_t, ROWS>;
 
+// Blocks with a given number of frames, for processing at block sizes other than
+// the default. SignalBlockOf<kFramesPerBlock> is SignalBlock.
+template<size_t FRAMES>
+using SignalBlockOf = SignalBlockArrayBase<float, 1, FRAMES>;
+
+template<size_t ROWS, size_t FRAMES>
+using SignalBlockArrayOf = SignalBlockArrayBase<float, ROWS, FRAMES>;
+
 // Block, where Block<float> = SignalBlock and Block<float4> = SignalBlock4.
-// This lets us write Block<T> in templates
+// This lets us write Block<T> in templates, or Block<T, FRAMES> for other block sizes.
+template<typename T, size_t FRAMES = kFramesPerBlock>
+using Block = SignalBlockArrayBase<T, 1, FRAMES>;
+
+// ----------------------------------------------------------------
+// Loop sizes for the block operations and expressions.
+
+template<typename T, size_t N>
+constexpr size_t numFloatsIn() { return sizeof(T) * N / sizeof(float); }
+
+template<typename T, size_t N>
+constexpr size_t numWideVectorsIn() { return numFloatsIn<T, N>() / kSIMDWideVectorElems; }
+
+// index of the first float4 not covered by the wide vectors
+template<typename T, size_t N>
+constexpr size_t float4TailStart() { return numWideVectorsIn<T, N>() * kSIMDWideVectorElems / 4; }
+
+// ----------------------------------------------------------------
+// Expression templates
+//
+// The arithmetic operators + - * / and unary - on float and float4 arrays do
+// not compute their results right away. Instead they return small expression
+// objects, and the whole expression is evaluated in a single loop over SIMD
+// vectors when it is assigned to an AlignedArray or SignalBlockArray or used to
+// construct one. So a * b + c * d - e makes one pass over its inputs and
+// creates no temporary blocks, and an addition with a product operand is
+// evaluated with multiplyAdd(), which is fused on the AVX2, AVX-512 and NEON
+// backends. In builds with runtime dispatch these loops use float4.
+//
+// Operands that are lvalues are held by reference and temporaries are held by
+// value, so expressions can be stored with auto while their operands are alive.
+// To pass an expression to a function template that deduces AlignedArray
+// parameters, call eval() on it. Arrays of other element types, such as
+// SignalBlockInt, keep the eager operators.
+
 template<typename T>
-using Block = SignalBlockArrayBase<T, 1>;
+constexpr bool isLazyElementType() { return std::is_same_v<T, float> || std::is_same_v<T, float4>; }
+
+// Detect an AlignedArray<T, N> or a class derived from one, and get T and N.
+template<typename T, size_t N>
+std::pair<T, std::integral_constant<size_t, N>> alignedArrayParams(const AlignedArray<T, N>*);
+
+template<typename D, typename = void>
+struct AlignedArrayTraits : std::false_type {};
+
+template<typename D>
+struct AlignedArrayTraits<D, std::void_t<decltype(alignedArrayParams(std::declval<const D*>()))>>
+: std::true_type
+{
+  using Params = decltype(alignedArrayParams(std::declval<const D*>()));
+  using scalar_type = typename Params::first_type;
+  static constexpr size_t kSize = Params::second_type::value;
+};
+
+// The type of block an expression evaluates to by default: the SignalBlockArray
+// type of its operands if they are SignalBlockArrays, otherwise the AlignedArray.
+template<typename T, size_t ROWS, size_t FRAMES>
+SignalBlockArrayBase<T, ROWS, FRAMES> blockResultType(const SignalBlockArrayBase<T, ROWS, FRAMES>*);
+template<typename T, size_t N>
+AlignedArray<T, N> blockResultType(const AlignedArray<T, N>*);
+
+// Properties shared by leaf arrays and expression nodes.
+template<typename D, typename = void>
+struct BlockOperandTraits : std::false_type {};
+
+template<typename D>
+struct BlockOperandTraits<D, std::enable_if_t<IsBlockExpr<D>::value>> : std::true_type
+{
+  using scalar_type = typename D::scalar_type;
+  using result_type = typename D::result_type;
+  static constexpr size_t kSize = D::kSize;
+};
+
+template<typename D>
+struct BlockOperandTraits<D, std::enable_if_t<!IsBlockExpr<D>::value && AlignedArrayTraits<D>::value>>
+: std::true_type
+{
+  using scalar_type = typename AlignedArrayTraits<D>::scalar_type;
+  using result_type = decltype(blockResultType(std::declval<const D*>()));
+  static constexpr size_t kSize = AlignedArrayTraits<D>::kSize;
+};
+
+template<typename X>
+constexpr bool isLazyOperand()
+{
+  using D = std::decay_t<X>;
+  if constexpr (BlockOperandTraits<D>::value)
+    return isLazyElementType<typename BlockOperandTraits<D>::scalar_type>();
+  else
+    return false;
+}
+
+// Can L and R be the operands of a lazy binary operator? Either both are lazy
+// operands of the same size and element type, or one of them is a lazy operand
+// and the other converts to its element type.
+template<typename L, typename R>
+constexpr bool areLazyOperands()
+{
+  using DL = std::decay_t<L>;
+  using DR = std::decay_t<R>;
+  if constexpr (isLazyOperand<L>() && isLazyOperand<R>())
+  {
+    using TL = BlockOperandTraits<DL>;
+    using TR = BlockOperandTraits<DR>;
+    return std::is_same_v<typename TL::scalar_type, typename TR::scalar_type> && (TL::kSize == TR::kSize);
+  }
+  else if constexpr (isLazyOperand<L>() && !BlockOperandTraits<DR>::value)
+    return std::is_convertible_v<DR, typename BlockOperandTraits<DL>::scalar_type>;
+  else if constexpr (isLazyOperand<R>() && !BlockOperandTraits<DL>::value)
+    return std::is_convertible_v<DL, typename BlockOperandTraits<DR>::scalar_type>;
+  else
+    return false;
+}
+
+// Load the vector V starting at float index i of an array.
+template<typename V>
+inline V loadBlockVector(const float* p, size_t i) { return *reinterpret_cast<const V*>(p + i); }
+
+// The expression nodes below own everything they hold except lvalue arrays:
+// a BlockArrayRef points to its array, so an expression stored with auto must
+// not outlive the named arrays in it. Temporary arrays are moved into a
+// BlockArrayValue, scalars are copied into a BlockScalar, and subexpressions
+// are held by value, so none of those can dangle.
+
+// Leaf operand: an array held by reference.
+template<typename D>
+struct BlockArrayRef
+{
+  const D* array;
+  
+  template<typename V>
+  V evalAt(size_t i) const { return loadBlockVector<V>(reinterpret_cast<const float*>(array->data()), i); }
+};
+
+// Leaf operand: a temporary array, held by value.
+template<typename D>
+struct BlockArrayValue
+{
+  D array;
+  
+  template<typename V>
+  V evalAt(size_t i) const { return loadBlockVector<V>(reinterpret_cast<const float*>(array.data()), i); }
+};
+
+// Leaf operand: a float or float4 scalar, repeated to fill the widest vector.
+template<typename T>
+struct BlockScalar
+{
+  alignas(kSIMDAlignBytes) std::array<float, kSIMDWideVectorElems> lanes;
+  
+  explicit BlockScalar(T x)
+  {
+    const float* px = reinterpret_cast<const float*>(&x);
+    constexpr size_t kScalarFloats = sizeof(T) / sizeof(float);
+    for (size_t i = 0; i < kSIMDWideVectorElems; ++i)
+    {
+      lanes[i] = px[i % kScalarFloats];
+    }
+  }
+  
+  template<typename V>
+  V evalAt(size_t) const { return loadBlockVector<V>(lanes.data(), 0); }
+};
+
+// Base class of the expression nodes. Evaluates the expression into an array
+// of kSize elements of type T.
+template<typename DERIVED, typename T, size_t N, typename RESULT>
+struct BlockExpr
+{
+  static constexpr bool kIsBlockExpr{true};
+  using scalar_type = T;
+  using result_type = RESULT;
+  static constexpr size_t kSize{N};
+  
+  void evaluateInto(float* dest) const
+  {
+    constexpr size_t kFloats = numFloatsIn<T, N>();
+    constexpr size_t kWideEnd = numWideVectorsIn<T, N>() * kSIMDWideVectorElems;
+    const DERIVED& e = static_cast<const DERIVED&>(*this);
+    for (size_t i = 0; i < kWideEnd; i += kSIMDWideVectorElems)
+    {
+      *reinterpret_cast<floatN*>(dest + i) = e.template evalAt<floatN>(i);
+    }
+    for (size_t i = kWideEnd; i < kFloats; i += 4)
+    {
+      *reinterpret_cast<float4*>(dest + i) = e.template evalAt<float4>(i);
+    }
+  }
+  
+  // Evaluate a single element. This is slow compared to evaluating the whole
+  // expression, but handy for tests and debugging.
+  T operator[](size_t i) const
+  {
+    const DERIVED& e = static_cast<const DERIVED&>(*this);
+    constexpr size_t kFloatsPerElem = sizeof(T) / sizeof(float);
+    size_t f = i * kFloatsPerElem;
+    float4 v = e.template evalAt<float4>(f & ~size_t(3));
+    if constexpr (std::is_same_v<T, float4>)
+      return v;
+    else
+      return getFloat4Lane(v, f & 3);
+  }
+};
+
+struct AddOp { template<typename V> static V apply(V a, V b) { return a + b; } };
+struct SubtractOp { template<typename V> static V apply(V a, V b) { return a - b; } };
+struct MultiplyOp { template<typename V> static V apply(V a, V b) { return a * b; } };
+struct DivideOp { template<typename V> static V apply(V a, V b) { return a / b; } };
+struct NegateOp { template<typename V> static V apply(V a) { return -a; } };
+
+template<typename OP, typename A, typename B, typename T, size_t N, typename R>
+struct BinaryBlockExpr;
+
+template<typename X>
+struct IsMultiplyBlockExpr : std::false_type {};
+template<typename A, typename B, typename T, size_t N, typename R>
+struct IsMultiplyBlockExpr<BinaryBlockExpr<MultiplyOp, A, B, T, N, R>> : std::true_type {};
+
+template<typename OP, typename A, typename B, typename T, size_t N, typename R>
+struct BinaryBlockExpr : BlockExpr<BinaryBlockExpr<OP, A, B, T, N, R>, T, N, R>
+{
+  A a;
+  B b;
+  
+  BinaryBlockExpr(A aa, B bb) : a(std::move(aa)), b(std::move(bb)) {}
+  
+  template<typename V>
+  V evalAt(size_t i) const
+  {
+    if constexpr (std::is_same_v<OP, AddOp> && IsMultiplyBlockExpr<A>::value)
+      return multiplyAdd(a.a.template evalAt<V>(i), a.b.template evalAt<V>(i), b.template evalAt<V>(i));
+    else if constexpr (std::is_same_v<OP, AddOp> && IsMultiplyBlockExpr<B>::value)
+      return multiplyAdd(b.a.template evalAt<V>(i), b.b.template evalAt<V>(i), a.template evalAt<V>(i));
+    else
+      return OP::apply(a.template evalAt<V>(i), b.template evalAt<V>(i));
+  }
+};
+
+template<typename OP, typename A, typename T, size_t N, typename R>
+struct UnaryBlockExpr : BlockExpr<UnaryBlockExpr<OP, A, T, N, R>, T, N, R>
+{
+  A a;
+  
+  explicit UnaryBlockExpr(A aa) : a(std::move(aa)) {}
+  
+  template<typename V>
+  V evalAt(size_t i) const { return OP::apply(a.template evalAt<V>(i)); }
+};
+
+// Wrap an array, expression or scalar as an operand with element type T.
+template<typename T, typename X>
+inline auto makeBlockOperand(X&& x)
+{
+  using D = std::decay_t<X>;
+  if constexpr (IsBlockExpr<D>::value)
+    return D(std::forward<X>(x));
+  else if constexpr (!AlignedArrayTraits<D>::value)
+    return BlockScalar<T>(T(x));
+  else if constexpr (std::is_lvalue_reference_v<X>)
+    return BlockArrayRef<D>{&x};
+  else
+    return BlockArrayValue<D>{std::forward<X>(x)};
+}
+
+template<typename OP, typename L, typename R>
+inline auto makeBinaryBlockExpr(L&& l, R&& r)
+{
+  using Traits = std::conditional_t<BlockOperandTraits<std::decay_t<L>>::value,
+                                    BlockOperandTraits<std::decay_t<L>>, BlockOperandTraits<std::decay_t<R>>>;
+  using T = typename Traits::scalar_type;
+  auto a = makeBlockOperand<T>(std::forward<L>(l));
+  auto b = makeBlockOperand<T>(std::forward<R>(r));
+  return BinaryBlockExpr<OP, decltype(a), decltype(b), T, Traits::kSize, typename Traits::result_type>(
+    std::move(a), std::move(b));
+}
+
+#define DEFINE_LAZY_BLOCK_OPERATOR(symbol, opType) \
+template<typename L, typename R, typename = std::enable_if_t<areLazyOperands<L, R>()>> \
+inline auto operator symbol(L&& l, R&& r) { \
+return makeBinaryBlockExpr<opType>(std::forward<L>(l), std::forward<R>(r)); \
+}
+
+DEFINE_LAZY_BLOCK_OPERATOR(+, AddOp)
+DEFINE_LAZY_BLOCK_OPERATOR(-, SubtractOp)
+DEFINE_LAZY_BLOCK_OPERATOR(*, MultiplyOp)
+DEFINE_LAZY_BLOCK_OPERATOR(/, DivideOp)
+
+template<typename X, typename = std::enable_if_t<isLazyOperand<X>()>>
+inline auto operator-(X&& x)
+{
+  using Traits = BlockOperandTraits<std::decay_t<X>>;
+  using T = typename Traits::scalar_type;
+  auto a = makeBlockOperand<T>(std::forward<X>(x));
+  return UnaryBlockExpr<NegateOp, decltype(a), T, Traits::kSize, typename Traits::result_type>(std::move(a));
+}
+
+// true if any of the arguments is an expression and all of them are lazy operands.
+// Used by the named block operations to accept expression arguments.
+template<typename... X>
+constexpr bool hasBlockExprArg()
+{
+  return (IsBlockExpr<X>::value || ...) && (isLazyOperand<X>() && ...);
+}
+
+// Evaluate an expression to its natural block type. Arrays are passed through.
+template<typename E, typename = std::enable_if_t<IsBlockExpr<E>::value>>
+inline typename E::result_type eval(const E& e)
+{
+  return typename E::result_type(e);
+}
+
+template<typename T, size_t N>
+inline const AlignedArray<T, N>& eval(const AlignedArray<T, N>& a)
+{
+  return a;
+}
+
+template<typename T, size_t ROWS, size_t FRAMES>
+inline const SignalBlockArrayBase<T, ROWS, FRAMES>& eval(const SignalBlockArrayBase<T, ROWS, FRAMES>& a)
+{
+  return a;
+}
+
+template<typename E, typename X,
+typename = std::enable_if_t<IsBlockExpr<E>::value && !IsBlockExpr<X>::value>>
+inline bool operator==(const E& e, const X& x) { return eval(e) == x; }
+
+template<typename X, typename E,
+typename = std::enable_if_t<IsBlockExpr<E>::value>, typename = void>
+inline bool operator==(const X& x, const E& e) { return x == eval(e); }
+
+template<typename E, typename X,
+typename = std::enable_if_t<IsBlockExpr<E>::value && !IsBlockExpr<X>::value>>
+inline bool operator!=(const E& e, const X& x) { return !(e == x); }
+
+template<typename X, typename E,
+typename = std::enable_if_t<IsBlockExpr<E>::value>, typename = void>
+inline bool operator!=(const X& x, const E& e) { return !(x == e); }
+
+template<typename E, typename = std::enable_if_t<IsBlockExpr<E>::value>>
+inline std::ostream& operator<<(std::ostream& out, const E& e)
+{
+  return out << eval(e);
+}
+
+// The eager operators, for arrays of other element types.
+#define DEFINE_EAGER_BLOCK_OPERATOR(symbol, opName) \
+template<typename T, size_t N, typename = std::enable_if_t<!isLazyElementType<T>()>> \
+inline AlignedArray<T, N> operator symbol(const AlignedArray<T, N>& a, const AlignedArray<T, N>& b) { \
+return opName(a, b); \
+}
+
+DEFINE_EAGER_BLOCK_OPERATOR(+, add)
+DEFINE_EAGER_BLOCK_OPERATOR(-, subtract)
+DEFINE_EAGER_BLOCK_OPERATOR(*, multiply)
+DEFINE_EAGER_BLOCK_OPERATOR(/, divide)
+
 
 // ----------------------------------------------------------------
 // SignalBlock4Array<ROWS>
@@ -304,206 +734,267 @@ inline float4* getFloat4BlockPtr(float4* array, size_t n) {
   return array + n * 4;
 }
 
-// Transpose all 4x4 blocks in the single row starting at rowPtr
+// Transpose all 4x4 blocks in the single row of FRAMES float4 frames starting at rowPtr
+template<size_t FRAMES = kFramesPerBlock>
 inline void transposeRow(float4* rowPtr) {
-  constexpr size_t blocksPerRow = kFramesPerBlock / 4;
+  constexpr size_t blocksPerRow = FRAMES / 4;
+#if defined(ML_SIMD_DISPATCH)
+  getDSPKernels().transpose4x4Blocks(reinterpret_cast<float*>(rowPtr), blocksPerRow);
+#else
   for (size_t i = 0; i < blocksPerRow; ++i) {
     transpose4x4InPlace(getFloat4BlockPtr(rowPtr, i));
   }
+#endif
 }
 
 // Transpose all 4x4 blocks in the single row starting at rowPtr
-inline void transposeRow(SignalBlock4& float4Row) {
-  float4* rowPtr = float4Row.data();
-  constexpr size_t blocksPerRow = kFramesPerBlock / 4;
-  for (size_t i = 0; i < blocksPerRow; ++i) {
-    transpose4x4InPlace(getFloat4BlockPtr(rowPtr, i));
-  }
+template<size_t FRAMES>
+inline void transposeRow(SignalBlockArrayBase<float4, 1, FRAMES>& float4Row) {
+  transposeRow<FRAMES>(float4Row.data());
 }
 
 // Transpose all 4x4 blocks in all rows
-template<size_t ROWS>
-inline void transposeRows(SignalBlock4Array<ROWS>& array) {
+template<size_t ROWS, size_t FRAMES>
+inline void transposeRows(SignalBlockArrayBase<float4, ROWS, FRAMES>& array) {
+#if defined(ML_SIMD_DISPATCH)
+  getDSPKernels().transpose4x4Blocks(reinterpret_cast<float*>(array.data()), ROWS * FRAMES / 4);
+#else
   for (size_t row = 0; row < ROWS; ++row) {
-    transposeRow(array.rowPtr(row));
+    transposeRow<FRAMES>(array.rowPtr(row));
   }
+#endif
 }
 
-// Convert ROWS of vertical SignalBlock4 to 4*ROWS of horizontal SignalBlocks.
-// Transpose separates the lanes within each 4x4 block,
+// Convert rows of vertical float4 frames at src to four horizontal rows each
+// at dest. Transpose separates the lanes within each 4x4 block,
 // then we deinterleave to collect each lane contiguously.
-template<size_t ROWS>
-inline SignalBlockArray<ROWS * 4> verticalToHorizontal(const SignalBlockArrayBase<float4, ROWS>& v)
+template<size_t FRAMES = kFramesPerBlock>
+inline void verticalToHorizontal(const float4* src, float* dest, size_t rows)
 {
-  SignalBlockArray<ROWS * 4> result;
-  
-  SignalBlockArrayBase<float4, ROWS> temp = v;
-  for (size_t r = 0; r < ROWS; ++r)
-  {
-    transposeRow(temp.rowPtr(r));
-  }
-  
-  constexpr size_t numBlocks = kFramesPerBlock / 4;
-  for (size_t r = 0; r < ROWS; ++r)
+#if defined(ML_SIMD_DISPATCH)
+  getDSPKernels().verticalToHorizontal(reinterpret_cast<const float*>(src), dest, rows, FRAMES);
+#else
+  constexpr size_t numBlocks = FRAMES / 4;
+  SignalBlockArrayBase<float4, 1, FRAMES> temp(uninitialized);
+  for (size_t r = 0; r < rows; ++r)
   {
+    std::copy(src + r * FRAMES, src + (r + 1) * FRAMES, temp.data());
+    transposeRow<FRAMES>(temp.data());
     for (size_t lane = 0; lane < 4; ++lane)
     {
-      float4* dest = reinterpret_cast<float4*>(result.rowPtr(r * 4 + lane));
-      const float4* src = reinterpret_cast<const float4*>(temp.rowPtr(r));
+      float4* laneDest = reinterpret_cast<float4*>(dest + (r * 4 + lane) * FRAMES);
       for (size_t block = 0; block < numBlocks; ++block)
       {
-        dest[block] = src[block * 4 + lane];
+        laneDest[block] = temp[block * 4 + lane];
       }
     }
   }
-  
-  return result;
+#endif
 }
 
+// Convert ROWS of vertical SignalBlock4 to 4*ROWS of horizontal SignalBlocks.
+template<size_t ROWS, size_t FRAMES>
+inline SignalBlockArrayOf<ROWS * 4, FRAMES> verticalToHorizontal(const SignalBlockArrayBase<float4, ROWS, FRAMES>& v)
+{
+  SignalBlockArrayOf<ROWS * 4, FRAMES> result(uninitialized);
+  verticalToHorizontal<FRAMES>(v.data(), result.data(), ROWS);
+  return result;
+}
 
-// Convert 4*ROWS of horizontal SignalBlocks to ROWS of vertical SignalBlock4.
-// Interleave the rows into blocks, then transpose to get back to the vertical layout.
-template<size_t ROWS>
-inline SignalBlockArrayBase<float4, ROWS> horizontalToVertical(const SignalBlockArray<ROWS * 4>& h)
+// Convert groups of four horizontal rows at src to one row of vertical float4
+// frames each at dest. Interleave the rows into blocks, then transpose to get
+// back to the vertical layout.
+template<size_t FRAMES = kFramesPerBlock>
+inline void horizontalToVertical(const float* src, float4* dest, size_t rows)
 {
-  SignalBlockArrayBase<float4, ROWS> temp;
-  constexpr size_t numBlocks = kFramesPerBlock / 4;
-  
-  for (size_t r = 0; r < ROWS; ++r)
+#if defined(ML_SIMD_DISPATCH)
+  getDSPKernels().horizontalToVertical(src, reinterpret_cast<float*>(dest), rows, FRAMES);
+#else
+  constexpr size_t numBlocks = FRAMES / 4;
+  for (size_t r = 0; r < rows; ++r)
   {
+    float4* rowDest = dest + r * FRAMES;
     for (size_t lane = 0; lane < 4; ++lane)
     {
-      const float4* src = reinterpret_cast<const float4*>(h.rowPtr(r * 4 + lane));
-      float4* dest = reinterpret_cast<float4*>(temp.rowPtr(r));
+      const float4* laneSrc = reinterpret_cast<const float4*>(src + (r * 4 + lane) * FRAMES);
       for (size_t block = 0; block < numBlocks; ++block)
       {
-        dest[block * 4 + lane] = src[block];
+        rowDest[block * 4 + lane] = laneSrc[block];
       }
     }
-    transposeRow(temp.rowPtr(r));
+    transposeRow<FRAMES>(rowDest);
   }
-  return temp;
+#endif
+}
+
+// Convert 4*ROWS of horizontal SignalBlocks to ROWS of vertical SignalBlock4.
+template<size_t ROWS, size_t FRAMES = kFramesPerBlock>
+inline SignalBlockArrayBase<float4, ROWS, FRAMES> horizontalToVertical(const SignalBlockArrayOf<ROWS * 4, FRAMES>& h)
+{
+  SignalBlockArrayBase<float4, ROWS, FRAMES> result(uninitialized);
+  horizontalToVertical<FRAMES>(h.data(), result.data(), ROWS);
+  return result;
 }
 
 // ----------------------------------------------------------------
 // SignalBlockDynamic: for holding a number of SignalBlocks only known at runtime.
 
-class SignalBlockDynamic final
+template<size_t FRAMES>
+class SignalBlockDynamicOf final
 {
-  std::vector<SignalBlock> data_;
+  std::vector<SignalBlockOf<FRAMES>> data_;
   
 public:
-  SignalBlockDynamic() = default;
-  ~SignalBlockDynamic() = default;
+  SignalBlockDynamicOf() = default;
+  ~SignalBlockDynamicOf() = default;
   
-  explicit SignalBlockDynamic(size_t rows) { data_.resize(rows); }
+  explicit SignalBlockDynamicOf(size_t rows) { data_.resize(rows); }
   void resize(size_t rows) { data_.resize(rows); }
   size_t size() const { return data_.size(); }
-  SignalBlock& operator[](int j) { return data_[j]; }
-  const SignalBlock& operator[](int j) const { return data_[j]; }
+  SignalBlockOf<FRAMES>& operator[](int j) { return data_[j]; }
+  const SignalBlockOf<FRAMES>& operator[](int j) const { return data_[j]; }
 };
 
+using SignalBlockDynamic = SignalBlockDynamicOf<kFramesPerBlock>;
+
+// ----------------------------------------------------------------
+// Whole-block operations.
+// The loops below run on floatN / intN, the widest SIMD vectors enabled for the
+// build, then finish any remainder smaller than one wide vector with float4.
+// The op expressions are generic lambdas so they compile for every vector type.
+// The operations themselves are listed in MLDSPOpList.h. In builds with runtime
+// dispatch (ML_SIMD_DISPATCH) each operation instead calls the kernel for the
+// best instruction set the CPU supports, see MLDSPDispatch.h.
 
 // ----------------------------------------------------------------
 // Unary operations, (float) -> float
 
 template<typename T, size_t N, typename OP_F2F>
 inline AlignedArray<T, N> OpF2F(const AlignedArray<T, N>& a, OP_F2F op) {
-  AlignedArray<T, N> result;
+  AlignedArray<T, N> result(uninitialized);
+  
+  const floatN* aw = reinterpret_cast<const floatN*>(a.data());
+  floatN* rw = reinterpret_cast<floatN*>(result.data());
+  for (size_t i = 0; i < numWideVectorsIn<T, N>(); ++i) {
+    rw[i] = op(aw[i]);
+  }
   
-  constexpr size_t numFloat4s = sizeof(AlignedArray<T, N>) / sizeof(float4);
   const float4* a4 = reinterpret_cast<const float4*>(a.data());
   float4* r4 = reinterpret_cast<float4*>(result.data());
-  
-  for (size_t i = 0; i < numFloat4s; ++i) {
+  for (size_t i = float4TailStart<T, N>(); i < numFloatsIn<T, N>() / 4; ++i) {
     r4[i] = op(a4[i]);
   }
   return result;
 }
 
+#if defined(ML_SIMD_DISPATCH)
 #define DEFINE_OP_F2F(name, expr) \
 template<typename T, size_t N> \
 inline AlignedArray<T, N> name(const AlignedArray<T, N>& a) { \
-return OpF2F(a, [](float4 x) { return (expr); }); \
+AlignedArray<T, N> result(uninitialized); \
+getDSPKernels().name(reinterpret_cast<const float*>(a.data()), \
+reinterpret_cast<float*>(result.data()), numFloatsIn<T, N>()); \
+return result; \
 }
+#else
+#define DEFINE_OP_F2F(name, expr) \
+template<typename T, size_t N> \
+inline AlignedArray<T, N> name(const AlignedArray<T, N>& a) { \
+return OpF2F(a, [](auto x) { return (expr); }); \
+}
+#endif
 
-DEFINE_OP_F2F(recipApprox, rcp(x))
-DEFINE_OP_F2F(sqrt, sqrt(x))
-DEFINE_OP_F2F(sqrtApprox, x * rsqrt(x))
-DEFINE_OP_F2F(abs, andNotBits(set1Float(-0.0f), x))
-
-// up/down sign: -1 or 1
-DEFINE_OP_F2F(sign, sign(x))
-
-// Trig, log and exp, using accurate cephes-derived library
-DEFINE_OP_F2F(sin, sin(x))
-DEFINE_OP_F2F(cos, cos(x))
-DEFINE_OP_F2F(log, log(x))
-DEFINE_OP_F2F(exp, exp(x))
-
-// Lazy log2 and exp2 from natural log / exp
-static const float4 kLogTwoVec{0.69314718055994529f};
-static const float4 kLogTwoRVec{1.4426950408889634f};
-DEFINE_OP_F2F(log2, log(x) * kLogTwoRVec)
-DEFINE_OP_F2F(exp2, exp(kLogTwoVec * x))
-
-// Trig, log and exp, using polynomial approximations
-DEFINE_OP_F2F(sinApprox, sinApprox(x))
-DEFINE_OP_F2F(cosApprox, cosApprox(x))
-DEFINE_OP_F2F(sigLogApprox, logApprox(x))
-DEFINE_OP_F2F(sigExpApprox, expApprox(x))
+// recipApprox, sqrt, sqrtApprox, abs, sign, sin, cos, tan, log, exp, log2, exp2,
+// sinApprox, cosApprox, tanApprox, sigLogApprox, sigExpApprox, log2Approx, exp2Approx,
+// sigTanhApprox, fractionalPart
+ML_DSP_OPS_F2F(DEFINE_OP_F2F)
 
-// Lazy log2 and exp2 approximations
-DEFINE_OP_F2F(log2Approx, logApprox(x) * kLogTwoRVec)
-DEFINE_OP_F2F(exp2Approx, expApprox(kLogTwoVec * x))
+#define DEFINE_OP_F2F_EXPR(name, expr) \
+template<typename A, typename = std::enable_if_t<hasBlockExprArg<A>()>> \
+inline auto name(const A& a) { return name(eval(a)); }
 
-// Cubic tanh approx
-DEFINE_OP_F2F(sigTanhApprox, tanhApprox(x))
+ML_DSP_OPS_F2F(DEFINE_OP_F2F_EXPR)
 
-// Fractional part
-DEFINE_OP_F2F(fractionalPart, x - intToFloat(floatToIntTruncate(x)))
+// sine and cosine together, using the cephes-derived sincos. Returns {sin, cos}.
+template<typename T, size_t N>
+inline std::pair<AlignedArray<T, N>, AlignedArray<T, N>> sincos(const AlignedArray<T, N>& a) {
+  std::pair<AlignedArray<T, N>, AlignedArray<T, N>> result;
+  
+#if defined(ML_SIMD_DISPATCH)
+  getDSPKernels().sincos(reinterpret_cast<const float*>(a.data()),
+                         reinterpret_cast<float*>(result.first.data()),
+                         reinterpret_cast<float*>(result.second.data()), numFloatsIn<T, N>());
+#else
+  const floatN* aw = reinterpret_cast<const floatN*>(a.data());
+  floatN* sw = reinterpret_cast<floatN*>(result.first.data());
+  floatN* cw = reinterpret_cast<floatN*>(result.second.data());
+  for (size_t i = 0; i < numWideVectorsIn<T, N>(); ++i) {
+    auto sc = sincos(aw[i]);
+    sw[i] = sc.first;
+    cw[i] = sc.second;
+  }
+  
+  const float4* a4 = reinterpret_cast<const float4*>(a.data());
+  float4* s4 = reinterpret_cast<float4*>(result.first.data());
+  float4* c4 = reinterpret_cast<float4*>(result.second.data());
+  for (size_t i = float4TailStart<T, N>(); i < numFloatsIn<T, N>() / 4; ++i) {
+    auto sc = sincos(a4[i]);
+    s4[i] = sc.first;
+    c4[i] = sc.second;
+  }
+#endif
+  return result;
+}
 
 // ----------------------------------------------------------------
 // Binary operations, (float, float) -> float
 
 template<typename T, size_t N, typename OP_FF2F>
 inline AlignedArray<T, N> OpFF2F(const AlignedArray<T, N>& a, const AlignedArray<T, N>& b, OP_FF2F op) {
-  AlignedArray<T, N> result;
+  AlignedArray<T, N> result(uninitialized);
+  
+  const floatN* aw = reinterpret_cast<const floatN*>(a.data());
+  const floatN* bw = reinterpret_cast<const floatN*>(b.data());
+  floatN* rw = reinterpret_cast<floatN*>(result.data());
+  for (size_t i = 0; i < numWideVectorsIn<T, N>(); ++i) {
+    rw[i] = op(aw[i], bw[i]);
+  }
   
-  constexpr size_t numFloat4s = sizeof(AlignedArray<T, N>) / sizeof(float4);
   const float4* a4 = reinterpret_cast<const float4*>(a.data());
   const float4* b4 = reinterpret_cast<const float4*>(b.data());
   float4* r4 = reinterpret_cast<float4*>(result.data());
-  
-  for (size_t i = 0; i < numFloat4s; ++i) {
+  for (size_t i = float4TailStart<T, N>(); i < numFloatsIn<T, N>() / 4; ++i) {
     r4[i] = op(a4[i], b4[i]);
   }
   return result;
 }
 
+#if defined(ML_SIMD_DISPATCH)
+#define DEFINE_OP_FF2F(name, expr) \
+template<typename T, size_t N> \
+inline AlignedArray<T, N> name(const AlignedArray<T, N>& a, const AlignedArray<T, N>& b) { \
+AlignedArray<T, N> result(uninitialized); \
+getDSPKernels().name(reinterpret_cast<const float*>(a.data()), reinterpret_cast<const float*>(b.data()), \
+reinterpret_cast<float*>(result.data()), numFloatsIn<T, N>()); \
+return result; \
+}
+#else
 #define DEFINE_OP_FF2F(name, expr) \
 template<typename T, size_t N> \
 inline AlignedArray<T, N> name(const AlignedArray<T, N>& a, const AlignedArray<T, N>& b) { \
-return OpFF2F(a, b, [](float4 x, float4 y) { return (expr); }); \
+return OpFF2F(a, b, [](auto x, auto y) { return (expr); }); \
 }
+#endif
 
-DEFINE_OP_FF2F(add, x + y)
-DEFINE_OP_FF2F(subtract, x - y)
-DEFINE_OP_FF2F(multiply, x * y)
-DEFINE_OP_FF2F(divide, x / y)
+// add, subtract, multiply, divide, divideApprox, pow, powApprox, min, max,
+// equal, notEqual, greaterThan, greaterThanOrEqual, lessThan, lessThanOrEqual
+ML_DSP_OPS_FF2F(DEFINE_OP_FF2F)
 
-DEFINE_OP_FF2F(divideApprox, x * rcp(y))
-DEFINE_OP_FF2F(pow, exp(log(x) * y))
-DEFINE_OP_FF2F(powApprox, expApprox(logApprox(x) * y))
-DEFINE_OP_FF2F(min, min(x, y))
-DEFINE_OP_FF2F(max, max(x, y))
+#define DEFINE_OP_FF2F_EXPR(name, expr) \
+template<typename A, typename B, typename = std::enable_if_t<hasBlockExprArg<A, B>()>> \
+inline auto name(const A& a, const B& b) { return name(eval(a), eval(b)); }
 
-DEFINE_OP_FF2F(equal, operator==(x, y))
-DEFINE_OP_FF2F(notEqual, operator!=(x, y))
-DEFINE_OP_FF2F(greaterThan, operator>(x, y))
-DEFINE_OP_FF2F(greaterThanOrEqual, operator>=(x, y))
-DEFINE_OP_FF2F(lessThan, operator<(x, y))
-DEFINE_OP_FF2F(lessThanOrEqual, operator<=(x, y))
+ML_DSP_OPS_FF2F(DEFINE_OP_FF2F_EXPR)
 
 // ----------------------------------------------------------------
 // Ternary operation, (float, float, float) -> float
@@ -511,69 +1002,107 @@ DEFINE_OP_FF2F(lessThanOrEqual, operator<=(x, y))
 template<typename T, size_t N, typename OP_FFF2F>
 inline AlignedArray<T, N> OpFFF2F(const AlignedArray<T, N>& a, const AlignedArray<T, N>& b,
                                   const AlignedArray<T, N>& c, OP_FFF2F op) {
-  AlignedArray<T, N> result;
+  AlignedArray<T, N> result(uninitialized);
+  
+  const floatN* aw = reinterpret_cast<const floatN*>(a.data());
+  const floatN* bw = reinterpret_cast<const floatN*>(b.data());
+  const floatN* cw = reinterpret_cast<const floatN*>(c.data());
+  floatN* rw = reinterpret_cast<floatN*>(result.data());
+  for (size_t i = 0; i < numWideVectorsIn<T, N>(); ++i) {
+    rw[i] = op(aw[i], bw[i], cw[i]);
+  }
   
-  constexpr size_t numFloat4s = sizeof(AlignedArray<T, N>) / sizeof(float4);
   const float4* a4 = reinterpret_cast<const float4*>(a.data());
   const float4* b4 = reinterpret_cast<const float4*>(b.data());
   const float4* c4 = reinterpret_cast<const float4*>(c.data());
   float4* r4 = reinterpret_cast<float4*>(result.data());
-  
-  for (size_t i = 0; i < numFloat4s; ++i) {
+  for (size_t i = float4TailStart<T, N>(); i < numFloatsIn<T, N>() / 4; ++i) {
     r4[i] = op(a4[i], b4[i], c4[i]);
   }
   return result;
 }
 
+#if defined(ML_SIMD_DISPATCH)
 #define DEFINE_OP_FFF2F(name, expr) \
 template<typename T, size_t N> \
 inline AlignedArray<T, N> name(const AlignedArray<T, N>& a, const AlignedArray<T, N>& b, \
 const AlignedArray<T, N>& c) { \
-return OpFFF2F(a, b, c, [](float4 x, float4 y, float4 z) { return (expr); }); \
+AlignedArray<T, N> result(uninitialized); \
+getDSPKernels().name(reinterpret_cast<const float*>(a.data()), reinterpret_cast<const float*>(b.data()), \
+reinterpret_cast<const float*>(c.data()), reinterpret_cast<float*>(result.data()), \
+numFloatsIn<T, N>()); \
+return result; \
 }
+#else
+#define DEFINE_OP_FFF2F(name, expr) \
+template<typename T, size_t N> \
+inline AlignedArray<T, N> name(const AlignedArray<T, N>& a, const AlignedArray<T, N>& b, \
+const AlignedArray<T, N>& c) { \
+return OpFFF2F(a, b, c, [](auto x, auto y, auto z) { return (expr); }); \
+}
+#endif
 
-DEFINE_OP_FFF2F(lerp, lerp(x, y, z))        // x = lerp(a, b, mix)
-DEFINE_OP_FFF2F(inverseLerp, (z - x) / (y - x)) // mix = inverseLerp(a, b, x)
-DEFINE_OP_FFF2F(clamp, min(max(x, y), z))       // clamp(x, minBound, maxBound)
-DEFINE_OP_FFF2F(within, andBits((x >= y), (x < z))) // is x in [y, z)?
-DEFINE_OP_FFF2F(select, select(x, y, z))  // select(resultIfTrue, resultIfFalse, conditionMask)
+// lerp, inverseLerp, clamp, within, select
+ML_DSP_OPS_FFF2F(DEFINE_OP_FFF2F)
+
+#define DEFINE_OP_FFF2F_EXPR(name, expr) \
+template<typename A, typename B, typename C, typename = std::enable_if_t<hasBlockExprArg<A, B, C>()>> \
+inline auto name(const A& a, const B& b, const C& c) { return name(eval(a), eval(b), eval(c)); }
+
+ML_DSP_OPS_FFF2F(DEFINE_OP_FFF2F_EXPR)
 
 // ----------------------------------------------------------------
 // Binary operation, (int32, int32) -> int32
 
 template<typename T, size_t N, typename OP_II2I>
 inline AlignedArray<T, N> OpII2I(const AlignedArray<T, N>& a, const AlignedArray<T, N>& b, OP_II2I op) {
-  AlignedArray<T, N> result;
+  AlignedArray<T, N> result(uninitialized);
+  
+  const intN* aw = reinterpret_cast<const intN*>(a.data());
+  const intN* bw = reinterpret_cast<const intN*>(b.data());
+  intN* rw = reinterpret_cast<intN*>(result.data());
+  for (size_t i = 0; i < numWideVectorsIn<T, N>(); ++i) {
+    rw[i] = op(aw[i], bw[i]);
+  }
   
-  constexpr size_t numInt4s = sizeof(AlignedArray<T, N>) / sizeof(int4);
   const int4* a4 = reinterpret_cast<const int4*>(a.data());
   const int4* b4 = reinterpret_cast<const int4*>(b.data());
   int4* r4 = reinterpret_cast<int4*>(result.data());
-  
-  for (size_t i = 0; i < numInt4s; ++i) {
+  for (size_t i = float4TailStart<T, N>(); i < numFloatsIn<T, N>() / 4; ++i) {
     r4[i] = op(a4[i], b4[i]);
   }
   return result;
 }
 
+#if defined(ML_SIMD_DISPATCH)
 #define DEFINE_OP_II2I(name, expr) \
 template<typename T, size_t N> \
 inline AlignedArray<T, N> name(const AlignedArray<T, N>& a, const AlignedArray<T, N>& b) { \
-return OpII2I(a, b, [](int4 x, int4 y) { return (expr); }); \
+AlignedArray<T, N> result(uninitialized); \
+getDSPKernels().name(reinterpret_cast<const int32_t*>(a.data()), reinterpret_cast<const int32_t*>(b.data()), \
+reinterpret_cast<int32_t*>(result.data()), numFloatsIn<T, N>()); \
+return result; \
 }
+#else
+#define DEFINE_OP_II2I(name, expr) \
+template<typename T, size_t N> \
+inline AlignedArray<T, N> name(const AlignedArray<T, N>& a, const AlignedArray<T, N>& b) { \
+return OpII2I(a, b, [](auto x, auto y) { return (expr); }); \
+}
+#endif
 
-DEFINE_OP_II2I(addInt32, x + y)
-DEFINE_OP_II2I(subtractInt32, x - y)
+// addInt32, subtractInt32
+ML_DSP_OPS_II2I(DEFINE_OP_II2I)
 
 // ----------------------------------------------------------------
 // Binary operation (T, T) -> T
 // Multiple-row and single-row operands
 
-template<typename T, size_t ROWS, typename OP>
-inline SignalBlockArrayBase<T, ROWS> OpFF2F_MS(const SignalBlockArrayBase<T, ROWS>& a,
-                                        const SignalBlockArrayBase<T, 1>& b,
+template<typename T, size_t ROWS, size_t FRAMES, typename OP>
+inline SignalBlockArrayBase<T, ROWS, FRAMES> OpFF2F_MS(const SignalBlockArrayBase<T, ROWS, FRAMES>& a,
+                                        const SignalBlockArrayBase<T, 1, FRAMES>& b,
                                         OP op) {
-  SignalBlockArrayBase<T, ROWS> result;
+  SignalBlockArrayBase<T, ROWS, FRAMES> result(uninitialized);
   
   for (size_t row = 0; row < ROWS; ++row) {
     result.setRow(row, OpFF2F(a.getRow(row), b, op));
@@ -582,22 +1111,33 @@ inline SignalBlockArrayBase<T, ROWS> OpFF2F_MS(const SignalBlockArrayBase<T, ROW
   return result;
 }
 
+#if defined(ML_SIMD_DISPATCH)
 #define DEFINE_OP_FF2F_MS(name, expr) \
-template<typename T, size_t ROWS> \
-inline SignalBlockArrayBase<T, ROWS> name(const SignalBlockArrayBase<T, ROWS>& a, \
-const SignalBlockArrayBase<T, 1>& b) { \
-return OpFF2F_MS(a, b, [](float4 x, float4 y) { return (expr); }); \
+template<typename T, size_t ROWS, size_t FRAMES> \
+inline SignalBlockArrayBase<T, ROWS, FRAMES> name(const SignalBlockArrayBase<T, ROWS, FRAMES>& a, \
+const SignalBlockArrayBase<T, 1, FRAMES>& b) { \
+SignalBlockArrayBase<T, ROWS, FRAMES> result(uninitialized); \
+getDSPKernels().name(reinterpret_cast<const float*>(a.data()), reinterpret_cast<const float*>(b.data()), \
+reinterpret_cast<float*>(result.data()), ROWS, numFloatsIn<T, FRAMES>()); \
+return result; \
 }
+#else
+#define DEFINE_OP_FF2F_MS(name, expr) \
+template<typename T, size_t ROWS, size_t FRAMES> \
+inline SignalBlockArrayBase<T, ROWS, FRAMES> name(const SignalBlockArrayBase<T, ROWS, FRAMES>& a, \
+const SignalBlockArrayBase<T, 1, FRAMES>& b) { \
+return OpFF2F_MS(a, b, [](auto x, auto y) { return (expr); }); \
+}
+#endif
+
+// add1, subtract1, multiply1, divide1, divideApprox1, pow1, powApprox1, min1, max1
+ML_DSP_OPS_FF2F_MS(DEFINE_OP_FF2F_MS)
 
-DEFINE_OP_FF2F_MS(add1, x + y)
-DEFINE_OP_FF2F_MS(subtract1, x - y)
-DEFINE_OP_FF2F_MS(multiply1, x * y)
-DEFINE_OP_FF2F_MS(divide1, x / y)
-DEFINE_OP_FF2F_MS(divideApprox1, x * rcp(y))
-DEFINE_OP_FF2F_MS(pow1, exp(log(x) * y))
-DEFINE_OP_FF2F_MS(powApprox1, expApprox(logApprox(x) * y))
-DEFINE_OP_FF2F_MS(min1, min(x, y))
-DEFINE_OP_FF2F_MS(max1, max(x, y))
+#define DEFINE_OP_FF2F_MS_EXPR(name, expr) \
+template<typename A, typename B, typename = std::enable_if_t<hasBlockExprArg<A, B>()>> \
+inline auto name(const A& a, const B& b) { return name(eval(a), eval(b)); }
+
+ML_DSP_OPS_FF2F_MS(DEFINE_OP_FF2F_MS_EXPR)
 
 
 // ----------------------------------------------------------------
@@ -605,26 +1145,42 @@ DEFINE_OP_FF2F_MS(max1, max(x, y))
 
 template<typename T, size_t N, typename OP_F2I>
 inline AlignedArray<int32_t, N> OpF2I(const AlignedArray<T, N>& a, OP_F2I op) {
-  AlignedArray<int32_t, N> result;
+  AlignedArray<int32_t, N> result(uninitialized);
+  
+  const floatN* aw = reinterpret_cast<const floatN*>(a.data());
+  intN* rw = reinterpret_cast<intN*>(result.data());
+  for (size_t i = 0; i < numWideVectorsIn<T, N>(); ++i) {
+    rw[i] = op(aw[i]);
+  }
   
-  constexpr size_t numFloat4s = sizeof(AlignedArray<T, N>) / sizeof(float4);
   const float4* a4 = reinterpret_cast<const float4*>(a.data());
   int4* r4 = reinterpret_cast<int4*>(result.data());
-  
-  for (size_t i = 0; i < numFloat4s; ++i) {
+  for (size_t i = float4TailStart<T, N>(); i < numFloatsIn<T, N>() / 4; ++i) {
     r4[i] = op(a4[i]);
   }
   return result;
 }
 
+#if defined(ML_SIMD_DISPATCH)
 #define DEFINE_OP_F2I(name, expr) \
 template<typename T, size_t N> \
 inline AlignedArray<int32_t, N> name(const AlignedArray<T, N>& a) { \
-return OpF2I(a, [](float4 x) { return (expr); }); \
+AlignedArray<int32_t, N> result(uninitialized); \
+getDSPKernels().name(reinterpret_cast<const float*>(a.data()), result.data(), numFloatsIn<T, N>()); \
+return result; \
 }
+#else
+#define DEFINE_OP_F2I(name, expr) \
+template<typename T, size_t N> \
+inline AlignedArray<int32_t, N> name(const AlignedArray<T, N>& a) { \
+return OpF2I(a, [](auto x) { return (expr); }); \
+}
+#endif
+
+// roundFloatToInt, truncateFloatToInt
+ML_DSP_OPS_F2I(DEFINE_OP_F2I)
 
-DEFINE_OP_F2I(roundFloatToInt, floatToIntRound(x))
-DEFINE_OP_F2I(truncateFloatToInt, floatToIntTruncate(x))
+ML_DSP_OPS_F2I(DEFINE_OP_F2F_EXPR)
 
 
 // ----------------------------------------------------------------
@@ -632,97 +1188,284 @@ DEFINE_OP_F2I(truncateFloatToInt, floatToIntTruncate(x))
 
 template<typename T, size_t N, typename OP_I2F>
 inline AlignedArray<float, N> OpI2F(const AlignedArray<T, N>& a, OP_I2F op) {
-  AlignedArray<float, N> result;
+  AlignedArray<float, N> result(uninitialized);
+  
+  const intN* aw = reinterpret_cast<const intN*>(a.data());
+  floatN* rw = reinterpret_cast<floatN*>(result.data());
+  for (size_t i = 0; i < numWideVectorsIn<T, N>(); ++i) {
+    rw[i] = op(aw[i]);
+  }
   
-  constexpr size_t numInt4s = sizeof(AlignedArray<T, N>) / sizeof(int4);
   const int4* a4 = reinterpret_cast<const int4*>(a.data());
   float4* r4 = reinterpret_cast<float4*>(result.data());
-  
-  for (size_t i = 0; i < numInt4s; ++i) {
+  for (size_t i = float4TailStart<T, N>(); i < numFloatsIn<T, N>() / 4; ++i) {
     r4[i] = op(a4[i]);
   }
   return result;
 }
 
+#if defined(ML_SIMD_DISPATCH)
 #define DEFINE_OP_I2F(name, expr) \
 template<typename T, size_t N> \
 inline AlignedArray<float, N> name(const AlignedArray<T, N>& a) { \
-return OpI2F(a, [](int4 x) { return (expr); }); \
+AlignedArray<float, N> result(uninitialized); \
+getDSPKernels().name(reinterpret_cast<const int32_t*>(a.data()), result.data(), numFloatsIn<T, N>()); \
+return result; \
 }
+#else
+#define DEFINE_OP_I2F(name, expr) \
+template<typename T, size_t N> \
+inline AlignedArray<float, N> name(const AlignedArray<T, N>& a) { \
+return OpI2F(a, [](auto x) { return (expr); }); \
+}
+#endif
 
-DEFINE_OP_I2F(intToFloat, intToFloat(x))
-DEFINE_OP_I2F(unsignedIntToFloat, unsignedIntToFloat(x))
+// intToFloat, unsignedIntToFloat
+ML_DSP_OPS_I2F(DEFINE_OP_I2F)
 
 
 // ----------------------------------------------------------------
 // load and store
+// These are plain copies and are not dispatched: the C library's memcpy already
+// chooses its own instruction set at runtime.
 
-template <size_t ROWS>
-inline void load(SignalBlockArray<ROWS>& vecDest, const float* pSrc)
+template <size_t ROWS, size_t FRAMES>
+inline void load(SignalBlockArrayOf<ROWS, FRAMES>& vecDest, const float* pSrc)
 {
-  std::copy(pSrc, pSrc + ROWS * kFramesPerBlock, vecDest.data());
+  std::copy(pSrc, pSrc + ROWS * FRAMES, vecDest.data());
 }
 
-template <size_t ROWS>
-inline void store(const SignalBlockArray<ROWS>& vecSrc, float* pDest)
+template <size_t ROWS, size_t FRAMES>
+inline void store(const SignalBlockArrayOf<ROWS, FRAMES>& vecSrc, float* pDest)
 {
-  std::copy(vecSrc.data(), vecSrc.data() + ROWS * kFramesPerBlock, pDest);
+  std::copy(vecSrc.data(), vecSrc.data() + ROWS * FRAMES, pDest);
 }
 
 // ----------------------------------------------------------------
 // single-vector horizontal operators returning float
 
-inline float sum(const SignalBlock& x)
+template<size_t FRAMES>
+inline float sum(const SignalBlockOf<FRAMES>& x)
 {
   const float4* x4 = reinterpret_cast<const float4*>(x.data());
   float sum = 0;
-  for (size_t i = 0; i < kFramesPerBlock / 4; ++i)
+  for (size_t i = 0; i < FRAMES / 4; ++i)
   {
     sum += vecSumH(x4[i]);
   }
   return sum;
 }
 
-inline float mean(const SignalBlock& x)
+template<size_t FRAMES>
+inline float mean(const SignalBlockOf<FRAMES>& x)
 {
-  const float4* x4 = reinterpret_cast<const float4*>(x.data());
-  float sum = 0;
-  for (size_t i = 0; i < kFramesPerBlock / 4; ++i)
-  {
-    sum += vecSumH(x4[i]);
-  }
-  return sum / kFramesPerBlock;
+  return sum(x) / FRAMES;
 }
 
-inline float max(const SignalBlock& x)
+template<size_t FRAMES>
+inline float max(const SignalBlockOf<FRAMES>& x)
 {
   const float4* x4 = reinterpret_cast<const float4*>(x.data());
   float fmax = FLT_MIN;
-  for (size_t i = 0; i < kFramesPerBlock / 4; ++i)
+  for (size_t i = 0; i < FRAMES / 4; ++i)
   {
     fmax = std::max(fmax, vecMaxH(x4[i]));
   }
   return fmax;
 }
 
-inline float min(const SignalBlock& x)
+template<size_t FRAMES>
+inline float min(const SignalBlockOf<FRAMES>& x)
 {
   const float4* x4 = reinterpret_cast<const float4*>(x.data());
   float fmin = FLT_MAX;
-  for (size_t i = 0; i < kFramesPerBlock / 4; ++i)
+  for (size_t i = 0; i < FRAMES / 4; ++i)
   {
     fmin = std::min(fmin, vecMinH(x4[i]));
   }
   return fmin;
 }
 
+// Non-template versions for the default block size, so that arguments
+// converting to SignalBlock, such as expressions, are accepted.
+inline float sum(const SignalBlock& x) { return sum<kFramesPerBlock>(x); }
+inline float mean(const SignalBlock& x) { return mean<kFramesPerBlock>(x); }
+inline float max(const SignalBlock& x) { return max<kFramesPerBlock>(x); }
+inline float min(const SignalBlock& x) { return min<kFramesPerBlock>(x); }
+
+// ----------------------------------------------------------------
+// scans
+//
+// Running sums along a block. Each scan takes the last output of the previous
+// block in carry and updates it, so that successive blocks make one
+// continuous signal. Blocks of float run four frames at a time: a log-step
+// shuffle scan within each float4, then one add to carry the total across
+// float4s. In a block of float4 each frame already holds four separate
+// signals, so those scans loop over frames.
+
+// inclusive: y[n] = carry + x[0] + ... + x[n]. carry becomes y[FRAMES - 1].
+template<typename T, size_t FRAMES>
+inline SignalBlockArrayBase<T, 1, FRAMES> inclusiveScan(const SignalBlockArrayBase<T, 1, FRAMES>& x, T& carry)
+{
+  SignalBlockArrayBase<T, 1, FRAMES> y(uninitialized);
+  if constexpr (std::is_same_v<T, float>)
+  {
+    const float4* x4 = reinterpret_cast<const float4*>(x.data());
+    float4* y4 = reinterpret_cast<float4*>(y.data());
+    float4 c(carry);
+    for (size_t i = 0; i < FRAMES / 4; ++i)
+    {
+      y4[i] = prefixSum(x4[i]) + c;
+      c = broadcastLane3(y4[i]);
+    }
+    carry = extractScalar(c);
+  }
+  else
+  {
+    for (size_t n = 0; n < FRAMES; ++n)
+    {
+      carry += x[n];
+      y[n] = carry;
+    }
+  }
+  return y;
+}
+
+// exclusive: y[n] = carry + x[0] + ... + x[n - 1]. carry becomes the sum
+// through x[FRAMES - 1], ready for the next block.
+template<typename T, size_t FRAMES>
+inline SignalBlockArrayBase<T, 1, FRAMES> exclusiveScan(const SignalBlockArrayBase<T, 1, FRAMES>& x, T& carry)
+{
+  SignalBlockArrayBase<T, 1, FRAMES> y(uninitialized);
+  if constexpr (std::is_same_v<T, float>)
+  {
+    const float4* x4 = reinterpret_cast<const float4*>(x.data());
+    float4* y4 = reinterpret_cast<float4*>(y.data());
+    float4 c(carry);
+    for (size_t i = 0; i < FRAMES / 4; ++i)
+    {
+      float4 s = prefixSum(x4[i]);
+      y4[i] = shiftLanesUp1(s) + c;
+      c += broadcastLane3(s);
+    }
+    carry = extractScalar(c);
+  }
+  else
+  {
+    for (size_t n = 0; n < FRAMES; ++n)
+    {
+      y[n] = carry;
+      carry += x[n];
+    }
+  }
+  return y;
+}
+
+// leaky: y[n] = a * y[n - 1] + x[n], with y[-1] = carry. The coefficient a
+// is constant over the block. carry becomes y[FRAMES - 1].
+template<typename T, size_t FRAMES>
+inline SignalBlockArrayBase<T, 1, FRAMES> leakyScan(const SignalBlockArrayBase<T, 1, FRAMES>& x, T a, T& carry)
+{
+  SignalBlockArrayBase<T, 1, FRAMES> y(uninitialized);
+  if constexpr (std::is_same_v<T, float>)
+  {
+    // within a float4, sum the inputs weighted by powers of a in two steps,
+    // then add the carry times (a, a^2, a^3, a^4).
+    const float4 a1(a);
+    const float4 a2(a * a);
+    const float4 carryGains(a, a * a, a * a * a, a * a * a * a);
+    const float4* x4 = reinterpret_cast<const float4*>(x.data());
+    float4* y4 = reinterpret_cast<float4*>(y.data());
+    float4 c(carry);
+    for (size_t i = 0; i < FRAMES / 4; ++i)
+    {
+      float4 v = x4[i];
+      v += shiftLanesUp1(v) * a1;
+      v += shiftLanesUp2(v) * a2;
+      y4[i] = multiplyAdd(c, carryGains, v);
+      c = broadcastLane3(y4[i]);
+    }
+    carry = extractScalar(c);
+  }
+  else
+  {
+    for (size_t n = 0; n < FRAMES; ++n)
+    {
+      carry = a * carry + x[n];
+      y[n] = carry;
+    }
+  }
+  return y;
+}
+
+// wrapping: y[n] = fracPart(y[n - 1] + x[n]), with y[-1] = carry. This is a
+// phase accumulator, for carry in [0, 1) and increments x that are not
+// negative. carry becomes y[FRAMES - 1].
+template<typename T, size_t FRAMES>
+inline SignalBlockArrayBase<T, 1, FRAMES> wrappingScan(const SignalBlockArrayBase<T, 1, FRAMES>& x, T& carry)
+{
+  SignalBlockArrayBase<T, 1, FRAMES> y(uninitialized);
+  if constexpr (std::is_same_v<T, float>)
+  {
+    // wrapping once per float4 keeps the partial sums small, so the
+    // precision stays close to that of wrapping every frame.
+    const float4* x4 = reinterpret_cast<const float4*>(x.data());
+    float4* y4 = reinterpret_cast<float4*>(y.data());
+    float4 c(carry);
+    for (size_t i = 0; i < FRAMES / 4; ++i)
+    {
+      y4[i] = fracPart(prefixSum(x4[i]) + c);
+      c = broadcastLane3(y4[i]);
+    }
+    carry = extractScalar(c);
+  }
+  else
+  {
+    for (size_t n = 0; n < FRAMES; ++n)
+    {
+      carry = fracPart(carry + x[n]);
+      y[n] = carry;
+    }
+  }
+  return y;
+}
+
+// differences, the inverse of inclusiveScan: y[n] = x[n] - x[n - 1], with
+// x[-1] = carry. carry becomes x[FRAMES - 1].
+template<typename T, size_t FRAMES>
+inline SignalBlockArrayBase<T, 1, FRAMES> differences(const SignalBlockArrayBase<T, 1, FRAMES>& x, T& carry)
+{
+  SignalBlockArrayBase<T, 1, FRAMES> y(uninitialized);
+  if constexpr (std::is_same_v<T, float>)
+  {
+    const float4* x4 = reinterpret_cast<const float4*>(x.data());
+    float4* y4 = reinterpret_cast<float4*>(y.data());
+    float4 prev(carry);
+    for (size_t i = 0; i < FRAMES / 4; ++i)
+    {
+      y4[i] = x4[i] - vecShuffleRight(prev, x4[i]);
+      prev = x4[i];
+    }
+    carry = x[FRAMES - 1];
+  }
+  else
+  {
+    for (size_t n = 0; n < FRAMES; ++n)
+    {
+      y[n] = x[n] - carry;
+      carry = x[n];
+    }
+  }
+  return y;
+}
+
 // ----------------------------------------------------------------
 // normalize each row
 
-template <size_t ROWS>
-inline SignalBlockArray<ROWS> normalize(const SignalBlockArray<ROWS>& x)
+template <size_t ROWS, size_t FRAMES>
+inline SignalBlockArrayOf<ROWS, FRAMES> normalize(const SignalBlockArrayOf<ROWS, FRAMES>& x)
 {
-  SignalBlockArray<ROWS> result;
+  SignalBlockArrayOf<ROWS, FRAMES> result(uninitialized);
   for (size_t j = 0; j < ROWS; ++j)
   {
     auto inputRow = x.getRow(j);
@@ -736,10 +1479,10 @@ inline SignalBlockArray<ROWS> normalize(const SignalBlockArray<ROWS>& x)
 
 // Given an input SignalBlockArray with N rows repeat all its rows of M times
 // to make a M*N row SignalBlockArray.
-template <size_t M, size_t N>
-inline SignalBlockArray<M * N> repeatRows(const SignalBlockArray<N>& x)
+template <size_t M, size_t N, size_t FRAMES>
+inline SignalBlockArrayOf<M * N, FRAMES> repeatRows(const SignalBlockArrayOf<N, FRAMES>& x)
 {
-  SignalBlockArray<M * N> result;
+  SignalBlockArrayOf<M * N, FRAMES> result(uninitialized);
   for (size_t j = 0, k = 0; j < M * N; ++j)
   {
     result.setRow(j, x.getRow(k));
@@ -751,10 +1494,10 @@ inline SignalBlockArray<M * N> repeatRows(const SignalBlockArray<N>& x)
 // for the given ROWS and given an input SignalBlockArray x with N rows,
 // stretch x by repeating rows as necessary to make an output SignalBlockArray
 // with ROWS rows.
-template <size_t ROWS, size_t N>
-inline SignalBlockArray<ROWS> stretchRows(const SignalBlockArray<N>& x)
+template <size_t ROWS, size_t N, size_t FRAMES>
+inline SignalBlockArrayOf<ROWS, FRAMES> stretchRows(const SignalBlockArrayOf<N, FRAMES>& x)
 {
-  SignalBlockArray<ROWS> result;
+  SignalBlockArrayOf<ROWS, FRAMES> result(uninitialized);
   for (size_t j = 0; j < ROWS; ++j)
   {
     size_t k = roundf((j * (N - 1.f)) / (ROWS - 1.f));
@@ -766,11 +1509,10 @@ inline SignalBlockArray<ROWS> stretchRows(const SignalBlockArray<N>& x)
 // for the given ROWS and given an input SignalBlockArray x with N rows,
 // fill an output array by copying rows of the input, then adding rows of zeros as
 // necessary.
-template <size_t ROWS, size_t N>
-inline SignalBlockArray<ROWS> zeroPadRows(const SignalBlockArray<N>& x)
+template <size_t ROWS, size_t N, size_t FRAMES>
+inline SignalBlockArrayOf<ROWS, FRAMES> zeroPadRows(const SignalBlockArrayOf<N, FRAMES>& x)
 {
-  // default constructor currently zero-fills
-  SignalBlockArray<ROWS> result;
+  SignalBlockArrayOf<ROWS, FRAMES> result(0.f);
   constexpr size_t rowsToCopy = (ROWS < N) ? ROWS : N;
   for (size_t j = 0; j < rowsToCopy; ++j)
   {
@@ -782,10 +1524,10 @@ inline SignalBlockArray<ROWS> zeroPadRows(const SignalBlockArray<N>& x)
 // Shift the array down by the number of rows given in rowsToShift.
 // Any rows shifted in from outside the range [0, ROWS) are zeroed. Negative
 // shifts are OK.
-template <size_t ROWS>
-inline SignalBlockArray<ROWS> shiftRows(const SignalBlockArray<ROWS>& x, int rowsToShift)
+template <size_t ROWS, size_t FRAMES>
+inline SignalBlockArrayOf<ROWS, FRAMES> shiftRows(const SignalBlockArrayOf<ROWS, FRAMES>& x, int rowsToShift)
 {
-  SignalBlockArray<ROWS> result;
+  SignalBlockArrayOf<ROWS, FRAMES> result(uninitialized);
   int k = -rowsToShift;
   for (size_t j = 0; j < ROWS; ++j)
   {
@@ -795,7 +1537,7 @@ inline SignalBlockArray<ROWS> shiftRows(const SignalBlockArray<ROWS>& x, int row
     }
     else
     {
-      result.setRow(j, SignalBlock(0.f));
+      result.setRow(j, SignalBlockOf<FRAMES>(0.f));
     }
     ++k;
   }
@@ -805,13 +1547,13 @@ inline SignalBlockArray<ROWS> shiftRows(const SignalBlockArray<ROWS>& x, int row
 // Rotate the array down by the number of rows given in rowsToRotate.
 // Any rows rotated in from outside the range [0, ROWS) are wrapped. Negative
 // rotations are OK.
-template <size_t ROWS>
-inline SignalBlockArray<ROWS> rotateRows(const SignalBlockArray<ROWS>& x, int rowsToRotate)
+template <size_t ROWS, size_t FRAMES>
+inline SignalBlockArrayOf<ROWS, FRAMES> rotateRows(const SignalBlockArrayOf<ROWS, FRAMES>& x, int rowsToRotate)
 {
   // modulo for positive and negative integers
   auto modulo = [&](int a, int b) { return a >= 0 ? (a % b) : (b - std::abs(a % b)) % b; };
 
-  SignalBlockArray<ROWS> result;
+  SignalBlockArrayOf<ROWS, FRAMES> result(uninitialized);
   
   // get start index k to which row 0 is mapped
   int k = modulo(-rowsToRotate, ROWS);
@@ -828,10 +1570,10 @@ inline SignalBlockArray<ROWS> rotateRows(const SignalBlockArray<ROWS>& x, int ro
 // row-wise combining
 
 // Variadic concatRows - concatenate any number of SignalBlockArrays
-template<size_t... Ns>
-inline SignalBlockArray<(Ns + ...)> concatRows(const SignalBlockArray<Ns>&... arrays)
+template<size_t FRAMES, size_t... Ns>
+inline SignalBlockArrayOf<(Ns + ...), FRAMES> concatRows(const SignalBlockArrayOf<Ns, FRAMES>&... arrays)
 {
-  SignalBlockArray<(Ns + ...)> result;
+  SignalBlockArrayOf<(Ns + ...), FRAMES> result(uninitialized);
   size_t offset = 0;
   
   auto copyArray = [&](const auto& arr, size_t rowCount) {
@@ -849,27 +1591,27 @@ inline SignalBlockArray<(Ns + ...)> concatRows(const SignalBlockArray<Ns>&... ar
 
 // Rotate the elements of each row of a SignalBlockArray by one element left.
 // The first element of each row is moved to the end
-template <size_t ROWS>
-inline SignalBlockArray<ROWS> rotateLeft(const SignalBlockArray<ROWS>& x)
+template <size_t ROWS, size_t FRAMES>
+inline SignalBlockArrayOf<ROWS, FRAMES> rotateLeft(const SignalBlockArrayOf<ROWS, FRAMES>& x)
 {
-  SignalBlockArray<ROWS> result;
+  SignalBlockArrayOf<ROWS, FRAMES> result(uninitialized);
   
   for (size_t row = 0; row < ROWS; ++row)
   {
-    SignalBlock xRow = x.getRow(row);
-    SignalBlock rRow;
+    SignalBlockOf<FRAMES> xRow = x.getRow(row);
+    SignalBlockOf<FRAMES> rRow(uninitialized);
     
     const float4* x4 = reinterpret_cast<const float4*>(xRow.data());
     float4* r4 = reinterpret_cast<float4*>(rRow.data());
     
     // Process all but the last float4
-    for (size_t n = 0; n < kFramesPerBlock / 4 - 1; ++n)
+    for (size_t n = 0; n < FRAMES / 4 - 1; ++n)
     {
       r4[n] = vecShuffleLeft(x4[n], x4[n + 1]);
     }
     
     // Wrap around: last float4 uses first float4 for right neighbor
-    r4[kFramesPerBlock / 4 - 1] = vecShuffleLeft(x4[kFramesPerBlock / 4 - 1], x4[0]);
+    r4[FRAMES / 4 - 1] = vecShuffleLeft(x4[FRAMES / 4 - 1], x4[0]);
     
     result.setRow(row, rRow);
   }
@@ -879,24 +1621,24 @@ inline SignalBlockArray<ROWS> rotateLeft(const SignalBlockArray<ROWS>& x)
 
 // Rotate the elements of each row of a SignalBlockArray by one element right.
 // The last element of each row is moved to the start
-template <size_t ROWS>
-inline SignalBlockArray<ROWS> rotateRight(const SignalBlockArray<ROWS>& x)
+template <size_t ROWS, size_t FRAMES>
+inline SignalBlockArrayOf<ROWS, FRAMES> rotateRight(const SignalBlockArrayOf<ROWS, FRAMES>& x)
 {
-  SignalBlockArray<ROWS> result;
+  SignalBlockArrayOf<ROWS, FRAMES> result(uninitialized);
   
   for (size_t row = 0; row < ROWS; ++row)
   {
-    SignalBlock xRow = x.getRow(row);
-    SignalBlock rRow;
+    SignalBlockOf<FRAMES> xRow = x.getRow(row);
+    SignalBlockOf<FRAMES> rRow(uninitialized);
     
     const float4* x4 = reinterpret_cast<const float4*>(xRow.data());
     float4* r4 = reinterpret_cast<float4*>(rRow.data());
     
     // First output float4 wraps around with last input float4
-    r4[0] = vecShuffleRight(x4[kFramesPerBlock / 4 - 1], x4[0]);
+    r4[0] = vecShuffleRight(x4[FRAMES / 4 - 1], x4[0]);
     
     // Process remaining float4s
-    for (size_t n = 0; n < kFramesPerBlock / 4 - 1; ++n)
+    for (size_t n = 0; n < FRAMES / 4 - 1; ++n)
     {
       r4[n + 1] = vecShuffleRight(x4[n], x4[n + 1]);
     }
@@ -910,10 +1652,10 @@ inline SignalBlockArray<ROWS> rotateRight(const SignalBlockArray<ROWS>& x)
 // ----------------------------------------------------------------
 // separating rows
 
-template <size_t ROWS>
-inline SignalBlockArray<(ROWS + 1) / 2> evenRows(const SignalBlockArray<ROWS>& x)
+template <size_t ROWS, size_t FRAMES>
+inline SignalBlockArrayOf<(ROWS + 1) / 2, FRAMES> evenRows(const SignalBlockArrayOf<ROWS, FRAMES>& x)
 {
-  SignalBlockArray<(ROWS + 1) / 2> result;
+  SignalBlockArrayOf<(ROWS + 1) / 2, FRAMES> result(uninitialized);
   for (size_t j = 0; j < (ROWS + 1) / 2; ++j)
   {
     result.setRow(j, x.getRow(j * 2));
@@ -921,10 +1663,10 @@ inline SignalBlockArray<(ROWS + 1) / 2> evenRows(const SignalBlockArray<ROWS>& x
   return result;
 }
 
-template <size_t ROWS>
-inline SignalBlockArray<ROWS / 2> oddRows(const SignalBlockArray<ROWS>& x)
+template <size_t ROWS, size_t FRAMES>
+inline SignalBlockArrayOf<ROWS / 2, FRAMES> oddRows(const SignalBlockArrayOf<ROWS, FRAMES>& x)
 {
-  SignalBlockArray<ROWS / 2> result;
+  SignalBlockArrayOf<ROWS / 2, FRAMES> result(uninitialized);
   for (size_t j = 0; j < ROWS / 2; ++j)
   {
     result.setRow(j, x.getRow(j * 2 + 1));
@@ -933,12 +1675,12 @@ inline SignalBlockArray<ROWS / 2> oddRows(const SignalBlockArray<ROWS>& x)
 }
 
 // return the SignalBlockArray consisting of rows [A, B) of the input.
-template <size_t A, size_t B, size_t ROWS>
-inline SignalBlockArray<B - A> separateRows(const SignalBlockArray<ROWS>& x)
+template <size_t A, size_t B, size_t ROWS, size_t FRAMES>
+inline SignalBlockArrayOf<B - A, FRAMES> separateRows(const SignalBlockArrayOf<ROWS, FRAMES>& x)
 {
   static_assert(B <= ROWS, "separateRows: range out of bounds!");
   static_assert(A < ROWS, "separateRows: range out of bounds!");
-  SignalBlockArray<B - A> result;
+  SignalBlockArrayOf<B - A, FRAMES> result(uninitialized);
   for (size_t j = A; j < B; ++j)
   {
     result.setRow(j - A, x.getRow(j));
@@ -949,10 +1691,10 @@ inline SignalBlockArray<B - A> separateRows(const SignalBlockArray<ROWS>& x)
 // ----------------------------------------------------------------
 // add rows to get row-wise sum
 
-template <size_t ROWS>
-inline SignalBlock addRows(const SignalBlockArray<ROWS>& x)
+template <size_t ROWS, size_t FRAMES>
+inline SignalBlockOf<FRAMES> addRows(const SignalBlockArrayOf<ROWS, FRAMES>& x)
 {
-  SignalBlock result(0.f);
+  SignalBlockOf<FRAMES> result(0.f);
   for (size_t j = 0; j < ROWS; ++j)
   {
     result = add(result, x.getRow(j));
@@ -964,13 +1706,13 @@ inline SignalBlock addRows(const SignalBlockArray<ROWS>& x)
 // rowIndex - returns a SignalBlockArray of ROWS rows, each row filled
 // with the index of its row
 
-template <size_t ROWS>
-inline SignalBlockArray<ROWS> rowIndex()
+template <size_t ROWS, size_t FRAMES = kFramesPerBlock>
+inline SignalBlockArrayOf<ROWS, FRAMES> rowIndex()
 {
-  SignalBlockArray<ROWS> result;
+  SignalBlockArrayOf<ROWS, FRAMES> result(uninitialized);
   for (size_t j = 0; j < ROWS; ++j)
   {
-    result.setRow(j, SignalBlock(static_cast<float>(j)));
+    result.setRow(j, SignalBlockOf<FRAMES>(static_cast<float>(j)));
   }
   return result;
 }
@@ -979,12 +1721,12 @@ inline SignalBlockArray<ROWS> rowIndex()
 // frameIndex - returns a SignalBlockArray<T> of ROWS rows, each row filled
 // with the index of its row in time order.
 
-template <typename T, size_t ROWS>
-inline SignalBlockArrayBase<T, ROWS> frameIndex()
+template <typename T, size_t ROWS, size_t FRAMES = kFramesPerBlock>
+inline SignalBlockArrayBase<T, ROWS, FRAMES> frameIndex()
 {
-  SignalBlockArrayBase<T, ROWS> result;
+  SignalBlockArrayBase<T, ROWS, FRAMES> result(uninitialized);
   T* writePtr = result.data();
-  for (size_t j = 0; j < ROWS * kFramesPerBlock; ++j)
+  for (size_t j = 0; j < ROWS * FRAMES; ++j)
   {
       *writePtr++ = T(j);
   }
@@ -1000,7 +1742,7 @@ template<typename InT, size_t N, typename FN>
 auto map(FN f, const AlignedArray<InT, N>& input)
 {
   using OutT = decltype(f(std::declval<InT>()));
-  AlignedArray<OutT, N> output;
+  AlignedArray<OutT, N> output(uninitialized);
   for (size_t i = 0; i < N; ++i) {
     output[i] = f(input[i]);
   }
@@ -1008,13 +1750,13 @@ auto map(FN f, const AlignedArray<InT, N>& input)
 }
 
 // Row-wise map: apply f to each row of a SignalBlockArray
-template<size_t N, typename FN>
-auto mapRows(FN f, const SignalBlockArray<N>& input)
+template<size_t N, size_t FRAMES, typename FN>
+auto mapRows(FN f, const SignalBlockArrayOf<N, FRAMES>& input)
 {
-  using OutRow = decltype(f(std::declval<SignalBlock>()));
+  using OutRow = decltype(f(std::declval<SignalBlockOf<FRAMES>>()));
   
   // Assumes f returns a SignalBlock (or compatible type)
-  SignalBlockArray<N> output;
+  SignalBlockArrayOf<N, FRAMES> output(uninitialized);
   for (size_t i = 0; i < N; ++i) {
     output.setRow(i, f(input.getRow(i)));
   }
@@ -1063,10 +1805,12 @@ inline SignalBlock rangeClosed(float start, float end)
 }
 
 // make a block from (start + interval) to end.
-inline SignalBlock interpolateBlockLinear(float start, float end)
+template<size_t FRAMES = kFramesPerBlock>
+inline SignalBlockOf<FRAMES> interpolateBlockLinear(float start, float end)
 {
-  float interval = (end - start) / kFramesPerBlock;
-  return columnIndex() * SignalBlock(interval) + SignalBlock(start + interval);
+  constexpr SignalBlockOf<FRAMES> kIndex{make_array<FRAMES>(intToFloatCastFn)};
+  float interval = (end - start) / FRAMES;
+  return kIndex * SignalBlockOf<FRAMES>(interval) + SignalBlockOf<FRAMES>(start + interval);
 }
 
 // ----------------------------------------------------------------
@@ -1089,19 +1833,22 @@ inline SignalBlock4 rangeClosed(float4 start, float4 end)
   return columnIndex4() * SignalBlock4(interval) + SignalBlock4(start);
 }
 
-inline SignalBlock4 interpolateBlockLinear(float4 start, float4 end)
+template<size_t FRAMES = kFramesPerBlock>
+inline Block<float4, FRAMES> interpolateBlockLinear(float4 start, float4 end)
 {
-  float4 interval = (end - start) / float4(kFramesPerBlock);
-  return columnIndex4() * SignalBlock4(interval) + SignalBlock4(start + interval);
+  float4 interval = (end - start) / float4(FRAMES);
+  return Block<float4, FRAMES>(columnToFloat4Fn) * Block<float4, FRAMES>(interval) +
+         Block<float4, FRAMES>(start + interval);
 }
 
 
 // ----------------------------------------------------------------
 // for testing
 
-inline bool validate(const SignalBlock& x)
+template<size_t FRAMES>
+inline bool validate(const SignalBlockOf<FRAMES>& x)
 {
-  for (size_t n = 0; n < kFramesPerBlock; ++n)
+  for (size_t n = 0; n < FRAMES; ++n)
   {
     constexpr float maxUsefulValue = 1e12f;
     if (std::isnan(x[n]) || (fabs(x[n]) > maxUsefulValue))
@@ -1111,22 +1858,97 @@ inline bool validate(const SignalBlock& x)
   }
   return true;
 }
+inline bool validate(const SignalBlock& x) { return validate<kFramesPerBlock>(x); }
 
 // ----------------------------------------------------------------
 // interpolate float array coeffs to SignalBlockArray<T> rows
 
-template<typename T, size_t COEFFS_SIZE>
-SignalBlockArrayBase<T, COEFFS_SIZE> interpolateCoeffsLinear(
+template<size_t FRAMES = kFramesPerBlock, typename T, size_t COEFFS_SIZE>
+SignalBlockArrayBase<T, COEFFS_SIZE, FRAMES> interpolateCoeffsLinear(
                                                              const std::array<T, COEFFS_SIZE>& c0,
                                                              const std::array<T, COEFFS_SIZE>& c1)
 {
-  SignalBlockArrayBase<T, COEFFS_SIZE> vy;
+  SignalBlockArrayBase<T, COEFFS_SIZE, FRAMES> vy(uninitialized);
   for (size_t i = 0; i < COEFFS_SIZE; ++i)
   {
-    vy.setRow(i, interpolateBlockLinear(c0[i], c1[i]));
+    vy.setRow(i, interpolateBlockLinear<FRAMES>(c0[i], c1[i]));
   }
   return vy;
 }
 
+// ----------------------------------------------------------------
+// CoeffCache: the params of a processor's last block and the coefficients
+// made from them. While the params stay bitwise equal and the coefficients
+// have not been changed some other way, the processor can skip makeCoeffs()
+// and interpolation and run with constant coefficients. Holds up to
+// MAX_VALUES params and coefficients together.
+//
+// The cache is worth its space only where makeCoeffs() is expensive. With
+// MAX_VALUES = 0 nothing is stored: the processor makes its coefficients
+// every block and compares them with the ones it has, which still skips the
+// interpolation when they are unchanged.
+
+struct CoeffCacheStats
+{
+  size_t hits{0};    // blocks that reused the last coefficients
+  size_t misses{0};  // blocks that made new coefficients
+};
+
+constexpr size_t kDefaultCoeffCacheSize{12};
+
+template<typename T, size_t MAX_VALUES = kDefaultCoeffCacheSize>
+class CoeffCache
+{
+ public:
+  // True if params and coeffs are bitwise equal to the stored ones. Counts a
+  // hit or a miss.
+  template<size_t N_PARAMS, size_t N_COEFFS>
+  bool matches(const std::array<T, N_PARAMS>& params, const std::array<T, N_COEFFS>& coeffs)
+  {
+    static_assert(N_PARAMS + N_COEFFS <= MAX_VALUES, "too many params and coeffs to cache");
+    bool hit = valid_ && !std::memcmp(values_.data(), params.data(), sizeof(params)) &&
+               !std::memcmp(values_.data() + N_PARAMS, coeffs.data(), sizeof(coeffs));
+    ++(hit ? stats_.hits : stats_.misses);
+    return hit;
+  }
+
+  template<size_t N_PARAMS, size_t N_COEFFS>
+  void store(const std::array<T, N_PARAMS>& params, const std::array<T, N_COEFFS>& coeffs)
+  {
+    std::copy(params.begin(), params.end(), values_.begin());
+    std::copy(coeffs.begin(), coeffs.end(), values_.begin() + N_PARAMS);
+    valid_ = true;
+  }
+
+  const CoeffCacheStats& getStats() const { return stats_; }
+  void resetStats() { stats_ = CoeffCacheStats{}; }
+
+ private:
+  std::array<T, MAX_VALUES> values_;
+  bool valid_{false};
+  CoeffCacheStats stats_;
+};
+
+template<typename T>
+class CoeffCache<T, 0>
+{
+ public:
+  // True if the next coeffs are bitwise equal to the current ones. Counts a
+  // hit or a miss.
+  template<size_t N_COEFFS>
+  bool matches(const std::array<T, N_COEFFS>& next, const std::array<T, N_COEFFS>& coeffs)
+  {
+    bool hit = !std::memcmp(next.data(), coeffs.data(), sizeof(coeffs));
+    ++(hit ? stats_.hits : stats_.misses);
+    return hit;
+  }
+
+  const CoeffCacheStats& getStats() const { return stats_; }
+  void resetStats() { stats_ = CoeffCacheStats{}; }
+
+ private:
+  CoeffCacheStats stats_;
+};
+
 
 }  // namespace ml
@@ -12,11 +12,22 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <tuple>
+#include <type_traits>
 #include <vector>
 
 #include "MLDSPOps.h"
 #include "MLDSPMath.h"
 #include "MLDSPFilters.h"
+#include "MLDSPFFT.h"
 
 namespace ml
 {
@@ -34,32 +45,53 @@ using HalfBlock = AlignedArray<T, kFramesPerBlock / 2>;
 template<typename T>
 struct HalfBandFilter
 {
-  // TEMP
-  Allpass1<T> apa0{{0.07986642623635751f}};
-  Allpass1<T> apa1{{0.5453536510711322f}};
-  Allpass1<T> apb0{{0.28382934487410993f}};
-  Allpass1<T> apb1{{0.8344118914807379f}};
+  static constexpr float kA0{0.07986642623635751f};
+  static constexpr float kA1{0.5453536510711322f};
+  static constexpr float kB0{0.28382934487410993f};
+  static constexpr float kB1{0.8344118914807379f};
+
+  // Group delay at low frequencies of upsample() or downsample(), in samples
+  // at the higher rate: twice the delay (1 - a) / (1 + a) of the a branch.
+  static constexpr float kGroupDelay{2.f * ((1.f - kA0) / (1.f + kA0) + (1.f - kA1) / (1.f + kA1))};
+
+  Allpass1<T> apa0{kA0};
+  Allpass1<T> apa1{kA1};
+  Allpass1<T> apb0{kB0};
+  Allpass1<T> apb1{kB1};
   T b1{0.f};
   
   // 32 in → 64 out
   Block<T> upsample(const HalfBlock<T>& in)
   {
-    Block<T> out;
+    Block<T> out(uninitialized);
+    upsample(in.data(), out.data(), kFramesPerBlock / 2);
+    return out;
+  }
+  
+  // 64 in → 32 out
+  HalfBlock<T> downsample(const Block<T>& in)
+  {
+    HalfBlock<T> out(uninitialized);
+    downsample(in.data(), out.data(), kFramesPerBlock / 2);
+    return out;
+  }
+
+  // inFrames in → inFrames * 2 out
+  void upsample(const T* in, T* out, size_t inFrames)
+  {
     size_t i2 = 0;
-    for (size_t i = 0; i < kFramesPerBlock / 2; ++i)
+    for (size_t i = 0; i < inFrames; ++i)
     {
       out[i2++] = apa1.nextFrame(apa0.nextFrame(in[i]));
       out[i2++] = apb1.nextFrame(apb0.nextFrame(in[i]));
     }
-    return out;
   }
-  
-  // 64 in → 32 out
-  HalfBlock<T> downsample(const Block<T>& in)
+
+  // outFrames * 2 in → outFrames out
+  void downsample(const T* in, T* out, size_t outFrames)
   {
-    HalfBlock<T> out;
     size_t i2 = 0;
-    for (size_t i = 0; i < kFramesPerBlock / 2; ++i)
+    for (size_t i = 0; i < outFrames; ++i)
     {
       T a0 = apa1.nextFrame(apa0.nextFrame(in[i2]));
       T b0 = apb1.nextFrame(apb0.nextFrame(in[i2 + 1]));
@@ -67,7 +99,6 @@ struct HalfBandFilter
       b1 = b0;
       i2 += 2;
     }
-    return out;
   }
   
   void clear()
@@ -105,7 +136,7 @@ struct Downsampler2x
   
   Block<T> operator()(const Block<T>& in1, const Block<T>& in2)
   {
-    Block<T> out;
+    Block<T> out(uninitialized);
     auto lo = filter.downsample(in1);
     auto hi = filter.downsample(in2);
     auto* half = reinterpret_cast<HalfBlock<T>*>(&out);
@@ -117,6 +148,77 @@ struct Downsampler2x
   void clear() { filter.clear(); }
 };
 
+// ----------------------------------------------------------------
+// UpsamplerNx and DownsamplerNx: OCTAVES HalfBandFilters in series, changing
+// the rate of one channel by kFactor = 2^OCTAVES. The stages ping-pong
+// between the two halves of a work buffer of kFramesPerBlock * kFactor frames
+// that the caller provides, so several channels can share one.
+
+template<typename T, int OCTAVES>
+struct UpsamplerNx
+{
+  static_assert(OCTAVES >= 1, "UpsamplerNx: OCTAVES must be at least 1");
+  static constexpr size_t kFactor{size_t(1) << OCTAVES};
+  std::array<HalfBandFilter<T>, OCTAVES> filters;
+
+  // kFramesPerBlock frames of x → kFramesPerBlock * kFactor frames of y
+  void operator()(const T* x, T* y, T* work)
+  {
+    const T* src = x;
+    size_t frames = kFramesPerBlock;
+    for (int i = 0; i < OCTAVES; ++i)
+    {
+      T* dest = (i == OCTAVES - 1) ? y : work + (i & 1) * (kFramesPerBlock * kFactor / 2);
+      filters[i].upsample(src, dest, frames);
+      src = dest;
+      frames *= 2;
+    }
+  }
+
+  void clear()
+  {
+    for (auto& f : filters) f.clear();
+  }
+
+  // group delay at low frequencies in samples at the lower rate
+  static constexpr float getGroupDelay()
+  {
+    return HalfBandFilter<T>::kGroupDelay * (1.f - 1.f / kFactor);
+  }
+};
+
+template<typename T, int OCTAVES>
+struct DownsamplerNx
+{
+  static_assert(OCTAVES >= 1, "DownsamplerNx: OCTAVES must be at least 1");
+  static constexpr size_t kFactor{size_t(1) << OCTAVES};
+  std::array<HalfBandFilter<T>, OCTAVES> filters;
+
+  // kFramesPerBlock * kFactor frames of x → kFramesPerBlock frames of y
+  void operator()(const T* x, T* y, T* work)
+  {
+    const T* src = x;
+    size_t frames = kFramesPerBlock * kFactor / 2;
+    for (int i = 0; i < OCTAVES; ++i)
+    {
+      T* dest = (i == OCTAVES - 1) ? y : work + (i & 1) * (kFramesPerBlock * kFactor / 2);
+      filters[i].downsample(src, dest, frames);
+      src = dest;
+      frames /= 2;
+    }
+  }
+
+  void clear()
+  {
+    for (auto& f : filters) f.clear();
+  }
+
+  static constexpr float getGroupDelay()
+  {
+    return HalfBandFilter<T>::kGroupDelay * (1.f - 1.f / kFactor);
+  }
+};
+
 // ----------------------------------------------------------------
 // Multi-octave Downsampler
 
@@ -236,6 +338,279 @@ struct Upsampler
     readIdx_ = 0;
   }
 };
+// ----------------------------------------------------------------
+// PolyphaseResampler: windowed-sinc FIR resampling by any ratio.
+//
+// For rates inRate and outRate with ratio L/M in lowest terms, each output is
+// an inner product of taps input samples with one of L phases of a Kaiser-
+// windowed sinc filter. The filter cuts off so that its stopband starts at
+// the lower of the two Nyquist frequencies. If L is more than
+// kMaxResamplerPhases, or after setRatio() is called, the resampler runs in
+// variable mode: phases are interpolated from a table of
+// kVariableResamplerPhases, and the ratio can change at any time, for
+// example to correct drift between clocks.
+//
+// Filter tables are made once for each set of parameters and shared by all
+// resamplers that use them. Each resampler gets its variable mode table when
+// it is constructed, so that switching modes does not allocate.
+//
+// T is float for one channel, or float4 for four channels in the lanes.
+// Output sample n is the input at time n * inRate / outRate, so that times
+// line up in offline renders. To get the tail of the input out, write
+// getTaps() / 2 more frames of zeros.
+
+// taps per phase and stopband attenuation in dB.
+struct ResamplerQuality
+{
+  size_t taps;
+  float stopbandDB;
+};
+
+namespace resamplerQuality
+{
+constexpr ResamplerQuality kDraft{16, 60.f};
+constexpr ResamplerQuality kNormal{64, 96.f};
+constexpr ResamplerQuality kHigh{128, 120.f};
+}  // namespace resamplerQuality
+
+constexpr size_t kMaxResamplerPhases{1024};
+constexpr size_t kVariableResamplerPhases{256};
+
+// Filter coefficients for each phase, taps (rounded up to a multiple of 4,
+// so that every row is aligned for float4 loads) per row. Row p is for the output time p / phases of the way from one input
+// sample to the next. There is one extra row, for p = phases, so that
+// variable mode can interpolate between rows p and p + 1.
+class ResamplerTable
+{
+ public:
+  ResamplerTable(size_t phases, size_t taps, float stopbandDB, double stopbandEdge)
+      : phases_(phases), taps_((taps + 3) & ~size_t(3)), coeffs_((phases + 1) * taps_)
+  {
+    // Kaiser window design: the attenuation sets beta and, with the number of
+    // taps, the width of the transition band, which ends at stopbandEdge
+    // (as a fraction of the input Nyquist frequency).
+    const double kPi = 3.141592653589793;
+    double a = stopbandDB;
+    double beta = (a > 50.) ? 0.1102 * (a - 8.7) : (a > 21.) ? 0.5842 * std::pow(a - 21., 0.4) + 0.07886 * (a - 21.) : 0.;
+    double transition = (a - 7.95) / (2.285 * 2. * kPi * taps_) * 2.;
+    double cutoff = std::max(stopbandEdge - transition / 2., 0.05);
+    double half = taps_ / 2.;
+
+    for (size_t p = 0; p <= phases; ++p)
+    {
+      float* row = coeffs_.data() + p * taps_;
+      double frac = double(p) / phases;
+      double sum = 0.;
+      for (size_t k = 0; k < taps_; ++k)
+      {
+        // distance from the output time, in input samples
+        double t = double(k) - (half - 1.) - frac;
+        double x = cutoff * t;
+        double sinc = (std::fabs(x) < 1e-9) ? 1. : std::sin(kPi * x) / (kPi * x);
+        double r = t / half;
+        double w = (std::fabs(r) < 1.) ? besselI0(beta * std::sqrt(1. - r * r)) / besselI0(beta) : 0.;
+        row[k] = float(sinc * w);
+        sum += row[k];
+      }
+      for (size_t k = 0; k < taps_; ++k) row[k] = float(row[k] / sum);
+    }
+  }
+
+  size_t getPhases() const { return phases_; }
+  size_t getTaps() const { return taps_; }
+  const float* getRow(size_t p) const { return coeffs_.data() + p * taps_; }
+
+  // Get the shared table for the given parameters, making it the first time.
+  // This locks, so call it from setup code.
+  static std::shared_ptr<const ResamplerTable> get(size_t phases, size_t taps, float stopbandDB,
+                                                   double stopbandEdge)
+  {
+    using Key = std::tuple<size_t, size_t, float, double>;
+    static std::mutex mutex;
+    static std::map<Key, std::shared_ptr<const ResamplerTable>> cache;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& table = cache[Key{phases, taps, stopbandDB, stopbandEdge}];
+    if (!table) table = std::make_shared<const ResamplerTable>(phases, taps, stopbandDB, stopbandEdge);
+    return table;
+  }
+
+ private:
+  static double besselI0(double x)
+  {
+    double sum = 1., term = 1.;
+    for (int k = 1; k < 64 && term > 1e-12 * sum; ++k)
+    {
+      term *= (x / (2. * k)) * (x / (2. * k));
+      sum += term;
+    }
+    return sum;
+  }
+
+  size_t phases_;
+  size_t taps_;
+  fft::FloatBuffer coeffs_;
+};
+
+template<typename T>
+class PolyphaseResampler
+{
+ public:
+  struct Result
+  {
+    size_t inputUsed;
+    size_t outputWritten;
+  };
+
+  PolyphaseResampler(int inRate, int outRate, ResamplerQuality quality = resamplerQuality::kNormal)
+  {
+    int g = std::gcd(inRate, outRate);
+    up_ = size_t(outRate / g);
+    down_ = size_t(inRate / g);
+    double stopbandEdge = std::min(1., double(outRate) / inRate);
+    variableTable_ =
+        ResamplerTable::get(kVariableResamplerPhases, quality.taps, quality.stopbandDB, stopbandEdge);
+    if (up_ <= kMaxResamplerPhases)
+      table_ = ResamplerTable::get(up_, quality.taps, quality.stopbandDB, stopbandEdge);
+    else
+      setRatio(double(outRate) / inRate);
+
+    capacity_ = table_->getTaps() + kFramesPerBlock * 4;
+    history_.resize(capacity_);
+    clear();
+  }
+
+  // Switch to variable mode with the given output / input ratio. The filter
+  // cutoff stays where the rates given to the constructor put it. This does
+  // not allocate or lock, so it can be called from the audio thread.
+  void setRatio(double outPerIn)
+  {
+    if (!variable_)
+    {
+      // both tables have the same taps, so the history is already big enough
+      table_ = variableTable_;
+      variable_ = true;
+      position_ = double(phase_) / up_;
+    }
+    step_ = 1. / outPerIn;
+  }
+
+  bool isVariable() const { return variable_; }
+  size_t getTaps() const { return table_->getTaps(); }
+  std::shared_ptr<const ResamplerTable> getTable() const { return table_; }
+
+  void clear()
+  {
+    std::fill(history_.begin(), history_.end(), T(0.f));
+
+    // start with half a window of zeros, so output 0 is centered on input 0
+    start_ = 0;
+    count_ = table_->getTaps() / 2 - 1;
+    skip_ = 0;
+    phase_ = 0;
+    position_ = 0.;
+  }
+
+  // Read up to inFrames input frames and write up to outFrames output
+  // frames, as many as the input allows. Input that is not used is left for
+  // the next call.
+  Result operator()(const T* in, size_t inFrames, T* out, size_t outFrames)
+  {
+    const size_t taps = table_->getTaps();
+    size_t used = 0;
+    size_t written = 0;
+    while (written < outFrames)
+    {
+      while (start_ + taps > count_)
+      {
+        if (!refill(in, inFrames, used)) return {used, written};
+      }
+
+      const T* x = history_.data() + start_;
+      if (!variable_)
+      {
+        out[written++] = dot(x, table_->getRow(phase_));
+        phase_ += down_;
+        start_ += phase_ / up_;
+        phase_ %= up_;
+      }
+      else
+      {
+        double p = position_ * kVariableResamplerPhases;
+        size_t row = size_t(p);
+        T a(float(p - row));
+        T y0 = dot(x, table_->getRow(row));
+        T y1 = dot(x, table_->getRow(row + 1));
+        out[written++] = y0 + a * (y1 - y0);
+        position_ += step_;
+        double whole = std::floor(position_);
+        start_ += size_t(whole);
+        position_ -= whole;
+      }
+    }
+    return {used, written};
+  }
+
+ private:
+  // Move the window to the front of the history and add input. Returns false
+  // if there was no input to add.
+  bool refill(const T* in, size_t inFrames, size_t& used)
+  {
+    if (start_ >= count_)
+    {
+      skip_ += start_ - count_;
+      start_ = count_ = 0;
+    }
+    else if (start_ > 0)
+    {
+      std::copy(history_.begin() + start_, history_.begin() + count_, history_.begin());
+      count_ -= start_;
+      start_ = 0;
+    }
+    size_t skipped = std::min(skip_, inFrames - used);
+    used += skipped;
+    skip_ -= skipped;
+
+    size_t n = std::min(capacity_ - count_, inFrames - used);
+    std::copy(in + used, in + used + n, history_.begin() + count_);
+    used += n;
+    count_ += n;
+    return n > 0;
+  }
+
+  // inner product of a window of input with a row of coefficients
+  T dot(const T* x, const float* h) const
+  {
+    const size_t taps = table_->getTaps();
+    if constexpr (std::is_same_v<T, float>)
+    {
+      float4 sum(0.f);
+      for (size_t k = 0; k < taps; k += 4) sum += loadFloat4Unaligned(x + k) * loadFloat4(h + k);
+      return vecSumH(sum);
+    }
+    else
+    {
+      T sum(0.f);
+      for (size_t k = 0; k < taps; ++k) sum += x[k] * T(h[k]);
+      return sum;
+    }
+  }
+
+  size_t up_{1};
+  size_t down_{1};
+  std::shared_ptr<const ResamplerTable> table_;
+  std::shared_ptr<const ResamplerTable> variableTable_;
+  bool variable_{false};
+
+  std::vector<T> history_;
+  size_t capacity_{0};
+  size_t start_{0};     // start of the current window in history_
+  size_t count_{0};     // frames in history_
+  size_t skip_{0};      // input frames to skip before the next window
+  size_t phase_{0};     // rational mode: position between samples, in 1/up_
+  double position_{0};  // variable mode: position between samples
+  double step_{1.};     // variable mode: input samples per output
+};
+
 // ----------------------------------------------------------------
 // higher-order functions with DSP
 
@@ -354,5 +729,101 @@ private:
   bool mPhase{false};
 };
 
+// UpsampleNxFunction is a function object that given a process function f,
+// upsamples each row of the input x by 2^OCTAVES, applies f to each of the
+// 2^OCTAVES blocks at the higher rate, downsamples and returns the result.
+// For float rows, each group of four rows is packed into the lanes of one
+// float4 cascade, and only the leftover rows are filtered one at a time. The
+// total delay of the filters is getGroupDelay() samples, about 3.4 for 4x.
+
+template<typename T, int OCTAVES, int ROWS, int OUT_ROWS = ROWS>
+class UpsampleNxFunction
+{
+  static constexpr size_t kFactor{size_t(1) << OCTAVES};
+  static constexpr bool kPack{std::is_same_v<T, float>};
+  static constexpr int kInGroups{kPack ? ROWS / 4 : 0};
+  static constexpr int kInSingles{ROWS - kInGroups * 4};
+  static constexpr int kOutGroups{kPack ? OUT_ROWS / 4 : 0};
+  static constexpr int kOutSingles{OUT_ROWS - kOutGroups * 4};
+
+  using inputType = const SignalBlockArrayBase<T, ROWS>;
+  using outputType = SignalBlockArrayBase<T, OUT_ROWS>;
+  using ProcessFn = std::function<outputType(inputType)>;
+
+ public:
+  inline outputType operator()(ProcessFn fn, inputType vx)
+  {
+    // upsample each group and each single row into the blocks of input
+    if constexpr (kPack)
+    {
+      for (int g = 0; g < kInGroups; ++g)
+      {
+        horizontalToVertical(vx.rowPtr(g * 4), packed_.data(), 1);
+        upGroups_[g](packed_.data(), packedWide_.data(), packedWork_.data());
+        for (size_t b = 0; b < kFactor; ++b)
+          verticalToHorizontal(packedWide_.rowPtr(b), upsampledInput_[b].rowPtr(g * 4), 1);
+      }
+    }
+    for (int j = 0; j < kInSingles; ++j)
+    {
+      int row = kInGroups * 4 + j;
+      upSingles_[j](vx.rowPtr(row), wide_.data(), work_.data());
+      for (size_t b = 0; b < kFactor; ++b) upsampledInput_[b].setRow(row, wide_.getRow(b));
+    }
+
+    // process upsampled input
+    for (size_t b = 0; b < kFactor; ++b) upsampledOutput_[b] = fn(upsampledInput_[b]);
+
+    // downsample each group and each single row to 1x output
+    outputType vy(uninitialized);
+    if constexpr (kPack)
+    {
+      for (int g = 0; g < kOutGroups; ++g)
+      {
+        for (size_t b = 0; b < kFactor; ++b)
+          horizontalToVertical(upsampledOutput_[b].rowPtr(g * 4), packedWide_.rowPtr(b), 1);
+        downGroups_[g](packedWide_.data(), packed_.data(), packedWork_.data());
+        verticalToHorizontal(packed_.data(), vy.rowPtr(g * 4), 1);
+      }
+    }
+    for (int j = 0; j < kOutSingles; ++j)
+    {
+      int row = kOutGroups * 4 + j;
+      for (size_t b = 0; b < kFactor; ++b) wide_.setRow(b, upsampledOutput_[b].getRow(row));
+      downSingles_[j](wide_.data(), vy.rowPtr(row), work_.data());
+    }
+    return vy;
+  }
+
+  void clear()
+  {
+    for (auto& u : upGroups_) u.clear();
+    for (auto& u : upSingles_) u.clear();
+    for (auto& d : downGroups_) d.clear();
+    for (auto& d : downSingles_) d.clear();
+  }
+
+  // delay of the upsampling and downsampling filters at low frequencies, in
+  // samples at the input rate.
+  static constexpr float getGroupDelay()
+  {
+    return UpsamplerNx<T, OCTAVES>::getGroupDelay() + DownsamplerNx<T, OCTAVES>::getGroupDelay();
+  }
+
+ private:
+  std::array<UpsamplerNx<float4, OCTAVES>, kInGroups> upGroups_;
+  std::array<UpsamplerNx<T, OCTAVES>, kInSingles> upSingles_;
+  std::array<DownsamplerNx<float4, OCTAVES>, kOutGroups> downGroups_;
+  std::array<DownsamplerNx<T, OCTAVES>, kOutSingles> downSingles_;
+
+  // work buffers shared by all the cascades: rows are blocks at the higher rate
+  SignalBlockArrayBase<float4, 1> packed_;
+  SignalBlockArrayBase<float4, kFactor> packedWide_, packedWork_;
+  SignalBlockArrayBase<T, kFactor> wide_, work_;
+
+  std::array<SignalBlockArrayBase<T, ROWS>, kFactor> upsampledInput_;
+  std::array<SignalBlockArrayBase<T, OUT_ROWS>, kFactor> upsampledOutput_;
+};
+
 }  // namespace ml
 
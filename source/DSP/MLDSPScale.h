@@ -42,6 +42,7 @@ class Scale
   {
     scaleRatios_ = b.scaleRatios_;
     pitches_ = b.pitches_;
+    sortedPitches_ = b.sortedPitches_;
   }
 
   // load a scale from an input string along with an optional mapping.
@@ -150,49 +151,25 @@ class Scale
   // return log pitch of the note of the current scale just below the input.
   float quantizePitch(float a) const
   {
-    float r = 0.f;
-    for (int i = kMLNumNotes - 1; i > 0; i--)
-    {
-      float p = (float)pitches_[i];
-      if (p <= a)
-      {
-        r = p;
-        break;
-      }
-    }
-    return r;
+    int i = lowerPitchIndex(a);
+    return (i > 0) ? (float)sortedPitches_[i] : 0.f;
   }
 
   // return log pitch of the note of the current scale closest to the input.
   float quantizePitchNearest(float a) const
   {
-    float fLower{0};
-    float fHigher{0};
-    int lowerIdx{0};
-    for (int i = kMLNumNotes - 1; i > 0; i--)
-    {
-      float p = (float)pitches_[i];
-      if (p <= a)
-      {
-        fLower = p;
-        if (i < kMLNumNotes - 1)
-        {
-          fHigher = (float)pitches_[i + 1];
-        }
-        lowerIdx = i;
-        break;
-      }
-    }
-
+    int lowerIdx = lowerPitchIndex(a);
     if (lowerIdx == kMLNumNotes - 1)
     {
-      return fLower;
+      return (float)sortedPitches_[lowerIdx];
     }
     else if (lowerIdx <= 0)
     {
-      return (float)pitches_[0];
+      return (float)sortedPitches_[0];
     }
 
+    float fLower = (float)sortedPitches_[lowerIdx];
+    float fHigher = (float)sortedPitches_[lowerIdx + 1];
     float d1 = (a - fLower);
     float d2 = (fHigher - a);
     if (d1 < d2)
@@ -237,6 +214,15 @@ class Scale
  private:
   float noteToPitch(float note) const;
 
+  // binary search for the index of the highest pitch above index 0 of
+  // sortedPitches_ that is at or below a, or 0 if there is none.
+  int lowerPitchIndex(float a) const
+  {
+    auto it = std::upper_bound(sortedPitches_.begin() + 1, sortedPitches_.end(), a,
+                               [](float x, double p) { return x < (float)p; });
+    return static_cast<int>(it - sortedPitches_.begin()) - 1;
+  }
+
   void addRatioAsFraction(int n, int d) { addRatio((double)n / (double)d); }
 
   void addRatioAsCents(double cents) { addRatio(std::pow(2., cents / 1200.)); }
@@ -284,6 +270,8 @@ class Scale
       ratios_[i] = (r * refFreqRatio);
       pitches_[i] = std::log2(ratios_[i]);
     }
+    sortedPitches_ = pitches_;
+    std::sort(sortedPitches_.begin(), sortedPitches_.end());
   }
 
   // trim from start (in place)
@@ -483,6 +471,9 @@ class Scale
 
   // pitch for each integer note number stored in linear octave space. pitch = log2(ratio).
   std::array<double, kMLNumNotes> pitches_;
+
+  // pitches_ in ascending order, for the quantize functions.
+  std::array<double, kMLNumNotes> sortedPitches_;
 };
 
 }  // namespace ml
@@ -147,7 +147,7 @@ struct ADSR
 
   inline SignalBlock operator()(const SignalBlock vx)
   {
-    SignalBlock r;
+    SignalBlock r(uninitialized);
     for (int i = 0; i < kFramesPerBlock; ++i)
     {
       r[i] = processSample(vx[i]);
@@ -183,7 +183,7 @@ struct Ramp
     
     // accumulate 32-bit phase with wrap
     // we test for wrap at every sample to get a clean ending
-    SignalBlockInt omega32V;
+    SignalBlockInt omega32V(uninitialized);
     for (int n = 0; n < kFramesPerBlock; ++n)
     {
       mOmega32 += intStepsPerSampleV[n] * mGate;
@@ -227,7 +227,12 @@ struct Ramp
 
 // linear interpolate over signal length to next value.
 
-constexpr float unityRampFn(size_t i) { return (i + 1) / static_cast<float>(kFramesPerBlock); }
+template<size_t FRAMES>
+constexpr float unityRampFnOf(size_t i) { return (i + 1) / static_cast<float>(FRAMES); }
+template<size_t FRAMES>
+constexpr SignalBlockOf<FRAMES> kUnityRampVecOf{unityRampFnOf<FRAMES>};
+
+constexpr float unityRampFn(size_t i) { return unityRampFnOf<kFramesPerBlock>(i); }
 constexpr SignalBlock kUnityRampVec{unityRampFn};
 
 struct Interpolator1
@@ -251,10 +256,11 @@ struct Interpolator1
 // convert a scalar float input into a SignalBlock with linear slew.
 // to allow optimization, glide time is quantized to SignalBlocks.
 
-class LinearGlide
+template<size_t FRAMES>
+class LinearGlideOf
 {
-  SignalBlock mCurrVec{0.f};
-  SignalBlock mStepVec{0.f};
+  SignalBlockOf<FRAMES> mCurrVec{0.f};
+  SignalBlockOf<FRAMES> mStepVec{0.f};
   float mTargetValue{0};
   float mDyPerVector{1.f / 32};
   int mVectorsPerGlide{32};
@@ -263,7 +269,7 @@ class LinearGlide
 public:
   void setGlideTimeInSamples(float t)
   {
-    mVectorsPerGlide = static_cast<int>(t / kFramesPerBlock);
+    mVectorsPerGlide = static_cast<int>(t / FRAMES);
     if (mVectorsPerGlide < 1) mVectorsPerGlide = 1;
     mDyPerVector = 1.0f / (mVectorsPerGlide + 0.f);
   }
@@ -275,10 +281,10 @@ public:
     mVectorsRemaining = 0;
   }
   
-  SignalBlock operator()(float f)
+  SignalBlockOf<FRAMES> operator()(float f)
   {
     // set target value if different from current value.
-    // const float currentValue = mCurrVec[kFramesPerBlock - 1];
+    // const float currentValue = mCurrVec[FRAMES - 1];
     if (f != mTargetValue)
     {
       mTargetValue = f;
@@ -295,21 +301,21 @@ public:
     else if (mVectorsRemaining == 0)
     {
       // end glide: write target value to output vector
-      mCurrVec = SignalBlock(mTargetValue);
-      mStepVec = SignalBlock(0.f);
+      mCurrVec = SignalBlockOf<FRAMES>(mTargetValue);
+      mStepVec = SignalBlockOf<FRAMES>(0.f);
       mVectorsRemaining--;
     }
     else if (mVectorsRemaining == mVectorsPerGlide)
     {
       // start glide: get change in output value per vector
-      float currentValue = mCurrVec[kFramesPerBlock - 1];
+      float currentValue = mCurrVec[FRAMES - 1];
       float dydv = (mTargetValue - currentValue) * mDyPerVector;
       
       // get constant step vector
-      mStepVec = SignalBlock(dydv);
+      mStepVec = SignalBlockOf<FRAMES>(dydv);
       
       // setup current vector with first interpolation ramp.
-      mCurrVec = SignalBlock(currentValue) + kUnityRampVec * mStepVec;
+      mCurrVec = SignalBlockOf<FRAMES>(currentValue) + kUnityRampVecOf<FRAMES> * mStepVec;
       
       mVectorsRemaining--;
     }
@@ -335,6 +341,8 @@ public:
   }
 };
 
+using LinearGlide = LinearGlideOf<kFramesPerBlock>;
+
 class SampleAccurateLinearGlide
 {
   float mCurrValue{0.f};
@@ -0,0 +1,274 @@
+// madronalib: a C++ framework for DSP applications.
+// Copyright (c) 2026 Madrona Labs LLC. http://www.madronalabs.com
+// Distributed under the MIT license: http://madrona-labs.mit-license.org/
+
+// Band-limited wavetable oscillators.
+//
+// A Wavetable is a set of single-cycle frames, each stored at kLevels mip
+// levels. Level j keeps the harmonics up to kTableSize / 2 >> j, so it can be
+// played at up to kTableSize / 2 << j times its fundamental without aliasing.
+// The levels are made with RealFFT when the Wavetable is constructed, which
+// allocates, so make Wavetables on a loading thread. After that a Wavetable
+// is not changed, so one can be shared by any number of oscillators.
+//
+// WavetableLibrary holds Wavetables by name. Reached through a
+// SharedResourcePointer, it is one library for all of its users, so the
+// tables for a wavetable are made once however many voices play them.
+//
+// WavetableGen<T> is a Gen with two params, frequency and position. It
+// crossfades between two mip levels with the octave of the frequency, and
+// between two frames with the position on [0, 1], using linear interpolation
+// within each table. With T = float4 it plays four voices at once, one in
+// each lane, all from the same Wavetable.
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "MLDSPOps.h"
+#include "MLDSPMath.h"
+#include "MLDSPGens.h"
+#include "MLDSPFFT.h"
+#include "MLSharedResource.h"
+
+namespace ml
+{
+
+class Wavetable
+{
+ public:
+  static constexpr size_t kTableSize{2048};
+  static constexpr size_t kLevels{11};
+
+  // Each table has one extra sample, a copy of its first, so that reads
+  // between the last sample and the first need no wrapping.
+  static constexpr size_t kStride{kTableSize + 1};
+
+  // A frame size must be a power of two from kMinFFTSize to kTableSize.
+  static bool isValidFrameSize(size_t frameSize)
+  {
+    return isValidFFTSize(frameSize) && (frameSize <= kTableSize);
+  }
+
+  // Make the tables from numFrames frames of frameSize samples each, with at
+  // least one frame and a valid frame size. Smaller frames are interpolated
+  // to kTableSize through their spectra. DC is removed.
+  Wavetable(const float* frames, size_t frameSize, size_t numFrames)
+      : numFrames_(std::max(numFrames, size_t(1))), data_(kLevels * numFrames_ * kStride, 0.f)
+  {
+    assert(isValidFrameSize(frameSize) && numFrames);
+    if (!isValidFrameSize(frameSize) || !numFrames) return;
+
+    RealFFT frameFFT(frameSize), tableFFT(kTableSize);
+    fft::FloatBuffer frame(frameSize), frameSpectrum(frameSize);
+    fft::FloatBuffer spectrum(kTableSize), levelSpectrum(kTableSize), table(kTableSize);
+    const size_t frameHalf = frameSize / 2;
+    const size_t half = kTableSize / 2;
+    for (size_t f = 0; f < numFrames; ++f)
+    {
+      // move the frame's spectrum into the packed layout for kTableSize,
+      // dropping DC and Nyquist, scaled for the inverse.
+      std::copy(frames + f * frameSize, frames + (f + 1) * frameSize, frame.data());
+      frameFFT.forward(frame.data(), frameSpectrum.data());
+      std::fill(spectrum.data(), spectrum.data() + kTableSize, 0.f);
+      const float scale = 1.f / frameSize;
+      for (size_t k = 1; k < frameHalf; ++k)
+      {
+        spectrum.data()[k] = frameSpectrum.data()[k] * scale;
+        spectrum.data()[half + k] = frameSpectrum.data()[frameHalf + k] * scale;
+      }
+
+      for (size_t level = 0; level < kLevels; ++level)
+      {
+        const size_t harmonics = half >> level;
+        std::copy(spectrum.data(), spectrum.data() + kTableSize, levelSpectrum.data());
+        for (size_t k = harmonics + 1; k < half; ++k)
+        {
+          levelSpectrum.data()[k] = 0.f;
+          levelSpectrum.data()[half + k] = 0.f;
+        }
+        tableFFT.inverse(levelSpectrum.data(), table.data());
+        float* dest = data_.data() + getOffset(level, f);
+        std::copy(table.data(), table.data() + kTableSize, dest);
+        dest[kTableSize] = dest[0];
+      }
+    }
+  }
+
+  size_t getNumFrames() const { return numFrames_; }
+
+  // the start of the table for a level and frame.
+  size_t getOffset(size_t level, size_t frame) const { return (level * numFrames_ + frame) * kStride; }
+  const float* data() const { return data_.data(); }
+  const float* getTable(size_t level, size_t frame) const { return data_.data() + getOffset(level, frame); }
+
+ private:
+  size_t numFrames_;
+  std::vector<float> data_;
+};
+
+class WavetableLibrary
+{
+ public:
+  // Make a Wavetable and store it under name, replacing any with that name.
+  // Oscillators playing a replaced Wavetable keep it until they are given
+  // another. If the frame size is not valid or there are no frames, nothing
+  // is stored and null is returned.
+  std::shared_ptr<const Wavetable> load(const std::string& name, const float* frames, size_t frameSize,
+                                        size_t numFrames)
+  {
+    if (!Wavetable::isValidFrameSize(frameSize) || !numFrames) return nullptr;
+    auto table = std::make_shared<const Wavetable>(frames, frameSize, numFrames);
+    std::lock_guard<std::mutex> lock(mutex_);
+    tables_[name] = table;
+    return table;
+  }
+
+  // the Wavetable stored under name, or null.
+  std::shared_ptr<const Wavetable> get(const std::string& name) const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = tables_.find(name);
+    return (it != tables_.end()) ? it->second : nullptr;
+  }
+
+  void remove(const std::string& name)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tables_.erase(name);
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  std::map<std::string, std::shared_ptr<const Wavetable>> tables_;
+};
+
+// WavetableGen takes two inputs (freq and position). Frequencies must not be
+// negative. With no Wavetable, the output is zero.
+
+template<typename T, size_t FRAMES = kFramesPerBlock>
+struct WavetableGen : Gen<T, WavetableGen<T, FRAMES>, FRAMES>
+{
+  enum { freq, position, nParams };
+  enum { freqCoeff, positionCoeff, nCoeffs };
+
+  using Params = std::array<T, nParams>;
+  using Coeffs = std::array<T, nCoeffs>;
+
+  Coeffs coeffs{};
+  T phase_{0.f};
+
+  WavetableGen() = default;
+  WavetableGen(std::shared_ptr<const Wavetable> table) { setWavetable(std::move(table)); }
+
+  // Set the Wavetable. Copying the shared_ptr does not allocate, but do not
+  // let the audio thread drop the last reference to a Wavetable.
+  void setWavetable(std::shared_ptr<const Wavetable> table) { table_ = std::move(table); }
+  const std::shared_ptr<const Wavetable>& getWavetable() const { return table_; }
+
+  void clear() { phase_ = T{0.f}; }
+  void clearLanes(T mask) { phase_ = andNotBits(mask, phase_); }
+
+  static Coeffs makeCoeffs(Params p) { return Coeffs(p); }
+
+  T nextFrame(Coeffs c)
+  {
+    phase_ = fracPart(phase_ + c[freqCoeff]);
+    if (!table_) return T{0.f};
+    return read(*table_, phase_, c[freqCoeff], c[positionCoeff]);
+  }
+
+  Block<T, FRAMES> nextBlock(const SignalBlockArrayBase<T, nCoeffs, FRAMES>& c)
+  {
+    Block<T, FRAMES> phases = wrappingScan(c.getRow(freqCoeff), phase_);
+    if (!table_) return Block<T, FRAMES>(T{0.f});
+    const Wavetable& table = *table_;
+    const T* freqs = c.rowPtr(freqCoeff);
+    const T* positions = c.rowPtr(positionCoeff);
+    Block<T, FRAMES> y(uninitialized);
+    for (size_t t = 0; t < FRAMES; ++t)
+    {
+      y[t] = read(table, phases[t], freqs[t], positions[t]);
+    }
+    return y;
+  }
+
+ private:
+  static constexpr int kLanes = std::is_same_v<T, float> ? 1 : 4;
+  std::shared_ptr<const Wavetable> table_;
+
+  // Read each lane from its two levels and two frames, and crossfade. The
+  // positions and fades are computed for all the lanes at once, then each
+  // lane gathers its samples.
+  static T read(const Wavetable& table, T phase, T f, T position)
+  {
+    const float lastFrame = float(table.getNumFrames() - 1);
+    T tablePos = phase * T{float(Wavetable::kTableSize)};
+    T framePos = clamp(position, T{0.f}, T{1.f}) * T{lastFrame};
+    T octave = f * T{float(Wavetable::kTableSize)};
+
+    alignas(16) float tablePosLanes[4], framePosLanes[4], octaveLanes[4];
+    toLanes(tablePos, tablePosLanes);
+    toLanes(framePos, framePosLanes);
+    toLanes(octave, octaveLanes);
+
+    // the samples to interpolate, in the order level, frame, index
+    alignas(16) float s[8][4];
+    alignas(16) float sampleFrac[4], frameFrac[4], levelFade[4];
+    const float* d = table.data();
+    for (int k = 0; k < kLanes; ++k)
+    {
+      size_t i = std::min(size_t(tablePosLanes[k]), Wavetable::kTableSize - 1);
+      sampleFrac[k] = tablePosLanes[k] - float(i);
+      size_t f0 = size_t(framePosLanes[k]);
+      size_t f1 = std::min(f0 + 1, table.getNumFrames() - 1);
+      frameFrac[k] = framePosLanes[k] - float(f0);
+
+      // The exponent of kTableSize * f is the octave e, so that level e + 1
+      // has no harmonics above Nyquist. The mantissa fades to level e + 2
+      // over the octave.
+      uint32_t bits = reinterpretFloatAsInt(octaveLanes[k]);
+      int e = int((bits >> 23) & 0xFF) - 127;
+      levelFade[k] = reinterpretFloatAsInt((bits & 0x007FFFFF) | 0x3F800000) - 1.f;
+      size_t lo = size_t(std::clamp(e + 1, 0, int(Wavetable::kLevels) - 1));
+      size_t hi = size_t(std::clamp(e + 2, 0, int(Wavetable::kLevels) - 1));
+
+      const size_t offsets[4] = {table.getOffset(lo, f0), table.getOffset(lo, f1), table.getOffset(hi, f0),
+                                 table.getOffset(hi, f1)};
+      for (int j = 0; j < 4; ++j)
+      {
+        s[j * 2][k] = d[offsets[j] + i];
+        s[j * 2 + 1][k] = d[offsets[j] + i + 1];
+      }
+    }
+
+    T sf = fromLanes(sampleFrac), ff = fromLanes(frameFrac), lf = fromLanes(levelFade);
+    T v[4];
+    for (int j = 0; j < 4; ++j) v[j] = lerp(fromLanes(s[j * 2]), fromLanes(s[j * 2 + 1]), sf);
+    return lerp(lerp(v[0], v[1], ff), lerp(v[2], v[3], ff), lf);
+  }
+
+  static void toLanes(T x, float* lanes)
+  {
+    if constexpr (kLanes == 1)
+      lanes[0] = x;
+    else
+      storeFloat4(lanes, x);
+  }
+
+  static T fromLanes(const float* lanes)
+  {
+    if constexpr (kLanes == 1)
+      return lanes[0];
+    else
+      return loadFloat4(lanes);
+  }
+};
+
+}  // namespace ml
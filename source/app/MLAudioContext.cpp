@@ -14,7 +14,8 @@ namespace ml
 // In a plugin, this should be called before each processing block with the latest info from the
 // host. In an app, this can be called only when there are time / rate changes.
 
-void AudioContext::ProcessTime::setTimeAndRate(const double ppqPos, const double bpmIn,
+template<size_t FRAMES>
+void AudioContextOf<FRAMES>::ProcessTime::setTimeAndRate(const double ppqPos, const double bpmIn,
                                                bool isPlaying, double sampleRateIn)
 {
   // working around a bug I can't reproduce, so I'm covering all the bases.
@@ -78,7 +79,8 @@ void AudioContext::ProcessTime::setTimeAndRate(const double ppqPos, const double
   samplesSincePreviousTime_ = 0;
 }
 
-void AudioContext::ProcessTime::clear(void)
+template<size_t FRAMES>
+void AudioContextOf<FRAMES>::ProcessTime::clear(void)
 {
   dpdt_ = 0.;
   active1_ = false;
@@ -86,9 +88,10 @@ void AudioContext::ProcessTime::clear(void)
 }
 
 // generate phasors from the input parameters
-void AudioContext::ProcessTime::makeTimeSignals()
+template<size_t FRAMES>
+void AudioContextOf<FRAMES>::ProcessTime::makeTimeSignals()
 {
-  for (int n = 0; n < kFramesPerBlock; ++n)
+  for (int n = 0; n < FRAMES; ++n)
   {
     quarterNotesPhase_[n] = omega_;
     omega_ += dpdt_;
@@ -97,14 +100,15 @@ void AudioContext::ProcessTime::makeTimeSignals()
       omega_ -= 1.f;
     }
   }
-  samplesSincePreviousTime_ += kFramesPerBlock;
-  samplesSinceStart += kFramesPerBlock;
+  samplesSincePreviousTime_ += FRAMES;
+  samplesSinceStart += FRAMES;
 }
 
 
 // AudioContext
 
-AudioContext::AudioContext(size_t nInputs, size_t nOutputs, int rate)
+template<size_t FRAMES>
+AudioContextOf<FRAMES>::AudioContextOf(size_t nInputs, size_t nOutputs, int rate)
     : inputs(nInputs), outputs(nOutputs)
 {
   resizeBuffers(nInputs, nOutputs, kMaxIOFramesDefault);
@@ -112,13 +116,15 @@ AudioContext::AudioContext(size_t nInputs, size_t nOutputs, int rate)
   clear();
 }
 
-void AudioContext::setSampleRate(int r)
+template<size_t FRAMES>
+void AudioContextOf<FRAMES>::setSampleRate(int r)
 {
   currentTime.sampleRate = r;
   eventsToSignals.setSampleRate(r);
 }
 
-void AudioContext::resizeBuffers(size_t nInputs, size_t nOutputs, size_t maxFrames)
+template<size_t FRAMES>
+void AudioContextOf<FRAMES>::resizeBuffers(size_t nInputs, size_t nOutputs, size_t maxFrames)
 {
   inputBuffers_.resize(nInputs);
   for (int i = 0; i < nInputs; ++i)
@@ -133,13 +139,14 @@ void AudioContext::resizeBuffers(size_t nInputs, size_t nOutputs, size_t maxFram
   }
 }
 
-void AudioContext::clear()
+template<size_t FRAMES>
+void AudioContextOf<FRAMES>::clear()
 {
   currentTime.clear();
   eventsToSignals.clear();
   
   // add a block of zeros to output buffer. We have a constant one-block delay between input and output.
-  SignalBlock emptyBlock(0.f);
+  SignalBlockOf<FRAMES> emptyBlock(0.f);
   for (auto& buf : outputBuffers_)
   {
     buf.clear();
@@ -152,9 +159,10 @@ void AudioContext::clear()
 // Buffer the external context and provide an internal context for the process function.
 // Then run the process function in the internal context as many times are necessary to
 // generate externalFrames of output.
-void AudioContext::process(const float** externalInputs, float** externalOutputs,
+template<size_t FRAMES>
+void AudioContextOf<FRAMES>::process(const float** externalInputs, float** externalOutputs,
                                   int externalFrames,
-                                  SignalProcessFn processFn, void* state)
+                                  ProcessFn processFn, void* state)
 {
   size_t nInputs = inputBuffers_.size();
   size_t nOutputs = outputBuffers_.size();
@@ -172,12 +180,12 @@ void AudioContext::process(const float** externalInputs, float** externalOutputs
   }
   
   inputSamplesAccumulated_ += externalFrames;
-  while (inputSamplesAccumulated_ >= kFramesPerBlock)
+  while (inputSamplesAccumulated_ >= FRAMES)
   {
     // read one block from each input buffer
     for (int c = 0; c < nInputs; c++)
     {
-      inputs[c] = inputBuffers_[c].read();
+      inputs[c] = inputBuffers_[c].read<FRAMES>();
     }
     
     // generate one block of time / event / controller signals
@@ -194,8 +202,8 @@ void AudioContext::process(const float** externalInputs, float** externalOutputs
     }
         
     // shift any remaining events in buffer forward and fix accum counter
-    eventsToSignals.adjustEventsInBuffer(kFramesPerBlock);
-    inputSamplesAccumulated_ -= kFramesPerBlock;
+    eventsToSignals.adjustEventsInBuffer(FRAMES);
+    inputSamplesAccumulated_ -= FRAMES;
   }
   
   // read from outputBuffers to external outputs
@@ -208,22 +216,32 @@ void AudioContext::process(const float** externalInputs, float** externalOutputs
   }
 }
 
-SignalBlock AudioContext::getInputController(size_t n) const
+template<size_t FRAMES>
+SignalBlockOf<FRAMES> AudioContextOf<FRAMES>::getInputController(size_t n) const
 {
   return eventsToSignals.getController(n).output;
 }
 
-void AudioContext::addInputEvent(const Event& e)
+template<size_t FRAMES>
+void AudioContextOf<FRAMES>::addInputEvent(const Event& e)
 {
   Event adjusted = e;
   adjusted.time += inputSamplesAccumulated_;
   eventsToSignals.addEvent(adjusted);
 }
 
-void AudioContext::updateTime(const double ppqPos, const double bpmIn, bool isPlaying,
+template<size_t FRAMES>
+void AudioContextOf<FRAMES>::updateTime(const double ppqPos, const double bpmIn, bool isPlaying,
                               double sampleRateIn)
 {
   currentTime.setTimeAndRate(ppqPos, bpmIn, isPlaying, sampleRateIn);
 }
 
+// The block sizes allowed by kFramesPerBlockBits.
+template class AudioContextOf<16>;
+template class AudioContextOf<32>;
+template class AudioContextOf<64>;
+template class AudioContextOf<128>;
+template class AudioContextOf<256>;
+
 }  // namespace ml
@@ -13,7 +13,15 @@ namespace ml
 
 // AudioContext: where our signal processors meet the rest of the world.
 // an AudioContext defines the sample rate and provides audio and event I/O.
-class AudioContext;
+//
+// AudioContextOf<FRAMES> runs its process function on blocks of FRAMES frames,
+// and AudioContext uses the default kFramesPerBlock. Because input is buffered
+// into whole blocks, the latency from input to output is one block. The member
+// functions are instantiated in MLAudioContext.cpp for blocks of 16 to 256 frames.
+template<size_t FRAMES>
+class AudioContextOf;
+
+using AudioContext = AudioContextOf<kFramesPerBlock>;
 
 using MainInputs = const SignalBlockDynamic&;
 using MainOutputs = SignalBlockDynamic&;
@@ -21,9 +29,13 @@ using SignalProcessFn = void (*)(AudioContext*, void*);
 
 constexpr size_t kMaxIOFramesDefault{4096};
 
-class AudioContext final
+template<size_t FRAMES>
+class AudioContextOf final
 {
  public:
+  using ProcessFn = void (*)(AudioContextOf*, void*);
+  static constexpr size_t kFrames{FRAMES};
+
   // AudioContext::ProcessTime maintains the current time in a DSP process and can track
   // the time in the host application if there is one.
   class ProcessTime
@@ -42,7 +54,7 @@ class AudioContext final
     void makeTimeSignals();
 
     // externally readable values 
-    SignalBlock quarterNotesPhase_;
+    SignalBlockOf<FRAMES> quarterNotesPhase_;
 
     double bpm{0};
     double sampleRate{0};
@@ -59,8 +71,8 @@ class AudioContext final
   };
 
 
-  AudioContext(size_t nInputs, size_t nOutputs, int sampleRate);
-  ~AudioContext() = default;
+  AudioContextOf(size_t nInputs, size_t nOutputs, int sampleRate);
+  ~AudioContextOf() = default;
 
   void clear();
 
@@ -71,7 +83,7 @@ class AudioContext final
   size_t getInputPolyphony() { return eventsToSignals.getPolyphony(); }
 
   void updateTime(const double ppqPos, const double bpmIn, bool isPlaying, double sampleRateIn);
-  SignalBlock getBeatPhase() { return currentTime.quarterNotesPhase_; }
+  SignalBlockOf<FRAMES> getBeatPhase() { return currentTime.quarterNotesPhase_; }
 
   void addInputEvent(const Event& e);
   void clearInputEvents() { eventsToSignals.clearEvents(); }
@@ -83,26 +95,26 @@ class AudioContext final
   void setInputUnison(bool u) { eventsToSignals.setUnison(u); }
   void setInputProtocol(Symbol p) { eventsToSignals.setProtocol(p); }
   void setInputModCC(int p) { eventsToSignals.setModCC(p); }
-  const EventsToSignals::Voice& getInputVoice(int n) { return eventsToSignals.getVoice(n); }
+  const typename EventsToSignalsOf<FRAMES>::Voice& getInputVoice(int n) { return eventsToSignals.getVoice(n); }
 
   int getNewestInputVoice() { return eventsToSignals.getNewestVoice(); }
-  SignalBlock getInputController(size_t n) const;
+  SignalBlockOf<FRAMES> getInputController(size_t n) const;
 
   double getSampleRate() { return currentTime.sampleRate; }
   const ProcessTime& getTimeInfo() { return currentTime; }
 
   // clients can access these directly to do processing
-  SignalBlockDynamic inputs;
-  SignalBlockDynamic outputs;
+  SignalBlockDynamicOf<FRAMES> inputs;
+  SignalBlockDynamicOf<FRAMES> outputs;
   
   void process(const float** inputs, float** outputs, int nFrames,
-               SignalProcessFn processFn, void* pState);
+               ProcessFn processFn, void* pState);
   
 
  private:
   ProcessTime currentTime;
   
-  ml::EventsToSignals eventsToSignals;
+  ml::EventsToSignalsOf<FRAMES> eventsToSignals;
   
   // buffers containing audio to / from outside world, in bigger chunks
   std::vector<ml::DSPBuffer> inputBuffers_;
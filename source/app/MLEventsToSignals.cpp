@@ -45,22 +45,26 @@ int getKeyIndex(const Event& e, Symbol protocol)
 // EventsToSignals::Voice
 //
 
-void EventsToSignals::Voice::setSampleRate(double r)
+template<size_t FRAMES>
+void EventsToSignalsOf<FRAMES>::Voice::setSampleRate(double r)
 {
   sr = r;
   recalcNeeded = true;
 }
 
-void EventsToSignals::Voice::setPitchGlideInSeconds(float g)
+template<size_t FRAMES>
+void EventsToSignalsOf<FRAMES>::Voice::setPitchGlideInSeconds(float g)
 {
   pitchGlideTimeInSeconds = g;
   recalcNeeded = true;
 }
 
-void EventsToSignals::Voice::setDriftAmount(float d) { driftAmount = d; }
+template<size_t FRAMES>
+void EventsToSignalsOf<FRAMES>::Voice::setDriftAmount(float d) { driftAmount = d; }
 
 // done when DSP is reset.
-void EventsToSignals::Voice::reset()
+template<size_t FRAMES>
+void EventsToSignalsOf<FRAMES>::Voice::reset()
 {
   driftSource.seed_ = voiceIndex * 232;
 
@@ -86,9 +90,11 @@ void EventsToSignals::Voice::reset()
 }
 
 // just reset the time.
-void EventsToSignals::Voice::resetTime() { eventAgeInSamples = 0; }
+template<size_t FRAMES>
+void EventsToSignalsOf<FRAMES>::Voice::resetTime() { eventAgeInSamples = 0; }
 
-void EventsToSignals::Voice::beginProcess()
+template<size_t FRAMES>
+void EventsToSignalsOf<FRAMES>::Voice::beginProcess()
 {
   if (recalcNeeded)
   {
@@ -114,7 +120,7 @@ void EventsToSignals::Voice::beginProcess()
   }
 
   nextFrameToProcess = 0;
-  driftCounter += kFramesPerBlock;
+  driftCounter += FRAMES;
 
   int driftIntervalSamples = (int)(sr * kDriftTimeSeconds);
   if (driftCounter >= nextDriftTimeInSamples)
@@ -129,7 +135,8 @@ void EventsToSignals::Voice::beginProcess()
 
 // write current signals and continue existing glides up to the frame just before
 // the time when a new event will happen.
-void EventsToSignals::Voice::writeOutputSignals(size_t endTime)
+template<size_t FRAMES>
+void EventsToSignalsOf<FRAMES>::Voice::writeOutputSignals(size_t endTime)
 {
   while(nextFrameToProcess < endTime)
   {
@@ -149,10 +156,11 @@ void EventsToSignals::Voice::writeOutputSignals(size_t endTime)
 
 // Write a note event to the voice. Writes all voice output signals for all frames
 // prior to the event time. Updates nextFrameToProcess with the event time.
-void EventsToSignals::Voice::writeNoteEvent(const Event& e, int keyIdx, bool doGlide, bool doReset)
+template<size_t FRAMES>
+void EventsToSignalsOf<FRAMES>::Voice::writeNoteEvent(const Event& e, int keyIdx, bool doGlide, bool doReset)
 {
   // incoming time in the event e is the sample offset into the DSPVector.
-  size_t destTime = clamp((size_t)e.time, (size_t)0, (size_t)kFramesPerBlock);
+  size_t destTime = clamp((size_t)e.time, (size_t)0, (size_t)FRAMES);
 
   switch (e.type)
   {
@@ -230,9 +238,10 @@ void EventsToSignals::Voice::writeNoteEvent(const Event& e, int keyIdx, bool doG
 
 // write all voice output signals from the most recent event's time to
 // the end of the buffer.
-void EventsToSignals::Voice::endProcess(float pitchBend)
+template<size_t FRAMES>
+void EventsToSignalsOf<FRAMES>::Voice::endProcess(float pitchBend)
 {
-  writeOutputSignals(kFramesPerBlock);
+  writeOutputSignals(FRAMES);
 
   // process glides, accurate to the DSP vector
   auto bendGlide = pitchBendGlide(currentPitchBend);
@@ -261,13 +270,15 @@ void EventsToSignals::Voice::endProcess(float pitchBend)
 // SmoothedController
 //
 
-void EventsToSignals::SmoothedController::setSampleRate(double r)
+template<size_t FRAMES>
+void EventsToSignalsOf<FRAMES>::SmoothedController::setSampleRate(double r)
 {
   sr = r;
   recalcNeeded = true;
 }
 
-void EventsToSignals::SmoothedController::process()
+template<size_t FRAMES>
+void EventsToSignalsOf<FRAMES>::SmoothedController::process()
 {
   if (recalcNeeded)
   {
@@ -285,7 +296,8 @@ void EventsToSignals::SmoothedController::process()
 // EventsToSignals
 //
 
-EventsToSignals::EventsToSignals()
+template<size_t FRAMES>
+EventsToSignalsOf<FRAMES>::EventsToSignalsOf()
 {
   eventBuffer_.reserve(kMaxEventsPerProcessBuffer);
 
@@ -296,15 +308,17 @@ EventsToSignals::EventsToSignals()
     voices[i].reset();
 
     // set vox output signal
-    voices[i].outputs.setRow(kVoice, SignalBlock((float)i - 1));
+    voices[i].outputs.setRow(kVoice, SignalBlockOf<FRAMES>((float)i - 1));
   }
 
   controllers.resize(kNumControllers);
 }
 
-EventsToSignals::~EventsToSignals() {}
+template<size_t FRAMES>
+EventsToSignalsOf<FRAMES>::~EventsToSignalsOf() {}
 
-void EventsToSignals::setSampleRate(double r)
+template<size_t FRAMES>
+void EventsToSignalsOf<FRAMES>::setSampleRate(double r)
 {
   sr = r;
 
@@ -319,16 +333,19 @@ void EventsToSignals::setSampleRate(double r)
   }
 }
 
-size_t EventsToSignals::setPolyphony(size_t n)
+template<size_t FRAMES>
+size_t EventsToSignalsOf<FRAMES>::setPolyphony(size_t n)
 {
   clear();
   polyphony_ = std::min(n, kMaxVoices);
   return polyphony_;
 }
 
-size_t EventsToSignals::getPolyphony() { return polyphony_; }
+template<size_t FRAMES>
+size_t EventsToSignalsOf<FRAMES>::getPolyphony() { return polyphony_; }
 
-void EventsToSignals::clear()
+template<size_t FRAMES>
+void EventsToSignalsOf<FRAMES>::clear()
 {
   eventBuffer_.clear();
 
@@ -340,7 +357,8 @@ void EventsToSignals::clear()
   lastFreeVoiceFound_ = 0;
 }
 
-void EventsToSignals::resetTimes()
+template<size_t FRAMES>
+void EventsToSignalsOf<FRAMES>::resetTimes()
 {
   eventBuffer_.clear();
 
@@ -369,18 +387,21 @@ bool soonerThan(const Event& a, const Event& b)
 
 // events should usually arrive in order, but unfortunately not all hosts will ensure this.
 // so we need to insert events by time on arrival.
-void EventsToSignals::addEvent(const Event& e)
+template<size_t FRAMES>
+void EventsToSignalsOf<FRAMES>::addEvent(const Event& e)
 {
   awake_ = true;
   auto it = std::lower_bound(eventBuffer_.begin(), eventBuffer_.end(), e, soonerThan);
   eventBuffer_.insert(it, e);
 }
 
-void EventsToSignals::clearEvents() {
+template<size_t FRAMES>
+void EventsToSignalsOf<FRAMES>::clearEvents() {
   eventBuffer_.clear();
 }
 
-void EventsToSignals::adjustEventsInBuffer(size_t startTime)
+template<size_t FRAMES>
+void EventsToSignalsOf<FRAMES>::adjustEventsInBuffer(size_t startTime)
 {
   for (auto& e : eventBuffer_)
   {
@@ -389,7 +410,8 @@ void EventsToSignals::adjustEventsInBuffer(size_t startTime)
 }
 
 
-void EventsToSignals::makeSignalBlock()
+template<size_t FRAMES>
+void EventsToSignalsOf<FRAMES>::makeSignalBlock()
 {
   // if we have never received an event, do nothing
   if (!awake_) return;
@@ -408,7 +430,7 @@ void EventsToSignals::makeSignalBlock()
   int eventsProcessed = 0;
   for (const auto& e : eventBuffer_)
   {
-    if(within(e.time, 0, (int)kFramesPerBlock))
+    if(within(e.time, 0, (int)FRAMES))
     {
       Event eventInThisVector = e;
       processEvent(eventInThisVector);
@@ -465,7 +487,7 @@ void EventsToSignals::makeSignalBlock()
     }
   }
 
-  testCounter += kFramesPerBlock;
+  testCounter += FRAMES;
   const int samples = 48000*5;
 
   if (testCounter > samples)
@@ -475,7 +497,8 @@ void EventsToSignals::makeSignalBlock()
   }
 }
 
-size_t EventsToSignals::countHeldKeys()
+template<size_t FRAMES>
+size_t EventsToSignalsOf<FRAMES>::countHeldKeys()
 {
   // count held keys. It might seem like we could just keep a counter, but
   // redundant note offs, which break that approach, are common.
@@ -489,7 +512,8 @@ size_t EventsToSignals::countHeldKeys()
 }
 
 // TEMP
-void EventsToSignals::showHeldKeys()
+template<size_t FRAMES>
+void EventsToSignalsOf<FRAMES>::showHeldKeys()
 {
   std::cout << "held:\n";
   for (int i = 0; i < kMaxPhysicalKeys; ++i)
@@ -515,7 +539,8 @@ void EventsToSignals::showHeldKeys()
   std::cout << "\n";
 }
 
-size_t EventsToSignals::countActiveVoices()
+template<size_t FRAMES>
+size_t EventsToSignalsOf<FRAMES>::countActiveVoices()
 {
   size_t c{0};
   for (int i = 1; i < polyphony_ + 1; ++i)
@@ -529,7 +554,8 @@ size_t EventsToSignals::countActiveVoices()
 }
 
 // process one incoming event by making the appropriate changes in state and change lists.
-void EventsToSignals::processEvent(const Event& eventParam)
+template<size_t FRAMES>
+void EventsToSignalsOf<FRAMES>::processEvent(const Event& eventParam)
 {
   Event event = eventParam;
 
@@ -564,7 +590,8 @@ void EventsToSignals::processEvent(const Event& eventParam)
 
 // a note on event tells use that the given key (channel, key#) wants to start
 // a note with the given pitch and velocity.
-void EventsToSignals::processNoteOnEvent(const Event& e)
+template<size_t FRAMES>
+void EventsToSignalsOf<FRAMES>::processNoteOnEvent(const Event& e)
 {
   int keyIdx = getKeyIndex(e, protocol_);
   keyStates_[keyIdx].state = KeyState::kOn;
@@ -617,7 +644,8 @@ void EventsToSignals::processNoteOnEvent(const Event& e)
   }
 }
 
-void EventsToSignals::processNoteOffEvent(const Event& e)
+template<size_t FRAMES>
+void EventsToSignalsOf<FRAMES>::processNoteOffEvent(const Event& e)
 {
   int keyIdx = getKeyIndex(e, protocol_);
   if (sustainPedalActive_)
@@ -700,9 +728,11 @@ void EventsToSignals::processNoteOffEvent(const Event& e)
 }
 
 // ?
-void EventsToSignals::processNoteUpdateEvent(const Event& event) {}
+template<size_t FRAMES>
+void EventsToSignalsOf<FRAMES>::processNoteUpdateEvent(const Event& event) {}
 
-void EventsToSignals::processChannelPressureEvent(const Event& event)
+template<size_t FRAMES>
+void EventsToSignalsOf<FRAMES>::processChannelPressureEvent(const Event& event)
 {
   switch (protocol_.getHash())
   {
@@ -736,7 +766,8 @@ void EventsToSignals::processChannelPressureEvent(const Event& event)
   }
 }
 
-void EventsToSignals::processNotePressureEvent(const Event& event)
+template<size_t FRAMES>
+void EventsToSignalsOf<FRAMES>::processNotePressureEvent(const Event& event)
 {
   switch (protocol_.getHash())
   {
@@ -760,7 +791,8 @@ void EventsToSignals::processNotePressureEvent(const Event& event)
   }
 }
 
-void EventsToSignals::processPitchWheelEvent(const Event& event)
+template<size_t FRAMES>
+void EventsToSignalsOf<FRAMES>::processPitchWheelEvent(const Event& event)
 {
   switch (protocol_.getHash())
   {
@@ -796,7 +828,8 @@ void EventsToSignals::processPitchWheelEvent(const Event& event)
 }
 
 // this handles all controller numbers
-void EventsToSignals::processControllerEvent(const Event& event)
+template<size_t FRAMES>
+void EventsToSignalsOf<FRAMES>::processControllerEvent(const Event& event)
 {
   int chan = event.channel;
   float val = event.value1;
@@ -890,7 +923,8 @@ void EventsToSignals::processControllerEvent(const Event& event)
   }
 }
 
-void EventsToSignals::processSustainPedalEvent(const Event& event)
+template<size_t FRAMES>
+void EventsToSignalsOf<FRAMES>::processSustainPedalEvent(const Event& event)
 {
   sustainPedalActive_ = (event.value1 > 0.5f) ? 1 : 0;
   if (!sustainPedalActive_)
@@ -919,11 +953,14 @@ void EventsToSignals::processSustainPedalEvent(const Event& event)
   }
 }
 
-void EventsToSignals::setPitchBendInSemitones(float f) { pitchBendRangeInSemitones_ = f; }
+template<size_t FRAMES>
+void EventsToSignalsOf<FRAMES>::setPitchBendInSemitones(float f) { pitchBendRangeInSemitones_ = f; }
 
-void EventsToSignals::setMPEPitchBendInSemitones(float f) { mpePitchBendRangeInSemitones_ = f; }
+template<size_t FRAMES>
+void EventsToSignalsOf<FRAMES>::setMPEPitchBendInSemitones(float f) { mpePitchBendRangeInSemitones_ = f; }
 
-void EventsToSignals::setPitchGlideInSeconds(float f)
+template<size_t FRAMES>
+void EventsToSignalsOf<FRAMES>::setPitchGlideInSeconds(float f)
 {
   for (auto& v : voices)
   {
@@ -931,7 +968,8 @@ void EventsToSignals::setPitchGlideInSeconds(float f)
   }
 }
 
-void EventsToSignals::setDriftAmount(float f)
+template<size_t FRAMES>
+void EventsToSignalsOf<FRAMES>::setDriftAmount(float f)
 {
   for (auto& v : voices)
   {
@@ -939,14 +977,16 @@ void EventsToSignals::setDriftAmount(float f)
   }
 }
 
-void EventsToSignals::setUnison(bool b) { unison_ = b; }
+template<size_t FRAMES>
+void EventsToSignalsOf<FRAMES>::setUnison(bool b) { unison_ = b; }
 
 #pragma mark -
 
 // return (one-based) index of free voice or -1 for none.
 // if a free voice is found, lastFreeVoiceFound_ is updated.
 //
-int EventsToSignals::findFreeVoice()
+template<size_t FRAMES>
+int EventsToSignalsOf<FRAMES>::findFreeVoice()
 {
   auto highestVoiceIdx = polyphony_ + 1;
   int r = -1;
@@ -969,7 +1009,8 @@ int EventsToSignals::findFreeVoice()
 
 // return the index of the voice with the note nearest to the note n.
 // Must always return a valid voice index.
-int EventsToSignals::findNearestVoice(int note)
+template<size_t FRAMES>
+int EventsToSignalsOf<FRAMES>::findNearestVoice(int note)
 {
   int r = 1;
   size_t minDist = 1024;
@@ -987,7 +1028,8 @@ int EventsToSignals::findNearestVoice(int note)
   return r;
 }
 
-void EventsToSignals::dumpVoices()
+template<size_t FRAMES>
+void EventsToSignalsOf<FRAMES>::dumpVoices()
 {
   auto dumpVoice = [&](int i)
   {
@@ -1040,4 +1082,11 @@ void EventsToSignals::dumpVoices()
   std::cout << "\n";
 }
 
+// The block sizes allowed by kFramesPerBlockBits.
+template class EventsToSignalsOf<16>;
+template class EventsToSignalsOf<32>;
+template class EventsToSignalsOf<64>;
+template class EventsToSignalsOf<128>;
+template class EventsToSignalsOf<256>;
+
 }  // namespace ml
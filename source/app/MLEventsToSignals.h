@@ -40,9 +40,11 @@ struct KeyState
 };
 
 // EventsToSignals processes different types of events and generates bundles of signals to
-// control synthesizers.
+// control synthesizers, one block of FRAMES frames at a time. The member functions are
+// instantiated in MLEventsToSignals.cpp for blocks of 16 to 256 frames.
 
-class EventsToSignals final
+template<size_t FRAMES>
+class EventsToSignalsOf final
 {
  public:
   static constexpr size_t kMaxVoices{16};
@@ -56,8 +58,8 @@ class EventsToSignals final
   static constexpr float kDriftTimeSeconds{8.0f};
   static constexpr float kDriftScale{0.02f};
 
-  explicit EventsToSignals();
-  ~EventsToSignals();
+  explicit EventsToSignalsOf();
+  ~EventsToSignalsOf();
 
   void setSampleRate(double r);
 
@@ -78,7 +80,7 @@ class EventsToSignals final
   void adjustEventsInBuffer(size_t time);
   
   // process incoming events in buffer and generate output signals.
-  // events in the queue in the time range [0, kFramesPerBlock) will
+  // events in the queue in the time range [0, FRAMES) will
   // be processed. it is assumed that all events in the queue are sorted by start time. Any
   // events outside the time range will be ignored.
   void makeSignalBlock();
@@ -127,7 +129,7 @@ class EventsToSignals final
     // data
 
     // output signals (velocity, pitch, voice... )
-    SignalBlockArray<kNumVoiceOutputRows> outputs;
+    SignalBlockArrayOf<kNumVoiceOutputRows, FRAMES> outputs;
 
     size_t nextFrameToProcess{0};
 
@@ -149,11 +151,11 @@ class EventsToSignals final
 
     // pitch glide
     SampleAccurateLinearGlide pitchGlide;
-    LinearGlide pitchBendGlide;
-    LinearGlide modGlide;
-    LinearGlide xGlide;
-    LinearGlide yGlide;
-    LinearGlide zGlide;
+    LinearGlideOf<FRAMES> pitchBendGlide;
+    LinearGlideOf<FRAMES> modGlide;
+    LinearGlideOf<FRAMES> xGlide;
+    LinearGlideOf<FRAMES> yGlide;
+    LinearGlideOf<FRAMES> zGlide;
     float pitchGlideTimeInSeconds{0};
     int pitchGlideTimeInSamples{0};
     bool inhibitPitchGlide{0};
@@ -161,7 +163,7 @@ class EventsToSignals final
     // drift generates a wandering signal on [0, 1] then is scaled and added to pitch
     // TODO encapsulate this as DrunkenWalkGen
     RandomScalarSource driftSource;
-    LinearGlide pitchDriftGlide;
+    LinearGlideOf<FRAMES> pitchDriftGlide;
     int driftCounter{0};
     float currentDriftValue{0};
     float driftAmount{0};
@@ -178,8 +180,8 @@ class EventsToSignals final
     void setSampleRate(double r);
     void process();
 
-    LinearGlide glide;
-    SignalBlock output{0.f};
+    LinearGlideOf<FRAMES> glide;
+    SignalBlockOf<FRAMES> output{0.f};
     float inputValue{0.f};
     double sr{0};
     bool recalcNeeded{false};
@@ -243,5 +245,7 @@ class EventsToSignals final
   int testCounter{0};
 };
 
+using EventsToSignals = EventsToSignalsOf<kFramesPerBlock>;
+
 }  // namespace ml
 
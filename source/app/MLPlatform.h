@@ -50,4 +50,12 @@ extern "C"
 #define ML_UNKNOWN 1  // this happens with Apple's Rez for example, so can't cause an error
 #endif
 
+// The SIMD vector wrapper types are read and written through pointers into float
+// and int32 arrays, so they must be allowed to alias those types.
+#if defined(__GNUC__) || defined(__clang__)
+#define ML_MAY_ALIAS __attribute__((__may_alias__))
+#else
+#define ML_MAY_ALIAS
+#endif
+
 #endif  // _ML_PLATFORM_H